@@ -0,0 +1,121 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include <util/threading.h>
+#include <util/platform.h>
+#include <algorithm>
+#include <chrono>
+#include "project-saver.hpp"
+
+using namespace std;
+
+/* wait for edits to settle, but never delay a write for too long */
+#define SAVE_QUIET_NS       500000000ULL
+#define SAVE_MAX_LATENCY_NS 3000000000ULL
+
+ProjectSaver::ProjectSaver()
+{
+	thread = std::thread([this] () {SaveThread();});
+}
+
+ProjectSaver::~ProjectSaver()
+{
+	{
+		lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+
+	cv.notify_one();
+	thread.join();
+}
+
+void ProjectSaver::SaveThread()
+{
+	os_set_thread_name("scene collection save thread");
+
+	unique_lock<std::mutex> lock(mutex);
+
+	for (;;) {
+		if (!pending) {
+			if (stopping)
+				break;
+
+			cv.wait(lock);
+			continue;
+		}
+
+		uint64_t now = os_gettime_ns();
+		uint64_t deadline = min(lastQueued + SAVE_QUIET_NS,
+				firstQueued + SAVE_MAX_LATENCY_NS);
+
+		if (!flushing && !stopping && now < deadline) {
+			cv.wait_for(lock, chrono::nanoseconds(deadline - now));
+			continue;
+		}
+
+		OBSData data = move(pending);
+		string path = move(pendingPath);
+		writing = true;
+
+		lock.unlock();
+
+		if (!obs_data_save_json_safe(data, path.c_str(), "tmp", "bak"))
+			blog(LOG_ERROR, "Could not save scene data to %s",
+					path.c_str());
+		data = nullptr;
+
+		lock.lock();
+
+		writing = false;
+		written.notify_all();
+	}
+}
+
+void ProjectSaver::WaitWritten(unique_lock<std::mutex> &lock)
+{
+	flushing = true;
+	cv.notify_one();
+
+	written.wait(lock, [this] () {return !pending && !writing;});
+	flushing = false;
+}
+
+void ProjectSaver::Queue(obs_data_t *data, const char *path)
+{
+	unique_lock<std::mutex> lock(mutex);
+
+	/* a snapshot of another collection is never dropped */
+	if (pending && pendingPath != path)
+		WaitWritten(lock);
+
+	uint64_t now = os_gettime_ns();
+
+	if (!pending)
+		firstQueued = now;
+	lastQueued = now;
+
+	pending = data;
+	pendingPath = path;
+
+	cv.notify_one();
+}
+
+void ProjectSaver::Flush()
+{
+	unique_lock<std::mutex> lock(mutex);
+	WaitWritten(lock);
+}
@@ -0,0 +1,55 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <obs.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/* Writes scene collections on a background thread.  A snapshot that is
+ * queued while another one waits replaces it, so a burst of edits results
+ * in a single write, no later than a fixed time after the first edit. */
+class ProjectSaver {
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::condition_variable written;
+
+	OBSData pending;
+	std::string pendingPath;
+	uint64_t firstQueued = 0;
+	uint64_t lastQueued = 0;
+	bool writing = false;
+	bool flushing = false;
+	bool stopping = false;
+
+	void SaveThread();
+	void WaitWritten(std::unique_lock<std::mutex> &lock);
+
+public:
+	ProjectSaver();
+	~ProjectSaver();
+
+	/* data must not be modified after it was queued */
+	void Queue(obs_data_t *data, const char *path);
+
+	/* blocks until every queued snapshot is written */
+	void Flush();
+};
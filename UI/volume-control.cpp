@@ -29,17 +29,6 @@ void VolControl::OBSVolumeChanged(void *data, float db)
 	QMetaObject::invokeMethod(volControl, "VolumeChanged");
 }
 
-void VolControl::OBSVolumeLevel(void *data, float level, float mag,
-			float peak, float muted)
-{
-	VolControl *volControl = static_cast<VolControl*>(data);
-
-	if (muted)
-		level = mag = peak = 0.0f;
-
-	volControl->volMeter->setLevels(mag, level, peak);
-}
-
 void VolControl::OBSVolumeMuted(void *data, calldata_t *calldata)
 {
 	VolControl *volControl = static_cast<VolControl*>(data);
@@ -121,7 +110,7 @@ VolControl::VolControl(OBSSource source_, bool showConfig)
 
 	nameLabel = new QLabel();
 	volLabel  = new QLabel();
-	volMeter  = new VolumeMeter();
+	volMeter  = new VolumeMeter(nullptr, obs_volmeter);
 	mute      = new MuteCheckBox();
 	slider    = new QSlider(Qt::Horizontal);
 
@@ -184,7 +173,6 @@ VolControl::VolControl(OBSSource source_, bool showConfig)
 	setLayout(mainLayout);
 
 	obs_fader_add_callback(obs_fader, OBSVolumeChanged, this);
-	obs_volmeter_add_callback(obs_volmeter, OBSVolumeLevel, this);
 
 	signal_handler_connect(obs_source_get_signal_handler(source),
 			"mute", OBSVolumeMuted, this);
@@ -206,7 +194,6 @@ VolControl::VolControl(OBSSource source_, bool showConfig)
 VolControl::~VolControl()
 {
 	obs_fader_remove_callback(obs_fader, OBSVolumeChanged, this);
-	obs_volmeter_remove_callback(obs_volmeter, OBSVolumeLevel, this);
 
 	signal_handler_disconnect(obs_source_get_signal_handler(source),
 			"mute", OBSVolumeMuted, this);
@@ -256,8 +243,9 @@ void VolumeMeter::setPeakHoldColor(QColor c)
 }
 
 
-VolumeMeter::VolumeMeter(QWidget *parent)
-			: QWidget(parent)
+VolumeMeter::VolumeMeter(QWidget *parent, obs_volmeter_t *obs_volmeter)
+			: QWidget(parent),
+			  obs_volmeter(obs_volmeter)
 {
 	setMinimumSize(1, 3);
 
@@ -285,36 +273,30 @@ VolumeMeter::~VolumeMeter()
 	updateTimerRef->RemoveVolControl(this);
 }
 
-void VolumeMeter::setLevels(float nmag, float npeak, float npeakHold)
-{
-	uint64_t ts = os_gettime_ns();
-	QMutexLocker locker(&dataMutex);
-
-	mag += nmag;
-	peak += npeak;
-	peakHold += npeakHold;
-	multiple += 1.0f;
-	lastUpdateTime = ts;
-}
-
+/* polls the latest levels from the meter instead of receiving them from a
+ * callback on the audio thread */
 inline void VolumeMeter::calcLevels()
 {
 	uint64_t ts = os_gettime_ns();
-	QMutexLocker locker(&dataMutex);
-
-	if (lastUpdateTime && ts - lastUpdateTime > 1000000000) {
-		mag = peak = peakHold = 0.0f;
-		multiple = 1.0f;
+	struct obs_volmeter_levels levels;
+
+	if (obs_volmeter_get_levels(obs_volmeter, &levels) &&
+	    levels.sequence != lastSequence) {
+		lastSequence   = levels.sequence;
+		lastUpdateTime = ts;
+
+		if (levels.muted) {
+			curMag = curPeak = curPeakHold = 0.0f;
+		} else {
+			curMag      = levels.magnitude;
+			curPeak     = levels.level;
+			curPeakHold = levels.peak;
+		}
+
+	} else if (lastUpdateTime && ts - lastUpdateTime > 1000000000) {
+		curMag = curPeak = curPeakHold = 0.0f;
 		lastUpdateTime = 0;
 	}
-
-	if (multiple > 0.0f) {
-		curMag = mag / multiple;
-		curPeak = peak / multiple;
-		curPeakHold = peakHold / multiple;
-
-		mag = peak = peakHold = multiple = 0.0f;
-	}
 }
 
 void VolumeMeter::paintEvent(QPaintEvent *event)
@@ -356,7 +338,7 @@ void VolumeMeter::paintEvent(QPaintEvent *event)
 			bkColor);
 
 	// Peak hold
-	if (peakHold == 1.0f)
+	if (curPeakHold == 1.0f)
 		scaledPeakHold--;
 
 	painter.setPen(peakHoldColor);
@@ -4,7 +4,6 @@
 #include <QWidget>
 #include <QSharedPointer>
 #include <QTimer>
-#include <QMutex>
 #include <QList>
 
 class QPushButton;
@@ -25,19 +24,18 @@ private:
 
 	inline void calcLevels();
 
-	QMutex dataMutex;
-	float mag = 0.0f, peak = 0.0f, peakHold = 0.0f;
-	float multiple = 0.0f;
+	obs_volmeter_t *obs_volmeter;
+	uint64_t lastSequence = 0;
 	uint64_t lastUpdateTime = 0;
 
 	QColor bkColor, magColor, peakColor, peakHoldColor;
 	QColor clipColor1, clipColor2;
 
 public:
-	explicit VolumeMeter(QWidget *parent = 0);
+	explicit VolumeMeter(QWidget *parent = 0,
+			obs_volmeter_t *obs_volmeter = nullptr);
 	~VolumeMeter();
 
-	void setLevels(float nmag, float npeak, float npeakHold);
 	QColor getBkColor() const;
 	void setBkColor(QColor c);
 	QColor getMagColor() const;
@@ -86,8 +84,6 @@ private:
 	obs_volmeter_t  *obs_volmeter;
 
 	static void OBSVolumeChanged(void *param, float db);
-	static void OBSVolumeLevel(void *data, float level, float mag,
-			float peak, float muted);
 	static void OBSVolumeMuted(void *data, calldata_t *calldata);
 
 	void EmitConfigClicked();
@@ -1117,12 +1117,17 @@ obs_data_array_t *OBSBasic::SaveTransitions()
 		obs_data_t *sourceData = obs_data_create();
 		obs_data_t *settings = obs_source_get_settings(tr);
 
+		/* written on the save thread, so don't use the live settings */
+		obs_data_t *settingsCopy = obs_data_create_from_json(
+				obs_data_get_json(settings));
+
 		obs_data_set_string(sourceData, "name", obs_source_get_name(tr));
 		obs_data_set_string(sourceData, "id", obs_obj_get_id(tr));
-		obs_data_set_obj(sourceData, "settings", settings);
+		obs_data_set_obj(sourceData, "settings", settingsCopy);
 
 		obs_data_array_push_back(transitions, sourceData);
 
+		obs_data_release(settingsCopy);
 		obs_data_release(settings);
 		obs_data_release(sourceData);
 	}
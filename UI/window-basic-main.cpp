@@ -268,7 +268,7 @@ static void SaveAudioDevice(const char *name, int channel, obs_data_t *parent,
 
 	audioSources.push_back(source);
 
-	obs_data_t *data = obs_save_source(source);
+	obs_data_t *data = obs_save_source_snapshot(source);
 
 	obs_data_set_obj(parent, name, data);
 
@@ -301,7 +301,9 @@ static obs_data_t *GenerateSaveData(obs_data_array_t *sceneOrder,
 	};
 	using FilterAudioSources_t = decltype(FilterAudioSources);
 
-	obs_data_array_t *sourcesArray = obs_save_sources_filtered(
+	/* unchanged sources are not saved again, and the snapshots can be
+	 * written on the save thread */
+	obs_data_array_t *sourcesArray = obs_save_sources_snapshot_filtered(
 			[](void *data, obs_source_t *source)
 	{
 		return (*static_cast<FilterAudioSources_t*>(data))(source);
@@ -442,12 +444,16 @@ void OBSBasic::Save(const char *file)
 	if (api) {
 		obs_data_t *moduleObj = obs_data_create();
 		api->on_save(moduleObj);
-		obs_data_set_obj(saveData, "modules", moduleObj);
+
+		/* modules may store objects they keep modifying */
+		obs_data_t *moduleCopy = obs_data_create_from_json(
+				obs_data_get_json(moduleObj));
+		obs_data_set_obj(saveData, "modules", moduleCopy);
+		obs_data_release(moduleCopy);
 		obs_data_release(moduleObj);
 	}
 
-	if (!obs_data_save_json_safe(saveData, file, "tmp", "bak"))
-		blog(LOG_ERROR, "Could not save scene data to %s", file);
+	projectSaver.Queue(saveData, file);
 
 	obs_data_release(saveData);
 	obs_data_array_release(sceneOrder);
@@ -1295,7 +1301,7 @@ void OBSBasic::OBSInit()
 	}
 
 	/* load audio monitoring */
-#if defined(_WIN32) || defined(__APPLE__)
+#if defined(_WIN32) || defined(__APPLE__) || HAVE_PULSEAUDIO
 	const char *device_name = config_get_string(basicConfig, "Audio",
 			"MonitoringDeviceName");
 	const char *device_id = config_get_string(basicConfig, "Audio",
@@ -1791,11 +1797,13 @@ OBSBasic::~OBSBasic()
 
 void OBSBasic::SaveProjectNow()
 {
-	if (disableSaving)
-		return;
+	if (!disableSaving) {
+		projectChanged = true;
+		SaveProjectDeferred();
+	}
 
-	projectChanged = true;
-	SaveProjectDeferred();
+	/* the collection file may be read, renamed or removed next */
+	projectSaver.Flush();
 }
 
 void OBSBasic::SaveProject()
@@ -29,6 +29,7 @@
 #include "window-basic-transform.hpp"
 #include "window-basic-adv-audio.hpp"
 #include "window-basic-filters.hpp"
+#include "project-saver.hpp"
 
 #include <obs-frontend-internal.hpp>
 
@@ -119,6 +120,7 @@ private:
 	bool loaded = false;
 	long disableSaving = 1;
 	bool projectChanged = false;
+	ProjectSaver projectSaver;
 	bool previewEnabled = true;
 	bool fullscreenInterface = false;
 
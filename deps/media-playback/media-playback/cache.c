@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <obs.h>
+#include <util/platform.h>
+#include <util/bmem.h>
+
+#include <sys/stat.h>
+
+#include "cache.h"
+
+/* complete caches, a cache is removed once its last user releases it */
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static DARRAY(struct mp_cache *) caches;
+
+static void get_file_info(const char *path, int64_t *size, int64_t *time)
+{
+	struct stat st;
+
+	if (os_stat(path, &st) == 0) {
+		*size = (int64_t)st.st_size;
+		*time = (int64_t)st.st_mtime;
+	} else {
+		*size = -1;
+		*time = -1;
+	}
+}
+
+struct mp_cache *mp_cache_create(const char *path)
+{
+	struct mp_cache *cache = bzalloc(sizeof(*cache));
+
+	cache->refs = 1;
+	cache->path = bstrdup(path);
+	get_file_info(path, &cache->file_size, &cache->file_time);
+	return cache;
+}
+
+void mp_cache_addref(struct mp_cache *cache)
+{
+	os_atomic_inc_long(&cache->refs);
+}
+
+static inline void free_frames(struct mp_frame *frames, size_t num)
+{
+	for (size_t i = 0; i < num; i++)
+		av_frame_free(&frames[i].frame);
+}
+
+void mp_cache_clear(struct mp_cache *cache)
+{
+	free_frames(cache->video.array, cache->video.num);
+	free_frames(cache->audio.array, cache->audio.num);
+	da_resize(cache->video, 0);
+	da_resize(cache->audio, 0);
+	cache->size = 0;
+}
+
+void mp_cache_release(struct mp_cache *cache)
+{
+	if (!cache)
+		return;
+
+	if (cache->complete) {
+		/* the registry lookup adds references under the mutex, so the
+		 * last release has to take it as well */
+		pthread_mutex_lock(&cache_mutex);
+		if (os_atomic_dec_long(&cache->refs) != 0) {
+			pthread_mutex_unlock(&cache_mutex);
+			return;
+		}
+		da_erase_item(caches, &cache);
+		if (!caches.num)
+			da_free(caches);
+		pthread_mutex_unlock(&cache_mutex);
+
+	} else if (os_atomic_dec_long(&cache->refs) != 0) {
+		return;
+	}
+
+	mp_cache_clear(cache);
+	da_free(cache->video);
+	da_free(cache->audio);
+	bfree(cache->path);
+	bfree(cache);
+}
+
+struct mp_cache *mp_cache_find(const char *path)
+{
+	struct mp_cache *cache = NULL;
+	int64_t size, time;
+
+	get_file_info(path, &size, &time);
+	if (size < 0)
+		return NULL;
+
+	pthread_mutex_lock(&cache_mutex);
+
+	for (size_t i = 0; i < caches.num; i++) {
+		struct mp_cache *c = caches.array[i];
+
+		if (c->file_size == size && c->file_time == time &&
+		    strcmp(c->path, path) == 0) {
+			mp_cache_addref(c);
+			cache = c;
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&cache_mutex);
+	return cache;
+}
+
+static size_t frame_size(const AVFrame *frame)
+{
+	size_t size = 0;
+
+	for (size_t i = 0; i < AV_NUM_DATA_POINTERS && frame->buf[i]; i++)
+		size += frame->buf[i]->size;
+
+	return size;
+}
+
+/* decoders hand out frames from buffer pools with edge padding, and a
+ * reference would keep the pool buffer alive, so frames are copied into
+ * buffers that are only as large as the image or samples */
+static AVFrame *copy_frame_compact(const AVFrame *frame, bool audio)
+{
+	AVFrame *copy = av_frame_alloc();
+
+	if (!copy)
+		return NULL;
+
+	copy->format = frame->format;
+	if (audio) {
+		copy->nb_samples     = frame->nb_samples;
+		copy->channel_layout = frame->channel_layout;
+		copy->channels       = frame->channels;
+	} else {
+		copy->width          = frame->width;
+		copy->height         = frame->height;
+	}
+
+	if (av_frame_get_buffer(copy, 32) < 0 ||
+	    av_frame_copy(copy, frame) < 0 ||
+	    av_frame_copy_props(copy, frame) < 0) {
+		av_frame_free(&copy);
+		return NULL;
+	}
+
+	return copy;
+}
+
+bool mp_cache_add(struct mp_cache *cache, const AVFrame *frame,
+		int64_t pts, int64_t next_pts, bool audio)
+{
+	struct mp_frame f;
+
+	/* hardware frames can't be copied, those are kept by reference */
+	f.frame = copy_frame_compact(frame, audio);
+	if (!f.frame)
+		f.frame = av_frame_clone(frame);
+	if (!f.frame)
+		return false;
+
+	f.pts = pts;
+	f.next_pts = next_pts;
+
+	if (audio)
+		da_push_back(cache->audio, &f);
+	else
+		da_push_back(cache->video, &f);
+
+	cache->size += frame_size(f.frame);
+	return true;
+}
+
+void mp_cache_publish(struct mp_cache *cache)
+{
+	pthread_mutex_lock(&cache_mutex);
+	cache->complete = true;
+	da_push_back(caches, &cache);
+	pthread_mutex_unlock(&cache_mutex);
+}
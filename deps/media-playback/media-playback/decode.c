@@ -16,6 +16,10 @@
 
 #include "decode.h"
 #include "media.h"
+#include "closest-format.h"
+
+#include <util/platform.h>
+#include <libavutil/imgutils.h>
 
 static AVCodec *find_hardware_decoder(enum AVCodecID id)
 {
@@ -66,6 +70,11 @@ static int mp_open_codec(struct mp_decode *d)
 	    c->codec_id != AV_CODEC_ID_WEBP)
 		c->thread_count = 0;
 
+#ifndef USE_NEW_FFMPEG_DECODE_API
+	/* decoded frames are queued, so they must own their data */
+	c->refcounted_frames = 1;
+#endif
+
 	ret = avcodec_open2(c, d->codec, NULL);
 	if (ret < 0)
 		goto fail;
@@ -91,6 +100,17 @@ bool mp_decode_init(mp_media_t *m, enum AVMediaType type, bool hw)
 	memset(d, 0, sizeof(*d));
 	d->m = m;
 	d->audio = type == AVMEDIA_TYPE_AUDIO;
+	d->max_frames = d->audio
+		? MP_AUDIO_LOOKAHEAD_FRAMES
+		: MP_VIDEO_LOOKAHEAD_FRAMES;
+
+	if (pthread_mutex_init(&d->mutex, NULL) != 0)
+		return false;
+	if (pthread_cond_init(&d->cond, NULL) != 0) {
+		pthread_mutex_destroy(&d->mutex);
+		return false;
+	}
+	d->sync_valid = true;
 
 	ret = av_find_best_stream(m->fmt, type, -1, -1, NULL, 0);
 	if (ret < 0)
@@ -136,7 +156,8 @@ bool mp_decode_init(mp_media_t *m, enum AVMediaType type, bool hw)
 	}
 
 	d->frame = av_frame_alloc();
-	if (!d->frame) {
+	d->decoded = av_frame_alloc();
+	if (!d->frame || !d->decoded) {
 		blog(LOG_WARNING, "MP: Failed to allocate %s frame",
 				av_get_media_type_string(type));
 		return false;
@@ -147,6 +168,15 @@ bool mp_decode_init(mp_media_t *m, enum AVMediaType type, bool hw)
 	return true;
 }
 
+static void mp_decode_clear_frames(struct mp_decode *d)
+{
+	while (d->frames.size) {
+		struct mp_frame f;
+		circlebuf_pop_front(&d->frames, &f, sizeof(f));
+		av_frame_free(&f.frame);
+	}
+}
+
 void mp_decode_clear_packets(struct mp_decode *d)
 {
 	if (d->packet_pending) {
@@ -159,12 +189,17 @@ void mp_decode_clear_packets(struct mp_decode *d)
 		circlebuf_pop_front(&d->packets, &pkt, sizeof(pkt));
 		av_packet_unref(&pkt);
 	}
+
+	d->packet_bytes = 0;
 }
 
 void mp_decode_free(struct mp_decode *d)
 {
+	mp_decode_stop(d);
 	mp_decode_clear_packets(d);
+	mp_decode_clear_frames(d);
 	circlebuf_free(&d->packets);
+	circlebuf_free(&d->frames);
 
 	if (d->decoder) {
 		avcodec_close(d->decoder);
@@ -174,25 +209,62 @@ void mp_decode_free(struct mp_decode *d)
 	}
 
 	if (d->frame)
-		av_free(d->frame);
+		av_frame_free(&d->frame);
+	if (d->decoded)
+		av_frame_free(&d->decoded);
+
+	sws_freeContext(d->swscale);
+
+	if (d->sync_valid) {
+		pthread_cond_destroy(&d->cond);
+		pthread_mutex_destroy(&d->mutex);
+	}
 
 	memset(d, 0, sizeof(*d));
 }
 
-void mp_decode_push_packet(struct mp_decode *decode, AVPacket *packet)
+void mp_decode_push_packet(struct mp_decode *d, AVPacket *packet)
 {
-	circlebuf_push_back(&decode->packets, packet, sizeof(*packet));
+	pthread_mutex_lock(&d->mutex);
+	circlebuf_push_back(&d->packets, packet, sizeof(*packet));
+	d->packet_bytes += packet->size;
+	pthread_cond_broadcast(&d->cond);
+	pthread_mutex_unlock(&d->mutex);
+}
+
+void mp_decode_set_demux_eof(struct mp_decode *d)
+{
+	pthread_mutex_lock(&d->mutex);
+	d->demux_eof = true;
+	pthread_cond_broadcast(&d->cond);
+	pthread_mutex_unlock(&d->mutex);
+}
+
+bool mp_decode_needs_packets(struct mp_decode *d, size_t *packets,
+		size_t *bytes)
+{
+	bool needs_packets;
+
+	pthread_mutex_lock(&d->mutex);
+	needs_packets = !d->decode_eof && !d->packet_pending &&
+		!d->packets.size && d->frames.size / sizeof(struct mp_frame) <
+		d->max_frames;
+	*packets = d->packets.size / sizeof(AVPacket);
+	*bytes = d->packet_bytes;
+	pthread_mutex_unlock(&d->mutex);
+
+	return needs_packets;
 }
 
 static inline int64_t get_estimated_duration(struct mp_decode *d,
 		int64_t last_pts)
 {
 	if (last_pts)
-		return d->frame_pts - last_pts;
+		return d->decode_pts - last_pts;
 
 	if (d->audio) {
-		return av_rescale_q(d->frame->nb_samples,
-				(AVRational){1, d->frame->sample_rate},
+		return av_rescale_q(d->decoded->nb_samples,
+				(AVRational){1, d->decoded->sample_rate},
 				(AVRational){1, 1000000000});
 	} else {
 		if (d->last_duration)
@@ -210,7 +282,7 @@ static int decode_packet(struct mp_decode *d, int *got_frame)
 	*got_frame = 0;
 
 #ifdef USE_NEW_FFMPEG_DECODE_API
-	ret = avcodec_receive_frame(d->decoder, d->frame);
+	ret = avcodec_receive_frame(d->decoder, d->decoded);
 	if (ret != 0 && ret != AVERROR(EAGAIN)) {
 		if (ret == AVERROR_EOF)
 			ret = 0;
@@ -225,7 +297,7 @@ static int decode_packet(struct mp_decode *d, int *got_frame)
 			return ret;
 		}
 
-		ret = avcodec_receive_frame(d->decoder, d->frame);
+		ret = avcodec_receive_frame(d->decoder, d->decoded);
 		if (ret != 0 && ret != AVERROR(EAGAIN)) {
 			if (ret == AVERROR_EOF)
 				ret = 0;
@@ -242,112 +314,412 @@ static int decode_packet(struct mp_decode *d, int *got_frame)
 #else
 	if (d->audio) {
 		ret = avcodec_decode_audio4(d->decoder,
-				d->frame, got_frame, &d->pkt);
+				d->decoded, got_frame, &d->pkt);
 	} else {
 		ret = avcodec_decode_video2(d->decoder,
-				d->frame, got_frame, &d->pkt);
+				d->decoded, got_frame, &d->pkt);
 	}
 #endif
 	return ret;
 }
 
-bool mp_decode_next(struct mp_decode *d)
+static inline int get_sws_colorspace(enum AVColorSpace cs)
+{
+	switch (cs) {
+	case AVCOL_SPC_BT709:
+		return SWS_CS_ITU709;
+	case AVCOL_SPC_FCC:
+		return SWS_CS_FCC;
+	case AVCOL_SPC_SMPTE170M:
+		return SWS_CS_SMPTE170M;
+	case AVCOL_SPC_SMPTE240M:
+		return SWS_CS_SMPTE240M;
+	default:
+		break;
+	}
+
+	return SWS_CS_ITU601;
+}
+
+static inline int get_sws_range(enum AVColorRange r)
+{
+	return r == AVCOL_RANGE_JPEG ? 1 : 0;
+}
+
+#define FIXED_1_0 (1<<16)
+
+static bool mp_decode_init_scaling(struct mp_decode *d, const AVFrame *in)
+{
+	int space = get_sws_colorspace(d->decoder->colorspace);
+	int range = get_sws_range(d->decoder->color_range);
+	const int *coeff = sws_getCoefficients(space);
+
+	d->swscale = sws_getCachedContext(d->swscale,
+			in->width, in->height, in->format,
+			in->width, in->height, d->scale_format,
+			SWS_FAST_BILINEAR, NULL, NULL, NULL);
+	if (!d->swscale) {
+		blog(LOG_WARNING, "MP: Failed to initialize scaler");
+		return false;
+	}
+
+	sws_setColorspaceDetails(d->swscale, coeff, range, coeff, range, 0,
+			FIXED_1_0, FIXED_1_0);
+	return true;
+}
+
+/*
+ * Moves the decoded picture into a new frame, converting it to a format obs
+ * can use if necessary.  Runs on the decode thread so the conversion does not
+ * hold up audio.
+ */
+static AVFrame *mp_decode_take_frame(struct mp_decode *d)
 {
-	bool eof = d->m->eof;
+	AVFrame *in = d->decoded;
+	AVFrame *out = av_frame_alloc();
+	int ret;
+
+	if (!out)
+		return NULL;
+
+	if (!d->audio && (!d->scale_checked ||
+	                  in->width  != d->scale_width ||
+	                  in->height != d->scale_height ||
+	                  in->format != d->scale_src_format)) {
+		d->scale_format = closest_format(in->format);
+		if (d->scale_format == in->format) {
+			sws_freeContext(d->swscale);
+			d->swscale = NULL;
+		} else if (!mp_decode_init_scaling(d, in)) {
+			d->scale_format = AV_PIX_FMT_NONE;
+		}
+
+		d->scale_width = in->width;
+		d->scale_height = in->height;
+		d->scale_src_format = in->format;
+		d->scale_checked = true;
+	}
+
+	if (!d->swscale) {
+		av_frame_move_ref(out, in);
+		return out;
+	}
+
+	out->format = d->scale_format;
+	out->width  = in->width;
+	out->height = in->height;
+
+	ret = av_frame_get_buffer(out, 32);
+	if (ret < 0)
+		goto fail;
+
+	ret = sws_scale(d->swscale,
+			(const uint8_t *const *)in->data, in->linesize,
+			0, in->height, out->data, out->linesize);
+	if (ret < 0)
+		goto fail;
+
+	av_frame_copy_props(out, in);
+	av_frame_unref(in);
+	return out;
+
+fail:
+	av_frame_free(&out);
+	av_frame_unref(in);
+	return NULL;
+}
+
+enum decode_result {
+	DECODE_NONE,
+	DECODE_FRAME,
+	DECODE_EOF
+};
+
+/*
+ * Decodes at most one frame from the pending packet, or drains the decoder
+ * once the demuxer has reached the end of the file.
+ */
+static enum decode_result mp_decode_step(struct mp_decode *d, bool drain)
+{
+	int64_t last_pts;
 	int got_frame;
 	int ret;
 
-	d->frame_ready = false;
+	if (!d->packet_pending) {
+		if (!drain)
+			return DECODE_NONE;
 
-	if (!eof && !d->packets.size)
-		return true;
-
-	while (!d->frame_ready) {
-		if (!d->packet_pending) {
-			if (!d->packets.size) {
-				if (eof) {
-					d->pkt.data = NULL;
-					d->pkt.size = 0;
-				} else {
-					return true;
-				}
-			} else {
-				circlebuf_pop_front(&d->packets, &d->orig_pkt,
-						sizeof(d->orig_pkt));
-				d->pkt = d->orig_pkt;
-				d->packet_pending = true;
-			}
-		}
+		d->pkt.data = NULL;
+		d->pkt.size = 0;
+	}
 
-		ret = decode_packet(d, &got_frame);
+	ret = decode_packet(d, &got_frame);
 
-		if (!got_frame && ret == 0) {
-			d->eof = true;
-			return true;
-		}
-		if (ret < 0) {
+	if (!got_frame && ret == 0)
+		return DECODE_EOF;
+
+	if (ret < 0) {
 #ifdef DETAILED_DEBUG_INFO
-			blog(LOG_DEBUG, "MP: decode failed: %s",
-					av_err2str(ret));
+		blog(LOG_DEBUG, "MP: decode failed: %s",
+				av_err2str(ret));
 #endif
 
-			if (d->packet_pending) {
-				av_packet_unref(&d->orig_pkt);
-				av_init_packet(&d->orig_pkt);
-				av_init_packet(&d->pkt);
-				d->packet_pending = false;
-			}
-			return true;
+		if (d->packet_pending) {
+			av_packet_unref(&d->orig_pkt);
+			av_init_packet(&d->orig_pkt);
+			av_init_packet(&d->pkt);
+			d->packet_pending = false;
 		}
+		return drain ? DECODE_EOF : DECODE_NONE;
+	}
 
-		d->frame_ready = !!got_frame;
+	if (d->packet_pending) {
+		if (d->pkt.size) {
+			d->pkt.data += ret;
+			d->pkt.size -= ret;
+		}
 
-		if (d->packet_pending) {
-			if (d->pkt.size) {
-				d->pkt.data += ret;
-				d->pkt.size -= ret;
-			}
+		if (d->pkt.size <= 0) {
+			av_packet_unref(&d->orig_pkt);
+			av_init_packet(&d->orig_pkt);
+			av_init_packet(&d->pkt);
+			d->packet_pending = false;
+		}
+	}
 
-			if (d->pkt.size <= 0) {
-				av_packet_unref(&d->orig_pkt);
-				av_init_packet(&d->orig_pkt);
-				av_init_packet(&d->pkt);
-				d->packet_pending = false;
-			}
+	if (!got_frame)
+		return DECODE_NONE;
+
+	last_pts = d->decode_pts;
+
+	if (d->decoded->best_effort_timestamp == AV_NOPTS_VALUE)
+		d->decode_pts = d->decode_next_pts;
+	else
+		d->decode_pts = av_rescale_q(
+				d->decoded->best_effort_timestamp,
+				d->stream->time_base,
+				(AVRational){1, 1000000000});
+
+	int64_t duration = d->decoded->pkt_duration;
+	if (!duration)
+		duration = get_estimated_duration(d, last_pts);
+	else
+		duration = av_rescale_q(duration,
+				d->stream->time_base,
+				(AVRational){1, 1000000000});
+
+	d->last_duration = duration;
+	d->decode_next_pts = d->decode_pts + duration;
+	return DECODE_FRAME;
+}
+
+static inline bool mp_decode_can_run(struct mp_decode *d)
+{
+	if (d->decode_eof)
+		return false;
+	if (d->frames.size / sizeof(struct mp_frame) >= d->max_frames)
+		return false;
+
+	return d->packet_pending || d->packets.size || d->demux_eof;
+}
+
+static void *mp_decode_thread(void *opaque)
+{
+	struct mp_decode *d = opaque;
+
+	os_set_thread_name(d->audio ? "mp_audio_decode" : "mp_video_decode");
+
+	pthread_mutex_lock(&d->mutex);
+
+	for (;;) {
+		enum decode_result result;
+		struct mp_frame f = {0};
+		bool popped = false;
+		bool skipping;
+		int64_t skip_pts;
+		bool starved;
+		bool drain;
+		uint64_t start;
+
+		while (!d->kill && !mp_decode_can_run(d))
+			pthread_cond_wait(&d->cond, &d->mutex);
+		if (d->kill)
+			break;
+
+		if (!d->packet_pending && d->packets.size) {
+			circlebuf_pop_front(&d->packets, &d->orig_pkt,
+					sizeof(d->orig_pkt));
+			d->packet_bytes -= d->orig_pkt.size;
+			d->pkt = d->orig_pkt;
+			d->packet_pending = true;
+			popped = true;
+		}
+
+		drain = d->demux_eof && !d->packets.size;
+		skipping = d->skipping;
+		skip_pts = d->skip_pts;
+		d->decoding = true;
+		pthread_mutex_unlock(&d->mutex);
+
+		if (popped)
+			mp_media_wake_demux(d->m);
+
+		start = os_gettime_ns();
+		result = mp_decode_step(d, drain);
+
+		/* frames before a seek target are decoded, but never
+		 * converted or queued */
+		if (result == DECODE_FRAME && skipping &&
+		    d->decode_next_pts <= skip_pts) {
+			av_frame_unref(d->decoded);
+			result = DECODE_NONE;
+		}
+
+		if (result == DECODE_FRAME) {
+			f.frame = mp_decode_take_frame(d);
+			f.pts = d->decode_pts;
+			f.next_pts = d->decode_next_pts;
+		}
+
+		pthread_mutex_lock(&d->mutex);
+
+		if (result == DECODE_FRAME)
+			d->skipping = false;
+		if (f.frame) {
+			circlebuf_push_back(&d->frames, &f, sizeof(f));
+			mp_update_average(&d->decode_ns,
+					os_gettime_ns() - start);
+		}
+		if (result == DECODE_EOF)
+			d->decode_eof = true;
+
+		d->decoding = false;
+		starved = !d->packet_pending && !d->packets.size;
+		pthread_cond_broadcast(&d->cond);
+
+		if (starved) {
+			pthread_mutex_unlock(&d->mutex);
+			mp_media_wake_demux(d->m);
+			pthread_mutex_lock(&d->mutex);
 		}
 	}
 
-	if (d->frame_ready) {
-		int64_t last_pts = d->frame_pts;
-
-		if (d->frame->best_effort_timestamp == AV_NOPTS_VALUE)
-			d->frame_pts = d->next_pts;
-		else
-			d->frame_pts = av_rescale_q(
-					d->frame->best_effort_timestamp,
-					d->stream->time_base,
-					(AVRational){1, 1000000000});
-
-		int64_t duration = d->frame->pkt_duration;
-		if (!duration)
-			duration = get_estimated_duration(d, last_pts);
-		else
-			duration = av_rescale_q(duration,
-					d->stream->time_base,
-					(AVRational){1, 1000000000});
-
-		d->last_duration = duration;
-		d->next_pts = d->frame_pts + duration;
+	pthread_mutex_unlock(&d->mutex);
+	return NULL;
+}
+
+bool mp_decode_start(struct mp_decode *d)
+{
+	if (pthread_create(&d->thread, NULL, mp_decode_thread, d) != 0) {
+		blog(LOG_WARNING, "MP: Could not create %s decode thread",
+				d->audio ? "audio" : "video");
+		return false;
 	}
 
+	d->thread_valid = true;
 	return true;
 }
 
-void mp_decode_flush(struct mp_decode *d)
+void mp_decode_stop(struct mp_decode *d)
 {
+	if (!d->sync_valid)
+		return;
+
+	pthread_mutex_lock(&d->mutex);
+	d->kill = true;
+	pthread_cond_broadcast(&d->cond);
+	pthread_mutex_unlock(&d->mutex);
+
+	if (d->thread_valid) {
+		pthread_join(d->thread, NULL);
+		d->thread_valid = false;
+	}
+}
+
+/*
+ * Makes the next decoded frame current, waiting for the decode thread if
+ * the look-ahead queue is empty.  Returns false if the decoder was stopped.
+ */
+bool mp_decode_next(struct mp_decode *d)
+{
+	struct mp_frame f;
+	bool stopped;
+
+	d->frame_ready = false;
+
+	pthread_mutex_lock(&d->mutex);
+
+	while (!d->kill && !d->frames.size && !d->decode_eof)
+		pthread_cond_wait(&d->cond, &d->mutex);
+
+	stopped = d->kill;
+
+	if (!stopped && d->frames.size) {
+		circlebuf_pop_front(&d->frames, &f, sizeof(f));
+		pthread_cond_broadcast(&d->cond);
+	} else {
+		f.frame = NULL;
+		d->eof = !stopped;
+	}
+
+	pthread_mutex_unlock(&d->mutex);
+
+	if (f.frame) {
+		/* a slot in the look-ahead queue opened up */
+		mp_media_wake_demux(d->m);
+
+		av_frame_unref(d->frame);
+		av_frame_move_ref(d->frame, f.frame);
+		av_frame_free(&f.frame);
+
+		d->frame_pts = f.pts;
+		d->next_pts = f.next_pts;
+		d->frame_ready = true;
+	}
+
+	return !stopped;
+}
+
+static void mp_decode_flush_internal(struct mp_decode *d, bool skip,
+		int64_t skip_pts)
+{
+	pthread_mutex_lock(&d->mutex);
+
+	while (d->decoding)
+		pthread_cond_wait(&d->cond, &d->mutex);
+
 	avcodec_flush_buffers(d->decoder);
 	mp_decode_clear_packets(d);
+	mp_decode_clear_frames(d);
+	d->demux_eof = false;
+	d->decode_eof = false;
+	d->skipping = skip;
+	d->skip_pts = skip_pts;
+
+	/* timestamps of the old position must not be used to estimate the
+	 * duration of the first frame after the flush */
+	d->decode_pts = 0;
+	d->decode_next_pts = 0;
+	d->last_duration = 0;
+
+	/* the new position may be encoded at a different size */
+	d->scale_checked = false;
+
 	d->eof = false;
 	d->frame_pts = 0;
 	d->frame_ready = false;
+
+	pthread_mutex_unlock(&d->mutex);
+}
+
+void mp_decode_flush(struct mp_decode *d)
+{
+	mp_decode_flush_internal(d, false, 0);
+}
+
+/* flushes for a seek, the first frame queued afterwards is the one that is
+ * shown at pts */
+void mp_decode_flush_to(struct mp_decode *d, int64_t pts)
+{
+	mp_decode_flush_internal(d, true, pts);
 }
@@ -30,6 +30,7 @@ extern "C" {
 
 #include <libavformat/avformat.h>
 #include <libavcodec/avcodec.h>
+#include <libswscale/swscale.h>
 #include <util/threading.h>
 
 #ifdef _MSC_VER
@@ -38,6 +39,18 @@ extern "C" {
 
 struct mp_media;
 
+/* decoded frame waiting in the look-ahead queue */
+struct mp_frame {
+	AVFrame               *frame;
+	int64_t               pts;
+	int64_t               next_pts;
+};
+
+/*
+ * Each stream is decoded on its own thread.  Packets are pushed by the demux
+ * thread, decoded (and converted, for video) frames are queued until the
+ * media thread plays them.  Both queues are protected by the decoder mutex.
+ */
 struct mp_decode {
 	struct mp_media       *m;
 	AVStream              *stream;
@@ -46,7 +59,7 @@ struct mp_decode {
 	AVCodecContext        *decoder;
 	AVCodec               *codec;
 
-	int64_t               last_duration;
+	/* media thread: the frame that is played next */
 	int64_t               frame_pts;
 	int64_t               next_pts;
 	AVFrame               *frame;
@@ -54,21 +67,63 @@ struct mp_decode {
 	bool                  frame_ready;
 	bool                  eof;
 
+	/* decode thread */
+	int64_t               last_duration;
+	int64_t               decode_pts;
+	int64_t               decode_next_pts;
+	AVFrame               *decoded;
+
 	AVPacket              orig_pkt;
 	AVPacket              pkt;
 	bool                  packet_pending;
+
+	/* the scaler is rebuilt whenever the decoded size or format changes */
+	enum AVPixelFormat    scale_format;
+	struct SwsContext     *swscale;
+	bool                  scale_checked;
+	int                   scale_width;
+	int                   scale_height;
+	int                   scale_src_format;
+
+	/* shared, protected by mutex */
+	pthread_mutex_t       mutex;
+	pthread_cond_t        cond;
+	bool                  sync_valid;
+	pthread_t             thread;
+	bool                  thread_valid;
+
 	struct circlebuf      packets;
+	size_t                packet_bytes;
+	struct circlebuf      frames;
+	size_t                max_frames;
+	bool                  demux_eof;
+	bool                  decode_eof;
+	bool                  decoding;
+	bool                  kill;
+
+	/* after a seek, frames that end before skip_pts are dropped */
+	bool                  skipping;
+	int64_t               skip_pts;
+
+	uint64_t              decode_ns;
 };
 
 extern bool mp_decode_init(struct mp_media *media, enum AVMediaType type,
 		bool hw);
 extern void mp_decode_free(struct mp_decode *decode);
 
+extern bool mp_decode_start(struct mp_decode *decode);
+extern void mp_decode_stop(struct mp_decode *decode);
+
 extern void mp_decode_clear_packets(struct mp_decode *decode);
 
 extern void mp_decode_push_packet(struct mp_decode *decode, AVPacket *pkt);
+extern void mp_decode_set_demux_eof(struct mp_decode *decode);
+extern bool mp_decode_needs_packets(struct mp_decode *decode,
+		size_t *packets, size_t *bytes);
 extern bool mp_decode_next(struct mp_decode *decode);
 extern void mp_decode_flush(struct mp_decode *decode);
+extern void mp_decode_flush_to(struct mp_decode *decode, int64_t pts);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,392 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <obs.h>
+#include <util/platform.h>
+#include <util/threading.h>
+#include <util/darray.h>
+#include <util/dstr.h>
+#include <util/bmem.h>
+
+#include <sys/stat.h>
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4244)
+#pragma warning(disable : 4204)
+#endif
+
+#include <libavformat/avformat.h>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#include "index.h"
+
+#define INDEX_MAGIC "OBSMPIX1"
+#define INDEX_EXT ".obs-index"
+#define INDEX_MAX_ENTRIES (16 * 1024 * 1024)
+
+/* the index file is only read back on the machine that wrote it, so the
+ * header is stored as is */
+struct index_header {
+	char                  magic[8];
+	int64_t               file_size;
+	int64_t               file_time;
+	int32_t               stream_index;
+	uint32_t              reserved;
+	uint64_t              count;
+};
+
+struct mp_index {
+	char                  *path;
+	char                  *index_path;
+	int                   stream_index;
+	int64_t               file_size;
+	int64_t               file_time;
+
+	/* protects entries and ready, entries never change once ready */
+	pthread_mutex_t       mutex;
+	DARRAY(struct mp_index_entry) entries;
+	bool                  ready;
+
+	/* index thread */
+	DARRAY(struct mp_index_entry) building;
+	pthread_t             thread;
+	bool                  thread_valid;
+	volatile bool         kill;
+};
+
+static void get_file_info(const char *path, int64_t *size, int64_t *time)
+{
+	struct stat st;
+
+	if (os_stat(path, &st) == 0) {
+		*size = (int64_t)st.st_size;
+		*time = (int64_t)st.st_mtime;
+	} else {
+		*size = -1;
+		*time = -1;
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+/* index file                                                                */
+
+static bool load_index(struct mp_index *index)
+{
+	struct index_header header;
+	bool success = false;
+	FILE *file;
+
+	file = os_fopen(index->index_path, "rb");
+	if (!file)
+		return false;
+
+	if (fread(&header, sizeof(header), 1, file) != 1)
+		goto exit;
+	if (memcmp(header.magic, INDEX_MAGIC, sizeof(header.magic)) != 0)
+		goto exit;
+
+	/* the file changed since the index was written */
+	if (header.file_size    != index->file_size ||
+	    header.file_time    != index->file_time ||
+	    header.stream_index != index->stream_index)
+		goto exit;
+
+	if (!header.count || header.count > INDEX_MAX_ENTRIES)
+		goto exit;
+
+	da_resize(index->entries, (size_t)header.count);
+	if (fread(index->entries.array, sizeof(struct mp_index_entry),
+				index->entries.num, file) != index->entries.num) {
+		da_resize(index->entries, 0);
+		goto exit;
+	}
+
+	success = true;
+
+exit:
+	fclose(file);
+	return success;
+}
+
+static bool write_index(const char *index_path,
+		const struct index_header *header,
+		const struct mp_index_entry *entries)
+{
+	struct dstr temp_path = {0};
+	bool success = false;
+	FILE *file;
+
+	dstr_printf(&temp_path, "%s.tmp", index_path);
+
+	/* media folders may well be read-only, in which case the index is
+	 * simply built again on the next open */
+	file = os_fopen(temp_path.array, "wb");
+	if (!file)
+		goto exit;
+
+	success = fwrite(header, sizeof(*header), 1, file) == 1 &&
+		fwrite(entries, sizeof(struct mp_index_entry),
+				(size_t)header->count, file) ==
+			(size_t)header->count;
+	fclose(file);
+
+	if (success) {
+		os_unlink(index_path);
+		success = os_rename(temp_path.array, index_path) == 0;
+	}
+	if (!success)
+		os_unlink(temp_path.array);
+
+exit:
+	dstr_free(&temp_path);
+	return success;
+}
+
+static inline void init_header(struct index_header *header,
+		int64_t file_size, int64_t file_time, int stream_index,
+		size_t count)
+{
+	memset(header, 0, sizeof(*header));
+	memcpy(header->magic, INDEX_MAGIC, sizeof(header->magic));
+	header->file_size    = file_size;
+	header->file_time    = file_time;
+	header->stream_index = stream_index;
+	header->count        = count;
+}
+
+static void save_index(struct mp_index *index)
+{
+	struct index_header header;
+
+	init_header(&header, index->file_size, index->file_time,
+			index->stream_index, index->entries.num);
+	write_index(index->index_path, &header, index->entries.array);
+}
+
+bool mp_index_write(const char *path, int stream_index,
+		const struct mp_index_entry *entries, size_t count)
+{
+	struct index_header header;
+	struct dstr index_path = {0};
+	int64_t file_size;
+	int64_t file_time;
+	bool success;
+
+	get_file_info(path, &file_size, &file_time);
+	if (file_size < 0)
+		return false;
+
+	init_header(&header, file_size, file_time, stream_index, count);
+
+	dstr_printf(&index_path, "%s" INDEX_EXT, path);
+	success = write_index(index_path.array, &header, entries);
+	dstr_free(&index_path);
+
+	return success;
+}
+
+/* ------------------------------------------------------------------------- */
+/* index thread                                                              */
+
+static int index_interrupt(void *data)
+{
+	struct mp_index *index = data;
+	return index->kill;
+}
+
+static int cmp_entries(const void *a, const void *b)
+{
+	const struct mp_index_entry *e1 = a;
+	const struct mp_index_entry *e2 = b;
+
+	if (e1->pts == e2->pts)
+		return 0;
+	return e1->pts < e2->pts ? -1 : 1;
+}
+
+/* reads the keyframe timestamps of every packet, nothing is decoded */
+static bool build_index(struct mp_index *index)
+{
+	AVFormatContext *fmt = avformat_alloc_context();
+	AVStream *stream;
+	AVPacket pkt;
+	int ret;
+
+	if (!fmt)
+		return false;
+
+	fmt->interrupt_callback.callback = index_interrupt;
+	fmt->interrupt_callback.opaque = index;
+
+	/* frees the context on failure */
+	if (avformat_open_input(&fmt, index->path, NULL, NULL) < 0)
+		return false;
+
+	if (index->stream_index >= (int)fmt->nb_streams) {
+		avformat_close_input(&fmt);
+		return false;
+	}
+
+	stream = fmt->streams[index->stream_index];
+
+	for (unsigned int i = 0; i < fmt->nb_streams; i++) {
+		if (fmt->streams[i] != stream)
+			fmt->streams[i]->discard = AVDISCARD_ALL;
+	}
+
+	av_init_packet(&pkt);
+
+	while ((ret = av_read_frame(fmt, &pkt)) >= 0) {
+		if (pkt.stream_index == index->stream_index &&
+		    (pkt.flags & AV_PKT_FLAG_KEY) != 0) {
+			struct mp_index_entry entry;
+
+			entry.ts = pkt.pts != AV_NOPTS_VALUE ? pkt.pts : pkt.dts;
+			if (entry.ts != AV_NOPTS_VALUE) {
+				entry.pts = av_rescale_q(entry.ts,
+						stream->time_base,
+						(AVRational){1, 1000000000});
+				da_push_back(index->building, &entry);
+			}
+		}
+
+		av_packet_unref(&pkt);
+	}
+
+	avformat_close_input(&fmt);
+
+	if (ret != AVERROR_EOF || !index->building.num)
+		return false;
+
+	qsort(index->building.array, index->building.num,
+			sizeof(struct mp_index_entry), cmp_entries);
+	return true;
+}
+
+static void *mp_index_thread(void *opaque)
+{
+	struct mp_index *index = opaque;
+	uint64_t start = os_gettime_ns();
+
+	os_set_thread_name("mp_index_thread");
+
+	if (!build_index(index)) {
+		if (!index->kill)
+			blog(LOG_INFO, "MP: Could not index '%s', seeking "
+					"will be less accurate", index->path);
+		da_free(index->building);
+		return NULL;
+	}
+
+	pthread_mutex_lock(&index->mutex);
+	da_move(index->entries, index->building);
+	index->ready = true;
+	pthread_mutex_unlock(&index->mutex);
+
+	blog(LOG_INFO, "MP: Indexed %d keyframes of '%s' in %d ms",
+			(int)index->entries.num, index->path,
+			(int)((os_gettime_ns() - start) / 1000000));
+
+	save_index(index);
+	return NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+
+struct mp_index *mp_index_create(const char *path, int stream_index)
+{
+	struct mp_index *index = bzalloc(sizeof(*index));
+	struct dstr index_path = {0};
+
+	if (pthread_mutex_init(&index->mutex, NULL) != 0) {
+		bfree(index);
+		return NULL;
+	}
+
+	dstr_printf(&index_path, "%s" INDEX_EXT, path);
+
+	index->path = bstrdup(path);
+	index->index_path = index_path.array;
+	index->stream_index = stream_index;
+	get_file_info(path, &index->file_size, &index->file_time);
+
+	if (load_index(index)) {
+		index->ready = true;
+		return index;
+	}
+
+	if (pthread_create(&index->thread, NULL, mp_index_thread, index) != 0) {
+		blog(LOG_WARNING, "MP: Could not create index thread");
+		mp_index_destroy(index);
+		return NULL;
+	}
+
+	index->thread_valid = true;
+	return index;
+}
+
+void mp_index_destroy(struct mp_index *index)
+{
+	if (!index)
+		return;
+
+	if (index->thread_valid) {
+		index->kill = true;
+		pthread_join(index->thread, NULL);
+	}
+
+	pthread_mutex_destroy(&index->mutex);
+	da_free(index->entries);
+	da_free(index->building);
+	bfree(index->index_path);
+	bfree(index->path);
+	bfree(index);
+}
+
+bool mp_index_find(struct mp_index *index, int64_t pts,
+		struct mp_index_entry *entry)
+{
+	size_t lo = 0, hi;
+	bool found = false;
+
+	if (!index)
+		return false;
+
+	pthread_mutex_lock(&index->mutex);
+
+	if (index->ready) {
+		hi = index->entries.num;
+
+		/* first entry after pts */
+		while (lo < hi) {
+			size_t mid = lo + (hi - lo) / 2;
+			if (index->entries.array[mid].pts <= pts)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+
+		*entry = index->entries.array[lo ? lo - 1 : 0];
+		found = true;
+	}
+
+	pthread_mutex_unlock(&index->mutex);
+	return found;
+}
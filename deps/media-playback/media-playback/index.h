@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <util/c99defs.h>
+
+/*
+ * Keyframe index of the video stream of a local file, used to seek straight
+ * to the keyframe that precedes a position.  The index is built on its own
+ * thread by reading every packet of the file once, and is stored next to the
+ * file (<file>.obs-index) so later opens only have to load it.  Until the
+ * index is ready, lookups fail and seeks fall back to the demuxer.
+ */
+struct mp_index_entry {
+	int64_t               pts; /* nanoseconds */
+	int64_t               ts;  /* stream time base */
+};
+
+struct mp_index;
+
+extern struct mp_index *mp_index_create(const char *path, int stream_index);
+extern void mp_index_destroy(struct mp_index *index);
+
+/* finds the last keyframe at or before pts, or the first keyframe if pts
+ * is before every keyframe */
+extern bool mp_index_find(struct mp_index *index, int64_t pts,
+		struct mp_index_entry *entry);
+
+/* writes the index file of path with the given keyframes, matching the
+ * current size and modification time of the file.  the entries must be
+ * sorted by pts. */
+extern bool mp_index_write(const char *path, int stream_index,
+		const struct mp_index_entry *entries, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
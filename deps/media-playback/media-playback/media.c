@@ -20,10 +20,8 @@
 #include <assert.h>
 
 #include "media.h"
-#include "closest-format.h"
 
 #include <libavdevice/avdevice.h>
-#include <libavutil/imgutils.h>
 
 static int64_t base_sys_ts = 0;
 
@@ -91,7 +89,7 @@ static int mp_media_next_packet(mp_media_t *media)
 
 	int ret = av_read_frame(media->fmt, &pkt);
 	if (ret < 0) {
-		if (ret != AVERROR_EOF)
+		if (ret != AVERROR_EOF && ret != AVERROR_EXIT)
 			blog(LOG_WARNING, "MP: av_read_frame failed: %s (%d)",
 					av_err2str(ret), ret);
 		return ret;
@@ -107,6 +105,232 @@ static int mp_media_next_packet(mp_media_t *media)
 	return ret;
 }
 
+/* ------------------------------------------------------------------------- */
+/* demux thread                                                              */
+
+#define MP_MIN_PACKETS 25
+#define MP_MAX_PACKET_BYTES (15 * 1024 * 1024)
+
+/*
+ * Keep reading while a decoder is starved.  Otherwise stop once every stream
+ * has enough packets queued or the queues hit the size limit.  Called with
+ * demux_mutex held, which also protects eof.
+ */
+static bool mp_media_should_demux(mp_media_t *m)
+{
+	size_t v_packets = MP_MIN_PACKETS, a_packets = MP_MIN_PACKETS;
+	size_t v_bytes = 0, a_bytes = 0;
+
+	if (m->demux_paused || m->eof)
+		return false;
+
+	if (m->has_video && mp_decode_needs_packets(&m->v, &v_packets,
+				&v_bytes))
+		return true;
+	if (m->has_audio && mp_decode_needs_packets(&m->a, &a_packets,
+				&a_bytes))
+		return true;
+
+	if (v_bytes + a_bytes > MP_MAX_PACKET_BYTES)
+		return false;
+
+	return v_packets < MP_MIN_PACKETS || a_packets < MP_MIN_PACKETS;
+}
+
+static void *mp_demux_thread(void *opaque)
+{
+	mp_media_t *m = opaque;
+
+	os_set_thread_name("mp_demux_thread");
+
+	pthread_mutex_lock(&m->demux_mutex);
+
+	while (!m->pipeline_kill) {
+		uint64_t start;
+		int ret;
+
+		if (!mp_media_should_demux(m)) {
+			pthread_cond_wait(&m->demux_cond, &m->demux_mutex);
+			continue;
+		}
+
+		m->demuxing = true;
+		pthread_mutex_unlock(&m->demux_mutex);
+
+		start = os_gettime_ns();
+		ret = mp_media_next_packet(m);
+
+		pthread_mutex_lock(&m->demux_mutex);
+		m->demuxing = false;
+		mp_update_average(&m->demux_ns, os_gettime_ns() - start);
+
+		if (ret < 0) {
+			/* interrupted reads end the stream like eof, the
+			 * media thread resets it afterwards */
+			m->eof = true;
+			m->demux_ret = ret;
+			if (ret != AVERROR_EOF && ret != AVERROR_EXIT)
+				m->demux_failed = true;
+
+			if (m->has_video)
+				mp_decode_set_demux_eof(&m->v);
+			if (m->has_audio)
+				mp_decode_set_demux_eof(&m->a);
+		}
+
+		pthread_cond_broadcast(&m->demux_cond);
+	}
+
+	pthread_mutex_unlock(&m->demux_mutex);
+	return NULL;
+}
+
+void mp_media_wake_demux(mp_media_t *m)
+{
+	pthread_mutex_lock(&m->demux_mutex);
+	pthread_cond_broadcast(&m->demux_cond);
+	pthread_mutex_unlock(&m->demux_mutex);
+}
+
+static void mp_media_pause_demux(mp_media_t *m)
+{
+	pthread_mutex_lock(&m->demux_mutex);
+	m->demux_paused = true;
+	while (m->demuxing)
+		pthread_cond_wait(&m->demux_cond, &m->demux_mutex);
+	pthread_mutex_unlock(&m->demux_mutex);
+}
+
+static void mp_media_resume_demux(mp_media_t *m, bool clear_eof)
+{
+	pthread_mutex_lock(&m->demux_mutex);
+	m->demux_paused = false;
+	if (clear_eof) {
+		m->eof = false;
+		m->demux_ret = 0;
+	}
+	pthread_cond_broadcast(&m->demux_cond);
+	pthread_mutex_unlock(&m->demux_mutex);
+}
+
+static bool mp_media_demux_failed(mp_media_t *m)
+{
+	bool failed;
+
+	pthread_mutex_lock(&m->demux_mutex);
+	failed = m->demux_failed;
+	pthread_mutex_unlock(&m->demux_mutex);
+
+	return failed;
+}
+
+/* true only if the demuxer read to the end of the file, not if the read was
+ * interrupted or failed */
+static bool mp_media_demux_reached_eof(mp_media_t *m)
+{
+	bool reached_eof;
+
+	pthread_mutex_lock(&m->demux_mutex);
+	reached_eof = m->eof && m->demux_ret == AVERROR_EOF;
+	pthread_mutex_unlock(&m->demux_mutex);
+
+	return reached_eof;
+}
+
+static bool mp_media_start_pipeline(mp_media_t *m)
+{
+	bool success = false;
+
+	pthread_mutex_lock(&m->mutex);
+
+	if (m->pipeline_kill)
+		goto exit;
+
+	if (m->has_video && !mp_decode_start(&m->v))
+		goto exit;
+	if (m->has_audio && !mp_decode_start(&m->a))
+		goto exit;
+
+	if (pthread_create(&m->demux_thread, NULL, mp_demux_thread, m) != 0) {
+		blog(LOG_WARNING, "MP: Could not create demux thread");
+		goto exit;
+	}
+
+	m->demux_thread_valid = true;
+	success = true;
+
+exit:
+	/* set even on failure so the started decoders get stopped */
+	m->pipeline_started = true;
+	pthread_mutex_unlock(&m->mutex);
+	return success;
+}
+
+static void mp_media_stop_pipeline(mp_media_t *m)
+{
+	bool started;
+
+	pthread_mutex_lock(&m->mutex);
+	m->pipeline_kill = true;
+	started = m->pipeline_started;
+	pthread_mutex_unlock(&m->mutex);
+
+	if (!started)
+		return;
+
+	if (m->has_video)
+		mp_decode_stop(&m->v);
+	if (m->has_audio)
+		mp_decode_stop(&m->a);
+
+	if (m->demux_thread_valid) {
+		mp_media_wake_demux(m);
+		pthread_join(m->demux_thread, NULL);
+		m->demux_thread_valid = false;
+	}
+}
+
+void mp_media_get_stats(mp_media_t *m, struct mp_media_stats *stats)
+{
+	size_t bytes;
+	bool started;
+
+	memset(stats, 0, sizeof(*stats));
+
+	pthread_mutex_lock(&m->mutex);
+	started = m->pipeline_started && !m->pipeline_kill;
+	pthread_mutex_unlock(&m->mutex);
+
+	if (!started)
+		return;
+
+	pthread_mutex_lock(&m->demux_mutex);
+	stats->demux_ns = m->demux_ns;
+	pthread_mutex_unlock(&m->demux_mutex);
+
+	if (m->has_video) {
+		mp_decode_needs_packets(&m->v, &stats->video_packets, &bytes);
+
+		pthread_mutex_lock(&m->v.mutex);
+		stats->video_decode_ns = m->v.decode_ns;
+		stats->video_frames = m->v.frames.size /
+			sizeof(struct mp_frame);
+		pthread_mutex_unlock(&m->v.mutex);
+	}
+
+	if (m->has_audio) {
+		mp_decode_needs_packets(&m->a, &stats->audio_packets, &bytes);
+
+		pthread_mutex_lock(&m->a.mutex);
+		stats->audio_decode_ns = m->a.decode_ns;
+		stats->audio_frames = m->a.frames.size /
+			sizeof(struct mp_frame);
+		pthread_mutex_unlock(&m->a.mutex);
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+
 static inline bool mp_media_ready_to_start(mp_media_t *m)
 {
 	if (m->has_audio && !m->a.eof && !m->a.frame_ready)
@@ -116,93 +340,181 @@ static inline bool mp_media_ready_to_start(mp_media_t *m)
 	return true;
 }
 
-static inline bool mp_decode_frame(struct mp_decode *d)
+/* ------------------------------------------------------------------------- */
+/* decoded frame cache                                                       */
+
+static void mp_media_init_cache(mp_media_t *m)
 {
-	return d->frame_ready || mp_decode_next(d);
+	if (!m->cache_max_bytes)
+		return;
+
+	if (m->is_network || m->hw || (m->format_name && *m->format_name)) {
+		m->cache_max_bytes = 0;
+		return;
+	}
+
+	if (m->fmt->duration != AV_NOPTS_VALUE &&
+	    m->fmt->duration > m->cache_max_ns / 1000) {
+		m->cache_max_bytes = 0;
+		return;
+	}
+
+	/* another source already decoded the whole file, the demux and
+	 * decode threads are not needed at all */
+	m->cache = mp_cache_find(m->path);
+	if (m->cache) {
+		m->cache_playing = true;
+		m->demux_paused = true;
+		blog(LOG_INFO, "MP: Playing '%s' from the frame cache",
+				m->path);
+	}
 }
 
-static inline int get_sws_colorspace(enum AVColorSpace cs)
+static void mp_media_disable_cache(mp_media_t *m)
 {
-	switch (cs) {
-	case AVCOL_SPC_BT709:
-		return SWS_CS_ITU709;
-	case AVCOL_SPC_FCC:
-		return SWS_CS_FCC;
-	case AVCOL_SPC_SMPTE170M:
-		return SWS_CS_SMPTE170M;
-	case AVCOL_SPC_SMPTE240M:
-		return SWS_CS_SMPTE240M;
-	default:
-		break;
+	mp_cache_release(m->cache);
+	m->cache = NULL;
+	m->cache_max_bytes = 0;
+	m->cache_recorded = false;
+}
+
+/* called on reset, starts recording or switches to cache playback */
+static void mp_media_reset_cache(mp_media_t *m)
+{
+	if (!m->cache_max_bytes || m->cache_playing)
+		return;
+
+	if (m->cache && m->cache_recorded) {
+		blog(LOG_INFO, "MP: Cached %d video and %d audio frames "
+				"(%d MB) of '%s'",
+				(int)m->cache->video.num,
+				(int)m->cache->audio.num,
+				(int)(m->cache->size / (1024 * 1024)),
+				m->path);
+
+		mp_cache_publish(m->cache);
+		mp_media_pause_demux(m);
+		m->cache_playing = true;
+		return;
 	}
 
-	return SWS_CS_ITU601;
+	if (m->cache)
+		mp_cache_clear(m->cache);
+	else
+		m->cache = mp_cache_create(m->path);
 }
 
-static inline int get_sws_range(enum AVColorRange r)
+static void mp_media_rewind_cache(mp_media_t *m)
 {
-	return r == AVCOL_RANGE_JPEG ? 1 : 0;
+	m->cache_v_pos = 0;
+	m->cache_a_pos = 0;
+
+	m->v.eof = m->a.eof = false;
+	m->v.frame_ready = m->a.frame_ready = false;
+	m->v.frame_pts = m->a.frame_pts = 0;
 }
 
-#define FIXED_1_0 (1<<16)
+/* index of the first cached frame that is still shown at pts */
+static size_t find_cached_frame(const struct mp_frame *frames, size_t num,
+		int64_t pts)
+{
+	size_t lo = 0, hi = num;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (frames[mid].next_pts <= pts)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
 
-static bool mp_media_init_scaling(mp_media_t *m)
+static void mp_media_seek_cache(mp_media_t *m, int64_t pts)
 {
-	int space = get_sws_colorspace(m->v.decoder->colorspace);
-	int range = get_sws_range(m->v.decoder->color_range);
-	const int *coeff = sws_getCoefficients(space);
+	struct mp_cache *c = m->cache;
 
-	m->swscale = sws_getCachedContext(NULL,
-			m->v.decoder->width, m->v.decoder->height,
-			m->v.decoder->pix_fmt,
-			m->v.decoder->width, m->v.decoder->height,
-			m->scale_format,
-			SWS_FAST_BILINEAR, NULL, NULL, NULL);
-	if (!m->swscale) {
-		blog(LOG_WARNING, "MP: Failed to initialize scaler");
-		return false;
+	mp_media_rewind_cache(m);
+	m->cache_v_pos = find_cached_frame(c->video.array, c->video.num, pts);
+	m->cache_a_pos = find_cached_frame(c->audio.array, c->audio.num, pts);
+}
+
+static void mp_media_record_frame(mp_media_t *m, struct mp_decode *d)
+{
+	struct mp_cache *c = m->cache;
+	struct mp_frame *first = d->audio ? c->audio.array : c->video.array;
+	int64_t duration = first ? d->frame_pts - first->pts : 0;
+
+	if (!mp_cache_add(c, d->frame, d->frame_pts, d->next_pts, d->audio) ||
+	    c->size > m->cache_max_bytes ||
+	    duration > m->cache_max_ns) {
+		blog(LOG_INFO, "MP: '%s' exceeds the frame cache limits, "
+				"frames will not be cached", m->path);
+		mp_media_disable_cache(m);
 	}
+}
 
-	sws_setColorspaceDetails(m->swscale, coeff, range, coeff, range, 0,
-			FIXED_1_0, FIXED_1_0);
+static void mp_media_next_cached_frame(mp_media_t *m, struct mp_decode *d)
+{
+	struct mp_cache *c = m->cache;
+	size_t *pos = d->audio ? &m->cache_a_pos : &m->cache_v_pos;
+	size_t num = d->audio ? c->audio.num : c->video.num;
+	struct mp_frame *f;
 
-	int ret = av_image_alloc(m->scale_pic, m->scale_linesizes,
-			m->v.decoder->width, m->v.decoder->height,
-			m->scale_format, 1);
-	if (ret < 0) {
-		blog(LOG_WARNING, "MP: Failed to create scale pic data");
-		return false;
+	if (*pos == num) {
+		d->eof = true;
+		return;
+	}
+
+	f = d->audio ? &c->audio.array[*pos] : &c->video.array[*pos];
+	(*pos)++;
+
+	/* cached frames are shared and only ever read */
+	av_frame_unref(d->frame);
+	if (av_frame_ref(d->frame, f->frame) < 0) {
+		d->eof = true;
+		return;
 	}
 
+	d->frame_pts = f->pts;
+	d->next_pts = f->next_pts;
+	d->frame_ready = true;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static inline bool mp_decode_frame(mp_media_t *m, struct mp_decode *d)
+{
+	if (d->frame_ready || d->eof)
+		return true;
+
+	if (m->cache_playing) {
+		mp_media_next_cached_frame(m, d);
+		return true;
+	}
+
+	if (!mp_decode_next(d))
+		return false;
+
+	if (m->cache && d->frame_ready)
+		mp_media_record_frame(m, d);
 	return true;
 }
 
+/* waits for the decode threads to deliver the next frame of each stream */
 static bool mp_media_prepare_frames(mp_media_t *m)
 {
-	while (!mp_media_ready_to_start(m)) {
-		if (!m->eof) {
-			int ret = mp_media_next_packet(m);
-			if (ret == AVERROR_EOF)
-				m->eof = true;
-			else if (ret < 0)
-				return false;
-		}
+	if (mp_media_demux_failed(m))
+		return false;
 
-		if (m->has_video && !mp_decode_frame(&m->v))
+	while (!mp_media_ready_to_start(m)) {
+		if (m->has_video && !mp_decode_frame(m, &m->v))
 			return false;
-		if (m->has_audio && !mp_decode_frame(&m->a))
+		if (m->has_audio && !mp_decode_frame(m, &m->a))
 			return false;
 	}
 
-	if (m->has_video && m->v.frame_ready && !m->swscale) {
-		m->scale_format = closest_format(m->v.frame->format);
-		if (m->scale_format != m->v.frame->format) {
-			if (!mp_media_init_scaling(m)) {
-				return false;
-			}
-		}
-	}
-
 	return true;
 }
 
@@ -290,34 +602,18 @@ static void mp_media_next_video(mp_media_t *m, bool preload)
 		return;
 	}
 
-	bool flip = false;
-	if (m->swscale) {
-		int ret = sws_scale(m->swscale,
-				(const uint8_t *const *)f->data, f->linesize,
-				0, f->height,
-				m->scale_pic, m->scale_linesizes);
-		if (ret < 0)
-			return;
-
-		flip = m->scale_linesizes[0] < 0 && m->scale_linesizes[1] == 0;
-		for (size_t i = 0; i < 4; i++) {
-			frame->data[i] = m->scale_pic[i];
-			frame->linesize[i] = abs(m->scale_linesizes[i]);
-		}
-
-	} else {
-		flip = f->linesize[0] < 0 && f->linesize[1] == 0;
+	/* frames were already converted by the decode thread */
+	bool flip = f->linesize[0] < 0 && f->linesize[1] == 0;
 
-		for (size_t i = 0; i < MAX_AV_PLANES; i++) {
-			frame->data[i] = f->data[i];
-			frame->linesize[i] = abs(f->linesize[i]);
-		}
+	for (size_t i = 0; i < MAX_AV_PLANES; i++) {
+		frame->data[i] = f->data[i];
+		frame->linesize[i] = abs(f->linesize[i]);
 	}
 
 	if (flip)
 		frame->data[0] -= frame->linesize[0] * (f->height - 1);
 
-	new_format = convert_pixel_format(m->scale_format);
+	new_format = convert_pixel_format(f->format);
 	new_space  = convert_color_space(f->colorspace);
 	new_range  = m->force_range == VIDEO_RANGE_DEFAULT
 		? convert_color_range(f->color_range)
@@ -407,32 +703,47 @@ static bool mp_media_reset(mp_media_t *m)
 		? av_rescale_q(seek_pos, AV_TIME_BASE_Q, stream->time_base)
 		: seek_pos;
 
-	if (!m->is_network) {
-		int ret = av_seek_frame(m->fmt, 0, seek_target, seek_flags);
-		if (ret < 0) {
-			blog(LOG_WARNING, "MP: Failed to seek: %s",
-					av_err2str(ret));
-			return false;
-		}
-	}
-
-	if (m->has_video && !m->is_network)
-		mp_decode_flush(&m->v);
-	if (m->has_audio && !m->is_network)
-		mp_decode_flush(&m->a);
+	mp_media_reset_cache(m);
 
-	int64_t next_ts = mp_media_get_base_pts(m);
-	int64_t offset = next_ts - m->next_pts_ns;
+	if (m->cache_playing) {
+		mp_media_rewind_cache(m);
+	} else {
+		/* the demux thread must not read while seeking or flushing */
+		mp_media_pause_demux(m);
+
+		if (!m->is_network) {
+			int ret = av_seek_frame(m->fmt, 0, seek_target,
+					seek_flags);
+			if (ret < 0) {
+				blog(LOG_WARNING, "MP: Failed to seek: %s",
+						av_err2str(ret));
+				mp_media_resume_demux(m, false);
+				return false;
+			}
+		}
 
-	m->eof = false;
-	m->base_ts += next_ts;
+		if (m->has_video && !m->is_network)
+			mp_decode_flush(&m->v);
+		if (m->has_audio && !m->is_network)
+			mp_decode_flush(&m->a);
+	}
 
+	/* clear stopping before the demuxer resumes, the interrupt callback
+	 * would abort its next read otherwise */
 	pthread_mutex_lock(&m->mutex);
 	stopping = m->stopping;
 	active = m->active;
 	m->stopping = false;
 	pthread_mutex_unlock(&m->mutex);
 
+	if (!m->cache_playing)
+		mp_media_resume_demux(m, true);
+
+	int64_t next_ts = mp_media_get_base_pts(m);
+	int64_t offset = next_ts - m->next_pts_ns;
+
+	m->base_ts += next_ts;
+
 	if (!mp_media_prepare_frames(m))
 		return false;
 
@@ -455,6 +766,103 @@ static bool mp_media_reset(mp_media_t *m)
 	return true;
 }
 
+static void mp_media_seek_demux(mp_media_t *m, int64_t pts)
+{
+	struct mp_index_entry entry;
+	int stream_index = -1;
+	int64_t seek_target;
+	int ret;
+
+	/* the index points straight at the keyframe before the target, the
+	 * demuxer on its own may land anywhere before it */
+	if (m->has_video && mp_index_find(m->index, pts, &entry)) {
+		stream_index = m->v.stream->index;
+		seek_target = entry.ts;
+	} else {
+		seek_target = av_rescale_q(pts, (AVRational){1, 1000000000},
+				AV_TIME_BASE_Q);
+	}
+
+	/* the demux thread must not read while seeking or flushing */
+	mp_media_pause_demux(m);
+
+	ret = av_seek_frame(m->fmt, stream_index, seek_target,
+			AVSEEK_FLAG_BACKWARD);
+	if (ret < 0) {
+		blog(LOG_WARNING, "MP: Failed to seek: %s", av_err2str(ret));
+		mp_media_resume_demux(m, false);
+		return;
+	}
+
+	if (m->has_video)
+		mp_decode_flush_to(&m->v, pts);
+	if (m->has_audio)
+		mp_decode_flush_to(&m->a, pts);
+
+	mp_media_resume_demux(m, true);
+}
+
+/*
+ * Frames of the new position continue where the current frame left off, so
+ * timestamps stay monotonic and a playing source keeps its pace.  The frame
+ * that is up stays visible until the decode threads reach the target.
+ */
+static bool mp_media_seek_to(mp_media_t *m, int64_t pos_ns)
+{
+	int64_t pts = pos_ns;
+	bool active;
+
+	if (m->is_network) {
+		blog(LOG_WARNING, "MP: Seeking is not supported for '%s'",
+				m->path);
+		return true;
+	}
+
+	if (pts < 0)
+		pts = 0;
+	if (m->fmt->start_time != AV_NOPTS_VALUE)
+		pts += av_rescale_q(m->fmt->start_time, AV_TIME_BASE_Q,
+				(AVRational){1, 1000000000});
+
+	if (m->cache_playing) {
+		mp_media_seek_cache(m, pts);
+	} else {
+		/* a partial recording no longer matches the file, the next
+		 * pass records the cache from the start again */
+		if (m->cache) {
+			mp_cache_release(m->cache);
+			m->cache = NULL;
+		}
+
+		mp_media_seek_demux(m, pts);
+	}
+
+	m->base_ts += m->next_pts_ns - m->start_ts;
+
+	pthread_mutex_lock(&m->mutex);
+	active = m->active;
+	pthread_mutex_unlock(&m->mutex);
+
+	if (!mp_media_prepare_frames(m))
+		return false;
+
+	/* past the end, the media thread handles it like any other eof */
+	if (mp_media_get_next_min_pts(m) == 0x7FFFFFFFFFFFFFFFLL)
+		return true;
+
+	m->start_ts = m->next_pts_ns = mp_media_get_next_min_pts(m);
+
+	if (!active) {
+		m->play_sys_ts = (int64_t)os_gettime_ns();
+		m->next_ns = 0;
+
+		if (m->v_preload_cb)
+			mp_media_next_video(m, true);
+	}
+
+	return true;
+}
+
 static inline bool mp_media_sleepto(mp_media_t *m)
 {
 	bool timeout = false;
@@ -483,9 +891,11 @@ static inline bool mp_media_eof(mp_media_t *m)
 	bool eof = v_ended && a_ended;
 
 	if (eof) {
+		bool interrupted;
 		bool looping;
 
 		pthread_mutex_lock(&m->mutex);
+		interrupted = m->stopping || m->reset || m->kill;
 		looping = m->looping;
 		if (!looping) {
 			m->active = false;
@@ -493,6 +903,13 @@ static inline bool mp_media_eof(mp_media_t *m)
 		}
 		pthread_mutex_unlock(&m->mutex);
 
+		/* every frame of the file went through the cache, unless the
+		 * stream ended early because a read was interrupted or
+		 * failed */
+		if (m->cache && !m->cache_playing && !interrupted &&
+		    mp_media_demux_reached_eof(m))
+			m->cache_recorded = true;
+
 		mp_media_reset(m);
 	}
 
@@ -505,6 +922,9 @@ static int interrupt_callback(void *data)
 	bool stop = false;
 	uint64_t ts = os_gettime_ns();
 
+	if (m->pipeline_kill)
+		return true;
+
 	if ((ts - m->interrupt_poll_ts) > 20000000) {
 		pthread_mutex_lock(&m->mutex);
 		stop = m->kill || m->stopping;
@@ -569,12 +989,25 @@ static inline bool mp_media_thread(mp_media_t *m)
 	if (!init_avformat(m)) {
 		return false;
 	}
+
+	mp_media_init_cache(m);
+
+	/* files without a duration, like images, have nothing to seek in */
+	if (!m->is_network && !m->cache_playing && m->has_video &&
+	    !(m->format_name && *m->format_name) &&
+	    m->fmt->duration != AV_NOPTS_VALUE)
+		m->index = mp_index_create(m->path, m->v.stream->index);
+
+	if (!mp_media_start_pipeline(m)) {
+		return false;
+	}
 	if (!mp_media_reset(m)) {
 		return false;
 	}
 
 	for (;;) {
-		bool reset, kill, is_active;
+		bool reset, kill, seek, is_active;
+		int64_t seek_ns;
 		bool timeout = false;
 
 		pthread_mutex_lock(&m->mutex);
@@ -592,8 +1025,11 @@ static inline bool mp_media_thread(mp_media_t *m)
 
 		reset = m->reset;
 		kill = m->kill;
+		seek = m->seek;
+		seek_ns = m->seek_ns;
 		m->reset = false;
 		m->kill = false;
+		m->seek = false;
 
 		pthread_mutex_unlock(&m->mutex);
 
@@ -602,6 +1038,12 @@ static inline bool mp_media_thread(mp_media_t *m)
 		}
 		if (reset) {
 			mp_media_reset(m);
+		}
+		if (seek) {
+			if (!mp_media_seek_to(m, seek_ns))
+				return false;
+		}
+		if (reset || seek) {
 			continue;
 		}
 
@@ -628,7 +1070,7 @@ static void *mp_media_thread_start(void *opaque)
 {
 	mp_media_t *m = opaque;
 
-	if (!mp_media_thread(m)) {
+	if (!mp_media_thread(m) && !m->pipeline_kill) {
 		if (m->stop_cb) {
 			m->stop_cb(m->opaque);
 		}
@@ -650,6 +1092,14 @@ static inline bool mp_media_init_internal(mp_media_t *m,
 		blog(LOG_WARNING, "MP: Failed to init semaphore");
 		return false;
 	}
+	if (pthread_mutex_init(&m->demux_mutex, NULL) != 0) {
+		blog(LOG_WARNING, "MP: Failed to init demux mutex");
+		return false;
+	}
+	if (pthread_cond_init(&m->demux_cond, NULL) != 0) {
+		blog(LOG_WARNING, "MP: Failed to init demux condition");
+		return false;
+	}
 
 	m->path = path ? bstrdup(path) : NULL;
 	m->format_name = format_name ? bstrdup(format_name) : NULL;
@@ -674,10 +1124,13 @@ bool mp_media_init(mp_media_t *media,
 		mp_stop_cb stop_cb,
 		mp_video_cb v_preload_cb,
 		bool hw_decoding,
-		enum video_range_type force_range)
+		enum video_range_type force_range,
+		int cache_max_sec,
+		int cache_max_mb)
 {
 	memset(media, 0, sizeof(*media));
 	pthread_mutex_init_value(&media->mutex);
+	pthread_mutex_init_value(&media->demux_mutex);
 	media->opaque = opaque;
 	media->v_cb = v_cb;
 	media->a_cb = a_cb;
@@ -686,10 +1139,19 @@ bool mp_media_init(mp_media_t *media,
 	media->force_range = force_range;
 	media->buffering = buffering;
 
+	if (cache_max_sec > 0 && cache_max_mb > 0) {
+		media->cache_max_ns = (int64_t)cache_max_sec * 1000000000LL;
+		media->cache_max_bytes = (size_t)cache_max_mb * 1024 * 1024;
+	}
+
 	if (path && *path)
 		media->is_network = !!strstr(path, "://");
 
+	/* sources can be created from several threads at once */
+	static pthread_mutex_t init_mutex = PTHREAD_MUTEX_INITIALIZER;
 	static bool initialized = false;
+
+	pthread_mutex_lock(&init_mutex);
 	if (!initialized) {
 		av_register_all();
 		avdevice_register_all();
@@ -697,6 +1159,7 @@ bool mp_media_init(mp_media_t *media,
 		avformat_network_init();
 		initialized = true;
 	}
+	pthread_mutex_unlock(&init_mutex);
 
 	if (!base_sys_ts)
 		base_sys_ts = (int64_t)os_gettime_ns();
@@ -717,6 +1180,9 @@ static void mp_kill_thread(mp_media_t *m)
 		pthread_mutex_unlock(&m->mutex);
 		os_sem_post(m->sem);
 
+		/* wakes the media thread if it waits for decoded frames */
+		mp_media_stop_pipeline(m);
+
 		pthread_join(m->thread, NULL);
 	}
 }
@@ -730,11 +1196,13 @@ void mp_media_free(mp_media_t *media)
 	mp_kill_thread(media);
 	mp_decode_free(&media->v);
 	mp_decode_free(&media->a);
+	mp_cache_release(media->cache);
+	mp_index_destroy(media->index);
 	avformat_close_input(&media->fmt);
 	pthread_mutex_destroy(&media->mutex);
+	pthread_mutex_destroy(&media->demux_mutex);
+	pthread_cond_destroy(&media->demux_cond);
 	os_sem_destroy(media->sem);
-	sws_freeContext(media->swscale);
-	av_freep(&media->scale_pic[0]);
 	bfree(media->path);
 	bfree(media->format_name);
 	memset(media, 0, sizeof(*media));
@@ -756,6 +1224,17 @@ void mp_media_play(mp_media_t *m, bool loop)
 	os_sem_post(m->sem);
 }
 
+void mp_media_seek(mp_media_t *m, int64_t pos_ns)
+{
+	/* only the last position counts when several seeks queue up */
+	pthread_mutex_lock(&m->mutex);
+	m->seek = true;
+	m->seek_ns = pos_ns;
+	pthread_mutex_unlock(&m->mutex);
+
+	os_sem_post(m->sem);
+}
+
 void mp_media_stop(mp_media_t *m)
 {
 	pthread_mutex_lock(&m->mutex);
@@ -18,6 +18,8 @@
 
 #include <obs.h>
 #include "decode.h"
+#include "cache.h"
+#include "index.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -38,6 +40,10 @@ extern "C" {
 #pragma warning(pop)
 #endif
 
+/* decoded frames that are kept ready for playback, per stream */
+#define MP_VIDEO_LOOKAHEAD_FRAMES 8
+#define MP_AUDIO_LOOKAHEAD_FRAMES 32
+
 typedef void (*mp_video_cb)(void *opaque, struct obs_source_frame *frame);
 typedef void (*mp_audio_cb)(void *opaque, struct obs_source_audio *audio);
 typedef void (*mp_stop_cb)(void *opaque);
@@ -55,18 +61,12 @@ struct mp_media {
 	char *format_name;
 	int buffering;
 
-	enum AVPixelFormat scale_format;
-	struct SwsContext *swscale;
-	int scale_linesizes[4];
-	uint8_t *scale_pic[4];
-
 	struct mp_decode v;
 	struct mp_decode a;
 	bool is_network;
 	bool has_video;
 	bool has_audio;
 	bool is_file;
-	bool eof;
 	bool hw;
 
 	struct obs_source_frame obsframe;
@@ -89,13 +89,62 @@ struct mp_media {
 	bool active;
 	bool reset;
 	bool kill;
+	bool seek;
+	int64_t seek_ns;
 
 	bool thread_valid;
 	pthread_t thread;
+
+	/* demux thread, shared state is protected by demux_mutex */
+	pthread_mutex_t demux_mutex;
+	pthread_cond_t demux_cond;
+	pthread_t demux_thread;
+	bool demux_thread_valid;
+	bool demux_paused;
+	bool demuxing;
+	bool demux_failed;
+	bool eof;
+	int demux_ret;
+	uint64_t demux_ns;
+
+	/* set under mutex once the demux and decode threads run */
+	bool pipeline_started;
+	volatile bool pipeline_kill;
+
+	/* decoded frame cache of looping local files, media thread only.
+	 * frames are recorded into the cache during the first pass and
+	 * played back from it afterwards. */
+	size_t cache_max_bytes;
+	int64_t cache_max_ns;
+	struct mp_cache *cache;
+	bool cache_recorded;
+	bool cache_playing;
+	size_t cache_v_pos;
+	size_t cache_a_pos;
+
+	/* keyframe index of local files, media thread only */
+	struct mp_index *index;
 };
 
 typedef struct mp_media mp_media_t;
 
+/**
+ * Pipeline statistics.  Latencies are running averages in nanoseconds, queue
+ * depths are the number of packets or decoded frames currently waiting.
+ */
+struct mp_media_stats {
+	uint64_t demux_ns;
+	uint64_t video_decode_ns;
+	uint64_t audio_decode_ns;
+
+	size_t video_packets;
+	size_t audio_packets;
+	size_t video_frames;
+	size_t audio_frames;
+};
+
+/* the decoded frame cache is only used for local files, and only when both
+ * cache_max_sec and cache_max_mb are non-zero */
 extern bool mp_media_init(mp_media_t *media,
 		const char *path,
 		const char *format,
@@ -106,12 +155,33 @@ extern bool mp_media_init(mp_media_t *media,
 		mp_stop_cb stop_cb,
 		mp_video_cb v_preload_cb,
 		bool hardware_decoding,
-		enum video_range_type force_range);
+		enum video_range_type force_range,
+		int cache_max_sec,
+		int cache_max_mb);
 extern void mp_media_free(mp_media_t *media);
 
 extern void mp_media_play(mp_media_t *media, bool loop);
 extern void mp_media_stop(mp_media_t *media);
 
+/* seeks to a position in nanoseconds from the start of the media, without
+ * changing whether it plays.  the current frame stays up until the frame at
+ * the new position is decoded.  network streams can not seek. */
+extern void mp_media_seek(mp_media_t *media, int64_t pos_ns);
+
+extern void mp_media_get_stats(mp_media_t *media,
+		struct mp_media_stats *stats);
+
+/* used by the decode threads */
+extern void mp_media_wake_demux(mp_media_t *media);
+
+static inline void mp_update_average(uint64_t *avg, uint64_t sample)
+{
+	if (*avg)
+		*avg = (*avg * 15 + sample) / 16;
+	else
+		*avg = sample;
+}
+
 /* #define DETAILED_DEBUG_INFO */
 
 #if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 48, 101)
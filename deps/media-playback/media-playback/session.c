@@ -0,0 +1,420 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <obs.h>
+#include <util/threading.h>
+#include <util/darray.h>
+#include <util/dstr.h>
+#include <util/bmem.h>
+
+#include "session.h"
+
+struct mp_session {
+	mp_media_t media;
+	struct mp_session_info info;
+	char *key;
+	long refs;
+
+	/* protects subscribers, held while frames are fanned out */
+	pthread_mutex_t mutex;
+	DARRAY(struct mp_subscriber *) subscribers;
+};
+
+struct mp_subscriber {
+	struct mp_session *session;
+	void *opaque;
+	mp_shared_video_cb v_cb;
+	mp_audio_cb a_cb;
+	mp_stop_cb stop_cb;
+	mp_video_cb v_preload_cb;
+	bool playing;
+};
+
+/* a decoded frame shared by the async frames of every subscriber */
+struct mp_shared_frame {
+	AVFrame *frame;
+	volatile long refs;
+};
+
+static pthread_mutex_t sessions_mutex = PTHREAD_MUTEX_INITIALIZER;
+static DARRAY(struct mp_session *) sessions;
+
+static void shared_frame_release(void *param)
+{
+	struct mp_shared_frame *shared = param;
+
+	if (os_atomic_dec_long(&shared->refs) == 0) {
+		av_frame_free(&shared->frame);
+		bfree(shared);
+	}
+}
+
+static struct mp_shared_frame *shared_frame_create(mp_media_t *media)
+{
+	struct mp_shared_frame *shared;
+	AVFrame *frame = av_frame_clone(media->v.frame);
+
+	if (!frame)
+		return NULL;
+
+	shared = bmalloc(sizeof(*shared));
+	shared->frame = frame;
+	shared->refs = 1;
+	return shared;
+}
+
+static void session_video(void *opaque, struct obs_source_frame *frame)
+{
+	struct mp_session *session = opaque;
+	struct mp_shared_frame *shared;
+
+	/* called from the media thread, which owns the current frame */
+	shared = shared_frame_create(&session->media);
+
+	pthread_mutex_lock(&session->mutex);
+
+	for (size_t i = 0; i < session->subscribers.num; i++) {
+		struct mp_subscriber *sub = session->subscribers.array[i];
+		struct obs_source_frame sub_frame = *frame;
+
+		if (!sub->playing || !sub->v_cb)
+			continue;
+
+		if (shared) {
+			os_atomic_inc_long(&shared->refs);
+			sub->v_cb(sub->opaque, &sub_frame,
+					shared_frame_release, shared);
+		} else {
+			sub->v_cb(sub->opaque, &sub_frame, NULL, NULL);
+		}
+	}
+
+	pthread_mutex_unlock(&session->mutex);
+
+	if (shared)
+		shared_frame_release(shared);
+}
+
+static void session_preload(void *opaque, struct obs_source_frame *frame)
+{
+	struct mp_session *session = opaque;
+
+	pthread_mutex_lock(&session->mutex);
+
+	for (size_t i = 0; i < session->subscribers.num; i++) {
+		struct mp_subscriber *sub = session->subscribers.array[i];
+		if (sub->v_preload_cb)
+			sub->v_preload_cb(sub->opaque, frame);
+	}
+
+	pthread_mutex_unlock(&session->mutex);
+}
+
+static void session_audio(void *opaque, struct obs_source_audio *audio)
+{
+	struct mp_session *session = opaque;
+
+	pthread_mutex_lock(&session->mutex);
+
+	for (size_t i = 0; i < session->subscribers.num; i++) {
+		struct mp_subscriber *sub = session->subscribers.array[i];
+		if (sub->playing && sub->a_cb)
+			sub->a_cb(sub->opaque, audio);
+	}
+
+	pthread_mutex_unlock(&session->mutex);
+}
+
+static void session_stopped(void *opaque)
+{
+	struct mp_session *session = opaque;
+
+	pthread_mutex_lock(&session->mutex);
+
+	for (size_t i = 0; i < session->subscribers.num; i++) {
+		struct mp_subscriber *sub = session->subscribers.array[i];
+		if (sub->stop_cb)
+			sub->stop_cb(sub->opaque);
+	}
+
+	pthread_mutex_unlock(&session->mutex);
+}
+
+/* the playback control options are part of the key as well, subscribers
+ * that start, stop or loop differently never share a session */
+static char *session_key(const struct mp_session_info *info)
+{
+	struct dstr key = {0};
+
+	dstr_printf(&key, "%s|%s|%d|%d|%d|%d|%d|%d|%d|%d",
+			info->path,
+			info->format ? info->format : "",
+			info->buffering,
+			(int)info->hardware_decoding,
+			(int)info->force_range,
+			(int)info->looping,
+			(int)info->restart_on_activate,
+			(int)info->close_when_inactive,
+			info->cache_max_sec,
+			info->cache_max_mb);
+	return key.array;
+}
+
+static void session_destroy(struct mp_session *session)
+{
+	/* joins the media thread, so no callback can still be running */
+	mp_media_free(&session->media);
+
+	pthread_mutex_destroy(&session->mutex);
+	da_free(session->subscribers);
+	bfree((char*)session->info.path);
+	bfree((char*)session->info.format);
+	bfree(session->key);
+	bfree(session);
+}
+
+static struct mp_session *session_create(const struct mp_session_info *info,
+		char *key)
+{
+	struct mp_session *session = bzalloc(sizeof(*session));
+
+	if (pthread_mutex_init(&session->mutex, NULL) != 0) {
+		bfree(session);
+		return NULL;
+	}
+
+	session->key = key;
+	session->refs = 1;
+
+	if (!mp_media_init(&session->media, info->path, info->format,
+				info->buffering, session, session_video,
+				session_audio, session_stopped,
+				session_preload, info->hardware_decoding,
+				info->force_range, info->cache_max_sec,
+				info->cache_max_mb)) {
+		pthread_mutex_destroy(&session->mutex);
+		bfree(session);
+		return NULL;
+	}
+
+	session->info = *info;
+	session->info.path = bstrdup(info->path);
+	session->info.format = info->format ? bstrdup(info->format) : NULL;
+	return session;
+}
+
+mp_subscriber_t *mp_session_subscribe(const struct mp_session_info *info,
+		void *opaque,
+		mp_shared_video_cb v_cb,
+		mp_audio_cb a_cb,
+		mp_stop_cb stop_cb,
+		mp_video_cb v_preload_cb)
+{
+	struct mp_session *session = NULL;
+	struct mp_subscriber *sub;
+	char *key;
+
+	if (!info->path || !*info->path)
+		return NULL;
+
+	key = session_key(info);
+
+	pthread_mutex_lock(&sessions_mutex);
+
+	for (size_t i = 0; i < sessions.num; i++) {
+		if (strcmp(sessions.array[i]->key, key) == 0) {
+			session = sessions.array[i];
+			session->refs++;
+			break;
+		}
+	}
+
+	if (session) {
+		bfree(key);
+	} else {
+		session = session_create(info, key);
+		if (!session) {
+			pthread_mutex_unlock(&sessions_mutex);
+			bfree(key);
+			return NULL;
+		}
+
+		da_push_back(sessions, &session);
+	}
+
+	pthread_mutex_unlock(&sessions_mutex);
+
+	sub = bzalloc(sizeof(*sub));
+	sub->session = session;
+	sub->opaque = opaque;
+	sub->v_cb = v_cb;
+	sub->a_cb = a_cb;
+	sub->stop_cb = stop_cb;
+	sub->v_preload_cb = v_preload_cb;
+
+	pthread_mutex_lock(&session->mutex);
+	da_push_back(session->subscribers, &sub);
+	pthread_mutex_unlock(&session->mutex);
+
+	return sub;
+}
+
+static void session_release(struct mp_session *session, bool last_playing)
+{
+	bool destroy;
+
+	pthread_mutex_lock(&sessions_mutex);
+	destroy = --session->refs == 0;
+	if (destroy) {
+		da_erase_item(sessions, &session);
+		if (!sessions.num)
+			da_free(sessions);
+	}
+	pthread_mutex_unlock(&sessions_mutex);
+
+	if (destroy)
+		session_destroy(session);
+	else if (last_playing)
+		mp_media_stop(&session->media);
+}
+
+/* returns true if no subscriber is playing anymore */
+static bool subscriber_stop_internal(struct mp_subscriber *sub, bool remove)
+{
+	struct mp_session *session = sub->session;
+	bool was_playing = sub->playing;
+	bool others_playing = false;
+
+	pthread_mutex_lock(&session->mutex);
+
+	sub->playing = false;
+	if (remove)
+		da_erase_item(session->subscribers, &sub);
+
+	for (size_t i = 0; i < session->subscribers.num; i++) {
+		if (session->subscribers.array[i]->playing) {
+			others_playing = true;
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&session->mutex);
+
+	return was_playing && !others_playing;
+}
+
+void mp_session_unsubscribe(mp_subscriber_t *sub)
+{
+	struct mp_session *session;
+	bool last_playing;
+
+	if (!sub)
+		return;
+
+	session = sub->session;
+	last_playing = subscriber_stop_internal(sub, true);
+	session_release(session, last_playing);
+
+	bfree(sub);
+}
+
+static bool has_other_subscribers(struct mp_subscriber *sub,
+		bool playing_only)
+{
+	struct mp_session *session = sub->session;
+	bool found = false;
+
+	pthread_mutex_lock(&session->mutex);
+
+	for (size_t i = 0; i < session->subscribers.num; i++) {
+		struct mp_subscriber *other = session->subscribers.array[i];
+		if (other != sub && (!playing_only || other->playing)) {
+			found = true;
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&session->mutex);
+	return found;
+}
+
+/* moves the subscriber to a session of its own that is never shared, so it
+ * can change the playback position without affecting anyone else */
+static bool subscriber_detach(struct mp_subscriber *sub)
+{
+	struct mp_session *old_session = sub->session;
+	struct mp_session *session;
+	bool was_playing = sub->playing;
+	bool last_playing;
+
+	session = session_create(&old_session->info, NULL);
+	if (!session)
+		return false;
+
+	last_playing = subscriber_stop_internal(sub, true);
+	session_release(old_session, last_playing);
+
+	sub->session = session;
+	sub->playing = was_playing;
+
+	pthread_mutex_lock(&session->mutex);
+	da_push_back(session->subscribers, &sub);
+	pthread_mutex_unlock(&session->mutex);
+	return true;
+}
+
+void mp_subscriber_play(mp_subscriber_t *sub, bool restart)
+{
+	struct mp_session *session;
+	mp_media_t *media;
+	bool active;
+
+	/* restarting the shared session would make every other subscriber
+	 * jump back as well */
+	if (restart && has_other_subscribers(sub, true))
+		subscriber_detach(sub);
+
+	session = sub->session;
+	media = &session->media;
+
+	pthread_mutex_lock(&session->mutex);
+	sub->playing = true;
+	pthread_mutex_unlock(&session->mutex);
+
+	pthread_mutex_lock(&media->mutex);
+	active = media->active;
+	pthread_mutex_unlock(&media->mutex);
+
+	if (restart || !active)
+		mp_media_play(media, session->info.looping);
+}
+
+void mp_subscriber_stop(mp_subscriber_t *sub)
+{
+	if (subscriber_stop_internal(sub, false))
+		mp_media_stop(&sub->session->media);
+}
+
+void mp_subscriber_seek(mp_subscriber_t *sub, int64_t pos_ns)
+{
+	/* seeking the shared session would move every other subscriber to
+	 * the new position as well */
+	if (has_other_subscribers(sub, false) && subscriber_detach(sub) &&
+	    sub->playing)
+		mp_media_play(&sub->session->media, sub->session->info.looping);
+
+	mp_media_seek(&sub->session->media, pos_ns);
+}
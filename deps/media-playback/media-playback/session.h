@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include "media.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Media sessions let several sources play the same input with a single
+ * mp_media_t.  Sessions are reference counted and shared by every subscriber
+ * that opens the same input with the same options, including the playback
+ * control options.  A subscriber that restarts playback while others are
+ * playing is moved to a session of its own.
+ *
+ * Frames are decoded once and handed to each playing subscriber.  Video
+ * frames come with a release callback that holds a reference to the decoded
+ * frame, so libobs can use the decoded data without copying it.  The video
+ * callback must pass the frame on to obs_source_output_video_external, or
+ * call the release callback itself.  The release callback is NULL if the
+ * frame could not be referenced, the frame must then be copied right away.
+ */
+struct mp_session_info {
+	const char *path;
+	const char *format;
+	int buffering;
+	bool hardware_decoding;
+	enum video_range_type force_range;
+	bool looping;
+	bool restart_on_activate;
+	bool close_when_inactive;
+	int cache_max_sec;
+	int cache_max_mb;
+};
+
+struct mp_subscriber;
+typedef struct mp_subscriber mp_subscriber_t;
+
+typedef void (*mp_shared_video_cb)(void *opaque,
+		struct obs_source_frame *frame,
+		void (*release)(void *param), void *param);
+
+extern mp_subscriber_t *mp_session_subscribe(
+		const struct mp_session_info *info,
+		void *opaque,
+		mp_shared_video_cb v_cb,
+		mp_audio_cb a_cb,
+		mp_stop_cb stop_cb,
+		mp_video_cb v_preload_cb);
+extern void mp_session_unsubscribe(mp_subscriber_t *sub);
+
+/* starts playback, or joins it if another subscriber already started it.
+ * restart always plays from the beginning, without affecting the other
+ * subscribers. */
+extern void mp_subscriber_play(mp_subscriber_t *sub, bool restart);
+
+/* the session keeps playing until every subscriber stopped */
+extern void mp_subscriber_stop(mp_subscriber_t *sub);
+
+/* a subscriber that shares its session is moved to a session of its own
+ * first, so the other subscribers keep their position */
+extern void mp_subscriber_seek(mp_subscriber_t *sub, int64_t pos_ns);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1943,26 +1943,21 @@ void gs_vertexbuffer_flush(gs_vertbuffer_t *vertbuffer)
 		return;
 	}
 
-	vertbuffer->FlushBuffer(vertbuffer->vertexBuffer,
-			vertbuffer->vbd.data->points, sizeof(vec3));
-
-	if (vertbuffer->normalBuffer)
-		vertbuffer->FlushBuffer(vertbuffer->normalBuffer,
-				vertbuffer->vbd.data->normals, sizeof(vec3));
+	vertbuffer->Flush(vertbuffer->vbd.data->num);
+}
 
-	if (vertbuffer->tangentBuffer)
-		vertbuffer->FlushBuffer(vertbuffer->tangentBuffer,
-				vertbuffer->vbd.data->tangents, sizeof(vec3));
+void gs_vertexbuffer_flush_partial(gs_vertbuffer_t *vertbuffer, size_t num)
+{
+	if (!vertbuffer->dynamic) {
+		blog(LOG_ERROR, "gs_vertexbuffer_flush_partial: vertex "
+		                "buffer is not dynamic");
+		return;
+	}
 
-	if (vertbuffer->colorBuffer)
-		vertbuffer->FlushBuffer(vertbuffer->colorBuffer,
-				vertbuffer->vbd.data->colors, sizeof(uint32_t));
+	if (num > vertbuffer->vbd.data->num)
+		num = vertbuffer->vbd.data->num;
 
-	for (size_t i = 0; i < vertbuffer->uvBuffers.size(); i++) {
-		gs_tvertarray &tv = vertbuffer->vbd.data->tvarray[i];
-		vertbuffer->FlushBuffer(vertbuffer->uvBuffers[i],
-				tv.array, tv.width*sizeof(float));
-	}
+	vertbuffer->Flush(num);
 }
 
 struct gs_vb_data *gs_vertexbuffer_get_data(const gs_vertbuffer_t *vertbuffer)
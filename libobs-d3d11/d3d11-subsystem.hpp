@@ -246,7 +246,8 @@ struct gs_vertex_buffer : gs_obj {
 	vector<size_t> uvSizes;
 
 	void FlushBuffer(ID3D11Buffer *buffer, void *array,
-			size_t elementSize);
+			size_t elementSize, size_t num);
+	void Flush(size_t num);
 
 	void MakeBufferList(gs_vertex_shader *shader,
 			vector<ID3D11Buffer*> &buffers,
@@ -33,7 +33,7 @@ static inline void PushBuffer(vector<ID3D11Buffer*> &buffers,
 }
 
 void gs_vertex_buffer::FlushBuffer(ID3D11Buffer *buffer, void *array,
-		size_t elementSize)
+		size_t elementSize, size_t num)
 {
 	D3D11_MAPPED_SUBRESOURCE msr;
 	HRESULT hr;
@@ -42,10 +42,33 @@ void gs_vertex_buffer::FlushBuffer(ID3D11Buffer *buffer, void *array,
 					D3D11_MAP_WRITE_DISCARD, 0, &msr)))
 		throw HRError("Failed to map buffer", hr);
 
-	memcpy(msr.pData, array, elementSize * vbd.data->num);
+	memcpy(msr.pData, array, elementSize * num);
 	device->context->Unmap(buffer, 0);
 }
 
+void gs_vertex_buffer::Flush(size_t num)
+{
+	FlushBuffer(vertexBuffer, vbd.data->points, sizeof(vec3), num);
+
+	if (normalBuffer)
+		FlushBuffer(normalBuffer, vbd.data->normals, sizeof(vec3),
+				num);
+
+	if (tangentBuffer)
+		FlushBuffer(tangentBuffer, vbd.data->tangents, sizeof(vec3),
+				num);
+
+	if (colorBuffer)
+		FlushBuffer(colorBuffer, vbd.data->colors, sizeof(uint32_t),
+				num);
+
+	for (size_t i = 0; i < uvBuffers.size(); i++) {
+		gs_tvertarray &tv = vbd.data->tvarray[i];
+		FlushBuffer(uvBuffers[i], tv.array, tv.width*sizeof(float),
+				num);
+	}
+}
+
 void gs_vertex_buffer::MakeBufferList(gs_vertex_shader *shader,
 		vector<ID3D11Buffer*> &buffers, vector<uint32_t> &strides)
 {
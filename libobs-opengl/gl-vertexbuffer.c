@@ -120,7 +120,7 @@ void gs_vertexbuffer_destroy(gs_vertbuffer_t *vb)
 	}
 }
 
-void gs_vertexbuffer_flush(gs_vertbuffer_t *vb)
+static void vertexbuffer_flush_internal(gs_vertbuffer_t *vb, size_t num)
 {
 	size_t i;
 
@@ -131,34 +131,34 @@ void gs_vertexbuffer_flush(gs_vertbuffer_t *vb)
 
 	if (!update_buffer(GL_ARRAY_BUFFER, vb->vertex_buffer,
 				vb->data->points,
-				vb->data->num * sizeof(struct vec3)))
+				num * sizeof(struct vec3)))
 		goto failed;
 
 	if (vb->normal_buffer) {
 		if (!update_buffer(GL_ARRAY_BUFFER, vb->normal_buffer,
 					vb->data->normals,
-					vb->data->num * sizeof(struct vec3)))
+					num * sizeof(struct vec3)))
 			goto failed;
 	}
 
 	if (vb->tangent_buffer) {
 		if (!update_buffer(GL_ARRAY_BUFFER, vb->tangent_buffer,
 					vb->data->tangents,
-					vb->data->num * sizeof(struct vec3)))
+					num * sizeof(struct vec3)))
 			goto failed;
 	}
 
 	if (vb->color_buffer) {
 		if (!update_buffer(GL_ARRAY_BUFFER, vb->color_buffer,
 					vb->data->colors,
-					vb->data->num * sizeof(uint32_t)))
+					num * sizeof(uint32_t)))
 			goto failed;
 	}
 
 	for (i = 0; i < vb->data->num_tex; i++) {
 		GLuint buffer = vb->uv_buffers.array[i];
 		struct gs_tvertarray *tv = vb->data->tvarray+i;
-		size_t size = vb->data->num * tv->width * sizeof(float);
+		size_t size = num * tv->width * sizeof(float);
 
 		if (!update_buffer(GL_ARRAY_BUFFER, buffer, tv->array, size))
 			goto failed;
@@ -170,6 +170,21 @@ failed:
 	blog(LOG_ERROR, "gs_vertexbuffer_flush (GL) failed");
 }
 
+void gs_vertexbuffer_flush(gs_vertbuffer_t *vb)
+{
+	vertexbuffer_flush_internal(vb, vb->data ? vb->data->num : 0);
+}
+
+void gs_vertexbuffer_flush_partial(gs_vertbuffer_t *vb, size_t num)
+{
+	if (!num)
+		return;
+	if (vb->data && num > vb->data->num)
+		num = vb->data->num;
+
+	vertexbuffer_flush_internal(vb, num);
+}
+
 struct gs_vb_data *gs_vertexbuffer_get_data(const gs_vertbuffer_t *vb)
 {
 	return vb->data;
@@ -0,0 +1,73 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "../../obs-internal.h"
+#include "../../util/darray.h"
+
+#include "pulseaudio-wrapper.h"
+
+struct sink_entry {
+	char *name;
+	char *id;
+};
+
+struct sink_list {
+	DARRAY(struct sink_entry) sinks;
+};
+
+/* sinks are collected first so the callback isn't run on the pulse
+ * mainloop thread */
+static void pulseaudio_output_info(pa_context *c, const pa_sink_info *i,
+		int eol, void *userdata)
+{
+	struct sink_list *list = userdata;
+	UNUSED_PARAMETER(c);
+
+	if (eol == 0) {
+		struct sink_entry entry = {
+			.name = bstrdup(i->description ? i->description :
+					i->name),
+			.id   = bstrdup(i->name)
+		};
+		da_push_back(list->sinks, &entry);
+	}
+
+	pulseaudio_signal(0);
+}
+
+void obs_enum_audio_monitoring_devices(obs_enum_audio_device_cb cb,
+		void *data)
+{
+	struct sink_list list = {0};
+	bool cont = true;
+
+	pulseaudio_init();
+	pulseaudio_get_sink_info_list(pulseaudio_output_info, &list);
+	pulseaudio_unref();
+
+	for (size_t i = 0; i < list.sinks.num; i++) {
+		struct sink_entry *entry = list.sinks.array + i;
+
+		if (cont)
+			cont = cb(data, entry->name, entry->id);
+
+		bfree(entry->name);
+		bfree(entry->id);
+	}
+
+	da_free(list.sinks);
+}
@@ -0,0 +1,523 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "../../media-io/audio-resampler.h"
+#include "../../util/circlebuf.h"
+#include "../../util/platform.h"
+#include "../../obs-internal.h"
+
+#include "pulseaudio-wrapper.h"
+
+/* server side buffering requested from pulse.  kept small since it adds
+ * directly to the monitoring latency. */
+#define TARGET_LATENCY_US  20000
+#define MIN_REQUEST_US      5000
+
+/* drop queued audio beyond this, e.g. after the sink was suspended */
+#define MAX_BUFFERED_US   250000
+
+/* audio ticks to average the latency over before locking onto it */
+#define DRIFT_CALIBRATE_TICKS 100
+
+struct audio_monitor {
+	obs_source_t       *source;
+	pa_stream          *stream;
+	char               *device;
+
+	pa_sample_spec     spec;
+	size_t             bytes_per_frame;
+	audio_resampler_t  *resampler;
+
+	/* audio not yet taken by the server, guarded by the mainloop lock */
+	struct circlebuf   new_data;
+
+	/* clock drift compensation, audio thread only */
+	double             avg_latency_us;
+	double             target_latency_us;
+	uint32_t           drift_ticks;
+	int                compensation;
+
+	volatile long      latency_us;
+	bool               pulse_initialized;
+	bool               ignore;
+};
+
+static void get_channel_map(pa_channel_map *map, enum speaker_layout speakers)
+{
+	pa_channel_map_init(map);
+	map->channels = (uint8_t)get_audio_channels(speakers);
+
+	/* same channel order as the ffmpeg layouts obs uses */
+	map->map[0] = PA_CHANNEL_POSITION_FRONT_LEFT;
+	map->map[1] = PA_CHANNEL_POSITION_FRONT_RIGHT;
+	map->map[2] = PA_CHANNEL_POSITION_FRONT_CENTER;
+	map->map[3] = PA_CHANNEL_POSITION_LFE;
+	map->map[4] = PA_CHANNEL_POSITION_REAR_LEFT;
+	map->map[5] = PA_CHANNEL_POSITION_REAR_RIGHT;
+	map->map[6] = PA_CHANNEL_POSITION_SIDE_LEFT;
+	map->map[7] = PA_CHANNEL_POSITION_SIDE_RIGHT;
+
+	switch (speakers) {
+	case SPEAKERS_MONO:
+		map->map[0] = PA_CHANNEL_POSITION_MONO;
+		break;
+	case SPEAKERS_2POINT1:
+		map->map[2] = PA_CHANNEL_POSITION_LFE;
+		break;
+	case SPEAKERS_QUAD:
+		map->map[2] = PA_CHANNEL_POSITION_REAR_LEFT;
+		map->map[3] = PA_CHANNEL_POSITION_REAR_RIGHT;
+		break;
+	case SPEAKERS_SURROUND:
+		map->map[3] = PA_CHANNEL_POSITION_REAR_CENTER;
+		break;
+	case SPEAKERS_4POINT1:
+		map->map[4] = PA_CHANNEL_POSITION_REAR_CENTER;
+		break;
+	case SPEAKERS_5POINT1:
+		map->map[4] = PA_CHANNEL_POSITION_SIDE_LEFT;
+		map->map[5] = PA_CHANNEL_POSITION_SIDE_RIGHT;
+		break;
+	case SPEAKERS_7POINT1_SURROUND:
+		map->map[6] = PA_CHANNEL_POSITION_FRONT_LEFT_OF_CENTER;
+		map->map[7] = PA_CHANNEL_POSITION_FRONT_RIGHT_OF_CENTER;
+		break;
+	case SPEAKERS_STEREO:
+	case SPEAKERS_5POINT1_SURROUND:
+	case SPEAKERS_7POINT1:
+	case SPEAKERS_UNKNOWN:
+		break;
+	}
+}
+
+static inline uint64_t bytes_to_usec(struct audio_monitor *monitor,
+		size_t bytes)
+{
+	return pa_bytes_to_usec((uint64_t)bytes, &monitor->spec);
+}
+
+/* feeds the server as much as it will take.  called with the mainloop
+ * lock held, either from the write callback or from the audio thread. */
+static void do_stream_write(struct audio_monitor *monitor)
+{
+	size_t bytes = pa_stream_writable_size(monitor->stream);
+	pa_usec_t server_latency;
+	int negative;
+
+	if (bytes == (size_t)-1)
+		return;
+
+	if (bytes > monitor->new_data.size)
+		bytes = monitor->new_data.size;
+	bytes -= bytes % monitor->bytes_per_frame;
+
+	while (bytes > 0) {
+		void *buffer = NULL;
+		size_t size = bytes;
+
+		if (pa_stream_begin_write(monitor->stream, &buffer, &size) < 0)
+			break;
+
+		if (size > bytes)
+			size = bytes;
+		size -= size % monitor->bytes_per_frame;
+		if (!size) {
+			pa_stream_cancel_write(monitor->stream);
+			break;
+		}
+
+		circlebuf_pop_front(&monitor->new_data, buffer, size);
+		pa_stream_write(monitor->stream, buffer, size, NULL, 0LL,
+				PA_SEEK_RELATIVE);
+		bytes -= size;
+	}
+
+	if (pa_stream_get_latency(monitor->stream, &server_latency,
+				&negative) == 0) {
+		uint64_t latency = negative ? 0 : server_latency;
+		latency += bytes_to_usec(monitor, monitor->new_data.size);
+		os_atomic_set_long(&monitor->latency_us, (long)latency);
+	}
+}
+
+static void pulseaudio_stream_write(pa_stream *p, size_t nbytes, void *data)
+{
+	UNUSED_PARAMETER(p);
+	UNUSED_PARAMETER(nbytes);
+
+	do_stream_write(data);
+}
+
+static void pulseaudio_stream_state(pa_stream *p, void *data)
+{
+	struct audio_monitor *monitor = data;
+	const pa_buffer_attr *attr;
+
+	switch (pa_stream_get_state(p)) {
+	case PA_STREAM_READY:
+		attr = pa_stream_get_buffer_attr(p);
+		if (attr)
+			blog(LOG_INFO, "audio monitoring: '%s' playing to '%s', "
+					"tlength %"PRIu64" ms, "
+					"minreq %"PRIu64" ms",
+					obs_source_get_name(monitor->source),
+					pa_stream_get_device_name(p),
+					bytes_to_usec(monitor,
+						attr->tlength) / 1000,
+					bytes_to_usec(monitor,
+						attr->minreq) / 1000);
+		break;
+
+	case PA_STREAM_FAILED:
+		blog(LOG_WARNING, "audio monitoring: Stream for '%s' failed: "
+				"%s",
+				obs_source_get_name(monitor->source),
+				pa_strerror(pa_context_errno(
+						pa_stream_get_context(p))));
+		break;
+
+	default:
+		break;
+	}
+}
+
+/* keeps the total latency where it settled after startup by slightly
+ * resampling, so the sink's clock drifting from the obs audio clock doesn't
+ * slowly grow the latency or starve the stream */
+static void compensate_drift(struct audio_monitor *monitor)
+{
+	long latency_us = os_atomic_load_long(&monitor->latency_us);
+	uint32_t rate = monitor->spec.rate;
+	int max_delta = (int)(rate / 200);
+	double err_frames;
+	int delta;
+
+	if (!latency_us)
+		return;
+
+	if (monitor->drift_ticks == 0)
+		monitor->avg_latency_us = (double)latency_us;
+	else
+		monitor->avg_latency_us = monitor->avg_latency_us * 0.95 +
+			(double)latency_us * 0.05;
+
+	if (++monitor->drift_ticks < DRIFT_CALIBRATE_TICKS)
+		return;
+	if (monitor->drift_ticks == DRIFT_CALIBRATE_TICKS) {
+		monitor->target_latency_us = monitor->avg_latency_us;
+		return;
+	}
+
+	/* correct a quarter of the error over the next second */
+	err_frames = (monitor->avg_latency_us - monitor->target_latency_us) *
+		(double)rate / 1000000.0;
+	delta = -(int)(err_frames / 4.0);
+
+	if (delta > max_delta)
+		delta = max_delta;
+	else if (delta < -max_delta)
+		delta = -max_delta;
+
+	if (delta != monitor->compensation &&
+	    audio_resampler_set_compensation(monitor->resampler, delta,
+		    (int)rate))
+		monitor->compensation = delta;
+}
+
+static void on_audio_playback(void *param, obs_source_t *source,
+		const struct audio_data *audio_data, bool muted)
+{
+	struct audio_monitor *monitor = param;
+	float vol = source->user_volume;
+	uint8_t *resample_data[MAX_AV_PLANES];
+	uint32_t resample_frames;
+	uint64_t ts_offset;
+	size_t max_size;
+	size_t bytes;
+	bool success;
+
+	success = audio_resampler_resample(monitor->resampler, resample_data,
+			&resample_frames, &ts_offset,
+			(const uint8_t *const *)audio_data->data,
+			(uint32_t)audio_data->frames);
+	if (!success)
+		return;
+
+	bytes = monitor->bytes_per_frame * resample_frames;
+
+	if (muted) {
+		memset(resample_data[0], 0, bytes);
+	} else {
+		/* apply volume */
+		if (!close_float(vol, 1.0f, EPSILON)) {
+			register float *cur = (float*)resample_data[0];
+			register float *end = cur +
+				resample_frames * monitor->spec.channels;
+
+			while (cur < end)
+				*(cur++) *= vol;
+		}
+	}
+
+	max_size = pa_usec_to_bytes(MAX_BUFFERED_US, &monitor->spec);
+
+	pulseaudio_lock();
+	circlebuf_push_back(&monitor->new_data, resample_data[0], bytes);
+
+	if (monitor->new_data.size > max_size)
+		circlebuf_pop_front(&monitor->new_data, NULL,
+				monitor->new_data.size - max_size);
+
+	do_stream_write(monitor);
+	pulseaudio_unlock();
+
+	compensate_drift(monitor);
+}
+
+static void get_default_sink(pa_context *c, const pa_server_info *i,
+		void *userdata)
+{
+	char **name = userdata;
+	UNUSED_PARAMETER(c);
+
+	if (i && i->default_sink_name)
+		*name = bstrdup(i->default_sink_name);
+	pulseaudio_signal(0);
+}
+
+static void get_sink_monitor(pa_context *c, const pa_sink_info *i, int eol,
+		void *userdata)
+{
+	char **name = userdata;
+	UNUSED_PARAMETER(c);
+
+	if (eol == 0 && i->monitor_source_name && !*name)
+		*name = bstrdup(i->monitor_source_name);
+	pulseaudio_signal(0);
+}
+
+/* a pulse capture of our own sink's monitor would feed back into itself */
+static bool is_self_monitor(const char *source_id, const char *sink_id)
+{
+	char *sink = NULL;
+	char *monitor = NULL;
+	bool match;
+
+	if (!source_id || !*source_id)
+		return false;
+
+	if (strcmp(sink_id, "default") == 0)
+		pulseaudio_get_server_info(get_default_sink, &sink);
+	else
+		sink = bstrdup(sink_id);
+
+	if (sink)
+		pulseaudio_get_sink_info(get_sink_monitor, sink, &monitor);
+
+	match = monitor && strcmp(monitor, source_id) == 0;
+	bfree(monitor);
+	bfree(sink);
+	return match;
+}
+
+static bool audio_monitor_init(struct audio_monitor *monitor,
+		obs_source_t *source)
+{
+	const struct audio_output_info *info = audio_output_get_info(
+			obs->audio.audio);
+	const char *id = obs->audio.monitoring_device_id;
+	pa_channel_map map;
+	pa_buffer_attr attr;
+	pa_stream_flags_t flags;
+	int ret;
+
+	monitor->source = source;
+
+	if (!id || !*id)
+		return false;
+
+	pulseaudio_init();
+	monitor->pulse_initialized = true;
+
+	if (source->info.output_flags & OBS_SOURCE_DO_NOT_SELF_MONITOR) {
+		obs_data_t *s = obs_source_get_settings(source);
+		const char *s_dev_id = obs_data_get_string(s, "device_id");
+		bool match = is_self_monitor(s_dev_id, id);
+		obs_data_release(s);
+
+		if (match) {
+			monitor->ignore = true;
+			return true;
+		}
+	}
+
+	monitor->spec.format   = PA_SAMPLE_FLOAT32LE;
+	monitor->spec.rate     = info->samples_per_sec;
+	monitor->spec.channels = (uint8_t)get_audio_channels(info->speakers);
+	monitor->bytes_per_frame = pa_frame_size(&monitor->spec);
+
+	if (!pa_sample_spec_valid(&monitor->spec)) {
+		blog(LOG_WARNING, "%s: %s", __FUNCTION__,
+				"Invalid sample spec");
+		return false;
+	}
+
+	struct resample_info from = {
+		.samples_per_sec = info->samples_per_sec,
+		.speakers = info->speakers,
+		.format = AUDIO_FORMAT_FLOAT_PLANAR
+	};
+	struct resample_info to = {
+		.samples_per_sec = info->samples_per_sec,
+		.speakers = info->speakers,
+		.format = AUDIO_FORMAT_FLOAT
+	};
+
+	monitor->resampler = audio_resampler_create(&to, &from);
+	if (!monitor->resampler) {
+		blog(LOG_WARNING, "%s: %s", __FUNCTION__,
+				"Failed to create resampler");
+		return false;
+	}
+
+	get_channel_map(&map, info->speakers);
+
+	monitor->stream = pulseaudio_stream_new(obs_source_get_name(source),
+			&monitor->spec, &map);
+	if (!monitor->stream) {
+		blog(LOG_WARNING, "%s: %s", __FUNCTION__,
+				"Failed to create stream");
+		return false;
+	}
+
+	if (strcmp(id, "default") != 0)
+		monitor->device = bstrdup(id);
+
+	attr.maxlength = (uint32_t)-1;
+	attr.tlength   = (uint32_t)pa_usec_to_bytes(TARGET_LATENCY_US,
+			&monitor->spec);
+	attr.prebuf    = (uint32_t)-1;
+	attr.minreq    = (uint32_t)pa_usec_to_bytes(MIN_REQUEST_US,
+			&monitor->spec);
+	attr.fragsize  = (uint32_t)-1;
+
+	flags = PA_STREAM_ADJUST_LATENCY | PA_STREAM_INTERPOLATE_TIMING |
+		PA_STREAM_AUTO_TIMING_UPDATE;
+
+	pulseaudio_lock();
+	pa_stream_set_state_callback(monitor->stream, pulseaudio_stream_state,
+			monitor);
+	pa_stream_set_write_callback(monitor->stream, pulseaudio_stream_write,
+			monitor);
+	ret = pa_stream_connect_playback(monitor->stream, monitor->device,
+			&attr, flags, NULL, NULL);
+	pulseaudio_unlock();
+
+	if (ret < 0) {
+		blog(LOG_WARNING, "%s: %s", __FUNCTION__,
+				"Failed to connect stream");
+		return false;
+	}
+
+	return true;
+}
+
+static void audio_monitor_free(struct audio_monitor *monitor)
+{
+	if (monitor->source)
+		obs_source_remove_audio_capture_callback(
+				monitor->source, on_audio_playback, monitor);
+
+	if (monitor->stream) {
+		pulseaudio_lock();
+		pa_stream_set_state_callback(monitor->stream, NULL, NULL);
+		pa_stream_set_write_callback(monitor->stream, NULL, NULL);
+		pa_stream_disconnect(monitor->stream);
+		pa_stream_unref(monitor->stream);
+		pulseaudio_unlock();
+	}
+
+	if (monitor->pulse_initialized)
+		pulseaudio_unref();
+
+	audio_resampler_destroy(monitor->resampler);
+	circlebuf_free(&monitor->new_data);
+	bfree(monitor->device);
+}
+
+static void audio_monitor_init_final(struct audio_monitor *monitor)
+{
+	if (monitor->ignore)
+		return;
+
+	obs_source_add_audio_capture_callback(monitor->source,
+			on_audio_playback, monitor);
+}
+
+struct audio_monitor *audio_monitor_create(obs_source_t *source)
+{
+	struct audio_monitor *monitor = bzalloc(sizeof(*monitor));
+
+	if (!audio_monitor_init(monitor, source)) {
+		goto fail;
+	}
+
+	pthread_mutex_lock(&obs->audio.monitoring_mutex);
+	da_push_back(obs->audio.monitors, &monitor);
+	pthread_mutex_unlock(&obs->audio.monitoring_mutex);
+
+	audio_monitor_init_final(monitor);
+	return monitor;
+
+fail:
+	audio_monitor_free(monitor);
+	bfree(monitor);
+	return NULL;
+}
+
+void audio_monitor_reset(struct audio_monitor *monitor)
+{
+	bool success;
+
+	obs_source_t *source = monitor->source;
+	audio_monitor_free(monitor);
+	memset(monitor, 0, sizeof(*monitor));
+
+	success = audio_monitor_init(monitor, source);
+	if (success)
+		audio_monitor_init_final(monitor);
+}
+
+void audio_monitor_destroy(struct audio_monitor *monitor)
+{
+	if (monitor) {
+		audio_monitor_free(monitor);
+
+		pthread_mutex_lock(&obs->audio.monitoring_mutex);
+		da_erase_item(obs->audio.monitors, &monitor);
+		pthread_mutex_unlock(&obs->audio.monitoring_mutex);
+
+		bfree(monitor);
+	}
+}
+
+uint64_t audio_monitor_get_latency(const struct audio_monitor *monitor)
+{
+	long latency_us = os_atomic_load_long(
+			(volatile long*)&monitor->latency_us);
+	return (uint64_t)latency_us * 1000ULL;
+}
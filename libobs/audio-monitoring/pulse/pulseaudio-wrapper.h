@@ -0,0 +1,52 @@
+/*
+Copyright (C) 2014 by Leonhard Oelke <leonhard@in-verted.de>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <inttypes.h>
+#include <pulse/stream.h>
+#include <pulse/context.h>
+#include <pulse/introspect.h>
+
+#pragma once
+
+/*
+ * A copy of the threaded mainloop wrapper used by the linux-pulseaudio
+ * plugin, with a different prefix so the two don't collide when the plugin
+ * is loaded.  libobs only uses it for audio monitoring.
+ */
+
+int_fast32_t pulseaudio_init();
+void pulseaudio_unref();
+
+/* mainloop lock, required for any pa_stream/pa_context call made from
+ * outside of mainloop callbacks.  don't use with the blocking functions
+ * below. */
+void pulseaudio_lock();
+void pulseaudio_unlock();
+void pulseaudio_wait();
+void pulseaudio_signal(int wait_for_accept);
+
+/* these block until the server context is ready and the callback has been
+ * called for every entry.  call without the lock. */
+int_fast32_t pulseaudio_get_sink_info_list(pa_sink_info_cb_t cb,
+		void *userdata);
+int_fast32_t pulseaudio_get_sink_info(pa_sink_info_cb_t cb, const char *name,
+		void *userdata);
+int_fast32_t pulseaudio_get_server_info(pa_server_info_cb_t cb,
+		void *userdata);
+
+pa_stream *pulseaudio_stream_new(const char *name, const pa_sample_spec *ss,
+		const pa_channel_map *map);
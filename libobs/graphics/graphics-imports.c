@@ -141,6 +141,7 @@ bool load_graphics_imports(struct gs_exports *exports, void *module,
 
 	GRAPHICS_IMPORT(gs_vertexbuffer_destroy);
 	GRAPHICS_IMPORT(gs_vertexbuffer_flush);
+	GRAPHICS_IMPORT(gs_vertexbuffer_flush_partial);
 	GRAPHICS_IMPORT(gs_vertexbuffer_get_data);
 
 	GRAPHICS_IMPORT(gs_indexbuffer_destroy);
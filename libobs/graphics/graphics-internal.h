@@ -189,6 +189,8 @@ struct gs_exports {
 
 	void (*gs_vertexbuffer_destroy)(gs_vertbuffer_t *vertbuffer);
 	void (*gs_vertexbuffer_flush)(gs_vertbuffer_t *vertbuffer);
+	void (*gs_vertexbuffer_flush_partial)(gs_vertbuffer_t *vertbuffer,
+			size_t num);
 	struct gs_vb_data *(*gs_vertexbuffer_get_data)(
 			const gs_vertbuffer_t *vertbuffer);
 
@@ -282,6 +284,7 @@ struct graphics_subsystem {
 	struct gs_effect       *cur_effect;
 
 	gs_vertbuffer_t        *sprite_buffer;
+	gs_vertbuffer_t        *sprite_batch_buffer;
 
 	bool                   using_immediate;
 	struct gs_vb_data      *vbd;
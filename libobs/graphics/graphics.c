@@ -144,6 +144,30 @@ static bool graphics_init_sprite_vb(struct graphics_subsystem *graphics)
 	return true;
 }
 
+#define SPRITE_BATCH_COUNT 256
+#define SPRITE_BATCH_VERTS (SPRITE_BATCH_COUNT * 6)
+
+static bool graphics_init_sprite_batch_vb(struct graphics_subsystem *graphics)
+{
+	struct gs_vb_data *vbd;
+
+	vbd = gs_vbdata_create();
+	vbd->num     = SPRITE_BATCH_VERTS;
+	vbd->points  = bzalloc(sizeof(struct vec3) * SPRITE_BATCH_VERTS);
+	vbd->num_tex = 1;
+	vbd->tvarray = bmalloc(sizeof(struct gs_tvertarray));
+	vbd->tvarray[0].width = 2;
+	vbd->tvarray[0].array =
+		bzalloc(sizeof(struct vec2) * SPRITE_BATCH_VERTS);
+
+	graphics->sprite_batch_buffer = graphics->exports.
+		device_vertexbuffer_create(graphics->device, vbd, GS_DYNAMIC);
+	if (!graphics->sprite_batch_buffer)
+		return false;
+
+	return true;
+}
+
 static bool graphics_init(struct graphics_subsystem *graphics)
 {
 	struct matrix4 top_mat;
@@ -157,6 +181,8 @@ static bool graphics_init(struct graphics_subsystem *graphics)
 		return false;
 	if (!graphics_init_sprite_vb(graphics))
 		return false;
+	if (!graphics_init_sprite_batch_vb(graphics))
+		return false;
 	if (pthread_mutex_init(&graphics->mutex, NULL) != 0)
 		return false;
 	if (pthread_mutex_init(&graphics->effect_mutex, NULL) != 0)
@@ -236,6 +262,8 @@ void gs_destroy(graphics_t *graphics)
 
 		graphics->exports.gs_vertexbuffer_destroy(
 				graphics->sprite_buffer);
+		graphics->exports.gs_vertexbuffer_destroy(
+				graphics->sprite_batch_buffer);
 		graphics->exports.gs_vertexbuffer_destroy(
 				graphics->immediate_vertbuffer);
 		graphics->exports.device_destroy(graphics->device);
@@ -1068,6 +1096,91 @@ void gs_draw_sprite_subregion(gs_texture_t *tex, uint32_t flip,
 	gs_draw(GS_TRISTRIP, 0, 0);
 }
 
+static void build_batch_sprite(struct vec3 *points, struct vec2 *uvs,
+		const struct gs_sprite *sprite)
+{
+	/* the two triangles gs_draw_sprite draws as a strip */
+	static const size_t order[6] = {0, 1, 2, 2, 1, 3};
+
+	gs_texture_t *tex = sprite->tex;
+	float fcx = (float)gs_texture_get_width(tex);
+	float fcy = (float)gs_texture_get_height(tex);
+	bool flip_u = (sprite->flip & GS_FLIP_U) != 0;
+	bool flip_v = (sprite->flip & GS_FLIP_V) != 0;
+	float start_u, end_u;
+	float start_v, end_v;
+	struct vec3 corners[4];
+	struct vec2 corner_uvs[4];
+
+	if (gs_texture_is_rect(tex)) {
+		assign_sprite_rect(&start_u, &end_u, fcx, flip_u);
+		assign_sprite_rect(&start_v, &end_v, fcy, flip_v);
+	} else {
+		assign_sprite_uv(&start_u, &end_u, flip_u);
+		assign_sprite_uv(&start_v, &end_v, flip_v);
+	}
+
+	vec3_zero(&corners[0]);
+	vec3_set(&corners[1],  fcx, 0.0f, 0.0f);
+	vec3_set(&corners[2], 0.0f,  fcy, 0.0f);
+	vec3_set(&corners[3],  fcx,  fcy, 0.0f);
+	vec2_set(&corner_uvs[0], start_u, start_v);
+	vec2_set(&corner_uvs[1], end_u,   start_v);
+	vec2_set(&corner_uvs[2], start_u, end_v);
+	vec2_set(&corner_uvs[3], end_u,   end_v);
+
+	for (size_t i = 0; i < 4; i++)
+		vec3_transform(&corners[i], &corners[i], sprite->transform);
+
+	for (size_t i = 0; i < 6; i++) {
+		points[i] = corners[order[i]];
+		uvs[i]    = corner_uvs[order[i]];
+	}
+}
+
+void gs_draw_sprites(gs_eparam_t *image, const struct gs_sprite *sprites,
+		size_t num)
+{
+	graphics_t *graphics = thread_graphics;
+
+	if (!gs_valid_p("gs_draw_sprites", sprites))
+		return;
+
+	while (num) {
+		size_t count = num < SPRITE_BATCH_COUNT
+			? num : SPRITE_BATCH_COUNT;
+		struct gs_vb_data *data;
+		struct vec2 *uvs;
+		size_t start = 0;
+
+		data = gs_vertexbuffer_get_data(graphics->sprite_batch_buffer);
+		uvs = data->tvarray[0].array;
+
+		for (size_t i = 0; i < count; i++)
+			build_batch_sprite(data->points + i * 6, uvs + i * 6,
+					&sprites[i]);
+
+		gs_vertexbuffer_flush_partial(graphics->sprite_batch_buffer,
+				count * 6);
+		gs_load_vertexbuffer(graphics->sprite_batch_buffer);
+		gs_load_indexbuffer(NULL);
+
+		/* only the texture changes between the draws */
+		for (size_t i = 1; i <= count; i++) {
+			if (i < count && sprites[i].tex == sprites[start].tex)
+				continue;
+
+			gs_effect_set_texture(image, sprites[start].tex);
+			gs_draw(GS_TRIS, (uint32_t)(start * 6),
+					(uint32_t)((i - start) * 6));
+			start = i;
+		}
+
+		sprites += count;
+		num -= count;
+	}
+}
+
 void gs_draw_cube_backdrop(gs_texture_t *cubetex, const struct quat *rot,
 		float left, float right, float top, float bottom, float znear)
 {
@@ -1250,6 +1363,21 @@ void gs_reset_blend_state(void)
 				GS_BLEND_ONE, GS_BLEND_ONE);
 }
 
+/* returns true if the blend state is what gs_reset_blend_state sets */
+bool gs_blend_state_is_reset(void)
+{
+	graphics_t *graphics = thread_graphics;
+
+	if (!gs_valid("gs_blend_state_is_reset"))
+		return false;
+
+	return graphics->cur_blend_state.enabled &&
+	       graphics->cur_blend_state.src_c  == GS_BLEND_SRCALPHA &&
+	       graphics->cur_blend_state.dest_c == GS_BLEND_INVSRCALPHA &&
+	       graphics->cur_blend_state.src_a  == GS_BLEND_ONE &&
+	       graphics->cur_blend_state.dest_a == GS_BLEND_ONE;
+}
+
 /* ------------------------------------------------------------------------- */
 
 const char *gs_preprocessor_name(void)
@@ -2430,6 +2558,15 @@ void gs_vertexbuffer_flush(gs_vertbuffer_t *vertbuffer)
 	thread_graphics->exports.gs_vertexbuffer_flush(vertbuffer);
 }
 
+void gs_vertexbuffer_flush_partial(gs_vertbuffer_t *vertbuffer, size_t num)
+{
+	if (!gs_valid_p("gs_vertexbuffer_flush_partial", vertbuffer))
+		return;
+
+	thread_graphics->exports.gs_vertexbuffer_flush_partial(vertbuffer,
+			num);
+}
+
 struct gs_vb_data *gs_vertexbuffer_get_data(const gs_vertbuffer_t *vertbuffer)
 {
 	if (!gs_valid_p("gs_vertexbuffer_get_data", vertbuffer))
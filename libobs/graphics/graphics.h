@@ -528,6 +528,27 @@ EXPORT void gs_draw_sprite(gs_texture_t *tex, uint32_t flip, uint32_t width,
 EXPORT void gs_draw_sprite_subregion(gs_texture_t *tex, uint32_t flip,
 		uint32_t x, uint32_t y, uint32_t cx, uint32_t cy);
 
+struct gs_sprite {
+	gs_texture_t         *tex;
+	const struct matrix4 *transform;
+	uint32_t             flip;
+};
+
+/**
+ * Draws 2D sprites at the size of their textures, each with its own
+ * transform, using as few draw calls as possible
+ *
+ *   The vertices of all sprites are transformed on the CPU and uploaded in a
+ * single vertex buffer, and consecutive sprites with the same texture are
+ * drawn with one call.  Textures are not packed into an atlas, so every
+ * change of texture still costs a draw call; what is saved is the vertex
+ * buffer update and the state changes between the draws.  The effect pass
+ * must be active already; image is the texture parameter of its effect.
+ * Textures must be 2D.
+ */
+EXPORT void gs_draw_sprites(gs_eparam_t *image, const struct gs_sprite *sprites,
+		size_t num);
+
 EXPORT void gs_draw_cube_backdrop(gs_texture_t *cubetex, const struct quat *rot,
 		float left, float right, float top, float bottom, float znear);
 
@@ -552,6 +573,7 @@ EXPORT void gs_perspective(float fovy, float aspect, float znear, float zfar);
 EXPORT void gs_blend_state_push(void);
 EXPORT void gs_blend_state_pop(void);
 EXPORT void gs_reset_blend_state(void);
+EXPORT bool gs_blend_state_is_reset(void);
 
 /* -------------------------- */
 /* library-specific functions */
@@ -716,6 +738,9 @@ EXPORT void     gs_samplerstate_destroy(gs_samplerstate_t *samplerstate);
 
 EXPORT void     gs_vertexbuffer_destroy(gs_vertbuffer_t *vertbuffer);
 EXPORT void     gs_vertexbuffer_flush(gs_vertbuffer_t *vertbuffer);
+/** Uploads only the first num vertices of a dynamic vertex buffer */
+EXPORT void     gs_vertexbuffer_flush_partial(gs_vertbuffer_t *vertbuffer,
+		size_t num);
 EXPORT struct gs_vb_data *gs_vertexbuffer_get_data(
 		const gs_vertbuffer_t *vertbuffer);
 
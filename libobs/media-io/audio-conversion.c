@@ -0,0 +1,313 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include <string.h>
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#include "audio-conversion.h"
+
+/* swresample's default level for mixing mono to stereo and back (-3 dB) */
+#define MIX_LEVEL 0.70710678118654752f
+
+/* swresample maps each integer format to [-1.0, 1.0] by the same scales */
+static inline float get_format_scale(enum audio_format format)
+{
+	switch (format) {
+	case AUDIO_FORMAT_U8BIT:
+	case AUDIO_FORMAT_U8BIT_PLANAR:
+		return 1.0f / 128.0f;
+
+	case AUDIO_FORMAT_16BIT:
+	case AUDIO_FORMAT_16BIT_PLANAR:
+		return 1.0f / 32768.0f;
+
+	case AUDIO_FORMAT_32BIT:
+	case AUDIO_FORMAT_32BIT_PLANAR:
+		return 1.0f / 2147483648.0f;
+
+	case AUDIO_FORMAT_FLOAT:
+	case AUDIO_FORMAT_FLOAT_PLANAR:
+	case AUDIO_FORMAT_UNKNOWN:
+		break;
+	}
+
+	return 1.0f;
+}
+
+/* ------------------------------------------------------------------------- */
+/* unscaled sample loads, four at a time or one at a time */
+
+static inline __m128 load4_u8(const uint8_t *in)
+{
+	__m128i zero = _mm_setzero_si128();
+	__m128i val;
+	uint32_t packed;
+
+	memcpy(&packed, in, sizeof(packed));
+	val = _mm_cvtsi32_si128((int)packed);
+	val = _mm_unpacklo_epi16(_mm_unpacklo_epi8(val, zero), zero);
+	return _mm_cvtepi32_ps(_mm_sub_epi32(val, _mm_set1_epi32(128)));
+}
+
+static inline __m128 load4_s16(const int16_t *in)
+{
+	__m128i val = _mm_loadl_epi64((const __m128i*)in);
+	val = _mm_srai_epi32(_mm_unpacklo_epi16(val, val), 16);
+	return _mm_cvtepi32_ps(val);
+}
+
+static inline __m128 load4_s32(const int32_t *in)
+{
+	return _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)in));
+}
+
+static inline __m128 load4_flt(const float *in)
+{
+	return _mm_loadu_ps(in);
+}
+
+static inline float load1_u8(const uint8_t *in)
+{
+	return (float)((int)*in - 128);
+}
+
+static inline float load1_s16(const int16_t *in)
+{
+	return (float)*in;
+}
+
+static inline float load1_s32(const int32_t *in)
+{
+	return (float)*in;
+}
+
+static inline float load1_flt(const float *in)
+{
+	return *in;
+}
+
+/* ------------------------------------------------------------------------- */
+/* converters for each input sample type.  'mul' is the format scale times
+ * the mix level, so every sample is only multiplied once. */
+
+#define DEFINE_CONVERTERS(name, type)                                         \
+/* one contiguous channel: a plane, or mono interleaved audio */              \
+static void name##_plane(float *out, const type *in, uint32_t frames,         \
+		float mul)                                                    \
+{                                                                             \
+	__m128 m = _mm_set1_ps(mul);                                          \
+	uint32_t i = 0;                                                       \
+                                                                              \
+	for (; i + 4 <= frames; i += 4)                                       \
+		_mm_storeu_ps(out + i, _mm_mul_ps(load4_##name(in + i), m));  \
+	for (; i < frames; i++)                                               \
+		out[i] = load1_##name(in + i) * mul;                          \
+}                                                                             \
+                                                                              \
+static void name##_plane_sum(float *out, const type *in1, const type *in2,    \
+		uint32_t frames, float mul)                                   \
+{                                                                             \
+	__m128 m = _mm_set1_ps(mul);                                          \
+	uint32_t i = 0;                                                       \
+                                                                              \
+	for (; i + 4 <= frames; i += 4) {                                     \
+		__m128 sum = _mm_add_ps(load4_##name(in1 + i),                \
+				load4_##name(in2 + i));                       \
+		_mm_storeu_ps(out + i, _mm_mul_ps(sum, m));                   \
+	}                                                                     \
+	for (; i < frames; i++)                                               \
+		out[i] = (load1_##name(in1 + i) + load1_##name(in2 + i)) * mul; \
+}                                                                             \
+                                                                              \
+static void name##_deinterleave_stereo(float *left, float *right,             \
+		const type *in, uint32_t frames, float mul)                   \
+{                                                                             \
+	__m128 m = _mm_set1_ps(mul);                                          \
+	uint32_t i = 0;                                                       \
+                                                                              \
+	for (; i + 4 <= frames; i += 4) {                                     \
+		__m128 lo = load4_##name(in + i * 2);                         \
+		__m128 hi = load4_##name(in + i * 2 + 4);                     \
+		__m128 l  = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));  \
+		__m128 r  = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));  \
+		_mm_storeu_ps(left  + i, _mm_mul_ps(l, m));                   \
+		_mm_storeu_ps(right + i, _mm_mul_ps(r, m));                   \
+	}                                                                     \
+	for (; i < frames; i++) {                                             \
+		left[i]  = load1_##name(in + i * 2)     * mul;                \
+		right[i] = load1_##name(in + i * 2 + 1) * mul;                \
+	}                                                                     \
+}                                                                             \
+                                                                              \
+static void name##_sum_stereo(float *out, const type *in, uint32_t frames,    \
+		float mul)                                                    \
+{                                                                             \
+	__m128 m = _mm_set1_ps(mul);                                          \
+	uint32_t i = 0;                                                       \
+                                                                              \
+	for (; i + 4 <= frames; i += 4) {                                     \
+		__m128 lo = load4_##name(in + i * 2);                         \
+		__m128 hi = load4_##name(in + i * 2 + 4);                     \
+		__m128 sum = _mm_add_ps(                                      \
+				_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)), \
+				_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1))); \
+		_mm_storeu_ps(out + i, _mm_mul_ps(sum, m));                   \
+	}                                                                     \
+	for (; i < frames; i++)                                               \
+		out[i] = (load1_##name(in + i * 2) +                          \
+		          load1_##name(in + i * 2 + 1)) * mul;                \
+}                                                                             \
+                                                                              \
+/* interleaved audio with more than two channels */                           \
+static void name##_deinterleave(float *out[], const type *in,                 \
+		size_t channels, uint32_t frames, float mul)                  \
+{                                                                             \
+	for (uint32_t i = 0; i < frames; i++) {                               \
+		for (size_t c = 0; c < channels; c++)                         \
+			out[c][i] = load1_##name(in++) * mul;                 \
+	}                                                                     \
+}                                                                             \
+                                                                              \
+static void name##_convert(const struct resample_info *dst,                   \
+		const struct resample_info *src,                              \
+		float *output[], const uint8_t *const input[],                \
+		uint32_t frames, float mul)                                   \
+{                                                                             \
+	size_t channels = get_audio_channels(src->speakers);                  \
+	bool planar = is_audio_planar(src->format);                           \
+	const type *in = (const type*)input[0];                               \
+                                                                              \
+	if (src->speakers == SPEAKERS_STEREO &&                               \
+	    dst->speakers == SPEAKERS_MONO) {                                 \
+		if (planar)                                                   \
+			name##_plane_sum(output[0], in,                       \
+					(const type*)input[1], frames,        \
+					mul * MIX_LEVEL);                     \
+		else                                                          \
+			name##_sum_stereo(output[0], in, frames,              \
+					mul * MIX_LEVEL);                     \
+                                                                              \
+	} else if (src->speakers == SPEAKERS_MONO &&                          \
+	           dst->speakers == SPEAKERS_STEREO) {                        \
+		name##_plane(output[0], in, frames, mul * MIX_LEVEL);         \
+		memcpy(output[1], output[0], frames * sizeof(float));         \
+                                                                              \
+	} else if (planar || channels == 1) {                                 \
+		for (size_t c = 0; c < channels; c++)                         \
+			name##_plane(output[c], (const type*)input[c],        \
+					frames, mul);                         \
+                                                                              \
+	} else if (channels == 2) {                                           \
+		name##_deinterleave_stereo(output[0], output[1], in, frames,  \
+				mul);                                         \
+                                                                              \
+	} else {                                                              \
+		name##_deinterleave(output, in, channels, frames, mul);       \
+	}                                                                     \
+}
+
+DEFINE_CONVERTERS(u8,  uint8_t)
+DEFINE_CONVERTERS(s16, int16_t)
+DEFINE_CONVERTERS(s32, int32_t)
+DEFINE_CONVERTERS(flt, float)
+
+/* ------------------------------------------------------------------------- */
+
+bool audio_convert_supported(const struct resample_info *dst,
+		const struct resample_info *src)
+{
+	if (dst->samples_per_sec != src->samples_per_sec)
+		return false;
+	if (dst->format != AUDIO_FORMAT_FLOAT_PLANAR)
+		return false;
+	if (src->format == AUDIO_FORMAT_UNKNOWN)
+		return false;
+	if (src->speakers == SPEAKERS_UNKNOWN ||
+	    dst->speakers == SPEAKERS_UNKNOWN)
+		return false;
+
+	return src->speakers == dst->speakers ||
+	       (src->speakers == SPEAKERS_MONO &&
+	        dst->speakers == SPEAKERS_STEREO) ||
+	       (src->speakers == SPEAKERS_STEREO &&
+	        dst->speakers == SPEAKERS_MONO);
+}
+
+void audio_convert(const struct resample_info *dst,
+		const struct resample_info *src,
+		float *output[], const uint8_t *const input[], uint32_t frames)
+{
+	float scale = get_format_scale(src->format);
+
+	switch (src->format) {
+	case AUDIO_FORMAT_U8BIT:
+	case AUDIO_FORMAT_U8BIT_PLANAR:
+		u8_convert(dst, src, output, input, frames, scale);
+		break;
+
+	case AUDIO_FORMAT_16BIT:
+	case AUDIO_FORMAT_16BIT_PLANAR:
+		s16_convert(dst, src, output, input, frames, scale);
+		break;
+
+	case AUDIO_FORMAT_32BIT:
+	case AUDIO_FORMAT_32BIT_PLANAR:
+		s32_convert(dst, src, output, input, frames, scale);
+		break;
+
+	case AUDIO_FORMAT_FLOAT:
+	case AUDIO_FORMAT_FLOAT_PLANAR:
+		flt_convert(dst, src, output, input, frames, scale);
+		break;
+
+	case AUDIO_FORMAT_UNKNOWN:
+		break;
+	}
+}
+
+void audio_downmix_to_mono_planar(float *data[], size_t channels,
+		uint32_t frames)
+{
+	const float channels_i = 1.0f / (float)channels;
+	__m128 mul = _mm_set1_ps(channels_i);
+	uint32_t i = 0;
+
+	/* one pass per block of samples rather than one pass per channel */
+	for (; i + 4 <= frames; i += 4) {
+		__m128 sum = _mm_loadu_ps(data[0] + i);
+
+		for (size_t c = 1; c < channels; c++)
+			sum = _mm_add_ps(sum, _mm_loadu_ps(data[c] + i));
+
+		sum = _mm_mul_ps(sum, mul);
+
+		for (size_t c = 0; c < channels; c++)
+			_mm_storeu_ps(data[c] + i, sum);
+	}
+
+	for (; i < frames; i++) {
+		float sum = data[0][i];
+
+		for (size_t c = 1; c < channels; c++)
+			sum += data[c][i];
+
+		sum *= channels_i;
+
+		for (size_t c = 0; c < channels; c++)
+			data[c][i] = sum;
+	}
+}
@@ -0,0 +1,50 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include "../util/c99defs.h"
+#include "audio-resampler.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Direct conversion to float planar audio for the cases that don't need
+ * resampling: the sample rate must match, and the speaker layout must either
+ * match or be a mono/stereo up/downmix.  Mix levels are the same as the
+ * default swresample matrix, so switching between the two doesn't change
+ * the volume of a source.
+ */
+
+EXPORT bool audio_convert_supported(const struct resample_info *dst,
+		const struct resample_info *src);
+
+/* output must have a float plane of at least 'frames' samples for each
+ * channel of dst->speakers */
+EXPORT void audio_convert(const struct resample_info *dst,
+		const struct resample_info *src,
+		float *output[], const uint8_t *const input[], uint32_t frames);
+
+/* replaces every channel with the average of all channels */
+EXPORT void audio_downmix_to_mono_planar(float *data[], size_t channels,
+		uint32_t frames);
+
+#ifdef __cplusplus
+}
+#endif
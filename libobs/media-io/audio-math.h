@@ -19,6 +19,9 @@
 
 #include "../util/c99defs.h"
 #include <math.h>
+#include <string.h>
+#include <xmmintrin.h>
+#include <emmintrin.h>
 
 #ifdef _MSC_VER
 #include <float.h>
@@ -38,6 +41,144 @@ static inline float db_to_mul(const float db)
 	return isfinite((double)db) ? powf(10.0f, db / 20.0f) : 0.0f;
 }
 
+/* ------------------------------------------------------------------------- */
+/* Fast approximations for per-sample DSP.
+ *
+ * log2 uses a 5th order polynomial over the mantissa and exp2 a 4th order
+ * polynomial over the fractional part, which keeps mul_to_db_fast and
+ * db_to_mul_fast within 0.0001 dB of mul_to_db and db_to_mul for normal,
+ * positive input.  Zero maps to about -764 dB instead of -INFINITY, and
+ * db_to_mul_fast clamps its result to the normal float range. */
+
+#define AUDIO_MATH_DB_PER_LOG2  6.0205999132796239f /* 20 * log10(2) */
+#define AUDIO_MATH_LOG2_PER_DB  0.1660964047443681f /* log2(10) / 20 */
+
+#define AUDIO_MATH_LOG2_C5  0.0439290998f
+#define AUDIO_MATH_LOG2_C4 -0.189834428f
+#define AUDIO_MATH_LOG2_C3  0.411564148f
+#define AUDIO_MATH_LOG2_C2 -0.707254899f
+#define AUDIO_MATH_LOG2_C1  1.44159239f
+#define AUDIO_MATH_LOG2_C0  1.43725035e-05f
+
+#define AUDIO_MATH_EXP2_C4  0.0136839897f
+#define AUDIO_MATH_EXP2_C3  0.051717781f
+#define AUDIO_MATH_EXP2_C2  0.241621243f
+#define AUDIO_MATH_EXP2_C1  0.692969586f
+#define AUDIO_MATH_EXP2_C0  1.00000359f
+
+static inline float log2_fast(const float val)
+{
+	uint32_t bits;
+	float m, p;
+	int e;
+
+	memcpy(&bits, &val, sizeof(bits));
+	e = (int)((bits >> 23) & 0xFF) - 127;
+	bits = (bits & 0x007FFFFF) | 0x3F800000;
+	memcpy(&m, &bits, sizeof(m));
+	m -= 1.0f;
+
+	p = AUDIO_MATH_LOG2_C5;
+	p = p * m + AUDIO_MATH_LOG2_C4;
+	p = p * m + AUDIO_MATH_LOG2_C3;
+	p = p * m + AUDIO_MATH_LOG2_C2;
+	p = p * m + AUDIO_MATH_LOG2_C1;
+	p = p * m + AUDIO_MATH_LOG2_C0;
+	return (float)e + p;
+}
+
+static inline float exp2_fast(float val)
+{
+	uint32_t bits;
+	float scale, f, p;
+	int i;
+
+	val = val < -126.0f ? -126.0f : (val > 126.0f ? 126.0f : val);
+	i = (int)floorf(val);
+	f = val - (float)i;
+
+	bits = (uint32_t)(i + 127) << 23;
+	memcpy(&scale, &bits, sizeof(scale));
+
+	p = AUDIO_MATH_EXP2_C4;
+	p = p * f + AUDIO_MATH_EXP2_C3;
+	p = p * f + AUDIO_MATH_EXP2_C2;
+	p = p * f + AUDIO_MATH_EXP2_C1;
+	p = p * f + AUDIO_MATH_EXP2_C0;
+	return scale * p;
+}
+
+static inline float mul_to_db_fast(const float mul)
+{
+	return AUDIO_MATH_DB_PER_LOG2 * log2_fast(mul);
+}
+
+static inline float db_to_mul_fast(const float db)
+{
+	return exp2_fast(db * AUDIO_MATH_LOG2_PER_DB);
+}
+
+static inline __m128 log2_fast_ps(const __m128 val)
+{
+	const __m128i mant_mask = _mm_set1_epi32(0x007FFFFF);
+	const __m128i one_bits  = _mm_set1_epi32(0x3F800000);
+	__m128i bits = _mm_castps_si128(val);
+	__m128 e, m, p;
+
+	e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23),
+				_mm_set1_epi32(127)));
+	m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, mant_mask),
+				one_bits));
+	m = _mm_sub_ps(m, _mm_set1_ps(1.0f));
+
+	p = _mm_set1_ps(AUDIO_MATH_LOG2_C5);
+	p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(AUDIO_MATH_LOG2_C4));
+	p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(AUDIO_MATH_LOG2_C3));
+	p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(AUDIO_MATH_LOG2_C2));
+	p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(AUDIO_MATH_LOG2_C1));
+	p = _mm_add_ps(_mm_mul_ps(p, m), _mm_set1_ps(AUDIO_MATH_LOG2_C0));
+	return _mm_add_ps(e, p);
+}
+
+static inline __m128 exp2_fast_ps(__m128 val)
+{
+	__m128 fi, f, p, scale;
+	__m128i i;
+
+	val = _mm_max_ps(_mm_min_ps(val, _mm_set1_ps(126.0f)),
+			_mm_set1_ps(-126.0f));
+
+	/* floor: truncate, then step down where truncation rounded up */
+	i  = _mm_cvttps_epi32(val);
+	fi = _mm_cvtepi32_ps(i);
+	fi = _mm_sub_ps(fi, _mm_and_ps(_mm_cmpgt_ps(fi, val),
+				_mm_set1_ps(1.0f)));
+	i  = _mm_cvttps_epi32(fi);
+	f  = _mm_sub_ps(val, fi);
+
+	scale = _mm_castsi128_ps(_mm_slli_epi32(
+				_mm_add_epi32(i, _mm_set1_epi32(127)), 23));
+
+	p = _mm_set1_ps(AUDIO_MATH_EXP2_C4);
+	p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(AUDIO_MATH_EXP2_C3));
+	p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(AUDIO_MATH_EXP2_C2));
+	p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(AUDIO_MATH_EXP2_C1));
+	p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(AUDIO_MATH_EXP2_C0));
+	return _mm_mul_ps(scale, p);
+}
+
+static inline __m128 mul_to_db_fast_ps(const __m128 mul)
+{
+	return _mm_mul_ps(_mm_set1_ps(AUDIO_MATH_DB_PER_LOG2),
+			log2_fast_ps(mul));
+}
+
+static inline __m128 db_to_mul_fast_ps(const __m128 db)
+{
+	return exp2_fast_ps(_mm_mul_ps(db,
+				_mm_set1_ps(AUDIO_MATH_LOG2_PER_DB)));
+}
+
 #ifdef _MSC_VER
 #pragma warning(pop)
 #endif
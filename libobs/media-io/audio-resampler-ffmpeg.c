@@ -171,3 +171,19 @@ bool audio_resampler_resample(audio_resampler_t *rs,
 	*out_frames = (uint32_t)ret;
 	return true;
 }
+
+bool audio_resampler_set_compensation(audio_resampler_t *rs,
+		int sample_delta, int distance)
+{
+	int errcode;
+
+	if (!rs) return false;
+
+	errcode = swr_set_compensation(rs->context, sample_delta, distance);
+	if (errcode < 0) {
+		blog(LOG_WARNING, "swr_set_compensation failed: %d", errcode);
+		return false;
+	}
+
+	return true;
+}
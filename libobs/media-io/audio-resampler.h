@@ -41,6 +41,12 @@ EXPORT bool audio_resampler_resample(audio_resampler_t *resampler,
 		 uint8_t *output[], uint32_t *out_frames, uint64_t *ts_offset,
 		 const uint8_t *const input[], uint32_t in_frames);
 
+/* stretches or squeezes the output by sample_delta frames, spread over the
+ * next 'distance' output frames.  used to follow an output device whose
+ * clock drifts from the obs audio clock. */
+EXPORT bool audio_resampler_set_compensation(audio_resampler_t *resampler,
+		int sample_delta, int distance);
+
 #ifdef __cplusplus
 }
 #endif
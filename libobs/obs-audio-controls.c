@@ -16,6 +16,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include <math.h>
+#include <string.h>
+#include <xmmintrin.h>
+#include <emmintrin.h>
 
 #include "util/threading.h"
 #include "util/bmem.h"
@@ -59,6 +62,64 @@ struct meter_cb {
 	void                   *param;
 };
 
+/* 4x oversampling polyphase FIR from ITU-R BS.1770-4 annex 2, stored as
+ * one coefficient per phase for each tap so that all four phases of an
+ * output sample are computed with one SSE multiply-add per tap */
+#define TRUE_PEAK_TAPS 12
+
+static const float true_peak_coeffs[TRUE_PEAK_TAPS][4] = {
+	{ 0.0017089843750f, -0.0291748046875f, -0.0189208984375f,
+	 -0.0083007812500f},
+	{ 0.0109863281250f,  0.0292968750000f,  0.0330810546875f,
+	  0.0148925781250f},
+	{-0.0196533203125f, -0.0517578125000f, -0.0582275390625f,
+	 -0.0266113281250f},
+	{ 0.0332031250000f,  0.0891113281250f,  0.1015625000000f,
+	  0.0476074218750f},
+	{-0.0594482421875f, -0.1665039062500f, -0.2003173828125f,
+	 -0.1022949218750f},
+	{ 0.1373291015625f,  0.4650878906250f,  0.7797851562500f,
+	  0.9721679687500f},
+	{ 0.9721679687500f,  0.7797851562500f,  0.4650878906250f,
+	  0.1373291015625f},
+	{-0.1022949218750f, -0.2003173828125f, -0.1665039062500f,
+	 -0.0594482421875f},
+	{ 0.0476074218750f,  0.1015625000000f,  0.0891113281250f,
+	  0.0332031250000f},
+	{-0.0266113281250f, -0.0582275390625f, -0.0517578125000f,
+	 -0.0196533203125f},
+	{ 0.0148925781250f,  0.0330810546875f,  0.0292968750000f,
+	  0.0109863281250f},
+	{-0.0083007812500f, -0.0189208984375f, -0.0291748046875f,
+	  0.0017089843750f},
+};
+
+/* frames processed per true peak window copy */
+#define VOLMETER_CHUNK 256
+
+/* EBU R128: 100 ms gating blocks, 400 ms momentary, 3 s short-term */
+#define LOUDNESS_MOMENTARY_BLOCKS  4
+#define LOUDNESS_SHORT_TERM_BLOCKS 30
+
+#define KWEIGHT_PI 3.14159265358979323846
+
+/* K-weighting pre-filter (high shelf) followed by the RLB high pass */
+struct kweight_filter {
+	double b[2][3];
+	double a[2][3];
+};
+
+struct volmeter_channel {
+	float                  ival_sum;
+	float                  ival_peak;
+	float                  ival_true_peak;
+
+	float                  tp_history[TRUE_PEAK_TAPS - 1];
+	double                 kw_state[2][2];
+	double                 block_sum;
+	float                  weight;
+};
+
 struct obs_volmeter {
 	pthread_mutex_t        mutex;
 	obs_fader_conversion_t pos_to_db;
@@ -84,6 +145,21 @@ struct obs_volmeter {
 	float                  vol_peak;
 	float                  vol_mag;
 	float                  vol_max;
+
+	struct volmeter_channel ch[MAX_AV_PLANES];
+	struct kweight_filter  kweight;
+	unsigned int           block_frames;
+	unsigned int           block_size;
+	float                  blocks[LOUDNESS_SHORT_TERM_BLOCKS];
+	unsigned int           block_idx;
+	unsigned int           block_count;
+	float                  momentary;
+	float                  short_term;
+
+	/* latest published levels, read without locking through a sequence
+	 * counter that is odd while the audio thread writes */
+	volatile long          levels_seq;
+	struct obs_volmeter_levels levels;
 };
 
 static float cubic_def_to_db(const float def)
@@ -265,26 +341,142 @@ static void volmeter_source_destroyed(void *vptr, calldata_t *calldata)
 	obs_volmeter_detach_source(volmeter);
 }
 
-/* TODO: Separate for individual channels */
-static void volmeter_sum_and_max(float *data[MAX_AV_PLANES], size_t frames,
-		float *sum, float *max)
+static inline double kweight_biquad(double x, const double *b,
+		const double *a, double *z)
+{
+	double y = b[0] * x + z[0];
+	z[0] = b[1] * x - a[1] * y + z[1];
+	z[1] = b[2] * x - a[2] * y;
+	return y;
+}
+
+static void volmeter_process_channel(struct volmeter_channel *ch,
+		const struct kweight_filter *kw, const float *data,
+		size_t frames)
+{
+	const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+	float window[TRUE_PEAK_TAPS - 1 + VOLMETER_CHUNK];
+	__m128 sum4  = _mm_setzero_ps();
+	__m128 peak4 = _mm_setzero_ps();
+	__m128 tp4   = _mm_setzero_ps();
+	double block_sum = ch->block_sum;
+	float vals[4];
+
+	while (frames) {
+		size_t n = frames > VOLMETER_CHUNK ? VOLMETER_CHUNK : frames;
+		size_t i = 0;
+
+		memcpy(window, ch->tp_history, sizeof(ch->tp_history));
+		memcpy(window + TRUE_PEAK_TAPS - 1, data, n * sizeof(float));
+
+		for (; i + 4 <= n; i += 4) {
+			__m128 v = _mm_loadu_ps(data + i);
+			sum4  = _mm_add_ps(sum4, _mm_mul_ps(v, v));
+			peak4 = _mm_max_ps(peak4, _mm_and_ps(v, abs_mask));
+		}
+		for (; i < n; i++) {
+			__m128 v = _mm_load_ss(data + i);
+			sum4  = _mm_add_ss(sum4, _mm_mul_ss(v, v));
+			peak4 = _mm_max_ss(peak4, _mm_and_ps(v, abs_mask));
+		}
+
+		for (i = 0; i < n; i++) {
+			const float *x = window + i + TRUE_PEAK_TAPS - 1;
+			__m128 acc = _mm_setzero_ps();
+
+			for (int k = 0; k < TRUE_PEAK_TAPS; k++) {
+				__m128 c = _mm_loadu_ps(true_peak_coeffs[k]);
+				acc = _mm_add_ps(acc,
+						_mm_mul_ps(c, _mm_set1_ps(x[-k])));
+			}
+			tp4 = _mm_max_ps(tp4, _mm_and_ps(acc, abs_mask));
+
+			double y = kweight_biquad(data[i], kw->b[0], kw->a[0],
+					ch->kw_state[0]);
+			y = kweight_biquad(y, kw->b[1], kw->a[1],
+					ch->kw_state[1]);
+			block_sum += y * y;
+		}
+
+		memcpy(ch->tp_history, window + n, sizeof(ch->tp_history));
+		data   += n;
+		frames -= n;
+	}
+
+	_mm_storeu_ps(vals, sum4);
+	ch->ival_sum += vals[0] + vals[1] + vals[2] + vals[3];
+
+	_mm_storeu_ps(vals, peak4);
+	for (size_t i = 0; i < 4; i++)
+		ch->ival_peak = fmaxf(ch->ival_peak, vals[i]);
+
+	_mm_storeu_ps(vals, tp4);
+	for (size_t i = 0; i < 4; i++)
+		ch->ival_true_peak = fmaxf(ch->ival_true_peak, vals[i]);
+
+	ch->block_sum = block_sum;
+}
+
+static inline float loudness_from_blocks(const float *blocks,
+		unsigned int idx, unsigned int count)
+{
+	double sum = 0.0;
+
+	if (!count)
+		return -INFINITY;
+
+	for (unsigned int i = 0; i < count; i++) {
+		idx = idx ? idx - 1 : LOUDNESS_SHORT_TERM_BLOCKS - 1;
+		sum += blocks[idx];
+	}
+
+	sum /= (double)count;
+	return sum > 0.0 ? (float)(-0.691 + 10.0 * log10(sum)) : -INFINITY;
+}
+
+static void volmeter_finish_block(obs_volmeter_t *volmeter)
 {
-	float s  = *sum;
-	float m  = *max;
+	double sum = 0.0;
+	unsigned int count;
 
-	for (size_t plane = 0; plane < MAX_AV_PLANES; plane++) {
+	for (unsigned int c = 0; c < volmeter->channels; c++) {
+		struct volmeter_channel *ch = &volmeter->ch[c];
+		sum += ch->weight * ch->block_sum;
+		ch->block_sum = 0.0;
+	}
+
+	volmeter->blocks[volmeter->block_idx] =
+		(float)(sum / (double)volmeter->block_size);
+	volmeter->block_idx = (volmeter->block_idx + 1) %
+		LOUDNESS_SHORT_TERM_BLOCKS;
+	if (volmeter->block_count < LOUDNESS_SHORT_TERM_BLOCKS)
+		volmeter->block_count++;
+	volmeter->block_frames = 0;
+
+	count = volmeter->block_count < LOUDNESS_MOMENTARY_BLOCKS ?
+		volmeter->block_count : LOUDNESS_MOMENTARY_BLOCKS;
+	volmeter->momentary = loudness_from_blocks(volmeter->blocks,
+			volmeter->block_idx, count);
+	volmeter->short_term = loudness_from_blocks(volmeter->blocks,
+			volmeter->block_idx, volmeter->block_count);
+}
+
+/* processes a span of frames that does not cross an interval or loudness
+ * block boundary */
+static void volmeter_process_frames(obs_volmeter_t *volmeter,
+		float *data[MAX_AV_PLANES], size_t frames)
+{
+	for (size_t plane = 0; plane < volmeter->channels; plane++) {
 		if (!data[plane])
 			break;
 
-		for (float *c = data[plane]; c < data[plane] + frames; ++c) {
-			const float pow = *c * *c;
-			s += pow;
-			m  = (m > pow) ? m : pow;
-		}
+		volmeter_process_channel(&volmeter->ch[plane],
+				&volmeter->kweight, data[plane], frames);
 	}
 
-	*sum = s;
-	*max = m;
+	volmeter->block_frames += (unsigned int)frames;
+	if (volmeter->block_frames == volmeter->block_size)
+		volmeter_finish_block(volmeter);
 }
 
 /**
@@ -296,6 +488,16 @@ static void volmeter_calc_ival_levels(obs_volmeter_t *volmeter)
 {
 	const unsigned int samples = volmeter->ival_frames * volmeter->channels;
 	const float alpha    = 0.15f;
+
+	for (unsigned int c = 0; c < volmeter->channels; c++) {
+		struct volmeter_channel *ch = &volmeter->ch[c];
+		float ch_max = ch->ival_peak * ch->ival_peak;
+
+		volmeter->ival_sum += ch->ival_sum;
+		if (ch_max > volmeter->ival_max)
+			volmeter->ival_max = ch_max;
+	}
+
 	const float ival_max = sqrtf(volmeter->ival_max);
 	const float ival_rms = sqrtf(volmeter->ival_sum / (float)samples);
 
@@ -323,14 +525,75 @@ static void volmeter_calc_ival_levels(obs_volmeter_t *volmeter)
 	volmeter->ival_max    = 0.0f;
 }
 
+static inline float volmeter_db(float val, float mul)
+{
+	return mul_to_db(val * mul);
+}
+
+/* called with the volmeter mutex held, by the audio thread only */
+static void volmeter_publish_levels(obs_volmeter_t *volmeter, float mul,
+		float level, float mag, float peak, bool muted)
+{
+	struct obs_volmeter_levels *levels = &volmeter->levels;
+	const float mul_db = mul_to_db(mul);
+
+	os_atomic_inc_long(&volmeter->levels_seq);
+
+	levels->sequence++;
+	levels->channels  = volmeter->channels;
+	levels->muted     = muted;
+	levels->level     = level;
+	levels->magnitude = mag;
+	levels->peak      = peak;
+
+	for (unsigned int c = 0; c < MAX_AV_PLANES; c++) {
+		struct volmeter_channel *ch = &volmeter->ch[c];
+		float rms = 0.0f;
+
+		if (c < volmeter->channels && volmeter->update_frames)
+			rms = sqrtf(ch->ival_sum /
+					(float)volmeter->update_frames);
+
+		levels->sample_peak[c] = volmeter_db(ch->ival_peak, mul);
+		levels->true_peak[c]   = volmeter_db(
+				fmaxf(ch->ival_true_peak, ch->ival_peak), mul);
+		levels->rms[c]         = volmeter_db(rms, mul);
+
+		ch->ival_sum       = 0.0f;
+		ch->ival_peak      = 0.0f;
+		ch->ival_true_peak = 0.0f;
+	}
+
+	levels->momentary  = volmeter->momentary + mul_db;
+	levels->short_term = volmeter->short_term + mul_db;
+
+	os_atomic_inc_long(&volmeter->levels_seq);
+}
+
+static void volmeter_update_levels(obs_volmeter_t *volmeter, bool muted)
+{
+	float mul, level, mag, peak;
+
+	mul   = db_to_mul(volmeter->cur_db);
+
+	level = volmeter->db_to_pos(mul_to_db(volmeter->vol_max * mul));
+	mag   = volmeter->db_to_pos(mul_to_db(volmeter->vol_mag * mul));
+	peak  = volmeter->db_to_pos(mul_to_db(volmeter->vol_peak * mul));
+
+	volmeter_publish_levels(volmeter, mul, level, mag, peak, muted);
+}
+
 static bool volmeter_process_audio_data(obs_volmeter_t *volmeter,
-		const struct audio_data *data)
+		const struct audio_data *data, bool muted)
 {
 	bool updated   = false;
 	size_t frames  = 0;
 	size_t left    = data->frames;
 	float *adata[MAX_AV_PLANES];
 
+	if (!volmeter->update_frames || !volmeter->block_size)
+		return false;
+
 	for (size_t i = 0; i < MAX_AV_PLANES; i++)
 		adata[i] = (float*)data->data[i];
 
@@ -340,8 +603,10 @@ static bool volmeter_process_audio_data(obs_volmeter_t *volmeter,
 			? volmeter->update_frames - volmeter->ival_frames
 			: left;
 
-		volmeter_sum_and_max(adata, frames, &volmeter->ival_sum,
-				&volmeter->ival_max);
+		if (volmeter->block_frames + frames > volmeter->block_size)
+			frames = volmeter->block_size - volmeter->block_frames;
+
+		volmeter_process_frames(volmeter, adata, frames);
 
 		volmeter->ival_frames += (unsigned int)frames;
 		left                  -= frames;
@@ -352,11 +617,12 @@ static bool volmeter_process_audio_data(obs_volmeter_t *volmeter,
 			adata[i] += frames;
 		}
 
-		/* break if we did not reach the end of the interval */
+		/* continue if we did not reach the end of the interval */
 		if (volmeter->ival_frames != volmeter->update_frames)
-			break;
+			continue;
 
 		volmeter_calc_ival_levels(volmeter);
+		volmeter_update_levels(volmeter, muted);
 		updated = true;
 	}
 
@@ -368,19 +634,16 @@ static void volmeter_source_data_received(void *vptr, obs_source_t *source,
 {
 	struct obs_volmeter *volmeter = (struct obs_volmeter *) vptr;
 	bool updated = false;
-	float mul, level, mag, peak;
+	float level, mag, peak;
 
 	pthread_mutex_lock(&volmeter->mutex);
 
-	updated = volmeter_process_audio_data(volmeter, data);
+	updated = volmeter_process_audio_data(volmeter, data, muted);
 
 	if (updated) {
-		mul   = db_to_mul(volmeter->cur_db);
-
-		level = volmeter->db_to_pos(mul_to_db(volmeter->vol_max * mul));
-		mag   = volmeter->db_to_pos(mul_to_db(volmeter->vol_mag * mul));
-		peak  = volmeter->db_to_pos(
-				mul_to_db(volmeter->vol_peak * mul));
+		level = volmeter->levels.level;
+		mag   = volmeter->levels.magnitude;
+		peak  = volmeter->levels.peak;
 	}
 
 	pthread_mutex_unlock(&volmeter->mutex);
@@ -391,16 +654,86 @@ static void volmeter_source_data_received(void *vptr, obs_source_t *source,
 	UNUSED_PARAMETER(source);
 }
 
+static void kweight_init(struct kweight_filter *kw, double rate)
+{
+	double f0 = 1681.974450955533;
+	double g  = 3.999843853973347;
+	double q  = 0.7071752369554196;
+	double k  = tan(KWEIGHT_PI * f0 / rate);
+	double vh = pow(10.0, g / 20.0);
+	double vb = pow(vh, 0.4996667741545416);
+	double a0 = 1.0 + k / q + k * k;
+
+	kw->b[0][0] = (vh + vb * k / q + k * k) / a0;
+	kw->b[0][1] = 2.0 * (k * k - vh) / a0;
+	kw->b[0][2] = (vh - vb * k / q + k * k) / a0;
+	kw->a[0][0] = 1.0;
+	kw->a[0][1] = 2.0 * (k * k - 1.0) / a0;
+	kw->a[0][2] = (1.0 - k / q + k * k) / a0;
+
+	f0 = 38.13547087602444;
+	q  = 0.5003270373238773;
+	k  = tan(KWEIGHT_PI * f0 / rate);
+	a0 = 1.0 + k / q + k * k;
+
+	kw->b[1][0] = 1.0;
+	kw->b[1][1] = -2.0;
+	kw->b[1][2] = 1.0;
+	kw->a[1][0] = 1.0;
+	kw->a[1][1] = 2.0 * (k * k - 1.0) / a0;
+	kw->a[1][2] = (1.0 - k / q + k * k) / a0;
+}
+
+/* BS.1770 channel weights: LFE is excluded, surround channels get +1.5 dB */
+static float channel_weight(enum speaker_layout speakers, unsigned int c)
+{
+	switch (speakers) {
+	case SPEAKERS_2POINT1:
+		return c == 2 ? 0.0f : 1.0f;
+	case SPEAKERS_QUAD:
+		return c >= 2 ? 1.41f : 1.0f;
+	case SPEAKERS_4POINT1:
+	case SPEAKERS_5POINT1:
+	case SPEAKERS_5POINT1_SURROUND:
+	case SPEAKERS_7POINT1:
+		return c == 3 ? 0.0f : (c >= 4 ? 1.41f : 1.0f);
+	case SPEAKERS_7POINT1_SURROUND:
+		return c == 3 ? 0.0f : (c == 4 || c == 5 ? 1.41f : 1.0f);
+	default:
+		return 1.0f;
+	}
+}
+
 static void volmeter_update_audio_settings(obs_volmeter_t *volmeter)
 {
 	audio_t *audio            = obs_get_audio();
 	const unsigned int sr     = audio_output_get_sample_rate(audio);
 	uint32_t channels         = (uint32_t)audio_output_get_channels(audio);
+	enum speaker_layout speakers = audio_output_get_info(audio)->speakers;
+
+	if (channels > MAX_AV_PLANES)
+		channels = MAX_AV_PLANES;
 
 	pthread_mutex_lock(&volmeter->mutex);
 	volmeter->channels        = channels;
 	volmeter->update_frames   = volmeter->update_ms * sr / 1000;
 	volmeter->peakhold_frames = volmeter->peakhold_ms * sr / 1000;
+
+	/* restart interval and loudness measurement */
+	volmeter->ival_frames  = 0;
+	volmeter->ival_sum     = 0.0f;
+	volmeter->ival_max     = 0.0f;
+	volmeter->block_size   = sr / 10;
+	volmeter->block_frames = 0;
+	volmeter->block_idx    = 0;
+	volmeter->block_count  = 0;
+	volmeter->momentary    = -INFINITY;
+	volmeter->short_term   = -INFINITY;
+	kweight_init(&volmeter->kweight, (double)sr);
+
+	memset(volmeter->ch, 0, sizeof(volmeter->ch));
+	for (unsigned int c = 0; c < channels; c++)
+		volmeter->ch[c].weight = channel_weight(speakers, c);
 	pthread_mutex_unlock(&volmeter->mutex);
 }
 
@@ -805,6 +1138,26 @@ void obs_volmeter_remove_callback(obs_volmeter_t *volmeter,
 	pthread_mutex_unlock(&volmeter->callback_mutex);
 }
 
+bool obs_volmeter_get_levels(obs_volmeter_t *volmeter,
+		struct obs_volmeter_levels *levels)
+{
+	long seq;
+
+	if (!volmeter || !levels)
+		return false;
+
+	do {
+		seq = os_atomic_load_long(&volmeter->levels_seq);
+		if (seq & 1)
+			continue;
+
+		*levels = volmeter->levels;
+	} while (os_atomic_load_long(&volmeter->levels_seq) != seq ||
+	         (seq & 1));
+
+	return levels->sequence != 0;
+}
+
 float obs_volmeter_get_cur_db(enum obs_fader_type type, const float def)
 {
 	float db;
@@ -251,6 +251,44 @@ EXPORT void obs_volmeter_add_callback(obs_volmeter_t *volmeter,
 EXPORT void obs_volmeter_remove_callback(obs_volmeter_t *volmeter,
 		obs_volmeter_updated_t callback, void *param);
 
+/**
+ * @brief Levels of the last completed update interval
+ *
+ * Peak, true peak and RMS values are per channel in dBFS, loudness values
+ * are EBU R128 momentary (400 ms) and short-term (3 s) loudness in LUFS.
+ * All of these have the source volume applied.
+ */
+struct obs_volmeter_levels {
+	uint64_t sequence;
+	uint32_t channels;
+	bool     muted;
+
+	/* mapped positions, as passed to obs_volmeter_updated_t */
+	float    level;
+	float    magnitude;
+	float    peak;
+
+	float    sample_peak[MAX_AV_PLANES];
+	float    true_peak[MAX_AV_PLANES];
+	float    rms[MAX_AV_PLANES];
+
+	float    momentary;
+	float    short_term;
+};
+
+/**
+ * @brief Get the latest levels of the volume meter
+ * @param volmeter pointer to the volume meter object
+ * @param levels receives a consistent copy of the latest levels
+ * @return false if no levels have been computed yet
+ *
+ * This never blocks the audio thread and can be polled from a UI timer
+ * instead of registering a callback.  The sequence member changes with
+ * every update interval.
+ */
+EXPORT bool obs_volmeter_get_levels(obs_volmeter_t *volmeter,
+		struct obs_volmeter_levels *levels);
+
 EXPORT float obs_volmeter_get_cur_db(enum obs_fader_type type, const float def);
 
 #ifdef __cplusplus
@@ -247,6 +247,7 @@ static void add_audio_buffering(struct obs_core_audio *audio,
 	ticks = (int)((frames + AUDIO_OUTPUT_FRAMES - 1) / AUDIO_OUTPUT_FRAMES);
 
 	audio->total_buffering_ticks += ticks;
+	os_atomic_inc_long(&audio->buffering_events);
 
 	if (audio->total_buffering_ticks >= MAX_BUFFERING_TICKS) {
 		ticks -= audio->total_buffering_ticks - MAX_BUFFERING_TICKS;
@@ -0,0 +1,184 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "obs.h"
+#include "obs-internal.h"
+
+static inline bool canvas_size_valid(uint32_t width, uint32_t height)
+{
+	return width >= 2 && height >= 2 &&
+	       width <= 32 * 1024 && height <= 32 * 1024;
+}
+
+static void free_canvas_view(struct obs_view *view)
+{
+	for (size_t i = 0; i < MAX_CHANNELS; i++) {
+		struct obs_source *source = view->channels[i];
+		if (source) {
+			obs_source_deactivate(source, MAIN_VIEW);
+			obs_source_release(source);
+		}
+	}
+
+	memset(view->channels, 0, sizeof(view->channels));
+	pthread_mutex_destroy(&view->channels_mutex);
+}
+
+obs_canvas_t *obs_canvas_create(const struct obs_video_info *info,
+		uint32_t frame_divisor)
+{
+	struct obs_video_info main_ovi;
+	struct obs_video_info ovi;
+	struct obs_canvas *canvas;
+
+	if (!obs || !info || !obs_get_video_info(&main_ovi))
+		return NULL;
+
+	if (!canvas_size_valid(info->output_width, info->output_height) ||
+	    !canvas_size_valid(info->base_width,   info->base_height)) {
+		blog(LOG_ERROR, "obs_canvas_create: Invalid canvas size");
+		return NULL;
+	}
+
+	if (!frame_divisor)
+		frame_divisor = 1;
+
+	/* canvases run on the main frame clock, only their composition and
+	 * output format are their own */
+	ovi = *info;
+	ovi.graphics_module = main_ovi.graphics_module;
+	ovi.adapter         = main_ovi.adapter;
+	ovi.fps_num         = main_ovi.fps_num;
+	ovi.fps_den         = main_ovi.fps_den * frame_divisor;
+
+	/* align to multiple-of-two and SSE alignment sizes */
+	ovi.output_width  &= 0xFFFFFFFC;
+	ovi.output_height &= 0xFFFFFFFE;
+
+	canvas = bzalloc(sizeof(struct obs_canvas));
+	canvas->view          = &canvas->own_view;
+	canvas->frame_divisor = frame_divisor;
+
+	if (!obs_view_init(&canvas->own_view)) {
+		bfree(canvas);
+		return NULL;
+	}
+
+	if (obs_canvas_init_video(canvas, &ovi) != OBS_VIDEO_SUCCESS) {
+		obs_canvas_free_video(canvas);
+		free_canvas_view(&canvas->own_view);
+		bfree(canvas);
+		return NULL;
+	}
+
+	pthread_mutex_lock(&obs->data.canvases_mutex);
+	canvas->next_tick      = obs->video.total_ticks;
+	canvas->prev_next      = &obs->data.first_canvas;
+	canvas->next           = obs->data.first_canvas;
+	obs->data.first_canvas = canvas;
+	if (canvas->next)
+		canvas->next->prev_next = &canvas->next;
+	pthread_mutex_unlock(&obs->data.canvases_mutex);
+
+	blog(LOG_INFO, "canvas created:\n"
+	               "\tbase resolution:   %dx%d\n"
+	               "\toutput resolution: %dx%d\n"
+	               "\tfps:               %d/%d\n"
+	               "\tformat:            %s",
+	               ovi.base_width, ovi.base_height,
+	               ovi.output_width, ovi.output_height,
+	               ovi.fps_num, ovi.fps_den,
+	               get_video_format_name(ovi.output_format));
+
+	return canvas;
+}
+
+void obs_canvas_destroy(obs_canvas_t *canvas)
+{
+	if (!canvas)
+		return;
+
+	/* waits for the frame in flight, which may still use the canvas */
+	pthread_mutex_lock(&obs->data.canvases_mutex);
+	if (canvas->prev_next)
+		*canvas->prev_next = canvas->next;
+	if (canvas->next)
+		canvas->next->prev_next = canvas->prev_next;
+	pthread_mutex_unlock(&obs->data.canvases_mutex);
+
+	video_output_stop(canvas->video);
+	obs_canvas_free_video(canvas);
+	free_canvas_view(&canvas->own_view);
+	bfree(canvas);
+}
+
+video_t *obs_canvas_get_video(const obs_canvas_t *canvas)
+{
+	return canvas ? canvas->video : NULL;
+}
+
+bool obs_canvas_get_video_info(const obs_canvas_t *canvas,
+		struct obs_video_info *ovi)
+{
+	if (!canvas || !ovi)
+		return false;
+
+	*ovi = canvas->ovi;
+	return true;
+}
+
+uint32_t obs_canvas_get_frame_divisor(const obs_canvas_t *canvas)
+{
+	return canvas ? canvas->frame_divisor : 0;
+}
+
+obs_source_t *obs_canvas_get_source(obs_canvas_t *canvas, uint32_t channel)
+{
+	return canvas ? obs_view_get_source(&canvas->own_view, channel) : NULL;
+}
+
+void obs_canvas_set_source(obs_canvas_t *canvas, uint32_t channel,
+		obs_source_t *source)
+{
+	struct obs_view *view;
+	struct obs_source *prev_source;
+
+	assert(channel < MAX_CHANNELS);
+
+	if (!canvas) return;
+	if (channel >= MAX_CHANNELS) return;
+
+	view = &canvas->own_view;
+
+	pthread_mutex_lock(&view->channels_mutex);
+
+	obs_source_addref(source);
+
+	prev_source = view->channels[channel];
+	view->channels[channel] = source;
+
+	pthread_mutex_unlock(&view->channels_mutex);
+
+	/* like the main view, a canvas that is output activates its sources */
+	if (source)
+		obs_source_activate(source, MAIN_VIEW);
+
+	if (prev_source) {
+		obs_source_deactivate(prev_source, MAIN_VIEW);
+		obs_source_release(prev_source);
+	}
+}
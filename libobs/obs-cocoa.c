@@ -1325,3 +1325,23 @@ bool obs_hotkeys_platform_is_pressed(obs_hotkeys_platform_t *plat,
 
 	return false;
 }
+
+bool obs_hotkeys_platform_has_key_events(obs_hotkeys_platform_t *plat)
+{
+	UNUSED_PARAMETER(plat);
+	return false;
+}
+
+bool obs_hotkeys_platform_wait_key_event(obs_hotkeys_platform_t *plat,
+		obs_key_t *key, bool *pressed)
+{
+	UNUSED_PARAMETER(plat);
+	*key = OBS_KEY_NONE;
+	*pressed = false;
+	return false;
+}
+
+void obs_hotkeys_platform_wake_key_events(obs_hotkeys_platform_t *plat)
+{
+	UNUSED_PARAMETER(plat);
+}
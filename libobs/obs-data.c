@@ -951,6 +951,44 @@ void obs_data_apply(obs_data_t *target, obs_data_t *apply_data)
 	}
 }
 
+static void set_default_array(obs_data_t *data, const char *name,
+		obs_data_array_t *array);
+
+static inline void copy_default_item(struct obs_data *data,
+		struct obs_data_item *item)
+{
+	const char *name = get_item_name(item);
+	void *ptr = get_item_default_data(item);
+
+	if (!ptr)
+		return;
+
+	if (item->type == OBS_DATA_OBJECT)
+		copy_obj(data, name, *(obs_data_t**)ptr,
+				obs_data_set_default_obj);
+	else if (item->type == OBS_DATA_ARRAY)
+		copy_array(data, name, *(obs_data_array_t**)ptr,
+				set_default_array);
+	else
+		set_item_def(data, NULL, name, ptr, item->default_size,
+				item->type);
+}
+
+void obs_data_apply_defaults(obs_data_t *target, obs_data_t *defaults)
+{
+	struct obs_data_item *item;
+
+	if (!target || !defaults || target == defaults)
+		return;
+
+	item = defaults->first_item;
+
+	while (item) {
+		copy_default_item(target, item);
+		item = item->next;
+	}
+}
+
 void obs_data_erase(obs_data_t *data, const char *name)
 {
 	struct obs_data_item *item = get_item(data, name);
@@ -1123,6 +1161,12 @@ void obs_data_set_default_obj(obs_data_t *data, const char *name, obs_data_t *ob
 	obs_set_obj(data, NULL, name, obj, set_item_def);
 }
 
+static void set_default_array(obs_data_t *data, const char *name,
+		obs_data_array_t *array)
+{
+	obs_set_array(data, NULL, name, array, set_item_def);
+}
+
 void obs_data_set_autoselect_string(obs_data_t *data, const char *name,
 		const char *val)
 {
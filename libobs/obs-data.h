@@ -76,6 +76,9 @@ EXPORT bool obs_data_save_json_safe(obs_data_t *data, const char *file,
 
 EXPORT void obs_data_apply(obs_data_t *target, obs_data_t *apply_data);
 
+/** Sets the default values of defaults as the default values of target */
+EXPORT void obs_data_apply_defaults(obs_data_t *target, obs_data_t *defaults);
+
 EXPORT void obs_data_erase(obs_data_t *data, const char *name);
 EXPORT void obs_data_clear(obs_data_t *data);
 
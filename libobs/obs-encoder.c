@@ -25,23 +25,55 @@
 
 struct obs_encoder_info *find_encoder(const char *id)
 {
-	for (size_t i = 0; i < obs->encoder_types.num; i++) {
-		struct obs_encoder_info *info = obs->encoder_types.array+i;
+	size_t idx = type_index_find(&obs->encoder_index,
+			&obs->encoder_types.da, sizeof(struct obs_encoder_info),
+			id);
+	return (idx != DARRAY_INVALID) ? obs->encoder_types.array+idx : NULL;
+}
 
-		if (strcmp(info->id, id) == 0)
-			return info;
-	}
+/* the type arrays change when a deferred module is loaded, so other code
+ * works with a copy of the type info */
+static const struct obs_encoder_info *copy_encoder_info(const char *id,
+		struct obs_encoder_info *info)
+{
+	const struct obs_encoder_info *found;
 
-	return NULL;
+	pthread_mutex_lock(&obs->types_mutex);
+	found = find_encoder(id);
+	if (found)
+		*info = *found;
+	pthread_mutex_unlock(&obs->types_mutex);
+
+	return found ? info : NULL;
+}
+
+/* applies the cached defaults of a registered type to settings */
+static void apply_defaults(const struct obs_encoder_info *info, obs_data_t *settings)
+{
+	obs_data_t *defaults = NULL;
+	size_t idx;
+
+	pthread_mutex_lock(&obs->types_mutex);
+	idx = type_index_find(&obs->encoder_index, &obs->encoder_types.da,
+			sizeof(struct obs_encoder_info), info->id);
+	if (idx != DARRAY_INVALID)
+		defaults = type_index_get_defaults(&obs->encoder_index, idx,
+				info->get_defaults);
+	pthread_mutex_unlock(&obs->types_mutex);
+
+	obs_data_apply_defaults(settings, defaults);
+	obs_data_release(defaults);
 }
 
 const char *obs_encoder_get_display_name(const char *id)
 {
-	struct obs_encoder_info *ei = find_encoder(id);
+	struct obs_encoder_info info_data;
+	const struct obs_encoder_info *ei = copy_encoder_info(id, &info_data);
 	return ei ? ei->get_name(ei->type_data) : NULL;
 }
 
-static bool init_encoder(struct obs_encoder *encoder, const char *name,
+static bool init_encoder(struct obs_encoder *encoder,
+		const struct obs_encoder_info *ei, const char *name,
 		obs_data_t *settings, obs_data_t *hotkey_data)
 {
 	pthread_mutexattr_t attr;
@@ -64,8 +96,8 @@ static bool init_encoder(struct obs_encoder *encoder, const char *name,
 	if (pthread_mutex_init(&encoder->outputs_mutex, NULL) != 0)
 		return false;
 
-	if (encoder->info.get_defaults)
-		encoder->info.get_defaults(encoder->context.settings);
+	if (ei)
+		apply_defaults(ei, encoder->context.settings);
 
 	return true;
 }
@@ -75,9 +107,13 @@ static struct obs_encoder *create_encoder(const char *id,
 		obs_data_t *settings, size_t mixer_idx, obs_data_t *hotkey_data)
 {
 	struct obs_encoder *encoder;
-	struct obs_encoder_info *ei = find_encoder(id);
+	struct obs_encoder_info info_data;
+	const struct obs_encoder_info *ei;
 	bool success;
 
+	load_deferred_type(OBS_OBJ_TYPE_ENCODER, id);
+
+	ei = copy_encoder_info(id, &info_data);
 	if (ei && ei->type != type)
 		return NULL;
 
@@ -94,7 +130,7 @@ static struct obs_encoder *create_encoder(const char *id,
 		encoder->info = *ei;
 	}
 
-	success = init_encoder(encoder, name, settings, hotkey_data);
+	success = init_encoder(encoder, ei, name, settings, hotkey_data);
 	if (!success) {
 		blog(LOG_ERROR, "creating encoder '%s' (%s) failed", name, id);
 		obs_encoder_destroy(encoder);
@@ -284,20 +320,25 @@ void obs_encoder_set_name(obs_encoder_t *encoder, const char *name)
 static inline obs_data_t *get_defaults(const struct obs_encoder_info *info)
 {
 	obs_data_t *settings = obs_data_create();
-	if (info->get_defaults)
-		info->get_defaults(settings);
+	apply_defaults(info, settings);
 	return settings;
 }
 
 obs_data_t *obs_encoder_defaults(const char *id)
 {
-	const struct obs_encoder_info *info = find_encoder(id);
+	load_deferred_type(OBS_OBJ_TYPE_ENCODER, id);
+
+	struct obs_encoder_info info_data;
+	const struct obs_encoder_info *info = copy_encoder_info(id, &info_data);
 	return (info) ? get_defaults(info) : NULL;
 }
 
 obs_properties_t *obs_get_encoder_properties(const char *id)
 {
-	const struct obs_encoder_info *ei = find_encoder(id);
+	load_deferred_type(OBS_OBJ_TYPE_ENCODER, id);
+
+	struct obs_encoder_info info_data;
+	const struct obs_encoder_info *ei = copy_encoder_info(id, &info_data);
 	if (ei && ei->get_properties) {
 		obs_data_t       *defaults = get_defaults(ei);
 		obs_properties_t *properties;
@@ -542,7 +583,8 @@ const char *obs_encoder_get_codec(const obs_encoder_t *encoder)
 
 const char *obs_get_encoder_codec(const char *id)
 {
-	struct obs_encoder_info *info = find_encoder(id);
+	struct obs_encoder_info info_data;
+	const struct obs_encoder_info *info = copy_encoder_info(id, &info_data);
 	return info ? info->codec : NULL;
 }
 
@@ -554,7 +596,8 @@ enum obs_encoder_type obs_encoder_get_type(const obs_encoder_t *encoder)
 
 enum obs_encoder_type obs_get_encoder_type(const char *id)
 {
-	struct obs_encoder_info *info = find_encoder(id);
+	struct obs_encoder_info info_data;
+	const struct obs_encoder_info *info = copy_encoder_info(id, &info_data);
 	return info ? info->type : OBS_ENCODER_AUDIO;
 }
 
@@ -1193,6 +1236,8 @@ const char *obs_encoder_get_id(const obs_encoder_t *encoder)
 
 uint32_t obs_get_encoder_caps(const char *encoder_id)
 {
-	struct obs_encoder_info *info = find_encoder(encoder_id);
+	struct obs_encoder_info info_data;
+	const struct obs_encoder_info *info =
+		copy_encoder_info(encoder_id, &info_data);
 	return info ? info->caps : 0;
 }
@@ -589,6 +589,8 @@ static inline void create_binding(obs_hotkey_t *hotkey,
 	binding->key = combo;
 	binding->hotkey_id = hotkey->id;
 	binding->hotkey    = hotkey;
+
+	obs->hotkeys.key_index_dirty = true;
 }
 
 static inline void load_binding(obs_hotkey_t *hotkey, obs_data_t *data)
@@ -620,6 +622,7 @@ static inline void load_bindings(obs_hotkey_t *hotkey, obs_data_array_t *data)
 		obs_data_release(item);
 	}
 
+	os_atomic_inc_long(&obs->data.save_gen);
 	hotkey_signal("hotkey_bindings_changed", hotkey);
 }
 
@@ -639,6 +642,7 @@ void obs_hotkey_load_bindings(obs_hotkey_id id,
 		for (size_t i = 0; i < num; i++)
 			create_binding(hotkey, combinations[i]);
 
+		os_atomic_inc_long(&obs->data.save_gen);
 		hotkey_signal("hotkey_bindings_changed", hotkey);
 	}
 	unlock();
@@ -915,6 +919,7 @@ static inline void remove_bindings(obs_hotkey_id id)
 			release_pressed_binding(binding);
 
 		da_erase(obs->hotkeys.bindings, idx);
+		obs->hotkeys.key_index_dirty = true;
 	}
 }
 
@@ -1072,6 +1077,13 @@ void obs_hotkeys_free(void)
 	da_free(obs->hotkeys.hotkeys);
 	da_free(obs->hotkeys.hotkey_pairs);
 
+	if (obs->hotkeys.key_index) {
+		for (size_t i = 0; i < OBS_KEY_LAST_VALUE; i++)
+			da_free(obs->hotkeys.key_index[i].bindings);
+		bfree(obs->hotkeys.key_index);
+		obs->hotkeys.key_index = NULL;
+	}
+
 	for (size_t i = 0; i < OBS_KEY_LAST_VALUE; i++) {
 		if (obs->hotkeys.translations[i]) {
 			bfree(obs->hotkeys.translations[i]);
@@ -1268,7 +1280,7 @@ static inline bool query_hotkey(void *data,
 	return true;
 }
 
-static inline void query_hotkeys()
+static inline uint32_t query_modifiers(void)
 {
 	uint32_t modifiers = 0;
 	if (is_pressed(OBS_KEY_SHIFT))
@@ -1279,26 +1291,114 @@ static inline void query_hotkeys()
 		modifiers |= INTERACT_ALT_KEY;
 	if (is_pressed(OBS_KEY_META))
 		modifiers |= INTERACT_COMMAND_KEY;
+	return modifiers;
+}
 
+static inline void query_hotkeys()
+{
 	struct obs_query_hotkeys_helper param = {
-		modifiers,
+		query_modifiers(),
 		obs->hotkeys.thread_disable_press,
 		obs->hotkeys.strict_modifiers,
 	};
 	enum_bindings(query_hotkey, &param);
 }
 
+static inline bool is_modifier_key(obs_key_t key)
+{
+	return key == OBS_KEY_SHIFT || key == OBS_KEY_CONTROL ||
+	       key == OBS_KEY_ALT || key == OBS_KEY_META;
+}
+
+static void rebuild_key_index(void)
+{
+	struct obs_core_hotkeys *hotkeys = &obs->hotkeys;
+
+	if (!hotkeys->key_index)
+		hotkeys->key_index = bzalloc(sizeof(struct obs_hotkey_key_index)
+				* OBS_KEY_LAST_VALUE);
+
+	for (size_t i = 0; i < OBS_KEY_LAST_VALUE; i++)
+		da_resize(hotkeys->key_index[i].bindings, 0);
+
+	for (size_t i = 0; i < hotkeys->bindings.num; i++) {
+		obs_key_t key = hotkeys->bindings.array[i].key.key;
+		if (key > OBS_KEY_NONE && key < OBS_KEY_LAST_VALUE)
+			da_push_back(hotkeys->key_index[key].bindings, &i);
+	}
+
+	hotkeys->key_index_dirty = false;
+}
+
+/* only the bindings bound to the changed key are evaluated, unless a
+ * modifier changed, in which case any binding could be affected */
+static void process_key_event(obs_key_t key, bool pressed)
+{
+	struct obs_core_hotkeys *hotkeys = &obs->hotkeys;
+	struct obs_query_hotkeys_helper param = {
+		query_modifiers(),
+		hotkeys->thread_disable_press,
+		hotkeys->strict_modifiers,
+	};
+
+	if (is_modifier_key(key)) {
+		enum_bindings(query_hotkey, &param);
+		return;
+	}
+
+	if (hotkeys->key_index_dirty || !hotkeys->key_index)
+		rebuild_key_index();
+
+	struct obs_hotkey_key_index *index = &hotkeys->key_index[key];
+	for (size_t i = 0; i < index->bindings.num; i++) {
+		size_t idx = index->bindings.array[i];
+		bool key_pressed = pressed;
+
+		/* a hotkey callback may have added or removed bindings */
+		if (hotkeys->key_index_dirty || idx >= hotkeys->bindings.num)
+			break;
+
+		handle_binding(&hotkeys->bindings.array[idx], param.modifiers,
+				param.no_press, param.strict_modifiers,
+				&key_pressed);
+	}
+}
+
 #define NBSP "\xC2\xA0"
 
-void *obs_hotkey_thread(void *arg)
+/* returns false if key events stopped working before the thread was asked
+ * to stop, in which case the caller falls back to polling */
+static bool hotkey_event_loop(const char *hotkey_thread_name)
 {
-	UNUSED_PARAMETER(arg);
+	obs_hotkeys_platform_t *context = obs->hotkeys.platform_context;
 
-	const char *hotkey_thread_name =
-		profile_store_name(obs_get_profiler_name_store(),
-				"obs_hotkey_thread(%g"NBSP"ms)", 25.);
-	profile_register_root(hotkey_thread_name, (uint64_t)25000000);
+	while (os_event_try(obs->hotkeys.stop_event) == EAGAIN) {
+		obs_key_t key;
+		bool pressed;
+
+		if (!obs_hotkeys_platform_wait_key_event(context, &key,
+					&pressed))
+			return os_event_try(obs->hotkeys.stop_event) != EAGAIN;
+
+		if (key <= OBS_KEY_NONE || key >= OBS_KEY_LAST_VALUE)
+			continue;
+		if (!lock())
+			continue;
+
+		profile_start(hotkey_thread_name);
+		process_key_event(key, pressed);
+		profile_end(hotkey_thread_name);
+
+		unlock();
+
+		profile_reenable_thread();
+	}
 
+	return true;
+}
+
+static void hotkey_poll_loop(const char *hotkey_thread_name)
+{
 	while (os_event_timedwait(obs->hotkeys.stop_event, 25) == ETIMEDOUT) {
 		if (!lock())
 			continue;
@@ -1311,6 +1411,32 @@ void *obs_hotkey_thread(void *arg)
 
 		profile_reenable_thread();
 	}
+}
+
+void *obs_hotkey_thread(void *arg)
+{
+	UNUSED_PARAMETER(arg);
+
+	obs_hotkeys_platform_t *context = obs->hotkeys.platform_context;
+	const char *hotkey_thread_name;
+
+	if (obs_hotkeys_platform_has_key_events(context)) {
+		hotkey_thread_name = profile_store_name(
+				obs_get_profiler_name_store(),
+				"obs_hotkey_thread(events)");
+		profile_register_root(hotkey_thread_name, 0);
+
+		if (hotkey_event_loop(hotkey_thread_name))
+			return NULL;
+
+		blog(LOG_WARNING, "obs-hotkey: key events failed, "
+		                  "falling back to polling");
+	}
+
+	hotkey_thread_name = profile_store_name(obs_get_profiler_name_store(),
+			"obs_hotkey_thread(%g"NBSP"ms)", 25.);
+	profile_register_root(hotkey_thread_name, (uint64_t)25000000);
+	hotkey_poll_loop(hotkey_thread_name);
 	return NULL;
 }
 
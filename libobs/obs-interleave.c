@@ -0,0 +1,111 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "obs-interleave.h"
+
+#define PACKET_SIZE sizeof(struct encoder_packet)
+
+/* packets almost always arrive in order, so check the end first and only
+ * binary search the array when a packet arrives late.  packets with equal
+ * timestamps stay in the order they were received. */
+void interleave_insert_packet(struct darray *packets,
+		const struct encoder_packet *packet)
+{
+	struct encoder_packet *array = packets->array;
+	size_t num = packets->num;
+	size_t low = 0;
+	size_t high = num;
+
+	if (!num || packet->dts_usec >= array[num - 1].dts_usec) {
+		darray_push_back(PACKET_SIZE, packets, packet);
+		return;
+	}
+
+	while (low < high) {
+		size_t mid = low + (high - low) / 2;
+
+		if (packet->dts_usec < array[mid].dts_usec)
+			high = mid;
+		else
+			low = mid + 1;
+	}
+
+	darray_insert(PACKET_SIZE, packets, low, packet);
+}
+
+static inline size_t interleave_track(const struct encoder_packet *packet)
+{
+	return packet->type == OBS_ENCODER_VIDEO ? 0 : packet->track_idx + 1;
+}
+
+static size_t next_track_packet(const struct encoder_packet *array,
+		size_t num, size_t track, size_t idx)
+{
+	for (; idx < num; idx++) {
+		if (interleave_track(&array[idx]) == track)
+			break;
+	}
+
+	return idx;
+}
+
+/* a k-way merge of the tracks instead of re-inserting every packet */
+void interleave_merge_tracks(struct darray *packets)
+{
+	struct darray old_array = *packets;
+	const struct encoder_packet *old = old_array.array;
+	size_t cursors[MAX_INTERLEAVE_TRACKS];
+
+	darray_init(packets);
+	darray_reserve(PACKET_SIZE, packets, old_array.num);
+
+	for (size_t i = 0; i < MAX_INTERLEAVE_TRACKS; i++)
+		cursors[i] = next_track_packet(old, old_array.num, i, 0);
+
+	for (;;) {
+		size_t best = DARRAY_INVALID;
+
+		for (size_t i = 0; i < MAX_INTERLEAVE_TRACKS; i++) {
+			const struct encoder_packet *packet;
+			const struct encoder_packet *best_packet;
+
+			if (cursors[i] >= old_array.num)
+				continue;
+			if (best == DARRAY_INVALID) {
+				best = i;
+				continue;
+			}
+
+			/* ties go to the packet that was received first */
+			packet      = &old[cursors[i]];
+			best_packet = &old[cursors[best]];
+			if (packet->dts_usec < best_packet->dts_usec ||
+			    (packet->dts_usec == best_packet->dts_usec &&
+			     cursors[i] < cursors[best]))
+				best = i;
+		}
+
+		if (best == DARRAY_INVALID)
+			break;
+
+		darray_push_back(PACKET_SIZE, packets, &old[cursors[best]]);
+		cursors[best] = next_track_packet(old, old_array.num, best,
+				cursors[best] + 1);
+	}
+
+	darray_free(&old_array);
+}
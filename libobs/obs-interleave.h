@@ -0,0 +1,45 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include "util/darray.h"
+#include "obs.h"
+
+/*
+ * Ordering of the output interleave buffer, an array of encoder_packet
+ * sorted by dts_usec.  Kept apart from the output so it can be tested and
+ * benchmarked on its own.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MAX_INTERLEAVE_TRACKS (MAX_AUDIO_MIXES + 1)
+
+/* inserts a packet after every packet with the same or a lower dts_usec */
+extern void interleave_insert_packet(struct darray *packets,
+		const struct encoder_packet *packet);
+
+/* restores the order after the timestamps of some tracks were shifted,
+ * packets of each track must still be in order relative to each other */
+extern void interleave_merge_tracks(struct darray *packets);
+
+#ifdef __cplusplus
+}
+#endif
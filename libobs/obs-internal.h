@@ -89,12 +89,39 @@ struct obs_module {
 	const char *(*name)(void);
 	const char *(*description)(void);
 	const char *(*author)(void);
+	bool        (*deferrable)(void);
 
 	struct obs_module *next;
 };
 
 extern void free_module(struct obs_module *mod);
 
+/* hash index over the ids of a registered type array, which also caches the
+ * default settings of each type once they have been requested */
+struct type_index {
+	size_t                          *slots;
+	size_t                          size;
+	DARRAY(obs_data_t*)             defaults;
+};
+
+extern void type_index_add(struct type_index *index,
+		const struct darray *types, size_t type_size);
+extern void type_index_rebuild(struct type_index *index,
+		const struct darray *types, size_t type_size);
+extern size_t type_index_find(const struct type_index *index,
+		const struct darray *types, size_t type_size, const char *id);
+extern obs_data_t *type_index_get_defaults(struct type_index *index,
+		size_t idx, void (*get_defaults)(obs_data_t *settings));
+extern void type_index_clear_defaults(struct type_index *index);
+extern void type_index_free(struct type_index *index);
+
+/* types registered from the module manifest before their module is loaded */
+struct deferred_type;
+
+extern void load_deferred_type(enum obs_obj_type type, const char *id);
+extern void load_deferred_modules(void);
+extern void free_deferred_types(void);
+
 struct obs_module_path {
 	char *bin;
 	char *data;
@@ -157,6 +184,17 @@ void obs_hotkeys_platform_free(struct obs_core_hotkeys *hotkeys);
 bool obs_hotkeys_platform_is_pressed(obs_hotkeys_platform_t *context,
 		obs_key_t key);
 
+/* Event-driven key input.  Platforms that can deliver key press/release
+ * events return true from obs_hotkeys_platform_has_key_events, after which
+ * the hotkey thread blocks in obs_hotkeys_platform_wait_key_event instead
+ * of polling every binding.  wait_key_event returns false when woken by
+ * obs_hotkeys_platform_wake_key_events or on error; *key is set to
+ * OBS_KEY_NONE for events that do not map to a key. */
+bool obs_hotkeys_platform_has_key_events(obs_hotkeys_platform_t *context);
+bool obs_hotkeys_platform_wait_key_event(obs_hotkeys_platform_t *context,
+		obs_key_t *key, bool *pressed);
+void obs_hotkeys_platform_wake_key_events(obs_hotkeys_platform_t *context);
+
 const char *obs_get_hotkey_translation(obs_key_t key, const char *def);
 
 struct obs_context_data;
@@ -173,6 +211,11 @@ struct obs_hotkey_binding {
 	obs_hotkey_t                *hotkey;
 };
 
+/* indices into obs_core_hotkeys::bindings, grouped by binding key */
+struct obs_hotkey_key_index {
+	DARRAY(size_t)              bindings;
+};
+
 struct obs_hotkey_name_map;
 void obs_hotkey_name_map_free(void);
 
@@ -212,15 +255,19 @@ extern void obs_display_free(struct obs_display *display);
 
 
 /* ------------------------------------------------------------------------- */
-/* core */
-
-struct obs_vframe_info {
-	uint64_t timestamp;
-	int count;
-};
+/* canvases */
+
+/*
+ * A canvas composites its own view into its own set of textures and outputs
+ * the result through its own video_t.  The main canvas is embedded in
+ * obs_core_video, additional canvases share its graphics context, frame
+ * clock and sources.
+ */
+struct obs_canvas {
+	struct obs_view                 *view;
+	video_t                         *video;
+	struct obs_video_info           ovi;
 
-struct obs_core_video {
-	graphics_t                      *graphics;
 	gs_stagesurf_t                  *copy_surfaces[NUM_TEXTURES];
 	gs_texture_t                    *render_textures[NUM_TEXTURES];
 	gs_texture_t                    *output_textures[NUM_TEXTURES];
@@ -230,6 +277,51 @@ struct obs_core_video {
 	bool                            textures_copied[NUM_TEXTURES];
 	bool                            textures_converted[NUM_TEXTURES];
 	struct circlebuf                vframe_info_buffer;
+	gs_stagesurf_t                  *mapped_surface;
+	int                             cur_texture;
+
+	/* the canvas renders every frame_divisor-th frame of the main frame
+	 * clock, next_tick is the main frame tick its next frame is due at */
+	uint32_t                        frame_divisor;
+	uint64_t                        next_tick;
+	bool                            rendered;
+	struct video_data               frame;
+	bool                            frame_ready;
+
+	bool                            gpu_conversion;
+	const char                      *conversion_tech;
+	uint32_t                        conversion_height;
+	uint32_t                        plane_offsets[3];
+	uint32_t                        plane_sizes[3];
+	uint32_t                        plane_linewidth[3];
+
+	uint32_t                        output_width;
+	uint32_t                        output_height;
+	uint32_t                        base_width;
+	uint32_t                        base_height;
+	float                           color_matrix[16];
+	enum obs_scale_type             scale_type;
+
+	struct obs_view                 own_view;
+	struct obs_canvas               *next;
+	struct obs_canvas               **prev_next;
+};
+
+extern int obs_canvas_init_video(struct obs_canvas *canvas,
+		struct obs_video_info *ovi);
+extern void obs_canvas_free_video(struct obs_canvas *canvas);
+
+
+/* ------------------------------------------------------------------------- */
+/* core */
+
+struct obs_vframe_info {
+	uint64_t timestamp;
+	int count;
+};
+
+struct obs_core_video {
+	graphics_t                      *graphics;
 	gs_effect_t                     *default_effect;
 	gs_effect_t                     *default_rect_effect;
 	gs_effect_t                     *opaque_effect;
@@ -240,32 +332,21 @@ struct obs_core_video {
 	gs_effect_t                     *bilinear_lowres_effect;
 	gs_effect_t                     *premultiplied_alpha_effect;
 	gs_samplerstate_t               *point_sampler;
-	gs_stagesurf_t                  *mapped_surface;
-	int                             cur_texture;
+
+	struct obs_canvas               main_canvas;
+
+	/* canvas currently being composited, graphics thread only */
+	struct obs_canvas               *render_canvas;
 
 	uint64_t                        video_time;
 	uint64_t                        video_avg_frame_time_ns;
+	uint64_t                        total_ticks;
 	double                          video_fps;
-	video_t                         *video;
 	pthread_t                       video_thread;
 	uint32_t                        total_frames;
 	uint32_t                        lagged_frames;
 	bool                            thread_initialized;
 
-	bool                            gpu_conversion;
-	const char                      *conversion_tech;
-	uint32_t                        conversion_height;
-	uint32_t                        plane_offsets[3];
-	uint32_t                        plane_sizes[3];
-	uint32_t                        plane_linewidth[3];
-
-	uint32_t                        output_width;
-	uint32_t                        output_height;
-	uint32_t                        base_width;
-	uint32_t                        base_height;
-	float                           color_matrix[16];
-	enum obs_scale_type             scale_type;
-
 	gs_texture_t                    *transparent_texture;
 
 	gs_effect_t                     *deinterlace_discard_effect;
@@ -276,8 +357,6 @@ struct obs_core_video {
 	gs_effect_t                     *deinterlace_blend_2x_effect;
 	gs_effect_t                     *deinterlace_yadif_effect;
 	gs_effect_t                     *deinterlace_yadif_2x_effect;
-
-	struct obs_video_info           ovi;
 };
 
 struct audio_monitor;
@@ -292,6 +371,7 @@ struct obs_core_audio {
 	struct circlebuf                buffered_timestamps;
 	int                             buffering_wait_ticks;
 	int                             total_buffering_ticks;
+	volatile long                   buffering_events;
 
 	float                           user_volume;
 
@@ -306,12 +386,14 @@ struct obs_core_data {
 	struct obs_source               *first_source;
 	struct obs_source               *first_audio_source;
 	struct obs_display              *first_display;
+	struct obs_canvas               *first_canvas;
 	struct obs_output               *first_output;
 	struct obs_encoder              *first_encoder;
 	struct obs_service              *first_service;
 
 	pthread_mutex_t                 sources_mutex;
 	pthread_mutex_t                 displays_mutex;
+	pthread_mutex_t                 canvases_mutex;
 	pthread_mutex_t                 outputs_mutex;
 	pthread_mutex_t                 encoders_mutex;
 	pthread_mutex_t                 services_mutex;
@@ -323,6 +405,10 @@ struct obs_core_data {
 
 	long long                       unnamed_index;
 
+	/* invalidates every saved source snapshot, for changes that affect
+	 * the saved data of other sources (renames, hotkey bindings) */
+	volatile long                   save_gen;
+
 	volatile bool                   valid;
 };
 
@@ -342,6 +428,10 @@ struct obs_core_hotkeys {
 	bool                            reroute_hotkeys;
 	DARRAY(obs_hotkey_binding_t)    bindings;
 
+	/* rebuilt lazily by the event-driven hotkey thread */
+	struct obs_hotkey_key_index     *key_index;
+	bool                            key_index_dirty;
+
 	obs_hotkey_callback_router_func router_func;
 	void                            *router_func_data;
 
@@ -364,6 +454,7 @@ struct obs_core_hotkeys {
 struct obs_core {
 	struct obs_module               *first_module;
 	DARRAY(struct obs_module_path)  module_paths;
+	DARRAY(struct deferred_type *)  deferred_types;
 
 	DARRAY(struct obs_source_info)  source_types;
 	DARRAY(struct obs_source_info)  input_types;
@@ -375,6 +466,16 @@ struct obs_core {
 	DARRAY(struct obs_modal_ui)     modal_ui_callbacks;
 	DARRAY(struct obs_modeless_ui)  modeless_ui_callbacks;
 
+	struct type_index               source_index;
+	struct type_index               output_index;
+	struct type_index               encoder_index;
+	struct type_index               service_index;
+	pthread_mutex_t                 type_defaults_mutex;
+
+	/* protects the type arrays, their indexes and deferred_types;
+	 * recursive because loading a module registers its types */
+	pthread_mutex_t                 types_mutex;
+
 	signal_handler_t                *signals;
 	proc_handler_t                  *procs;
 
@@ -493,6 +594,16 @@ struct async_frame {
 	struct obs_source_frame *frame;
 	long unused_count;
 	bool used;
+
+	/* frame data is owned by the source and released instead of reused */
+	bool external;
+};
+
+/* release callback of a frame that uses the memory of the source */
+struct async_release {
+	struct obs_source_frame *frame;
+	void (*release)(void *param);
+	void *param;
 };
 
 enum audio_action_type {
@@ -536,6 +647,22 @@ struct obs_source {
 	/* signals to call the source update in the video thread */
 	bool                            defer_update;
 
+	/* the create callback has not been called yet, see
+	 * obs_source_create_deferred.  context.data is published by the
+	 * create thread, so the source is not ticked, rendered or updated
+	 * until this is cleared. */
+	volatile bool                   create_pending;
+
+	/* source_create has not been emitted yet, loading thread only */
+	bool                            create_signal_pending;
+
+	/* incremented whenever state that is saved changes, the last saved
+	 * snapshot is reused until then (see obs_save_source_snapshot) */
+	volatile long                   save_gen;
+	obs_data_t                      *save_snapshot;
+	long                            save_snapshot_gen;
+	long                            save_snapshot_global_gen;
+
 	/* ensures show/hide are only called once */
 	volatile long                   show_refs;
 
@@ -579,6 +706,7 @@ struct obs_source {
 	float                           *audio_output_buf[MAX_AUDIO_MIXES][MAX_AUDIO_CHANNELS];
 	struct resample_info            sample_info;
 	audio_resampler_t               *resampler;
+	bool                            audio_convert;
 	pthread_mutex_t                 audio_actions_mutex;
 	pthread_mutex_t                 audio_buf_mutex;
 	pthread_mutex_t                 audio_mutex;
@@ -612,6 +740,7 @@ struct obs_source {
 	struct obs_source_frame         *async_preload_frame;
 	DARRAY(struct async_frame)      async_cache;
 	DARRAY(struct obs_source_frame*)async_frames;
+	DARRAY(struct async_release)    async_releases;
 	pthread_mutex_t                 async_mutex;
 	uint32_t                        async_width;
 	uint32_t                        async_height;
@@ -641,6 +770,22 @@ struct obs_source {
 	enum obs_allow_direct_render    allow_direct;
 	bool                            rendering_filter;
 
+	/* render result cache, used when the source was rendered more than
+	 * once in the previous frame.  it's only dropped after the source was
+	 * rendered at most once for a number of frames in a row. */
+	gs_texrender_t                  *render_cache;
+	uint32_t                        render_cache_cx;
+	uint32_t                        render_cache_cy;
+	long                            render_count;
+	bool                            render_cache_enabled;
+	uint32_t                        render_cache_unused_frames;
+
+	/* the render cache is kept across frames while the source and its
+	 * filters have static content */
+	bool                            content_static;
+	volatile bool                   content_changed;
+	const char                      *profile_filter_audio_name;
+
 	/* sources specific hotkeys */
 	obs_hotkey_pair_id              mute_unmute_key;
 	obs_hotkey_id                   push_to_mute_key;
@@ -689,6 +834,20 @@ extern bool obs_source_init_context(struct obs_source *source,
 extern void obs_source_save(obs_source_t *source);
 extern void obs_source_load(obs_source_t *source);
 
+/* creates the source but leaves the create callback to
+ * obs_source_deferred_create if the type allows creating it on another
+ * thread.  the source_create signal is held back for every source created
+ * this way: obs_source_deferred_finish must be called afterwards from the
+ * loading thread for each of them, in load order, and emits it. */
+extern obs_source_t *obs_source_create_deferred(const char *id,
+		const char *name, obs_data_t *settings,
+		obs_data_t *hotkey_data);
+extern void obs_source_deferred_create(obs_source_t *source);
+extern void obs_source_deferred_finish(obs_source_t *source);
+
+/* marks the saved state of a source (and the source it filters) as changed */
+extern void obs_source_set_dirty(obs_source_t *source);
+
 extern bool obs_transition_init(obs_source_t *transition);
 extern void obs_transition_free(obs_source_t *transition);
 extern void obs_transition_tick(obs_source_t *transition);
@@ -700,6 +859,7 @@ extern void obs_transition_load(obs_source_t *source, obs_data_t *data);
 struct audio_monitor *audio_monitor_create(obs_source_t *source);
 void audio_monitor_reset(struct audio_monitor *monitor);
 extern void audio_monitor_destroy(struct audio_monitor *monitor);
+uint64_t audio_monitor_get_latency(const struct audio_monitor *monitor);
 
 extern void obs_source_destroy(struct obs_source *source);
 
@@ -748,6 +908,18 @@ static inline enum gs_color_format convert_video_format(
 extern void obs_source_activate(obs_source_t *source, enum view_type type);
 extern void obs_source_deactivate(obs_source_t *source, enum view_type type);
 extern void obs_source_video_tick(obs_source_t *source, float seconds);
+
+/* false while a scene is being rendered directly into its parent scene, in
+ * which case its items are not clipped to its canvas, or into a canvas that
+ * is not the size of the scenes */
+extern bool obs_scene_render_clipped(void);
+
+/* obs_source_video_render in two steps, so scenes can batch the draws of
+ * cached sources: updates the render cache and returns its texture, which
+ * holds premultiplied color, or returns NULL if the source has to be drawn
+ * with obs_source_video_render_uncached instead */
+extern gs_texture_t *obs_source_video_render_cache(obs_source_t *source);
+extern void obs_source_video_render_uncached(obs_source_t *source);
 extern float obs_source_get_target_volume(obs_source_t *source,
 		obs_source_t *target);
 
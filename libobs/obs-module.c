@@ -15,6 +15,8 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 ******************************************************************************/
 
+#include <sys/stat.h>
+
 #include "util/platform.h"
 #include "util/dstr.h"
 
@@ -53,6 +55,7 @@ static int load_module_exports(struct obs_module *mod, const char *path)
 	mod->name        = os_dlsym(mod->module, "obs_module_name");
 	mod->description = os_dlsym(mod->module, "obs_module_description");
 	mod->author      = os_dlsym(mod->module, "obs_module_author");
+	mod->deferrable  = os_dlsym(mod->module, "obs_module_deferrable");
 	return MODULE_SUCCESS;
 }
 
@@ -143,7 +146,8 @@ void obs_log_loaded_modules(void)
 	blog(LOG_INFO, "  Loaded Modules:");
 
 	for (obs_module_t *mod = obs->first_module; !!mod; mod = mod->next)
-		blog(LOG_INFO, "    %s", mod->file);
+		blog(LOG_INFO, "    %s%s", mod->file,
+				mod->module ? "" : " (deferred)");
 }
 
 const char *obs_get_module_file_name(obs_module_t *module)
@@ -221,20 +225,548 @@ void obs_add_module_path(const char *bin, const char *data)
 	da_push_back(obs->module_paths, &omp);
 }
 
+/* ------------------------------------------------------------------------- */
+/* module manifest
+ *
+ * The first time a module is loaded, the types it registers are written to a
+ * manifest along with their display names and flags.  On later startups a
+ * module that declared itself deferrable isn't opened at all: its types are
+ * registered as placeholders from the manifest, and the module is only loaded
+ * once one of them is created or its defaults or properties are requested.
+ * Modules that register types depending on the system, like hardware
+ * encoders, must not declare themselves deferrable.
+ *
+ * An entry is used as long as the module binary keeps the same size and
+ * modification time.  The whole manifest is discarded if the locale or the
+ * libobs API version changes. */
+
+#define MANIFEST_FILE "module-manifest.json"
+#define MANIFEST_VERSION 2
+
+struct deferred_type {
+	enum obs_obj_type  type;
+	char               *id;
+	char               *name;
+	char               *codec;
+	struct obs_module  *module;
+	bool               loaded;
+};
+
+static const char *deferred_get_name(void *type_data)
+{
+	struct deferred_type *dt = type_data;
+	return dt->name;
+}
+
+/* only marks a placeholder as configurable, the module is always loaded
+ * before properties are actually created */
+static obs_properties_t *deferred_get_properties(void *data)
+{
+	UNUSED_PARAMETER(data);
+	return NULL;
+}
+
+static inline bool is_deferred(const char *(*get_name)(void *type_data))
+{
+	return get_name == deferred_get_name;
+}
+
+static void free_deferred_type(struct deferred_type *dt)
+{
+	bfree(dt->id);
+	bfree(dt->name);
+	bfree(dt->codec);
+	bfree(dt);
+}
+
+static void add_deferred_source(struct deferred_type *dt, obs_data_t *item)
+{
+	struct obs_source_info info = {0};
+	struct darray *array;
+
+	info.id           = dt->id;
+	info.type         = (enum obs_source_type)obs_data_get_int(item, "type");
+	info.output_flags = (uint32_t)obs_data_get_int(item, "flags");
+	info.get_name     = deferred_get_name;
+	info.type_data    = dt;
+
+	if (obs_data_get_bool(item, "configurable"))
+		info.get_properties = deferred_get_properties;
+
+	if (info.type == OBS_SOURCE_TYPE_INPUT)
+		array = &obs->input_types.da;
+	else if (info.type == OBS_SOURCE_TYPE_FILTER)
+		array = &obs->filter_types.da;
+	else
+		array = &obs->transition_types.da;
+
+	darray_push_back(sizeof(struct obs_source_info), array, &info);
+	da_push_back(obs->source_types, &info);
+	type_index_add(&obs->source_index, &obs->source_types.da,
+			sizeof(info));
+}
+
+static void add_deferred_output(struct deferred_type *dt, obs_data_t *item)
+{
+	struct obs_output_info info = {0};
+
+	info.id        = dt->id;
+	info.flags     = (uint32_t)obs_data_get_int(item, "flags");
+	info.get_name  = deferred_get_name;
+	info.type_data = dt;
+
+	da_push_back(obs->output_types, &info);
+	type_index_add(&obs->output_index, &obs->output_types.da, sizeof(info));
+}
+
+static void add_deferred_encoder(struct deferred_type *dt, obs_data_t *item)
+{
+	struct obs_encoder_info info = {0};
+
+	dt->codec = bstrdup(obs_data_get_string(item, "codec"));
+
+	info.id        = dt->id;
+	info.type      = (enum obs_encoder_type)obs_data_get_int(item, "type");
+	info.codec     = dt->codec;
+	info.caps      = (uint32_t)obs_data_get_int(item, "caps");
+	info.get_name  = deferred_get_name;
+	info.type_data = dt;
+
+	da_push_back(obs->encoder_types, &info);
+	type_index_add(&obs->encoder_index, &obs->encoder_types.da, sizeof(info));
+}
+
+static void add_deferred_service(struct deferred_type *dt)
+{
+	struct obs_service_info info = {0};
+
+	info.id        = dt->id;
+	info.get_name  = deferred_get_name;
+	info.type_data = dt;
+
+	da_push_back(obs->service_types, &info);
+	type_index_add(&obs->service_index, &obs->service_types.da, sizeof(info));
+}
+
+static void add_deferred_type(struct obs_module *mod, obs_data_t *item)
+{
+	const char *kind = obs_data_get_string(item, "kind");
+	const char *id   = obs_data_get_string(item, "id");
+	struct deferred_type *dt;
+	enum obs_obj_type type;
+
+	if (strcmp(kind, "source") == 0 && !get_source_info(id))
+		type = OBS_OBJ_TYPE_SOURCE;
+	else if (strcmp(kind, "output") == 0 && !find_output(id))
+		type = OBS_OBJ_TYPE_OUTPUT;
+	else if (strcmp(kind, "encoder") == 0 && !find_encoder(id))
+		type = OBS_OBJ_TYPE_ENCODER;
+	else if (strcmp(kind, "service") == 0 && !find_service(id))
+		type = OBS_OBJ_TYPE_SERVICE;
+	else
+		return;
+
+	dt         = bzalloc(sizeof(*dt));
+	dt->type   = type;
+	dt->id     = bstrdup(id);
+	dt->name   = bstrdup(obs_data_get_string(item, "name"));
+	dt->module = mod;
+
+	if (type == OBS_OBJ_TYPE_SOURCE)
+		add_deferred_source(dt, item);
+	else if (type == OBS_OBJ_TYPE_OUTPUT)
+		add_deferred_output(dt, item);
+	else if (type == OBS_OBJ_TYPE_ENCODER)
+		add_deferred_encoder(dt, item);
+	else
+		add_deferred_service(dt);
+
+	da_push_back(obs->deferred_types, &dt);
+}
+
+#define ERASE_PLACEHOLDER(list, dt)                                       \
+	do {                                                              \
+		for (size_t i = 0; i < list.num; i++) {                   \
+			if (is_deferred(list.array[i].get_name) &&        \
+			    list.array[i].type_data == dt) {              \
+				da_erase(list, i);                        \
+				break;                                    \
+			}                                                 \
+		}                                                         \
+	} while (false)
+
+/* removes placeholders that the module did not replace when it was loaded */
+static void remove_placeholder(struct deferred_type *dt)
+{
+	if (dt->type == OBS_OBJ_TYPE_SOURCE) {
+		ERASE_PLACEHOLDER(obs->source_types, dt);
+		ERASE_PLACEHOLDER(obs->input_types, dt);
+		ERASE_PLACEHOLDER(obs->filter_types, dt);
+		ERASE_PLACEHOLDER(obs->transition_types, dt);
+		type_index_rebuild(&obs->source_index, &obs->source_types.da,
+				sizeof(struct obs_source_info));
+	} else if (dt->type == OBS_OBJ_TYPE_OUTPUT) {
+		ERASE_PLACEHOLDER(obs->output_types, dt);
+		type_index_rebuild(&obs->output_index, &obs->output_types.da,
+				sizeof(struct obs_output_info));
+	} else if (dt->type == OBS_OBJ_TYPE_ENCODER) {
+		ERASE_PLACEHOLDER(obs->encoder_types, dt);
+		type_index_rebuild(&obs->encoder_index,
+				&obs->encoder_types.da,
+				sizeof(struct obs_encoder_info));
+	} else {
+		ERASE_PLACEHOLDER(obs->service_types, dt);
+		type_index_rebuild(&obs->service_index,
+				&obs->service_types.da,
+				sizeof(struct obs_service_info));
+	}
+}
+
+#undef ERASE_PLACEHOLDER
+
+static bool open_deferred_module(struct obs_module *mod)
+{
+	mod->module = os_dlopen(mod->bin_path);
+	if (!mod->module) {
+		blog(LOG_WARNING, "Module '%s' not found", mod->bin_path);
+		return false;
+	}
+
+	if (load_module_exports(mod, mod->bin_path) != MODULE_SUCCESS) {
+		mod->module = NULL;
+		return false;
+	}
+
+	mod->set_pointer(mod);
+
+	if (mod->set_locale)
+		mod->set_locale(obs->locale);
+
+	return true;
+}
+
+static void load_deferred_module(struct obs_module *mod)
+{
+	/* the module may create its own types while it's being loaded */
+	if (mod->module)
+		return;
+
+	blog(LOG_INFO, "Loading module '%s' on first use", mod->file);
+
+	if (open_deferred_module(mod))
+		obs_init_module(mod);
+
+#ifdef _WIN32
+	reset_win32_symbol_paths();
+#endif
+
+	/* copies of a placeholder's info may still point at its type data, so
+	 * loaded types are only freed on shutdown */
+	for (size_t i = 0; i < obs->deferred_types.num; i++) {
+		struct deferred_type *dt = obs->deferred_types.array[i];
+		if (dt->module != mod || dt->loaded)
+			continue;
+
+		remove_placeholder(dt);
+		dt->loaded = true;
+	}
+}
+
+void load_deferred_type(enum obs_obj_type type, const char *id)
+{
+	if (!obs || !id)
+		return;
+
+	pthread_mutex_lock(&obs->types_mutex);
+
+	for (size_t i = 0; i < obs->deferred_types.num; i++) {
+		struct deferred_type *dt = obs->deferred_types.array[i];
+
+		if (!dt->loaded && dt->type == type &&
+		    strcmp(dt->id, id) == 0) {
+			load_deferred_module(dt->module);
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&obs->types_mutex);
+}
+
+void load_deferred_modules(void)
+{
+	pthread_mutex_lock(&obs->types_mutex);
+	for (size_t i = 0; i < obs->deferred_types.num; i++) {
+		struct deferred_type *dt = obs->deferred_types.array[i];
+		if (!dt->loaded)
+			load_deferred_module(dt->module);
+	}
+	pthread_mutex_unlock(&obs->types_mutex);
+}
+
+void free_deferred_types(void)
+{
+	pthread_mutex_lock(&obs->types_mutex);
+	for (size_t i = 0; i < obs->deferred_types.num; i++)
+		free_deferred_type(obs->deferred_types.array[i]);
+	da_free(obs->deferred_types);
+	pthread_mutex_unlock(&obs->types_mutex);
+}
+
+static void defer_module(const struct obs_module_info *info,
+		obs_data_t *entry)
+{
+	struct obs_module mod = {0};
+	struct obs_module *module;
+	obs_data_array_t *types;
+	size_t count;
+
+	mod.bin_path  = bstrdup(info->bin_path);
+	mod.file      = strrchr(mod.bin_path, '/');
+	mod.file      = (!mod.file) ? mod.bin_path : (mod.file + 1);
+	mod.mod_name  = get_module_name(mod.file);
+	mod.data_path = bstrdup(info->data_path);
+	mod.next      = obs->first_module;
+
+	blog(LOG_DEBUG, "Deferring module: %s", mod.file);
+
+	module = bmemdup(&mod, sizeof(mod));
+	obs->first_module = module;
+
+	types = obs_data_get_array(entry, "types");
+	count = obs_data_array_count(types);
+
+	pthread_mutex_lock(&obs->types_mutex);
+	for (size_t i = 0; i < count; i++) {
+		obs_data_t *item = obs_data_array_item(types, i);
+		add_deferred_type(module, item);
+		obs_data_release(item);
+	}
+	pthread_mutex_unlock(&obs->types_mutex);
+
+	obs_data_array_release(types);
+}
+
+struct type_counts {
+	size_t sources;
+	size_t outputs;
+	size_t encoders;
+	size_t services;
+	size_t uis;
+};
+
+static inline void get_type_counts(struct type_counts *counts)
+{
+	counts->sources  = obs->source_types.num;
+	counts->outputs  = obs->output_types.num;
+	counts->encoders = obs->encoder_types.num;
+	counts->services = obs->service_types.num;
+	counts->uis      = obs->modal_ui_callbacks.num +
+	                   obs->modeless_ui_callbacks.num;
+}
+
+static obs_data_t *add_manifest_type(obs_data_array_t *types,
+		const char *kind, const char *id, const char *name)
+{
+	obs_data_t *item = obs_data_create();
+
+	obs_data_set_string(item, "kind", kind);
+	obs_data_set_string(item, "id", id);
+	obs_data_set_string(item, "name", name ? name : "");
+	obs_data_array_push_back(types, item);
+	obs_data_release(item);
+	return item;
+}
+
+static void set_file_info(obs_data_t *entry, const char *path)
+{
+	struct stat st;
+
+	if (os_stat(path, &st) == 0) {
+		obs_data_set_int(entry, "size", (long long)st.st_size);
+		obs_data_set_int(entry, "mtime", (long long)st.st_mtime);
+	}
+}
+
+static bool file_info_matches(obs_data_t *entry, const char *path)
+{
+	struct stat st;
+
+	if (os_stat(path, &st) != 0)
+		return false;
+
+	return obs_data_get_int(entry, "size") == (long long)st.st_size &&
+	       obs_data_get_int(entry, "mtime") == (long long)st.st_mtime;
+}
+
+/* records the types a module registered while it was being initialized */
+static obs_data_t *create_manifest_entry(struct obs_module *mod,
+		const struct type_counts *prev)
+{
+	obs_data_t *entry = obs_data_create();
+	obs_data_array_t *types = obs_data_array_create();
+	struct type_counts cur;
+	obs_data_t *item;
+
+	get_type_counts(&cur);
+
+	for (size_t i = prev->sources; i < cur.sources; i++) {
+		struct obs_source_info *info = &obs->source_types.array[i];
+
+		item = add_manifest_type(types, "source", info->id,
+				info->get_name(info->type_data));
+		obs_data_set_int(item, "type", info->type);
+		obs_data_set_int(item, "flags", info->output_flags);
+		obs_data_set_bool(item, "configurable", !!info->get_properties);
+	}
+
+	for (size_t i = prev->outputs; i < cur.outputs; i++) {
+		struct obs_output_info *info = &obs->output_types.array[i];
+
+		item = add_manifest_type(types, "output", info->id,
+				info->get_name(info->type_data));
+		obs_data_set_int(item, "flags", info->flags);
+	}
+
+	for (size_t i = prev->encoders; i < cur.encoders; i++) {
+		struct obs_encoder_info *info = &obs->encoder_types.array[i];
+
+		item = add_manifest_type(types, "encoder", info->id,
+				info->get_name(info->type_data));
+		obs_data_set_int(item, "type", info->type);
+		obs_data_set_string(item, "codec", info->codec);
+		obs_data_set_int(item, "caps", info->caps);
+	}
+
+	for (size_t i = prev->services; i < cur.services; i++) {
+		struct obs_service_info *info = &obs->service_types.array[i];
+
+		add_manifest_type(types, "service", info->id,
+				info->get_name(info->type_data));
+	}
+
+	/* modules that don't opt in, register no types or register UI must
+	 * always be loaded at startup */
+	obs_data_set_string(entry, "path", mod->bin_path);
+	obs_data_set_bool(entry, "deferrable",
+			mod->deferrable && mod->deferrable() &&
+			obs_data_array_count(types) > 0 &&
+			cur.uis == prev->uis);
+	obs_data_set_array(entry, "types", types);
+	set_file_info(entry, mod->bin_path);
+
+	obs_data_array_release(types);
+	return entry;
+}
+
+static obs_data_t *find_manifest_entry(obs_data_array_t *entries,
+		const char *path)
+{
+	size_t count = obs_data_array_count(entries);
+
+	for (size_t i = 0; i < count; i++) {
+		obs_data_t *entry = obs_data_array_item(entries, i);
+
+		if (strcmp(obs_data_get_string(entry, "path"), path) == 0) {
+			if (file_info_matches(entry, path))
+				return entry;
+
+			obs_data_release(entry);
+			break;
+		}
+
+		obs_data_release(entry);
+	}
+
+	return NULL;
+}
+
+static char *get_manifest_path(void)
+{
+	struct dstr path = {0};
+
+	if (!obs->module_config_path)
+		return NULL;
+
+	dstr_copy(&path, obs->module_config_path);
+	if (!dstr_is_empty(&path) && dstr_end(&path) != '/')
+		dstr_cat_ch(&path, '/');
+	dstr_cat(&path, MANIFEST_FILE);
+	return path.array;
+}
+
+static obs_data_array_t *load_manifest(const char *path)
+{
+	obs_data_array_t *modules = NULL;
+	obs_data_t *manifest;
+
+	manifest = obs_data_create_from_json_file_safe(path, "bak");
+	if (!manifest)
+		return NULL;
+
+	if (obs_data_get_int(manifest, "version") == MANIFEST_VERSION &&
+	    obs_data_get_int(manifest, "api_version") == LIBOBS_API_VER &&
+	    strcmp(obs_data_get_string(manifest, "locale"), obs->locale) == 0)
+		modules = obs_data_get_array(manifest, "modules");
+
+	obs_data_release(manifest);
+	return modules;
+}
+
+static void save_manifest(const char *path, obs_data_array_t *modules)
+{
+	obs_data_t *manifest = obs_data_create();
+
+	obs_data_set_int(manifest, "version", MANIFEST_VERSION);
+	obs_data_set_int(manifest, "api_version", LIBOBS_API_VER);
+	obs_data_set_string(manifest, "locale", obs->locale);
+	obs_data_set_array(manifest, "modules", modules);
+
+	os_mkdirs(obs->module_config_path);
+	if (!obs_data_save_json_safe(manifest, path, "tmp", "bak"))
+		blog(LOG_WARNING, "Failed to save module manifest '%s'", path);
+
+	obs_data_release(manifest);
+}
+
+struct load_all_info {
+	obs_data_array_t *prev_modules;
+	obs_data_array_t *modules;
+	bool changed;
+};
+
 static void load_all_callback(void *param, const struct obs_module_info *info)
 {
+	struct load_all_info *lai = param;
+	struct type_counts counts;
 	obs_module_t *module;
+	obs_data_t *entry;
+
+	entry = find_manifest_entry(lai->prev_modules, info->bin_path);
+
+	if (entry && obs_data_get_bool(entry, "deferrable")) {
+		defer_module(info, entry);
+		goto finish;
+	}
 
 	int code = obs_open_module(&module, info->bin_path, info->data_path);
 	if (code != MODULE_SUCCESS) {
 		blog(LOG_DEBUG, "Failed to load module file '%s': %d",
 				info->bin_path, code);
+		obs_data_release(entry);
 		return;
 	}
 
-	obs_init_module(module);
+	get_type_counts(&counts);
 
-	UNUSED_PARAMETER(param);
+	if (obs_init_module(module) && !entry) {
+		entry = create_manifest_entry(module, &counts);
+		lai->changed = true;
+	}
+
+finish:
+	if (entry)
+		obs_data_array_push_back(lai->modules, entry);
+	obs_data_release(entry);
 }
 
 static const char *obs_load_all_modules_name = "obs_load_all_modules";
@@ -244,13 +776,32 @@ static const char *reset_win32_symbol_paths_name = "reset_win32_symbol_paths";
 
 void obs_load_all_modules(void)
 {
+	struct load_all_info lai = {0};
+	char *manifest_path;
+
 	profile_start(obs_load_all_modules_name);
-	obs_find_modules(load_all_callback, NULL);
+
+	manifest_path    = get_manifest_path();
+	lai.prev_modules = manifest_path ? load_manifest(manifest_path) : NULL;
+	lai.modules      = obs_data_array_create();
+
+	obs_find_modules(load_all_callback, &lai);
 #ifdef _WIN32
 	profile_start(reset_win32_symbol_paths_name);
 	reset_win32_symbol_paths();
 	profile_end(reset_win32_symbol_paths_name);
 #endif
+
+	if (lai.changed || obs_data_array_count(lai.modules) !=
+	                   obs_data_array_count(lai.prev_modules)) {
+		if (manifest_path)
+			save_manifest(manifest_path, lai.modules);
+	}
+
+	obs_data_array_release(lai.prev_modules);
+	obs_data_array_release(lai.modules);
+	bfree(manifest_path);
+
 	profile_end(obs_load_all_modules_name);
 }
 
@@ -484,7 +1035,26 @@ cleanup:
 	return lookup;
 }
 
-#define REGISTER_OBS_DEF(size_var, structure, dest, info)                 \
+/* replaces the placeholder of a type that was registered from the module
+ * manifest, all type info structures start with their id */
+static bool replace_placeholder(struct darray *array, size_t element_size,
+		const void *data)
+{
+	const char *id = *(const char **)data;
+
+	for (size_t i = 0; i < array->num; i++) {
+		uint8_t *item = (uint8_t*)array->array + element_size * i;
+
+		if (strcmp(*(const char **)item, id) == 0) {
+			memcpy(item, data, element_size);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+#define REGISTER_OBS_DEF(size_var, structure, dest, info, existing)       \
 	do {                                                              \
 		struct structure data = {0};                              \
 		if (!size_var) {                                          \
@@ -504,7 +1074,9 @@ cleanup:
 		}                                                         \
                                                                           \
 		memcpy(&data, info, size_var);                            \
-		da_push_back(dest, &data);                                \
+		if (!existing ||                                          \
+		    !replace_placeholder(&dest.da, sizeof(data), &data))  \
+			da_push_back(dest, &data);                        \
 	} while (false)
 
 #define CHECK_REQUIRED_VAL(type, info, val, func) \
@@ -540,8 +1112,9 @@ cleanup:
 #define service_warn(format, ...) \
 	blog(LOG_WARNING, "obs_register_service: " format, ##__VA_ARGS__)
 
-void obs_register_source_s(const struct obs_source_info *info, size_t size)
+static void register_source(const struct obs_source_info *info, size_t size)
 {
+	const struct obs_source_info *existing;
 	struct obs_source_info data = {0};
 	struct darray *array = NULL;
 
@@ -557,7 +1130,8 @@ void obs_register_source_s(const struct obs_source_info *info, size_t size)
 		goto error;
 	}
 
-	if (get_source_info(info->id)) {
+	existing = get_source_info(info->id);
+	if (existing && !is_deferred(existing->get_name)) {
 		source_warn("Source '%s' already exists!  "
 		                  "Duplicate library?", info->id);
 		goto error;
@@ -624,18 +1198,35 @@ void obs_register_source_s(const struct obs_source_info *info, size_t size)
 		goto error;
 	}
 
+	if (existing) {
+		if (array)
+			replace_placeholder(array, sizeof(data), &data);
+		replace_placeholder(&obs->source_types.da, sizeof(data), &data);
+		return;
+	}
+
 	if (array)
 		darray_push_back(sizeof(struct obs_source_info), array, &data);
 	da_push_back(obs->source_types, &data);
+	type_index_add(&obs->source_index, &obs->source_types.da,
+			sizeof(data));
 	return;
 
 error:
 	HANDLE_ERROR(size, obs_source_info, info);
 }
 
-void obs_register_output_s(const struct obs_output_info *info, size_t size)
+void obs_register_source_s(const struct obs_source_info *info, size_t size)
 {
-	if (find_output(info->id)) {
+	pthread_mutex_lock(&obs->types_mutex);
+	register_source(info, size);
+	pthread_mutex_unlock(&obs->types_mutex);
+}
+
+static void register_output(const struct obs_output_info *info, size_t size)
+{
+	const struct obs_output_info *existing = find_output(info->id);
+	if (existing && !is_deferred(existing->get_name)) {
 		output_warn("Output id '%s' already exists!  "
 		                  "Duplicate library?", info->id);
 		goto error;
@@ -662,16 +1253,28 @@ void obs_register_output_s(const struct obs_output_info *info, size_t size)
 	}
 #undef CHECK_REQUIRED_VAL_
 
-	REGISTER_OBS_DEF(size, obs_output_info, obs->output_types, info);
+	REGISTER_OBS_DEF(size, obs_output_info, obs->output_types, info,
+			existing);
+	if (!existing)
+		type_index_add(&obs->output_index, &obs->output_types.da,
+				sizeof(struct obs_output_info));
 	return;
 
 error:
 	HANDLE_ERROR(size, obs_output_info, info);
 }
 
-void obs_register_encoder_s(const struct obs_encoder_info *info, size_t size)
+void obs_register_output_s(const struct obs_output_info *info, size_t size)
+{
+	pthread_mutex_lock(&obs->types_mutex);
+	register_output(info, size);
+	pthread_mutex_unlock(&obs->types_mutex);
+}
+
+static void register_encoder(const struct obs_encoder_info *info, size_t size)
 {
-	if (find_encoder(info->id)) {
+	const struct obs_encoder_info *existing = find_encoder(info->id);
+	if (existing && !is_deferred(existing->get_name)) {
 		encoder_warn("Encoder id '%s' already exists!  "
 		                  "Duplicate library?", info->id);
 		goto error;
@@ -688,16 +1291,28 @@ void obs_register_encoder_s(const struct obs_encoder_info *info, size_t size)
 		CHECK_REQUIRED_VAL_(info, get_frame_size, obs_register_encoder);
 #undef CHECK_REQUIRED_VAL_
 
-	REGISTER_OBS_DEF(size, obs_encoder_info, obs->encoder_types, info);
+	REGISTER_OBS_DEF(size, obs_encoder_info, obs->encoder_types, info,
+			existing);
+	if (!existing)
+		type_index_add(&obs->encoder_index, &obs->encoder_types.da,
+				sizeof(struct obs_encoder_info));
 	return;
 
 error:
 	HANDLE_ERROR(size, obs_encoder_info, info);
 }
 
-void obs_register_service_s(const struct obs_service_info *info, size_t size)
+void obs_register_encoder_s(const struct obs_encoder_info *info, size_t size)
 {
-	if (find_service(info->id)) {
+	pthread_mutex_lock(&obs->types_mutex);
+	register_encoder(info, size);
+	pthread_mutex_unlock(&obs->types_mutex);
+}
+
+static void register_service(const struct obs_service_info *info, size_t size)
+{
+	const struct obs_service_info *existing = find_service(info->id);
+	if (existing && !is_deferred(existing->get_name)) {
 		service_warn("Service id '%s' already exists!  "
 		                  "Duplicate library?", info->id);
 		goto error;
@@ -710,13 +1325,24 @@ void obs_register_service_s(const struct obs_service_info *info, size_t size)
 	CHECK_REQUIRED_VAL_(info, destroy,  obs_register_service);
 #undef CHECK_REQUIRED_VAL_
 
-	REGISTER_OBS_DEF(size, obs_service_info, obs->service_types, info);
+	REGISTER_OBS_DEF(size, obs_service_info, obs->service_types, info,
+			existing);
+	if (!existing)
+		type_index_add(&obs->service_index, &obs->service_types.da,
+				sizeof(struct obs_service_info));
 	return;
 
 error:
 	HANDLE_ERROR(size, obs_service_info, info);
 }
 
+void obs_register_service_s(const struct obs_service_info *info, size_t size)
+{
+	pthread_mutex_lock(&obs->types_mutex);
+	register_service(info, size);
+	pthread_mutex_unlock(&obs->types_mutex);
+}
+
 void obs_regsiter_modal_ui_s(const struct obs_modal_ui *info, size_t size)
 {
 #define CHECK_REQUIRED_VAL_(info, val, func) \
@@ -726,7 +1352,8 @@ void obs_regsiter_modal_ui_s(const struct obs_modal_ui *info, size_t size)
 	CHECK_REQUIRED_VAL_(info, exec,   obs_regsiter_modal_ui);
 #undef CHECK_REQUIRED_VAL_
 
-	REGISTER_OBS_DEF(size, obs_modal_ui, obs->modal_ui_callbacks, info);
+	REGISTER_OBS_DEF(size, obs_modal_ui, obs->modal_ui_callbacks, info,
+			NULL);
 	return;
 
 error:
@@ -743,7 +1370,7 @@ void obs_regsiter_modeless_ui_s(const struct obs_modeless_ui *info, size_t size)
 #undef CHECK_REQUIRED_VAL_
 
 	REGISTER_OBS_DEF(size, obs_modeless_ui, obs->modeless_ui_callbacks,
-			info);
+			info, NULL);
 	return;
 
 error:
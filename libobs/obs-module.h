@@ -164,6 +164,16 @@ MODULE_EXTERN obs_module_t *obs_current_module(void);
 	MODULE_EXPORT const char *obs_module_author(void); \
 	const char *obs_module_author(void) {return name;}
 
+/**
+ * Optional: Allows libobs to defer loading the module until one of its types
+ * is used.  Only declare this if the module always registers the same types
+ * and does nothing else at startup, as the types of a deferred module are
+ * taken from the last time it was loaded.
+ */
+#define OBS_MODULE_DEFERRABLE() \
+	MODULE_EXPORT bool obs_module_deferrable(void); \
+	bool obs_module_deferrable(void) {return true;}
+
 /** Optional: Returns the full name of the module */
 MODULE_EXPORT const char *obs_module_name(void);
 
@@ -29,6 +29,11 @@
 #include <X11/Xutil.h>
 #include <X11/Xlib-xcb.h>
 #include <X11/keysym.h>
+#ifdef USE_XINPUT
+#include <X11/extensions/XInput2.h>
+#include <poll.h>
+#include <errno.h>
+#endif
 #include <inttypes.h>
 #include "util/dstr.h"
 #include "obs-internal.h"
@@ -266,6 +271,15 @@ struct obs_hotkeys_platform {
 	xcb_keysym_t *keysyms;
 	int num_keysyms;
 	int syms_per_code;
+
+#ifdef USE_XINPUT
+	/* separate connection that only the hotkey thread reads XInput2 raw
+	 * events from; the wake pipe interrupts it on shutdown */
+	Display *event_display;
+	int xi_opcode;
+	int wake_pipe[2];
+	obs_key_t keycode_keys[256];
+#endif
 };
 
 #define MOUSE_1 (1<<16)
@@ -570,6 +584,11 @@ static inline void add_key(obs_hotkeys_platform_t *context, obs_key_t key,
 	xcb_keycode_t kc = (xcb_keycode_t)code;
 	da_push_back(context->keycodes[key].list, &kc);
 
+#ifdef USE_XINPUT
+	if (context->keycode_keys[kc] == OBS_KEY_NONE)
+		context->keycode_keys[kc] = key;
+#endif
+
 	if (context->keycodes[key].list.num > 1) {
 		blog(LOG_DEBUG, "found alternate keycode %d for %s "
 		                "which already has keycode %d",
@@ -623,9 +642,15 @@ static inline bool fill_keycodes(struct obs_core_hotkeys *hotkeys)
 
 			if (sym[i] == XK_Super_L) {
 				context->super_l_code = code;
+#ifdef USE_XINPUT
+				context->keycode_keys[code] = OBS_KEY_META;
+#endif
 				break;
 			} else if (sym[i] == XK_Super_R) {
 				context->super_r_code = code;
+#ifdef USE_XINPUT
+				context->keycode_keys[code] = OBS_KEY_META;
+#endif
 				break;
 			} else {
 				key = key_from_base_keysym(context, sym[i]);
@@ -646,6 +671,58 @@ error1:
 	return error != NULL || reply == NULL;
 }
 
+#ifdef USE_XINPUT
+static bool init_xinput(obs_hotkeys_platform_t *context)
+{
+	unsigned char mask_bits[XIMaskLen(XI_LASTEVENT)] = {0};
+	XIEventMask mask = {XIAllMasterDevices, sizeof(mask_bits), mask_bits};
+	int event, error, major = 2, minor = 0;
+	Display *display;
+
+	context->wake_pipe[0] = context->wake_pipe[1] = -1;
+
+	display = XOpenDisplay(NULL);
+	if (!display)
+		return false;
+
+	if (!XQueryExtension(display, "XInputExtension", &context->xi_opcode,
+				&event, &error) ||
+	    XIQueryVersion(display, &major, &minor) != Success) {
+		blog(LOG_INFO, "XInput2 not available, hotkeys will be polled");
+		goto fail;
+	}
+
+	if (pipe(context->wake_pipe) != 0) {
+		blog(LOG_WARNING, "Failed to create hotkey wake pipe");
+		goto fail;
+	}
+
+	XISetMask(mask_bits, XI_RawKeyPress);
+	XISetMask(mask_bits, XI_RawKeyRelease);
+	XISetMask(mask_bits, XI_RawButtonPress);
+	XISetMask(mask_bits, XI_RawButtonRelease);
+	XISelectEvents(display, DefaultRootWindow(display), &mask, 1);
+	XFlush(display);
+
+	context->event_display = display;
+	return true;
+
+fail:
+	XCloseDisplay(display);
+	return false;
+}
+
+static void free_xinput(obs_hotkeys_platform_t *context)
+{
+	if (context->event_display)
+		XCloseDisplay(context->event_display);
+	if (context->wake_pipe[0] != -1)
+		close(context->wake_pipe[0]);
+	if (context->wake_pipe[1] != -1)
+		close(context->wake_pipe[1]);
+}
+#endif
+
 bool obs_hotkeys_platform_init(struct obs_core_hotkeys *hotkeys)
 {
 	Display *display = XOpenDisplay(NULL);
@@ -657,6 +734,9 @@ bool obs_hotkeys_platform_init(struct obs_core_hotkeys *hotkeys)
 
 	fill_base_keysyms(hotkeys);
 	fill_keycodes(hotkeys);
+#ifdef USE_XINPUT
+	init_xinput(hotkeys->platform_context);
+#endif
 	return true;
 }
 
@@ -667,6 +747,9 @@ void obs_hotkeys_platform_free(struct obs_core_hotkeys *hotkeys)
 	for (size_t i = 0; i < OBS_KEY_LAST_VALUE; i++)
 		da_free(context->keycodes[i].list);
 
+#ifdef USE_XINPUT
+	free_xinput(context);
+#endif
 	XCloseDisplay(context->display);
 	bfree(context->keysyms);
 	bfree(context);
@@ -780,6 +863,116 @@ bool obs_hotkeys_platform_is_pressed(obs_hotkeys_platform_t *context,
 	}
 }
 
+#ifdef USE_XINPUT
+static obs_key_t key_from_raw_event(obs_hotkeys_platform_t *context,
+		XIRawEvent *raw)
+{
+	switch (raw->evtype) {
+	case XI_RawKeyPress:
+	case XI_RawKeyRelease:
+		if (raw->detail < 0 || raw->detail > 255)
+			return OBS_KEY_NONE;
+		return context->keycode_keys[raw->detail];
+
+	/* same button mapping as mouse_button_pressed */
+	case XI_RawButtonPress:
+	case XI_RawButtonRelease:
+		switch (raw->detail) {
+		case 1: return OBS_KEY_MOUSE1;
+		case 2: return OBS_KEY_MOUSE3;
+		case 3: return OBS_KEY_MOUSE2;
+		}
+	}
+
+	return OBS_KEY_NONE;
+}
+
+static bool wait_for_display(obs_hotkeys_platform_t *context)
+{
+	Display *display = context->event_display;
+
+	while (!XPending(display)) {
+		struct pollfd fds[2] = {
+			{ConnectionNumber(display), POLLIN, 0},
+			{context->wake_pipe[0], POLLIN, 0}
+		};
+
+		if (poll(fds, 2, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+
+			blog(LOG_WARNING, "poll on hotkey display failed");
+			return false;
+		}
+
+		if (fds[1].revents)
+			return false;
+		if (fds[0].revents & (POLLERR | POLLHUP))
+			return false;
+	}
+
+	return true;
+}
+#endif
+
+bool obs_hotkeys_platform_has_key_events(obs_hotkeys_platform_t *context)
+{
+#ifdef USE_XINPUT
+	return context && context->event_display;
+#else
+	UNUSED_PARAMETER(context);
+	return false;
+#endif
+}
+
+bool obs_hotkeys_platform_wait_key_event(obs_hotkeys_platform_t *context,
+		obs_key_t *key, bool *pressed)
+{
+	*key = OBS_KEY_NONE;
+	*pressed = false;
+
+#ifdef USE_XINPUT
+	XGenericEventCookie *cookie;
+	XEvent event;
+
+	if (!obs_hotkeys_platform_has_key_events(context))
+		return false;
+	if (!wait_for_display(context))
+		return false;
+
+	XNextEvent(context->event_display, &event);
+	cookie = &event.xcookie;
+
+	if (cookie->type != GenericEvent ||
+	    cookie->extension != context->xi_opcode ||
+	    !XGetEventData(context->event_display, cookie))
+		return true;
+
+	*key = key_from_raw_event(context, cookie->data);
+	*pressed = cookie->evtype == XI_RawKeyPress ||
+	           cookie->evtype == XI_RawButtonPress;
+
+	XFreeEventData(context->event_display, cookie);
+	return true;
+#else
+	UNUSED_PARAMETER(context);
+	return false;
+#endif
+}
+
+void obs_hotkeys_platform_wake_key_events(obs_hotkeys_platform_t *context)
+{
+#ifdef USE_XINPUT
+	if (obs_hotkeys_platform_has_key_events(context)) {
+		char c = 0;
+		if (write(context->wake_pipe[1], &c, 1) != 1)
+			blog(LOG_WARNING, "Failed to wake hotkey thread");
+	}
+#else
+	UNUSED_PARAMETER(context);
+#endif
+}
+
 static bool get_key_translation(struct dstr *dstr, xcb_keycode_t keycode)
 {
 	xcb_connection_t *connection;
@@ -19,6 +19,7 @@
 #include "util/platform.h"
 #include "obs.h"
 #include "obs-internal.h"
+#include "obs-interleave.h"
 
 #if BUILD_CAPTIONS
 #include <caption/caption.h>
@@ -57,17 +58,50 @@ static inline bool data_capture_ending(const struct obs_output *output)
 
 const struct obs_output_info *find_output(const char *id)
 {
-	size_t i;
-	for (i = 0; i < obs->output_types.num; i++)
-		if (strcmp(obs->output_types.array[i].id, id) == 0)
-			return obs->output_types.array+i;
+	size_t idx = type_index_find(&obs->output_index,
+			&obs->output_types.da, sizeof(struct obs_output_info),
+			id);
+	return (idx != DARRAY_INVALID) ? obs->output_types.array+idx : NULL;
+}
 
-	return NULL;
+/* the type arrays change when a deferred module is loaded, so other code
+ * works with a copy of the type info */
+static const struct obs_output_info *copy_output_info(const char *id,
+		struct obs_output_info *info)
+{
+	const struct obs_output_info *found;
+
+	pthread_mutex_lock(&obs->types_mutex);
+	found = find_output(id);
+	if (found)
+		*info = *found;
+	pthread_mutex_unlock(&obs->types_mutex);
+
+	return found ? info : NULL;
+}
+
+/* applies the cached defaults of a registered type to settings */
+static void apply_defaults(const struct obs_output_info *info, obs_data_t *settings)
+{
+	obs_data_t *defaults = NULL;
+	size_t idx;
+
+	pthread_mutex_lock(&obs->types_mutex);
+	idx = type_index_find(&obs->output_index, &obs->output_types.da,
+			sizeof(struct obs_output_info), info->id);
+	if (idx != DARRAY_INVALID)
+		defaults = type_index_get_defaults(&obs->output_index, idx,
+				info->get_defaults);
+	pthread_mutex_unlock(&obs->types_mutex);
+
+	obs_data_apply_defaults(settings, defaults);
+	obs_data_release(defaults);
 }
 
 const char *obs_output_get_display_name(const char *id)
 {
-	const struct obs_output_info *info = find_output(id);
+	struct obs_output_info info_data;
+	const struct obs_output_info *info = copy_output_info(id, &info_data);
 	return (info != NULL) ? info->get_name(info->type_data) : NULL;
 }
 
@@ -97,7 +131,10 @@ static bool init_output_handlers(struct obs_output *output, const char *name,
 obs_output_t *obs_output_create(const char *id, const char *name,
 		obs_data_t *settings, obs_data_t *hotkey_data)
 {
-	const struct obs_output_info *info = find_output(id);
+	load_deferred_type(OBS_OBJ_TYPE_OUTPUT, id);
+
+	struct obs_output_info info_data;
+	const struct obs_output_info *info = copy_output_info(id, &info_data);
 	struct obs_output *output;
 	int ret;
 
@@ -129,8 +166,8 @@ obs_output_t *obs_output_create(const char *id, const char *name,
 	}
 	output->video    = obs_get_video();
 	output->audio    = obs_get_audio();
-	if (output->info.get_defaults)
-		output->info.get_defaults(output->context.settings);
+	if (info)
+		apply_defaults(info, output->context.settings);
 
 	ret = os_event_init(&output->reconnect_stop_event,
 			OS_EVENT_TYPE_MANUAL);
@@ -421,20 +458,25 @@ bool obs_output_active(const obs_output_t *output)
 static inline obs_data_t *get_defaults(const struct obs_output_info *info)
 {
 	obs_data_t *settings = obs_data_create();
-	if (info->get_defaults)
-		info->get_defaults(settings);
+	apply_defaults(info, settings);
 	return settings;
 }
 
 obs_data_t *obs_output_defaults(const char *id)
 {
-	const struct obs_output_info *info = find_output(id);
+	load_deferred_type(OBS_OBJ_TYPE_OUTPUT, id);
+
+	struct obs_output_info info_data;
+	const struct obs_output_info *info = copy_output_info(id, &info_data);
 	return (info) ? get_defaults(info) : NULL;
 }
 
 obs_properties_t *obs_get_output_properties(const char *id)
 {
-	const struct obs_output_info *info = find_output(id);
+	load_deferred_type(OBS_OBJ_TYPE_OUTPUT, id);
+
+	struct obs_output_info info_data;
+	const struct obs_output_info *info = copy_output_info(id, &info_data);
 	if (info && info->get_properties) {
 		obs_data_t       *defaults = get_defaults(info);
 		obs_properties_t *properties;
@@ -1328,35 +1370,6 @@ static bool initialize_interleaved_packets(struct obs_output *output)
 	return true;
 }
 
-static inline void insert_interleaved_packet(struct obs_output *output,
-		struct encoder_packet *out)
-{
-	size_t idx;
-	for (idx = 0; idx < output->interleaved_packets.num; idx++) {
-		struct encoder_packet *cur_packet;
-		cur_packet = output->interleaved_packets.array + idx;
-
-		if (out->dts_usec < cur_packet->dts_usec)
-			break;
-	}
-
-	da_insert(output->interleaved_packets, idx, out);
-}
-
-static void resort_interleaved_packets(struct obs_output *output)
-{
-	DARRAY(struct encoder_packet) old_array;
-
-	old_array.da = output->interleaved_packets.da;
-	memset(&output->interleaved_packets, 0,
-			sizeof(output->interleaved_packets));
-
-	for (size_t i = 0; i < old_array.num; i++)
-		insert_interleaved_packet(output, &old_array.array[i]);
-
-	da_free(old_array);
-}
-
 static void discard_unused_audio_packets(struct obs_output *output,
 		int64_t dts_usec)
 {
@@ -1374,6 +1387,7 @@ static void discard_unused_audio_packets(struct obs_output *output,
 		discard_to_idx(output, idx);
 }
 
+static const char *interleave_packets_name = "interleave_packets";
 static void interleave_packets(void *data, struct encoder_packet *packet)
 {
 	struct obs_output     *output = data;
@@ -1412,7 +1426,9 @@ static void interleave_packets(void *data, struct encoder_packet *packet)
 	else
 		check_received(output, packet);
 
-	insert_interleaved_packet(output, &out);
+	profile_start(interleave_packets_name);
+
+	interleave_insert_packet(&output->interleaved_packets.da, &out);
 	set_higher_ts(output, &out);
 
 	/* when both video and audio have been received, we're ready
@@ -1421,7 +1437,8 @@ static void interleave_packets(void *data, struct encoder_packet *packet)
 		if (!was_started) {
 			if (prune_interleaved_packets(output)) {
 				if (initialize_interleaved_packets(output)) {
-					resort_interleaved_packets(output);
+					interleave_merge_tracks(
+						&output->interleaved_packets.da);
 					send_interleaved(output);
 				}
 			}
@@ -1430,6 +1447,8 @@ static void interleave_packets(void *data, struct encoder_packet *packet)
 		}
 	}
 
+	profile_end(interleave_packets_name);
+
 	pthread_mutex_unlock(&output->interleaved_mutex);
 }
 
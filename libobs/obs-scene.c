@@ -159,6 +159,7 @@ static void scene_destroy(void *data)
 
 	pthread_mutex_destroy(&scene->video_mutex);
 	pthread_mutex_destroy(&scene->audio_mutex);
+	da_free(scene->sprites);
 	bfree(scene);
 }
 
@@ -311,6 +312,13 @@ static inline uint32_t calc_cy(const struct obs_scene_item *item,
 	return (crop_cy > height) ? 2 : (height - crop_cy);
 }
 
+/* the scene saves its items, so item changes change its saved state */
+static inline void set_scene_dirty(struct obs_scene_item *item)
+{
+	if (item->parent)
+		obs_source_set_dirty(item->parent->source);
+}
+
 static void update_item_transform(struct obs_scene_item *item)
 {
 	uint32_t        width         = obs_source_get_width(item->source);
@@ -462,8 +470,99 @@ static void render_item_texture(struct obs_scene_item *item)
 		obs_source_draw(tex, 0, 0, 0, 0, 0);
 }
 
+/* number of scene items being rendered without a texture of their own, in
+ * which case a nested scene's items are not clipped to its canvas.  only
+ * accessed from the graphics thread. */
+static long unclipped_depth = 0;
+
+/* scenes are the size of the main canvas, other canvases composite them at
+ * their own base size */
+static inline const struct obs_canvas *get_render_canvas(void)
+{
+	const struct obs_canvas *canvas = obs->video.render_canvas;
+	return canvas ? canvas : &obs->video.main_canvas;
+}
+
+static inline bool render_canvas_is_scene_sized(void)
+{
+	const struct obs_canvas *canvas = get_render_canvas();
+	const struct obs_canvas *main_canvas = &obs->video.main_canvas;
+
+	return canvas->base_width  == main_canvas->base_width &&
+	       canvas->base_height == main_canvas->base_height;
+}
+
+bool obs_scene_render_clipped(void)
+{
+	return unclipped_depth == 0 && render_canvas_is_scene_sized();
+}
+
+/* item textures that render_item_texture draws with the default effect and
+ * sampler */
+static inline bool item_texture_batchable(const struct obs_scene_item *item)
+{
+	enum obs_scale_type type = item->scale_filter;
+
+	if (type == OBS_SCALE_DISABLE)
+		return true;
+
+	return type != OBS_SCALE_POINT &&
+		close_float(item->output_scale.x, 1.0f, EPSILON) &&
+		close_float(item->output_scale.y, 1.0f, EPSILON);
+}
+
+static void flush_sprites(struct obs_scene *scene)
+{
+	gs_effect_t *effect = obs->video.default_effect;
+	gs_eparam_t *image;
+
+	if (!scene->sprites.num)
+		return;
+
+	image = gs_effect_get_param_by_name(effect, "image");
+
+	/* render cache textures hold premultiplied color, with alpha already
+	 * composited by render_to_cache */
+	if (scene->sprites_premultiplied) {
+		gs_blend_state_push();
+		gs_blend_function_separate(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA,
+				GS_BLEND_ONE, GS_BLEND_ONE);
+	}
+
+	while (gs_effect_loop(effect, "Draw"))
+		gs_draw_sprites(image, scene->sprites.array,
+				scene->sprites.num);
+
+	if (scene->sprites_premultiplied)
+		gs_blend_state_pop();
+
+	da_resize(scene->sprites, 0);
+}
+
+/* consecutive items that only draw a texture with the same blend state are
+ * drawn with a single vertex buffer.  there is no texture atlas, so items
+ * with different textures still take one draw call each, only items that
+ * share a texture (such as several items of the same cached source) are
+ * drawn with a single call. */
+static void add_sprite(struct obs_scene_item *item, gs_texture_t *tex,
+		bool premultiplied)
+{
+	struct obs_scene *scene = item->parent;
+	struct gs_sprite *sprite;
+
+	if (scene->sprites.num && scene->sprites_premultiplied != premultiplied)
+		flush_sprites(scene);
+
+	sprite = da_push_back_new(scene->sprites);
+	sprite->tex = tex;
+	sprite->transform = &item->draw_transform;
+	scene->sprites_premultiplied = premultiplied;
+}
+
 static inline void render_item(struct obs_scene_item *item)
 {
+	gs_texture_t *tex;
+
 	if (item->item_render) {
 		uint32_t width  = obs_source_get_width(item->source);
 		uint32_t height = obs_source_get_height(item->source);
@@ -489,18 +588,170 @@ static inline void render_item(struct obs_scene_item *item)
 			obs_source_video_render(item->source);
 			gs_texrender_end(item->item_render);
 		}
+
+		if (item_texture_batchable(item)) {
+			tex = gs_texrender_get_texture(item->item_render);
+			if (tex)
+				add_sprite(item, tex, false);
+			return;
+		}
+	} else {
+		unclipped_depth++;
+		tex = obs_source_video_render_cache(item->source);
+		unclipped_depth--;
+
+		if (tex) {
+			add_sprite(item, tex, true);
+			return;
+		}
 	}
 
+	/* everything else is drawn in order with the pending sprites */
+	flush_sprites(item->parent);
+
 	gs_matrix_push();
 	gs_matrix_mul(&item->draw_transform);
 	if (item->item_render) {
 		render_item_texture(item);
 	} else {
-		obs_source_video_render(item->source);
+		unclipped_depth++;
+		obs_source_video_render_uncached(item->source);
+		unclipped_depth--;
 	}
 	gs_matrix_pop();
 }
 
+/* ------------------------------------------------------------------------- */
+/* culling */
+
+#define MAX_OCCLUDERS 8
+
+struct cull_rect {
+	struct vec2 min;
+	struct vec2 max;
+};
+
+/* gets the area the item draws to in scene coordinates, returns false if
+ * the item is rotated to something other than a multiple of 90 degrees */
+static bool get_item_rect(const struct obs_scene_item *item,
+		struct cull_rect *rect)
+{
+	const struct matrix4 *m = &item->draw_transform;
+	uint32_t cx = calc_cx(item, obs_source_get_width(item->source));
+	uint32_t cy = calc_cy(item, obs_source_get_height(item->source));
+	struct vec3 corners[4];
+
+	vec3_set(&corners[0], 0.0f,      0.0f,      0.0f);
+	vec3_set(&corners[1], (float)cx, 0.0f,      0.0f);
+	vec3_set(&corners[2], 0.0f,      (float)cy, 0.0f);
+	vec3_set(&corners[3], (float)cx, (float)cy, 0.0f);
+
+	vec2_set(&rect->min, M_INFINITE, M_INFINITE);
+	vec2_set(&rect->max, -M_INFINITE, -M_INFINITE);
+
+	for (size_t i = 0; i < 4; i++) {
+		struct vec3 pos;
+		vec3_transform(&pos, &corners[i], m);
+
+		if (pos.x < rect->min.x) rect->min.x = pos.x;
+		if (pos.y < rect->min.y) rect->min.y = pos.y;
+		if (pos.x > rect->max.x) rect->max.x = pos.x;
+		if (pos.y > rect->max.y) rect->max.y = pos.y;
+	}
+
+	return close_float(m->x.y, 0.0f, EPSILON) &&
+	       close_float(m->y.x, 0.0f, EPSILON);
+}
+
+static inline bool item_is_opaque(const struct obs_scene_item *item)
+{
+	const struct obs_source *source = item->source;
+	uint32_t flags = source->info.output_flags;
+
+	if (!source->enabled)
+		return false;
+
+	/* filters can add transparency */
+	if (source->filters.num)
+		return false;
+
+	/* async sources draw their current frame over their whole area, so
+	 * they are opaque whenever that frame has no alpha channel */
+	if ((flags & OBS_SOURCE_ASYNC) != 0) {
+		if (!source->async_active || !source->async_texture)
+			return false;
+
+		return source->async_format != VIDEO_FORMAT_RGBA &&
+		       source->async_format != VIDEO_FORMAT_BGRA;
+	}
+
+	if ((flags & OBS_SOURCE_OPAQUE) == 0 || !source->context.data)
+		return false;
+
+	return !source->info.video_opaque ||
+	       source->info.video_opaque(source->context.data);
+}
+
+static inline bool rect_contains(const struct cull_rect *outer,
+		const struct cull_rect *inner)
+{
+	return inner->min.x >= outer->min.x && inner->max.x <= outer->max.x &&
+	       inner->min.y >= outer->min.y && inner->max.y <= outer->max.y;
+}
+
+static inline bool rect_outside(const struct cull_rect *rect, float cx,
+		float cy)
+{
+	return rect->max.x <= 0.0f || rect->min.x >= cx ||
+	       rect->max.y <= 0.0f || rect->min.y >= cy;
+}
+
+/* marks items that cannot contribute a pixel, walking front to back: items
+ * outside of the canvas, and items inside the area of an opaque item above
+ * them.  items outside of the canvas are only culled when the scene is
+ * clipped to its canvas. */
+static long cull_items(struct obs_scene_item *last)
+{
+	struct cull_rect occluders[MAX_OCCLUDERS];
+	size_t num_occluders = 0;
+	bool clipped = obs_scene_render_clipped();
+	float canvas_cx = (float)obs->video.main_canvas.base_width;
+	float canvas_cy = (float)obs->video.main_canvas.base_height;
+	long culled = 0;
+
+	for (struct obs_scene_item *item = last; item; item = item->prev) {
+		struct cull_rect rect;
+		bool axis_aligned;
+
+		item->culled = false;
+		if (!item->user_visible)
+			continue;
+
+		axis_aligned = get_item_rect(item, &rect);
+
+		if (clipped && rect_outside(&rect, canvas_cx, canvas_cy))
+			item->culled = true;
+
+		for (size_t i = 0; !item->culled && i < num_occluders; i++) {
+			if (rect_contains(&occluders[i], &rect))
+				item->culled = true;
+		}
+
+		if (item->culled) {
+			culled++;
+			continue;
+		}
+
+		if (axis_aligned && num_occluders < MAX_OCCLUDERS &&
+		    item_is_opaque(item))
+			occluders[num_occluders++] = rect;
+	}
+
+	return culled;
+}
+
+/* ------------------------------------------------------------------------- */
+
 static void scene_video_tick(void *data, float seconds)
 {
 	struct obs_scene *scene = data;
@@ -523,15 +774,13 @@ static void scene_video_render(void *data, gs_effect_t *effect)
 	DARRAY(struct obs_scene_item*) remove_items;
 	struct obs_scene *scene = data;
 	struct obs_scene_item *item;
+	struct obs_scene_item *last = NULL;
 
 	da_init(remove_items);
 
 	video_lock(scene);
 	item = scene->first_item;
 
-	gs_blend_state_push();
-	gs_reset_blend_state();
-
 	while (item) {
 		if (obs_source_removed(item->source)) {
 			struct obs_scene_item *del_item = item;
@@ -545,12 +794,21 @@ static void scene_video_render(void *data, gs_effect_t *effect)
 		if (source_size_changed(item))
 			update_item_transform(item);
 
-		if (item->user_visible)
-			render_item(item);
-
+		last = item;
 		item = item->next;
 	}
 
+	os_atomic_set_long(&scene->culled_items, cull_items(last));
+
+	gs_blend_state_push();
+	gs_reset_blend_state();
+
+	for (item = scene->first_item; item; item = item->next) {
+		if (item->user_visible && !item->culled)
+			render_item(item);
+	}
+
+	flush_sprites(scene);
 	gs_blend_state_pop();
 
 	video_unlock(scene);
@@ -756,13 +1014,13 @@ static void scene_save(void *data, obs_data_t *settings)
 static uint32_t scene_getwidth(void *data)
 {
 	UNUSED_PARAMETER(data);
-	return obs->video.base_width;
+	return obs->video.main_canvas.base_width;
 }
 
 static uint32_t scene_getheight(void *data)
 {
 	UNUSED_PARAMETER(data);
-	return obs->video.base_height;
+	return obs->video.main_canvas.base_height;
 }
 
 static void apply_scene_item_audio_actions(struct obs_scene_item *item,
@@ -1154,6 +1412,14 @@ obs_scene_t *obs_scene_from_source(const obs_source_t *source)
 	return source->context.data;
 }
 
+size_t obs_scene_get_culled_item_count(const obs_scene_t *scene)
+{
+	if (!obs_ptr_valid(scene, "obs_scene_get_culled_item_count"))
+		return 0;
+
+	return (size_t)os_atomic_load_long(&scene->culled_items);
+}
+
 obs_sceneitem_t *obs_scene_find_source(obs_scene_t *scene, const char *name)
 {
 	struct obs_scene_item *item;
@@ -1387,6 +1653,8 @@ obs_sceneitem_t *obs_scene_add(obs_scene_t *scene, obs_source_t *source)
 
 	full_unlock(scene);
 
+	obs_source_set_dirty(scene->source);
+
 	if (!scene->source->context.private)
 		init_hotkeys(scene, item, obs_source_get_name(source));
 
@@ -1460,6 +1728,8 @@ void obs_sceneitem_remove(obs_sceneitem_t *item)
 
 	full_unlock(scene);
 
+	obs_source_set_dirty(scene->source);
+
 	obs_sceneitem_release(item);
 }
 
@@ -1501,6 +1771,7 @@ void obs_sceneitem_set_pos(obs_sceneitem_t *item, const struct vec2 *pos)
 	if (item) {
 		vec2_copy(&item->pos, pos);
 		update_item_transform(item);
+		set_scene_dirty(item);
 	}
 }
 
@@ -1509,6 +1780,7 @@ void obs_sceneitem_set_rot(obs_sceneitem_t *item, float rot)
 	if (item) {
 		item->rot = rot;
 		update_item_transform(item);
+		set_scene_dirty(item);
 	}
 }
 
@@ -1517,6 +1789,7 @@ void obs_sceneitem_set_scale(obs_sceneitem_t *item, const struct vec2 *scale)
 	if (item) {
 		vec2_copy(&item->scale, scale);
 		update_item_transform(item);
+		set_scene_dirty(item);
 	}
 }
 
@@ -1525,6 +1798,7 @@ void obs_sceneitem_set_alignment(obs_sceneitem_t *item, uint32_t alignment)
 	if (item) {
 		item->align = alignment;
 		update_item_transform(item);
+		set_scene_dirty(item);
 	}
 }
 
@@ -1583,6 +1857,8 @@ void obs_sceneitem_set_order(obs_sceneitem_t *item,
 	signal_reorder(item);
 
 	full_unlock(scene);
+
+	obs_source_set_dirty(scene->source);
 	obs_scene_release(scene);
 }
 
@@ -1615,6 +1891,8 @@ void obs_sceneitem_set_order_position(obs_sceneitem_t *item,
 	signal_reorder(item);
 
 	full_unlock(scene);
+
+	obs_source_set_dirty(scene->source);
 	obs_scene_release(scene);
 }
 
@@ -1624,6 +1902,7 @@ void obs_sceneitem_set_bounds_type(obs_sceneitem_t *item,
 	if (item) {
 		item->bounds_type = type;
 		update_item_transform(item);
+		set_scene_dirty(item);
 	}
 }
 
@@ -1633,6 +1912,7 @@ void obs_sceneitem_set_bounds_alignment(obs_sceneitem_t *item,
 	if (item) {
 		item->bounds_align = alignment;
 		update_item_transform(item);
+		set_scene_dirty(item);
 	}
 }
 
@@ -1641,6 +1921,7 @@ void obs_sceneitem_set_bounds(obs_sceneitem_t *item, const struct vec2 *bounds)
 	if (item) {
 		item->bounds = *bounds;
 		update_item_transform(item);
+		set_scene_dirty(item);
 	}
 }
 
@@ -1708,6 +1989,7 @@ void obs_sceneitem_set_info(obs_sceneitem_t *item,
 		item->bounds_align = info->bounds_alignment;
 		item->bounds       = info->bounds;
 		update_item_transform(item);
+		set_scene_dirty(item);
 	}
 }
 
@@ -1759,6 +2041,7 @@ bool obs_sceneitem_set_visible(obs_sceneitem_t *item, bool visible)
 	}
 
 	item->user_visible = visible;
+	set_scene_dirty(item);
 
 	calldata_init_fixed(&cd, stack, sizeof(stack));
 	calldata_set_ptr(&cd, "scene", item->parent);
@@ -1795,6 +2078,7 @@ bool obs_sceneitem_set_locked(obs_sceneitem_t *item, bool lock)
 		return false;
 
 	item->locked = lock;
+	set_scene_dirty(item);
 
 	return true;
 }
@@ -1921,6 +2205,7 @@ void obs_sceneitem_set_crop(obs_sceneitem_t *item,
 	obs_leave_graphics();
 
 	update_item_transform(item);
+	set_scene_dirty(item);
 }
 
 void obs_sceneitem_get_crop(const obs_sceneitem_t *item,
@@ -1955,6 +2240,7 @@ void obs_sceneitem_set_scale_filter(obs_sceneitem_t *item,
 	obs_leave_graphics();
 
 	update_item_transform(item);
+	set_scene_dirty(item);
 }
 
 enum obs_scale_type obs_sceneitem_get_scale_filter(
@@ -43,6 +43,9 @@ struct obs_scene_item {
 	bool                  selected;
 	bool                  locked;
 
+	/* set by the culling pass each frame, graphics thread only */
+	bool                  culled;
+
 	gs_texrender_t        *item_render;
 	struct obs_sceneitem_crop crop;
 
@@ -84,4 +87,12 @@ struct obs_scene {
 	pthread_mutex_t       video_mutex;
 	pthread_mutex_t       audio_mutex;
 	struct obs_scene_item *first_item;
+
+	/* number of items skipped by the culling pass in the last frame */
+	volatile long         culled_items;
+
+	/* items drawn as plain textures with the default effect, waiting to
+	 * be drawn together.  graphics thread only. */
+	DARRAY(struct gs_sprite) sprites;
+	bool                  sprites_premultiplied;
 };
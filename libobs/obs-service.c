@@ -19,17 +19,50 @@
 
 const struct obs_service_info *find_service(const char *id)
 {
-	size_t i;
-	for (i = 0; i < obs->service_types.num; i++)
-		if (strcmp(obs->service_types.array[i].id, id) == 0)
-			return obs->service_types.array+i;
+	size_t idx = type_index_find(&obs->service_index,
+			&obs->service_types.da, sizeof(struct obs_service_info),
+			id);
+	return (idx != DARRAY_INVALID) ? obs->service_types.array+idx : NULL;
+}
 
-	return NULL;
+/* the type arrays change when a deferred module is loaded, so other code
+ * works with a copy of the type info */
+static const struct obs_service_info *copy_service_info(const char *id,
+		struct obs_service_info *info)
+{
+	const struct obs_service_info *found;
+
+	pthread_mutex_lock(&obs->types_mutex);
+	found = find_service(id);
+	if (found)
+		*info = *found;
+	pthread_mutex_unlock(&obs->types_mutex);
+
+	return found ? info : NULL;
+}
+
+/* applies the cached defaults of a registered type to settings */
+static void apply_defaults(const struct obs_service_info *info, obs_data_t *settings)
+{
+	obs_data_t *defaults = NULL;
+	size_t idx;
+
+	pthread_mutex_lock(&obs->types_mutex);
+	idx = type_index_find(&obs->service_index, &obs->service_types.da,
+			sizeof(struct obs_service_info), info->id);
+	if (idx != DARRAY_INVALID)
+		defaults = type_index_get_defaults(&obs->service_index, idx,
+				info->get_defaults);
+	pthread_mutex_unlock(&obs->types_mutex);
+
+	obs_data_apply_defaults(settings, defaults);
+	obs_data_release(defaults);
 }
 
 const char *obs_service_get_display_name(const char *id)
 {
-	const struct obs_service_info *info = find_service(id);
+	struct obs_service_info info_data;
+	const struct obs_service_info *info = copy_service_info(id, &info_data);
 	return (info != NULL) ? info->get_name(info->type_data) : NULL;
 }
 
@@ -37,7 +70,10 @@ static obs_service_t *obs_service_create_internal(const char *id,
 		const char *name, obs_data_t *settings, obs_data_t *hotkey_data,
 		bool private)
 {
-	const struct obs_service_info *info = find_service(id);
+	load_deferred_type(OBS_OBJ_TYPE_SERVICE, id);
+
+	struct obs_service_info info_data;
+	const struct obs_service_info *info = copy_service_info(id, &info_data);
 	struct obs_service *service;
 
 	if (!info) {
@@ -122,20 +158,25 @@ const char *obs_service_get_name(const obs_service_t *service)
 static inline obs_data_t *get_defaults(const struct obs_service_info *info)
 {
 	obs_data_t *settings = obs_data_create();
-	if (info->get_defaults)
-		info->get_defaults(settings);
+	apply_defaults(info, settings);
 	return settings;
 }
 
 obs_data_t *obs_service_defaults(const char *id)
 {
-	const struct obs_service_info *info = find_service(id);
+	load_deferred_type(OBS_OBJ_TYPE_SERVICE, id);
+
+	struct obs_service_info info_data;
+	const struct obs_service_info *info = copy_service_info(id, &info_data);
 	return (info) ? get_defaults(info) : NULL;
 }
 
 obs_properties_t *obs_get_service_properties(const char *id)
 {
-	const struct obs_service_info *info = find_service(id);
+	load_deferred_type(OBS_OBJ_TYPE_SERVICE, id);
+
+	struct obs_service_info info_data;
+	const struct obs_service_info *info = copy_service_info(id, &info_data);
 	if (info && info->get_properties) {
 		obs_data_t       *defaults = get_defaults(info);
 		obs_properties_t *properties;
@@ -131,7 +131,7 @@ static inline void deinterlace_get_closest_frames(obs_source_t *s,
 	if (!s->async_frames.num)
 		return;
 
-	info = video_output_get_info(obs->video.video);
+	info = video_output_get_info(obs->video.main_canvas.video);
 	half_interval = (uint64_t)info->fps_den * 500000000ULL /
 		(uint64_t)info->fps_num;
 
@@ -414,6 +414,8 @@ void obs_source_set_deinterlace_mode(obs_source_t *source,
 		source->deinterlace_effect = get_effect(mode);
 		obs_leave_graphics();
 	}
+
+	obs_source_set_dirty(source);
 }
 
 enum obs_deinterlace_mode obs_source_get_deinterlace_mode(
@@ -431,6 +433,7 @@ void obs_source_set_deinterlace_field_order(obs_source_t *source,
 
 	source->deinterlace_top_first =
 		field_order == OBS_DEINTERLACE_FIELD_ORDER_TOP;
+	obs_source_set_dirty(source);
 }
 
 enum obs_deinterlace_field_order obs_source_get_deinterlace_field_order(
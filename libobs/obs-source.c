@@ -18,6 +18,7 @@
 #include <inttypes.h>
 
 #include "media-io/format-conversion.h"
+#include "media-io/audio-conversion.h"
 #include "media-io/video-frame.h"
 #include "media-io/audio-io.h"
 #include "util/threading.h"
@@ -29,9 +30,31 @@
 #include "obs.h"
 #include "obs-internal.h"
 
+static inline bool create_pending(const struct obs_source *source)
+{
+	return os_atomic_load_bool(&source->create_pending);
+}
+
 static inline bool data_valid(const struct obs_source *source, const char *f)
 {
-	return obs_source_valid(source, f) && source->context.data;
+	return obs_source_valid(source, f) && !create_pending(source) &&
+		source->context.data;
+}
+
+void obs_source_set_dirty(obs_source_t *source)
+{
+	while (source) {
+		os_atomic_inc_long(&source->save_gen);
+		source = source->filter_parent;
+	}
+}
+
+void obs_source_invalidate_content(obs_source_t *source)
+{
+	while (source) {
+		os_atomic_set_bool(&source->content_changed, true);
+		source = source->filter_parent;
+	}
 }
 
 static inline bool deinterlacing_enabled(const struct obs_source *source)
@@ -41,13 +64,51 @@ static inline bool deinterlacing_enabled(const struct obs_source *source)
 
 const struct obs_source_info *get_source_info(const char *id)
 {
-	for (size_t i = 0; i < obs->source_types.num; i++) {
-		struct obs_source_info *info = &obs->source_types.array[i];
-		if (strcmp(info->id, id) == 0)
-			return info;
+	size_t idx = type_index_find(&obs->source_index,
+			&obs->source_types.da, sizeof(struct obs_source_info),
+			id);
+	return (idx != DARRAY_INVALID) ? &obs->source_types.array[idx] : NULL;
+}
+
+/* the type arrays change when a deferred module is loaded, so other code
+ * works with a copy of the type info */
+static const struct obs_source_info *copy_source_info(const char *id,
+		struct obs_source_info *info)
+{
+	const struct obs_source_info *found;
+
+	pthread_mutex_lock(&obs->types_mutex);
+	found = get_source_info(id);
+	if (found)
+		*info = *found;
+	pthread_mutex_unlock(&obs->types_mutex);
+
+	return found ? info : NULL;
+}
+
+/* applies the defaults of a registered type to settings, they are cached
+ * unless the type marks them as dynamic */
+static void apply_defaults(const struct obs_source_info *info, obs_data_t *settings)
+{
+	obs_data_t *defaults = NULL;
+	size_t idx;
+
+	if ((info->output_flags & OBS_SOURCE_DYNAMIC_DEFAULTS) != 0) {
+		if (info->get_defaults)
+			info->get_defaults(settings);
+		return;
 	}
 
-	return NULL;
+	pthread_mutex_lock(&obs->types_mutex);
+	idx = type_index_find(&obs->source_index, &obs->source_types.da,
+			sizeof(struct obs_source_info), info->id);
+	if (idx != DARRAY_INVALID)
+		defaults = type_index_get_defaults(&obs->source_index, idx,
+				info->get_defaults);
+	pthread_mutex_unlock(&obs->types_mutex);
+
+	obs_data_apply_defaults(settings, defaults);
+	obs_data_release(defaults);
 }
 
 static const char *source_signals[] = {
@@ -94,7 +155,8 @@ bool obs_source_init_context(struct obs_source *source,
 
 const char *obs_source_get_display_name(const char *id)
 {
-	const struct obs_source_info *info = get_source_info(id);
+	struct obs_source_info info_data;
+	const struct obs_source_info *info = copy_source_info(id, &info_data);
 	return (info != NULL) ? info->get_name(info->type_data) : NULL;
 }
 
@@ -290,13 +352,32 @@ static void obs_source_init_audio_hotkeys(struct obs_source *source)
 			obs_source_hotkey_push_to_talk, source);
 }
 
+static void obs_source_call_create(struct obs_source *source)
+{
+	void *data = NULL;
+
+	/* allow the source to be created even if creation fails so that the
+	 * user's data doesn't become lost */
+	if (source->info.create)
+		data = source->info.create(source->context.settings, source);
+
+	/* may run on a create thread while the source is already listed */
+	os_atomic_set_ptr(&source->context.data, data);
+	if (!data)
+		blog(LOG_ERROR, "Failed to create source '%s'!",
+				source->context.name);
+}
+
 static obs_source_t *obs_source_create_internal(const char *id,
 		const char *name, obs_data_t *settings,
-		obs_data_t *hotkey_data, bool private)
+		obs_data_t *hotkey_data, bool private, bool defer)
 {
 	struct obs_source *source = bzalloc(sizeof(struct obs_source));
 
-	const struct obs_source_info *info = get_source_info(id);
+	load_deferred_type(OBS_OBJ_TYPE_SOURCE, id);
+
+	struct obs_source_info info_data;
+	const struct obs_source_info *info = copy_source_info(id, &info_data);
 	if (!info) {
 		blog(LOG_ERROR, "Source ID '%s' not found", id);
 
@@ -317,12 +398,17 @@ static obs_source_t *obs_source_create_internal(const char *id,
 	source->push_to_mute_key = OBS_INVALID_HOTKEY_ID;
 	source->push_to_talk_key = OBS_INVALID_HOTKEY_ID;
 
+	/* set before the source is added to the source list */
+	if (defer && info &&
+	    (info->output_flags & OBS_SOURCE_CREATE_THREADSAFE) != 0)
+		source->create_pending = true;
+
 	if (!obs_source_init_context(source, settings, name, hotkey_data,
 				private))
 		goto fail;
 
-	if (info && info->get_defaults)
-		info->get_defaults(source->context.settings);
+	if (info)
+		apply_defaults(info, source->context.settings);
 
 	if (!obs_source_init(source))
 		goto fail;
@@ -330,20 +416,24 @@ static obs_source_t *obs_source_create_internal(const char *id,
 	if (!private)
 		obs_source_init_audio_hotkeys(source);
 
-	/* allow the source to be created even if creation fails so that the
-	 * user's data doesn't become lost */
-	if (info)
-		source->context.data = info->create(source->context.settings,
-				source);
-	if (!source->context.data)
-		blog(LOG_ERROR, "Failed to create source '%s'!", name);
+	source->enabled = true;
+
+	if (source->create_pending)
+		return source;
+
+	obs_source_call_create(source);
+	source->flags = source->default_flags;
+
+	/* sources created while loading signal in load order once all of
+	 * them exist, see obs_source_deferred_finish */
+	if (defer) {
+		source->create_signal_pending = true;
+		return source;
+	}
 
 	blog(LOG_DEBUG, "%ssource '%s' (%s) created",
 			private ? "private " : "", name, id);
 	obs_source_dosignal(source, "source_create", NULL);
-
-	source->flags = source->default_flags;
-	source->enabled = true;
 	return source;
 
 fail:
@@ -356,13 +446,47 @@ obs_source_t *obs_source_create(const char *id, const char *name,
 		obs_data_t *settings, obs_data_t *hotkey_data)
 {
 	return obs_source_create_internal(id, name, settings, hotkey_data,
-			false);
+			false, false);
 }
 
 obs_source_t *obs_source_create_private(const char *id, const char *name,
 		obs_data_t *settings)
 {
-	return obs_source_create_internal(id, name, settings, NULL, true);
+	return obs_source_create_internal(id, name, settings, NULL, true,
+			false);
+}
+
+obs_source_t *obs_source_create_deferred(const char *id, const char *name,
+		obs_data_t *settings, obs_data_t *hotkey_data)
+{
+	return obs_source_create_internal(id, name, settings, hotkey_data,
+			false, true);
+}
+
+void obs_source_deferred_create(obs_source_t *source)
+{
+	if (source && create_pending(source))
+		obs_source_call_create(source);
+}
+
+void obs_source_deferred_finish(obs_source_t *source)
+{
+	if (!source)
+		return;
+
+	if (create_pending(source)) {
+		os_atomic_set_bool(&source->create_pending, false);
+		source->create_signal_pending = true;
+	}
+
+	if (!source->create_signal_pending)
+		return;
+
+	source->create_signal_pending = false;
+
+	blog(LOG_DEBUG, "source '%s' (%s) created", source->context.name,
+			source->info.id);
+	obs_source_dosignal(source, "source_create", NULL);
 }
 
 static char *get_new_filter_name(obs_source_t *dst, const char *name)
@@ -490,10 +614,62 @@ void obs_source_frame_init(struct obs_source_frame *frame,
 	}
 }
 
-static inline void obs_source_frame_decref(struct obs_source_frame *frame)
+/* frames that use the memory of the source are looked up in
+ * async_releases, which is protected by async_mutex */
+static inline struct async_release *find_async_release(obs_source_t *source,
+		const struct obs_source_frame *frame)
 {
-	if (os_atomic_dec_long(&frame->refs) == 0)
+	for (size_t i = 0; i < source->async_releases.num; i++) {
+		struct async_release *ar = &source->async_releases.array[i];
+		if (ar->frame == frame)
+			return ar;
+	}
+
+	return NULL;
+}
+
+static struct obs_source_frame *async_frame_create_external(
+		obs_source_t *source, const struct obs_source_frame *frame,
+		void (*release)(void *param), void *param)
+{
+	struct obs_source_frame *new_frame = bzalloc(sizeof(*new_frame));
+	struct async_release *ar;
+
+	*new_frame = *frame;
+	new_frame->refs = 1;
+	new_frame->prev_frame = false;
+
+	ar = da_push_back_new(source->async_releases);
+	ar->frame = new_frame;
+	ar->release = release;
+	ar->param = param;
+	return new_frame;
+}
+
+static void async_frame_destroy(obs_source_t *source,
+		struct obs_source_frame *frame)
+{
+	struct async_release *ar = source ?
+		find_async_release(source, frame) : NULL;
+
+	if (ar) {
+		void (*release)(void *param) = ar->release;
+		void *param = ar->param;
+
+		da_erase(source->async_releases,
+				ar - source->async_releases.array);
+		release(param);
+		bfree(frame);
+	} else {
 		obs_source_frame_destroy(frame);
+	}
+}
+
+static inline void obs_source_frame_decref(obs_source_t *source,
+		struct obs_source_frame *frame)
+{
+	if (os_atomic_dec_long(&frame->refs) == 0)
+		async_frame_destroy(source, frame);
 }
 
 static bool obs_source_filter_remove_refless(obs_source_t *source,
@@ -544,7 +720,8 @@ void obs_source_destroy(struct obs_source *source)
 	obs_hotkey_pair_unregister(source->mute_unmute_key);
 
 	for (i = 0; i < source->async_cache.num; i++)
-		obs_source_frame_decref(source->async_cache.array[i].frame);
+		obs_source_frame_decref(source,
+				source->async_cache.array[i].frame);
 
 	gs_enter_context(obs->video.graphics);
 	if (source->async_texrender)
@@ -557,6 +734,8 @@ void obs_source_destroy(struct obs_source *source)
 		gs_texture_destroy(source->async_prev_texture);
 	if (source->filter_texrender)
 		gs_texrender_destroy(source->filter_texrender);
+	if (source->render_cache)
+		gs_texrender_destroy(source->render_cache);
 	gs_leave_context();
 
 	for (i = 0; i < MAX_AV_PLANES; i++)
@@ -575,6 +754,7 @@ void obs_source_destroy(struct obs_source *source)
 	da_free(source->audio_cb_list);
 	da_free(source->async_cache);
 	da_free(source->async_frames);
+	da_free(source->async_releases);
 	da_free(source->filters);
 	pthread_mutex_destroy(&source->filter_mutex);
 	pthread_mutex_destroy(&source->audio_actions_mutex);
@@ -582,6 +762,7 @@ void obs_source_destroy(struct obs_source *source)
 	pthread_mutex_destroy(&source->audio_cb_mutex);
 	pthread_mutex_destroy(&source->audio_mutex);
 	pthread_mutex_destroy(&source->async_mutex);
+	obs_data_release(source->save_snapshot);
 	obs_context_data_free(&source->context);
 
 	if (source->owns_info_id)
@@ -688,26 +869,34 @@ bool obs_source_removed(const obs_source_t *source)
 static inline obs_data_t *get_defaults(const struct obs_source_info *info)
 {
 	obs_data_t *settings = obs_data_create();
-	if (info->get_defaults)
-		info->get_defaults(settings);
+	apply_defaults(info, settings);
 	return settings;
 }
 
 obs_data_t *obs_source_settings(const char *id)
 {
-	const struct obs_source_info *info = get_source_info(id);
+	load_deferred_type(OBS_OBJ_TYPE_SOURCE, id);
+
+	struct obs_source_info info_data;
+	const struct obs_source_info *info = copy_source_info(id, &info_data);
 	return (info) ? get_defaults(info) : NULL;
 }
 
 obs_data_t *obs_get_source_defaults(const char *id)
 {
-	const struct obs_source_info *info = get_source_info(id);
+	load_deferred_type(OBS_OBJ_TYPE_SOURCE, id);
+
+	struct obs_source_info info_data;
+	const struct obs_source_info *info = copy_source_info(id, &info_data);
 	return info ? get_defaults(info) : NULL;
 }
 
 obs_properties_t *obs_get_source_properties(const char *id)
 {
-	const struct obs_source_info *info = get_source_info(id);
+	load_deferred_type(OBS_OBJ_TYPE_SOURCE, id);
+
+	struct obs_source_info info_data;
+	const struct obs_source_info *info = copy_source_info(id, &info_data);
 	if (info && info->get_properties) {
 		obs_data_t       *defaults = get_defaults(info);
 		obs_properties_t *properties;
@@ -722,7 +911,8 @@ obs_properties_t *obs_get_source_properties(const char *id)
 
 bool obs_is_source_configurable(const char *id)
 {
-	const struct obs_source_info *info = get_source_info(id);
+	struct obs_source_info info_data;
+	const struct obs_source_info *info = copy_source_info(id, &info_data);
 	return info && info->get_properties;
 }
 
@@ -755,7 +945,8 @@ uint32_t obs_source_get_output_flags(const obs_source_t *source)
 
 uint32_t obs_get_source_output_flags(const char *id)
 {
-	const struct obs_source_info *info = get_source_info(id);
+	struct obs_source_info info_data;
+	const struct obs_source_info *info = copy_source_info(id, &info_data);
 	return info ? info->output_flags : 0;
 }
 
@@ -766,6 +957,7 @@ static void obs_source_deferred_update(obs_source_t *source)
 				source->context.settings);
 
 	source->defer_update = false;
+	obs_source_invalidate_content(source);
 }
 
 void obs_source_update(obs_source_t *source, obs_data_t *settings)
@@ -775,10 +967,14 @@ void obs_source_update(obs_source_t *source, obs_data_t *settings)
 
 	if (settings)
 		obs_data_apply(source->context.settings, settings);
+	obs_source_set_dirty(source);
 
+	/* a source that is still being created gets the settings from its
+	 * create callback */
 	if (source->info.output_flags & OBS_SOURCE_VIDEO) {
 		source->defer_update = true;
-	} else if (source->context.data && source->info.update) {
+	} else if (!create_pending(source) && source->context.data &&
+	           source->info.update) {
 		source->info.update(source->context.data,
 				source->context.settings);
 	}
@@ -989,12 +1185,45 @@ static void async_tick(obs_source_t *source)
 				source->cur_async_frame);
 }
 
+/* only worth caching when there are filters to skip, a static source by
+ * itself is usually a single draw */
+static bool content_is_static(obs_source_t *source)
+{
+	bool has_filters = false;
+
+	if ((source->info.output_flags & OBS_SOURCE_STATIC_CONTENT) == 0)
+		return false;
+
+	pthread_mutex_lock(&source->filter_mutex);
+
+	for (size_t i = 0; i < source->filters.num; i++) {
+		struct obs_source *filter = source->filters.array[i];
+		uint32_t flags = filter->info.output_flags;
+
+		if (!filter->enabled)
+			continue;
+		if ((flags & OBS_SOURCE_STATIC_CONTENT) == 0) {
+			has_filters = false;
+			break;
+		}
+
+		has_filters = true;
+	}
+
+	pthread_mutex_unlock(&source->filter_mutex);
+	return has_filters;
+}
+
+#define MAX_RENDER_CACHE_UNUSED_FRAMES 60
+
 void obs_source_video_tick(obs_source_t *source, float seconds)
 {
 	bool now_showing, now_active;
 
 	if (!obs_source_valid(source, "obs_source_video_tick"))
 		return;
+	if (create_pending(source))
+		return;
 
 	if (source->info.type == OBS_SOURCE_TYPE_TRANSITION)
 		obs_transition_tick(source);
@@ -1009,6 +1238,23 @@ void obs_source_video_tick(obs_source_t *source, float seconds)
 	if (source->filter_texrender)
 		gs_texrender_reset(source->filter_texrender);
 
+	/* cache the render result this frame if the source was rendered more
+	 * than once last frame.  outputs with a frame divisor only render
+	 * every few frames, so the cache is kept for a while to keep it from
+	 * being recreated all the time. */
+	if (source->render_count > 1) {
+		source->render_cache_enabled = true;
+		source->render_cache_unused_frames = 0;
+	} else if (source->render_cache_enabled &&
+	           ++source->render_cache_unused_frames >=
+	           MAX_RENDER_CACHE_UNUSED_FRAMES) {
+		source->render_cache_enabled = false;
+	}
+	source->render_count = 0;
+	source->content_static = content_is_static(source);
+	if (source->render_cache && !source->content_static)
+		gs_texrender_reset(source->render_cache);
+
 	/* call show/hide if the reference changed */
 	now_showing = !!source->show_refs;
 	if (now_showing != source->showing) {
@@ -1732,6 +1978,8 @@ static inline void render_video(obs_source_t *source)
 	if (source->info.type != OBS_SOURCE_TYPE_FILTER &&
 	    (source->info.output_flags & OBS_SOURCE_VIDEO) == 0)
 		return;
+	if (create_pending(source))
+		return;
 
 	if (source->info.type == OBS_SOURCE_TYPE_INPUT &&
 	    (source->info.output_flags & OBS_SOURCE_ASYNC) != 0 &&
@@ -1763,13 +2011,133 @@ static inline void render_video(obs_source_t *source)
 		obs_source_render_async_video(source);
 }
 
+/* sources are only cached when drawn with the default blend state, which is
+ * what the cached texture is composited with, and scenes only when their
+ * items are clipped to their canvas like the cached texture would be.  this
+ * also keeps sources that are drawn into another cache from being cached. */
+static inline bool can_cache_render(obs_source_t *source)
+{
+	if (source->info.type == OBS_SOURCE_TYPE_FILTER ||
+	    source->rendering_filter)
+		return false;
+	if ((source->info.output_flags & OBS_SOURCE_VIDEO) == 0)
+		return false;
+	if (create_pending(source))
+		return false;
+	if (obs_scene_from_source(source) && !obs_scene_render_clipped())
+		return false;
+
+	return gs_blend_state_is_reset();
+}
+
+static bool render_to_cache(obs_source_t *source, uint32_t cx, uint32_t cy)
+{
+	gs_texrender_t *cache = source->render_cache;
+
+	if (!cache) {
+		cache = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+		source->render_cache = cache;
+	}
+
+	/* size changed since it was cached this frame */
+	if (source->render_cache_cx != cx || source->render_cache_cy != cy)
+		gs_texrender_reset(cache);
+
+	if (gs_texrender_begin(cache, cx, cy)) {
+		struct vec4 clear_color;
+
+		vec4_zero(&clear_color);
+		gs_clear(GS_CLEAR_COLOR, &clear_color, 0.0f, 0);
+		gs_ortho(0.0f, (float)cx, 0.0f, (float)cy, -100.0f, 100.0f);
+
+		/* alpha is composited with "over" as well, so overlapping
+		 * translucent draws leave the coverage they have on screen
+		 * rather than adding up */
+		gs_blend_state_push();
+		gs_blend_function_separate(
+				GS_BLEND_SRCALPHA, GS_BLEND_INVSRCALPHA,
+				GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+
+		render_video(source);
+
+		gs_blend_state_pop();
+		gs_texrender_end(cache);
+
+		source->render_cache_cx = cx;
+		source->render_cache_cy = cy;
+	}
+
+	return gs_texrender_get_texture(cache) != NULL;
+}
+
+/* the cache holds premultiplied color, since the source was blended onto
+ * a transparent texture */
+static void draw_render_cache(gs_texture_t *tex)
+{
+	gs_effect_t *effect = obs->video.default_effect;
+
+	gs_blend_state_push();
+	gs_blend_function_separate(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA,
+			GS_BLEND_ONE, GS_BLEND_ONE);
+
+	while (gs_effect_loop(effect, "Draw"))
+		obs_source_draw(tex, 0, 0, 0, 0, false);
+
+	gs_blend_state_pop();
+}
+
+gs_texture_t *obs_source_video_render_cache(obs_source_t *source)
+{
+	uint32_t cx, cy;
+
+	if (!can_cache_render(source))
+		return NULL;
+
+	source->render_count++;
+
+	if (!source->render_cache_enabled && !source->content_static &&
+	    source->render_cache) {
+		gs_texrender_destroy(source->render_cache);
+		source->render_cache = NULL;
+	}
+
+	if (os_atomic_set_bool(&source->content_changed, false) &&
+	    source->render_cache)
+		gs_texrender_reset(source->render_cache);
+
+	cx = obs_source_get_width(source);
+	cy = obs_source_get_height(source);
+
+	if ((source->render_cache_enabled || source->content_static) &&
+	    cx && cy &&
+	    render_to_cache(source, cx, cy))
+		return gs_texrender_get_texture(source->render_cache);
+
+	return NULL;
+}
+
+void obs_source_video_render_uncached(obs_source_t *source)
+{
+	obs_source_addref(source);
+	render_video(source);
+	obs_source_release(source);
+}
+
 void obs_source_video_render(obs_source_t *source)
 {
+	gs_texture_t *cache;
+
 	if (!obs_source_valid(source, "obs_source_video_render"))
 		return;
 
 	obs_source_addref(source);
-	render_video(source);
+
+	cache = obs_source_video_render_cache(source);
+	if (cache)
+		draw_render_cache(cache);
+	else
+		render_video(source);
+
 	obs_source_release(source);
 }
 
@@ -1931,6 +2299,9 @@ void obs_source_filter_add(obs_source_t *source, obs_source_t *filter)
 
 	pthread_mutex_unlock(&source->filter_mutex);
 
+	obs_source_set_dirty(source);
+	obs_source_invalidate_content(source);
+
 	calldata_init_fixed(&cd, stack, sizeof(stack));
 	calldata_set_ptr(&cd, "source", source);
 	calldata_set_ptr(&cd, "filter", filter);
@@ -1966,6 +2337,8 @@ static bool obs_source_filter_remove_refless(obs_source_t *source,
 
 	pthread_mutex_unlock(&source->filter_mutex);
 
+	obs_source_invalidate_content(source);
+
 	calldata_init_fixed(&cd, stack, sizeof(stack));
 	calldata_set_ptr(&cd, "source", source);
 	calldata_set_ptr(&cd, "filter", filter);
@@ -1992,8 +2365,10 @@ void obs_source_filter_remove(obs_source_t *source, obs_source_t *filter)
 	if (!obs_ptr_valid(filter, "obs_source_filter_remove"))
 		return;
 
-	if (obs_source_filter_remove_refless(source, filter))
+	if (obs_source_filter_remove_refless(source, filter)) {
+		obs_source_set_dirty(source);
 		obs_source_release(filter);
+	}
 }
 
 static size_t find_next_filter(obs_source_t *source, obs_source_t *filter,
@@ -2092,8 +2467,11 @@ void obs_source_filter_set_order(obs_source_t *source, obs_source_t *filter,
 	success = move_filter_dir(source, filter, movement);
 	pthread_mutex_unlock(&source->filter_mutex);
 
-	if (success)
+	if (success) {
+		obs_source_set_dirty(source);
+		obs_source_invalidate_content(source);
 		obs_source_dosignal(source, NULL, "reorder_filters");
+	}
 }
 
 obs_data_t *obs_source_get_settings(const obs_source_t *source)
@@ -2105,6 +2483,46 @@ obs_data_t *obs_source_get_settings(const obs_source_t *source)
 	return source->context.settings;
 }
 
+static void copy_frame_data(struct obs_source_frame *dst,
+		const struct obs_source_frame *src);
+
+static inline bool has_async_video_filters(obs_source_t *source)
+{
+	for (size_t i = 0; i < source->filters.num; i++) {
+		struct obs_source *filter = source->filters.array[i];
+		if (filter->enabled && filter->context.data &&
+		    filter->info.filter_video)
+			return true;
+	}
+
+	return false;
+}
+
+/* filters may hold on to frames for as long as they like, so they never get
+ * the memory of the source; otherwise the source could not get its buffers
+ * back when it stops */
+static struct obs_source_frame *own_filter_frame(obs_source_t *source,
+		struct obs_source_frame *frame)
+{
+	struct obs_source_frame *copy;
+	bool external;
+
+	pthread_mutex_lock(&source->async_mutex);
+	external = find_async_release(source, frame) != NULL;
+	pthread_mutex_unlock(&source->async_mutex);
+
+	if (!external)
+		return frame;
+
+	copy = obs_source_frame_create(frame->format, frame->width,
+			frame->height);
+	copy->refs = 1;
+	copy_frame_data(copy, frame);
+
+	obs_source_release_frame(source, frame);
+	return copy;
+}
+
 struct obs_source_frame *filter_async_video(obs_source_t *source,
 		struct obs_source_frame *in)
 {
@@ -2112,6 +2530,9 @@ struct obs_source_frame *filter_async_video(obs_source_t *source,
 
 	pthread_mutex_lock(&source->filter_mutex);
 
+	if (has_async_video_filters(source))
+		in = own_filter_frame(source, in);
+
 	for (i = source->filters.num; i > 0; i--) {
 		struct obs_source *filter = source->filters.array[i-1];
 
@@ -2251,7 +2672,8 @@ static inline bool async_texture_changed(struct obs_source *source,
 static inline void free_async_cache(struct obs_source *source)
 {
 	for (size_t i = 0; i < source->async_cache.num; i++)
-		obs_source_frame_decref(source->async_cache.array[i].frame);
+		obs_source_frame_decref(source,
+				source->async_cache.array[i].frame);
 
 	da_resize(source->async_cache, 0);
 	da_resize(source->async_frames, 0);
@@ -2269,7 +2691,7 @@ static void clean_cache(obs_source_t *source)
 		struct async_frame *af = &source->async_cache.array[i - 1];
 		if (!af->used) {
 			if (++af->unused_count == MAX_UNUSED_FRAME_DURATION) {
-				obs_source_frame_destroy(af->frame);
+				async_frame_destroy(source, af->frame);
 				da_erase(source->async_cache, i - 1);
 			}
 		}
@@ -2278,8 +2700,40 @@ static void clean_cache(obs_source_t *source)
 
 #define MAX_ASYNC_FRAMES 30
 
-static inline struct obs_source_frame *cache_video(struct obs_source *source,
+/* the texture upload expects planar frames to be laid out exactly like
+ * frames created with obs_source_frame_create, so only those can be used
+ * without copying */
+static inline bool async_frame_uses_external_data(
 		const struct obs_source_frame *frame)
+{
+	uint32_t size = frame->width * frame->height;
+
+	switch (frame->format) {
+	case VIDEO_FORMAT_I420:
+		return frame->linesize[0] == frame->width &&
+		       frame->linesize[1] == frame->width / 2 &&
+		       frame->linesize[2] == frame->width / 2 &&
+		       frame->data[1] == frame->data[0] + size &&
+		       frame->data[2] == frame->data[1] + size / 4;
+
+	case VIDEO_FORMAT_NV12:
+		return frame->linesize[0] == frame->width &&
+		       frame->linesize[1] == frame->width &&
+		       frame->data[1] == frame->data[0] + size;
+
+	case VIDEO_FORMAT_Y800:
+	case VIDEO_FORMAT_I444:
+	case VIDEO_FORMAT_NONE:
+		return false;
+
+	default:
+		return true;
+	}
+}
+
+static inline struct obs_source_frame *cache_video(struct obs_source *source,
+		const struct obs_source_frame *frame,
+		void (*release)(void *param), void *param)
 {
 	struct obs_source_frame *new_frame = NULL;
 
@@ -2289,6 +2743,9 @@ static inline struct obs_source_frame *cache_video(struct obs_source *source,
 		free_async_cache(source);
 		source->last_frame_ts = 0;
 		pthread_mutex_unlock(&source->async_mutex);
+
+		if (release)
+			release(param);
 		return NULL;
 	}
 
@@ -2299,9 +2756,25 @@ static inline struct obs_source_frame *cache_video(struct obs_source *source,
 		source->async_cache_format = frame->format;
 	}
 
+	if (release && async_frame_uses_external_data(frame)) {
+		struct async_frame new_af = {0};
+
+		new_frame = async_frame_create_external(source, frame,
+				release, param);
+
+		new_af.frame = new_frame;
+		new_af.used = true;
+		new_af.external = true;
+		da_push_back(source->async_cache, &new_af);
+
+		clean_cache(source);
+		pthread_mutex_unlock(&source->async_mutex);
+		return new_frame;
+	}
+
 	for (size_t i = 0; i < source->async_cache.num; i++) {
 		struct async_frame *af = &source->async_cache.array[i];
-		if (!af->used) {
+		if (!af->used && !af->external) {
 			new_frame = af->frame;
 			af->used = true;
 			af->unused_count = 0;
@@ -2312,7 +2785,7 @@ static inline struct obs_source_frame *cache_video(struct obs_source *source,
 	clean_cache(source);
 
 	if (!new_frame) {
-		struct async_frame new_af;
+		struct async_frame new_af = {0};
 		enum video_format format = frame->format;
 
 		if (format == VIDEO_FORMAT_Y800)
@@ -2339,22 +2812,24 @@ static inline struct obs_source_frame *cache_video(struct obs_source *source,
 		new_frame = NULL;
 	}
 
+	/* the data was copied, so the source can have its buffer back */
+	if (release)
+		release(param);
+
 	return new_frame;
 }
 
-void obs_source_output_video(obs_source_t *source,
-		const struct obs_source_frame *frame)
+static void output_video_internal(obs_source_t *source,
+		const struct obs_source_frame *frame,
+		void (*release)(void *param), void *param)
 {
-	if (!obs_source_valid(source, "obs_source_output_video"))
-		return;
-
 	if (!frame) {
 		source->async_active = false;
 		return;
 	}
 
-	struct obs_source_frame *output = !!frame ?
-		cache_video(source, frame) : NULL;
+	struct obs_source_frame *output = cache_video(source, frame,
+			release, param);
 
 	/* ------------------------------------------- */
 
@@ -2366,6 +2841,38 @@ void obs_source_output_video(obs_source_t *source,
 	}
 }
 
+void obs_source_output_video(obs_source_t *source,
+		const struct obs_source_frame *frame)
+{
+	if (!obs_source_valid(source, "obs_source_output_video"))
+		return;
+
+	output_video_internal(source, frame, NULL, NULL);
+}
+
+void obs_source_output_video_external(obs_source_t *source,
+		const struct obs_source_frame *frame,
+		void (*release)(void *param), void *param)
+{
+	if (!obs_source_valid(source, "obs_source_output_video_external")) {
+		if (release)
+			release(param);
+		return;
+	}
+
+	output_video_internal(source, frame, release, param);
+}
+
+void obs_source_flush_async_video(obs_source_t *source)
+{
+	if (!obs_source_valid(source, "obs_source_flush_async_video"))
+		return;
+
+	pthread_mutex_lock(&source->async_mutex);
+	free_async_cache(source);
+	pthread_mutex_unlock(&source->async_mutex);
+}
+
 static inline bool preload_frame_changed(obs_source_t *source,
 		const struct obs_source_frame *in)
 {
@@ -2433,8 +2940,19 @@ static inline struct obs_audio_data *filter_async_audio(obs_source_t *source,
 			continue;
 
 		if (filter->context.data && filter->info.filter_audio) {
+			/* keyed on the type, filters can be renamed while
+			 * audio is being filtered */
+			if (!filter->profile_filter_audio_name)
+				filter->profile_filter_audio_name =
+					profile_store_name(
+						obs_get_profiler_name_store(),
+						"filter_audio(%s)",
+						filter->info.id);
+
+			profile_start(filter->profile_filter_audio_name);
 			in = filter->info.filter_audio(filter->context.data,
 					in);
+			profile_end(filter->profile_filter_audio_name);
 			if (!in)
 				return NULL;
 		}
@@ -2462,6 +2980,7 @@ static inline void reset_resampler(obs_source_t *source,
 	audio_resampler_destroy(source->resampler);
 	source->resampler = NULL;
 	source->resample_offset = 0;
+	source->audio_convert = false;
 
 	if (source->sample_info.samples_per_sec == obs_info->samples_per_sec &&
 	    source->sample_info.format          == obs_info->format          &&
@@ -2470,6 +2989,13 @@ static inline void reset_resampler(obs_source_t *source,
 		return;
 	}
 
+	/* only resample if the sample rate or an uncommon remix requires it */
+	if (audio_convert_supported(&output_info, &source->sample_info)) {
+		source->audio_convert = true;
+		source->audio_failed = false;
+		return;
+	}
+
 	source->resampler = audio_resampler_create(&output_info,
 			&source->sample_info);
 
@@ -2478,50 +3004,65 @@ static inline void reset_resampler(obs_source_t *source,
 		blog(LOG_ERROR, "creation of resampler failed");
 }
 
-static void copy_audio_data(obs_source_t *source,
-		const uint8_t *const data[], uint32_t frames, uint64_t ts)
+static void ensure_audio_storage(obs_source_t *source, uint32_t frames,
+		uint64_t ts)
 {
 	size_t planes    = audio_output_get_planes(obs->audio.audio);
 	size_t blocksize = audio_output_get_block_size(obs->audio.audio);
 	size_t size      = (size_t)frames * blocksize;
-	bool   resize    = source->audio_storage_size < size;
 
 	source->audio_data.frames    = frames;
 	source->audio_data.timestamp = ts;
 
-	for (size_t i = 0; i < planes; i++) {
-		/* ensure audio storage capacity */
-		if (resize) {
-			bfree(source->audio_data.data[i]);
-			source->audio_data.data[i] = bmalloc(size);
-		}
+	if (source->audio_storage_size >= size)
+		return;
 
-		memcpy(source->audio_data.data[i], data[i], size);
+	for (size_t i = 0; i < planes; i++) {
+		bfree(source->audio_data.data[i]);
+		source->audio_data.data[i] = bmalloc(size);
 	}
 
-	if (resize)
-		source->audio_storage_size = size;
+	source->audio_storage_size = size;
 }
 
-/* TODO: SSE optimization */
-static void downmix_to_mono_planar(struct obs_source *source, uint32_t frames)
+static void copy_audio_data(obs_source_t *source,
+		const uint8_t *const data[], uint32_t frames, uint64_t ts)
 {
-	size_t channels = audio_output_get_channels(obs->audio.audio);
-	const float channels_i = 1.0f / (float)channels;
-	float **data = (float**)source->audio_data.data;
+	size_t planes    = audio_output_get_planes(obs->audio.audio);
+	size_t blocksize = audio_output_get_block_size(obs->audio.audio);
+	size_t size      = (size_t)frames * blocksize;
 
-	for (size_t channel = 1; channel < channels; channel++) {
-		for (uint32_t frame = 0; frame < frames; frame++)
-			data[0][frame] += data[channel][frame];
-	}
+	ensure_audio_storage(source, frames, ts);
 
-	for (uint32_t frame = 0; frame < frames; frame++)
-		data[0][frame] *= channels_i;
+	for (size_t i = 0; i < planes; i++)
+		memcpy(source->audio_data.data[i], data[i], size);
+}
 
-	for (size_t channel = 1; channel < channels; channel++) {
-		for (uint32_t frame = 0; frame < frames; frame++)
-			data[channel][frame] = data[0][frame];
-	}
+/* converts straight into the source's audio storage */
+static void convert_audio_data(obs_source_t *source,
+		const struct obs_source_audio *audio)
+{
+	const struct audio_output_info *obs_info;
+	struct resample_info output_info;
+
+	obs_info = audio_output_get_info(obs->audio.audio);
+
+	output_info.format           = obs_info->format;
+	output_info.samples_per_sec  = obs_info->samples_per_sec;
+	output_info.speakers         = obs_info->speakers;
+
+	ensure_audio_storage(source, audio->frames, audio->timestamp);
+	audio_convert(&output_info, &source->sample_info,
+			(float**)source->audio_data.data, audio->data,
+			audio->frames);
+}
+
+static inline void downmix_to_mono_planar(struct obs_source *source,
+		uint32_t frames)
+{
+	size_t channels = audio_output_get_channels(obs->audio.audio);
+	audio_downmix_to_mono_planar((float**)source->audio_data.data,
+			channels, frames);
 }
 
 /* resamples/remixes new audio to the designated main audio output format */
@@ -2550,6 +3091,8 @@ static void process_audio(obs_source_t *source,
 
 		copy_audio_data(source, (const uint8_t *const *)output, frames,
 				audio->timestamp);
+	} else if (source->audio_convert) {
+		convert_audio_data(source, audio);
 	} else {
 		copy_audio_data(source, audio->data, audio->frames,
 				audio->timestamp);
@@ -2602,7 +3145,12 @@ void remove_async_frame(obs_source_t *source, struct obs_source_frame *frame)
 		struct async_frame *f = &source->async_cache.array[i];
 
 		if (f->frame == frame) {
-			f->used = false;
+			if (f->external) {
+				da_erase(source->async_cache, i);
+				obs_source_frame_decref(source, frame);
+			} else {
+				f->used = false;
+			}
 			break;
 		}
 	}
@@ -2757,7 +3305,7 @@ void obs_source_release_frame(obs_source_t *source,
 		pthread_mutex_lock(&source->async_mutex);
 
 		if (os_atomic_dec_long(&frame->refs) == 0)
-			obs_source_frame_destroy(frame);
+			async_frame_destroy(source, frame);
 		else
 			remove_async_frame(source, frame);
 
@@ -2782,6 +3330,9 @@ void obs_source_set_name(obs_source_t *source, const char *name)
 		char *prev_name = bstrdup(source->context.name);
 		obs_context_data_setname(&source->context, name);
 
+		/* scenes save their items by source name */
+		os_atomic_inc_long(&obs->data.save_gen);
+
 		calldata_init(&data);
 		calldata_set_ptr(&data, "source", source);
 		calldata_set_string(&data, "new_name", source->context.name);
@@ -3044,6 +3595,7 @@ void obs_source_set_volume(obs_source_t *source, float volume)
 		pthread_mutex_unlock(&source->audio_actions_mutex);
 
 		source->user_volume = volume;
+		obs_source_set_dirty(source);
 	}
 }
 
@@ -3067,6 +3619,7 @@ void obs_source_set_sync_offset(obs_source_t *source, int64_t offset)
 				&data);
 
 		source->sync_offset = calldata_int(&data, "offset");
+		obs_source_set_dirty(source);
 	}
 }
 
@@ -3313,6 +3866,7 @@ void obs_source_set_flags(obs_source_t *source, uint32_t flags)
 
 	if (flags != source->flags) {
 		source->flags = flags;
+		obs_source_set_dirty(source);
 		signal_flags_updated(source);
 	}
 }
@@ -3353,6 +3907,7 @@ void obs_source_set_audio_mixers(obs_source_t *source, uint32_t mixers)
 	mixers = (uint32_t)calldata_int(&data, "mixers");
 
 	source->audio_mixers = mixers;
+	obs_source_set_dirty(source);
 }
 
 uint32_t obs_source_get_audio_mixers(const obs_source_t *source)
@@ -3503,6 +4058,8 @@ void obs_source_set_enabled(obs_source_t *source, bool enabled)
 		return;
 
 	source->enabled = enabled;
+	obs_source_set_dirty(source);
+	obs_source_invalidate_content(source);
 
 	calldata_init_fixed(&data, stack, sizeof(stack));
 	calldata_set_ptr(&data, "source", source);
@@ -3531,6 +4088,7 @@ void obs_source_set_muted(obs_source_t *source, bool muted)
 		return;
 
 	source->user_muted = muted;
+	obs_source_set_dirty(source);
 
 	calldata_init_fixed(&data, stack, sizeof(stack));
 	calldata_set_ptr(&data, "source", source);
@@ -3595,6 +4153,7 @@ void obs_source_enable_push_to_mute(obs_source_t *source, bool enabled)
 				enabled ? "enabled" : "disabled");
 
 	source->push_to_mute_enabled = enabled;
+	obs_source_set_dirty(source);
 
 	if (changed)
 		source_signal_push_to_changed(source, "push_to_mute_changed",
@@ -3622,6 +4181,7 @@ void obs_source_set_push_to_mute_delay(obs_source_t *source, uint64_t delay)
 
 	pthread_mutex_lock(&source->audio_mutex);
 	source->push_to_mute_delay = delay;
+	obs_source_set_dirty(source);
 
 	source_signal_push_to_delay(source, "push_to_mute_delay", delay);
 	pthread_mutex_unlock(&source->audio_mutex);
@@ -3653,6 +4213,7 @@ void obs_source_enable_push_to_talk(obs_source_t *source, bool enabled)
 				enabled ? "enabled" : "disabled");
 
 	source->push_to_talk_enabled = enabled;
+	obs_source_set_dirty(source);
 
 	if (changed)
 		source_signal_push_to_changed(source, "push_to_talk_changed",
@@ -3680,6 +4241,7 @@ void obs_source_set_push_to_talk_delay(obs_source_t *source, uint64_t delay)
 
 	pthread_mutex_lock(&source->audio_mutex);
 	source->push_to_talk_delay = delay;
+	obs_source_set_dirty(source);
 
 	source_signal_push_to_delay(source, "push_to_talk_delay", delay);
 	pthread_mutex_unlock(&source->audio_mutex);
@@ -3929,7 +4491,7 @@ static inline void process_audio_source_tick(obs_source_t *source,
 void obs_source_audio_render(obs_source_t *source, uint32_t mixers,
 		size_t channels, size_t sample_rate, size_t size)
 {
-	if (!source->audio_output_buf[0][0]) {
+	if (!source->audio_output_buf[0][0] || create_pending(source)) {
 		source->audio_pending = true;
 		return;
 	}
@@ -4018,16 +4580,30 @@ void obs_source_set_monitoring_type(obs_source_t *source,
 	was_on = source->monitoring_type != OBS_MONITORING_TYPE_NONE;
 	now_on = type != OBS_MONITORING_TYPE_NONE;
 
+	/* the monitor pointer is swapped under the monitoring mutex, which
+	 * obs_source_get_monitoring_latency holds while it uses the monitor */
 	if (was_on != now_on) {
 		if (!was_on) {
-			source->monitor = audio_monitor_create(source);
+			struct audio_monitor *monitor =
+				audio_monitor_create(source);
+
+			pthread_mutex_lock(&obs->audio.monitoring_mutex);
+			source->monitor = monitor;
+			pthread_mutex_unlock(&obs->audio.monitoring_mutex);
 		} else {
-			audio_monitor_destroy(source->monitor);
+			struct audio_monitor *monitor;
+
+			pthread_mutex_lock(&obs->audio.monitoring_mutex);
+			monitor = source->monitor;
 			source->monitor = NULL;
+			pthread_mutex_unlock(&obs->audio.monitoring_mutex);
+
+			audio_monitor_destroy(monitor);
 		}
 	}
 
 	source->monitoring_type = type;
+	obs_source_set_dirty(source);
 }
 
 enum obs_monitoring_type obs_source_get_monitoring_type(
@@ -4037,6 +4613,21 @@ enum obs_monitoring_type obs_source_get_monitoring_type(
 		source->monitoring_type : OBS_MONITORING_TYPE_NONE;
 }
 
+uint64_t obs_source_get_monitoring_latency(const obs_source_t *source)
+{
+	uint64_t latency = 0;
+
+	if (!obs_source_valid(source, "obs_source_get_monitoring_latency"))
+		return 0;
+
+	pthread_mutex_lock(&obs->audio.monitoring_mutex);
+	if (source->monitor)
+		latency = audio_monitor_get_latency(source->monitor);
+	pthread_mutex_unlock(&obs->audio.monitoring_mutex);
+
+	return latency;
+}
+
 void obs_source_set_async_unbuffered(obs_source_t *source, bool unbuffered)
 {
 	if (!obs_source_valid(source, "obs_source_set_async_unbuffered"))
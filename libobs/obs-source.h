@@ -130,6 +130,61 @@ enum obs_source_type {
  */
 #define OBS_SOURCE_DO_NOT_SELF_MONITOR (1<<9)
 
+/**
+ * Source can be created on any thread
+ *
+ * When loading sources, the create callback of sources with this flag may be
+ * called on a worker thread, concurrently with the create callbacks of other
+ * sources.  It is called after the saved source state (volume, flags,
+ * filters, etc.) has been applied, and must not depend on other sources.
+ *
+ * Use this for sources that block in their create callback, for example to
+ * open devices or decode files.
+ */
+#define OBS_SOURCE_CREATE_THREADSAFE (1<<10)
+
+/**
+ * Source video is opaque
+ *
+ * Specifies that the source always fills its entire width and height with
+ * fully opaque pixels while it has video.  Scenes use this to skip rendering
+ * items that are completely covered by this source.
+ *
+ * Do not use this for sources that can have transparency, such as images or
+ * window captures.  Async video sources do not need this flag, their opacity
+ * is determined from the format of their frames.
+ *
+ * Sources that don't always have something to draw should implement
+ * video_opaque as well.
+ */
+#define OBS_SOURCE_OPAQUE (1<<11)
+
+/**
+ * Source video only changes when the source is updated
+ *
+ * Specifies that the video output of the source only changes when its
+ * settings are updated or when it calls obs_source_invalidate_content, for
+ * example when an animation advances.  For filters, this means the filter's
+ * output only changes when its input changes.
+ *
+ * When a source and all of its enabled filters have this flag, the filtered
+ * output is kept in a texture and the filters are not rendered again until
+ * the content changes.  The texture is rendered with "over" alpha blending
+ * and holds premultiplied color, so translucent output composites the same
+ * as when it is drawn directly.  The destination alpha is the exception: it
+ * does not add up where translucent parts of the output overlap.
+ */
+#define OBS_SOURCE_STATIC_CONTENT (1<<12)
+
+/**
+ * Source defaults depend on the system state
+ *
+ * Specifies that get_defaults can return different values each time it is
+ * called, for example the current default device.  The defaults of other
+ * source types are only queried once and then reused.
+ */
+#define OBS_SOURCE_DYNAMIC_DEFAULTS (1<<13)
+
 /** @} */
 
 typedef void (*obs_source_enum_proc_t)(obs_source_t *parent,
@@ -425,6 +480,17 @@ struct obs_source_info {
 	void (*enum_all_sources)(void *data,
 			obs_source_enum_proc_t enum_callback,
 			void *param);
+
+	/**
+	 * Called from the graphics thread to check whether a source with the
+	 * OBS_SOURCE_OPAQUE flag currently has opaque video to draw.  If this
+	 * callback isn't implemented, the source is always treated as opaque.
+	 *
+	 * @param  data  Source data
+	 * @return       true if the next video_render fills the entire width
+	 *               and height of the source with opaque pixels
+	 */
+	bool (*video_opaque)(void *data);
 };
 
 EXPORT void obs_register_source_s(const struct obs_source_info *info,
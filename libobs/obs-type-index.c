@@ -0,0 +1,152 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include <string.h>
+
+#include "util/crc32.h"
+#include "obs-internal.h"
+
+/*
+ * Open addressing table of registered type ids.  Slots hold the index of the
+ * type in its registered type array plus one, zero is an empty slot.  The
+ * table is kept at most half full so probe sequences stay short.
+ *
+ * All type info structures start with their id, which is what the table
+ * compares against.
+ */
+
+#define MIN_INDEX_SIZE 16
+
+static inline size_t hash_id(const char *id)
+{
+	return (size_t)calc_crc32(0, id, strlen(id));
+}
+
+static inline const char *get_type_id(const struct darray *types,
+		size_t type_size, size_t idx)
+{
+	return *(const char **)((uint8_t*)types->array + type_size * idx);
+}
+
+static void insert_id(struct type_index *index, const char *id, size_t idx)
+{
+	size_t mask = index->size - 1;
+	size_t slot = hash_id(id) & mask;
+
+	while (index->slots[slot])
+		slot = (slot + 1) & mask;
+
+	index->slots[slot] = idx + 1;
+}
+
+void type_index_rebuild(struct type_index *index, const struct darray *types,
+		size_t type_size)
+{
+	size_t size = MIN_INDEX_SIZE;
+
+	while (size < types->num * 2)
+		size *= 2;
+
+	bfree(index->slots);
+	index->slots = bzalloc(size * sizeof(size_t));
+	index->size  = size;
+
+	for (size_t i = 0; i < types->num; i++)
+		insert_id(index, get_type_id(types, type_size, i), i);
+
+	/* cached defaults are stored by type index, which may have changed */
+	type_index_clear_defaults(index);
+}
+
+void type_index_add(struct type_index *index, const struct darray *types,
+		size_t type_size)
+{
+	size_t idx = types->num - 1;
+
+	if (types->num * 2 > index->size)
+		type_index_rebuild(index, types, type_size);
+	else
+		insert_id(index, get_type_id(types, type_size, idx), idx);
+}
+
+size_t type_index_find(const struct type_index *index,
+		const struct darray *types, size_t type_size, const char *id)
+{
+	size_t mask = index->size - 1;
+	size_t slot;
+
+	if (!index->size || !id)
+		return DARRAY_INVALID;
+
+	slot = hash_id(id) & mask;
+
+	while (index->slots[slot]) {
+		size_t idx = index->slots[slot] - 1;
+
+		if (strcmp(get_type_id(types, type_size, idx), id) == 0)
+			return idx;
+
+		slot = (slot + 1) & mask;
+	}
+
+	return DARRAY_INVALID;
+}
+
+obs_data_t *type_index_get_defaults(struct type_index *index, size_t idx,
+		void (*get_defaults)(obs_data_t *settings))
+{
+	obs_data_t *defaults;
+
+	if (!get_defaults)
+		return NULL;
+
+	pthread_mutex_lock(&obs->type_defaults_mutex);
+
+	if (index->defaults.num <= idx)
+		da_resize(index->defaults, idx + 1);
+
+	defaults = index->defaults.array[idx];
+	if (!defaults) {
+		defaults = obs_data_create();
+		get_defaults(defaults);
+		index->defaults.array[idx] = defaults;
+	}
+
+	obs_data_addref(defaults);
+
+	pthread_mutex_unlock(&obs->type_defaults_mutex);
+	return defaults;
+}
+
+void type_index_clear_defaults(struct type_index *index)
+{
+	pthread_mutex_lock(&obs->type_defaults_mutex);
+
+	for (size_t i = 0; i < index->defaults.num; i++)
+		obs_data_release(index->defaults.array[i]);
+	da_free(index->defaults);
+
+	pthread_mutex_unlock(&obs->type_defaults_mutex);
+}
+
+void type_index_free(struct type_index *index)
+{
+	type_index_clear_defaults(index);
+	bfree(index->slots);
+	index->slots = NULL;
+	index->size  = 0;
+}
@@ -29,8 +29,8 @@ static uint64_t tick_sources(uint64_t cur_time, uint64_t last_time)
 	float                seconds;
 
 	if (!last_time)
-		last_time = cur_time -
-			video_output_get_frame_time(obs->video.video);
+		last_time = cur_time - video_output_get_frame_time(
+				obs->video.main_canvas.video);
 
 	delta_time = cur_time - last_time;
 	seconds = (float)((double)delta_time / 1000000000.0);
@@ -84,16 +84,16 @@ static inline void set_render_size(uint32_t width, uint32_t height)
 	gs_set_viewport(0, 0, width, height);
 }
 
-static inline void unmap_last_surface(struct obs_core_video *video)
+static inline void unmap_last_surface(struct obs_canvas *canvas)
 {
-	if (video->mapped_surface) {
-		gs_stagesurface_unmap(video->mapped_surface);
-		video->mapped_surface = NULL;
+	if (canvas->mapped_surface) {
+		gs_stagesurface_unmap(canvas->mapped_surface);
+		canvas->mapped_surface = NULL;
 	}
 }
 
 static const char *render_main_texture_name = "render_main_texture";
-static inline void render_main_texture(struct obs_core_video *video,
+static inline void render_main_texture(struct obs_canvas *canvas,
 		int cur_texture)
 {
 	profile_start(render_main_texture_name);
@@ -101,94 +101,100 @@ static inline void render_main_texture(struct obs_core_video *video,
 	struct vec4 clear_color;
 	vec4_set(&clear_color, 0.0f, 0.0f, 0.0f, 1.0f);
 
-	gs_set_render_target(video->render_textures[cur_texture], NULL);
+	gs_set_render_target(canvas->render_textures[cur_texture], NULL);
 	gs_clear(GS_CLEAR_COLOR, &clear_color, 1.0f, 0);
 
-	set_render_size(video->base_width, video->base_height);
+	set_render_size(canvas->base_width, canvas->base_height);
 
-	pthread_mutex_lock(&obs->data.draw_callbacks_mutex);
+	/* main render callbacks only draw into the main canvas */
+	if (canvas == &obs->video.main_canvas) {
+		pthread_mutex_lock(&obs->data.draw_callbacks_mutex);
 
-	for (size_t i = 0; i < obs->data.draw_callbacks.num; i++) {
-		struct draw_callback *callback;
-		callback = obs->data.draw_callbacks.array+i;
+		for (size_t i = 0; i < obs->data.draw_callbacks.num; i++) {
+			struct draw_callback *callback;
+			callback = obs->data.draw_callbacks.array+i;
 
-		callback->draw(callback->param,
-				video->base_width, video->base_height);
-	}
+			callback->draw(callback->param,
+					canvas->base_width,
+					canvas->base_height);
+		}
 
-	pthread_mutex_unlock(&obs->data.draw_callbacks_mutex);
+		pthread_mutex_unlock(&obs->data.draw_callbacks_mutex);
+	}
 
-	obs_view_render(&obs->data.main_view);
+	obs->video.render_canvas = canvas;
+	obs_view_render(canvas->view);
+	obs->video.render_canvas = NULL;
 
-	video->textures_rendered[cur_texture] = true;
+	canvas->textures_rendered[cur_texture] = true;
 
 	profile_end(render_main_texture_name);
 }
 
 static inline gs_effect_t *get_scale_effect_internal(
-		struct obs_core_video *video)
+		struct obs_canvas *canvas)
 {
 	/* if the dimension is under half the size of the original image,
 	 * bicubic/lanczos can't sample enough pixels to create an accurate
 	 * image, so use the bilinear low resolution effect instead */
-	if (video->output_width  < (video->base_width  / 2) &&
-	    video->output_height < (video->base_height / 2)) {
-		return video->bilinear_lowres_effect;
+	if (canvas->output_width  < (canvas->base_width  / 2) &&
+	    canvas->output_height < (canvas->base_height / 2)) {
+		return obs->video.bilinear_lowres_effect;
 	}
 
-	switch (video->scale_type) {
-	case OBS_SCALE_BILINEAR: return video->default_effect;
-	case OBS_SCALE_LANCZOS:  return video->lanczos_effect;
+	switch (canvas->scale_type) {
+	case OBS_SCALE_BILINEAR: return obs->video.default_effect;
+	case OBS_SCALE_LANCZOS:  return obs->video.lanczos_effect;
 	case OBS_SCALE_BICUBIC:
 	default:;
 	}
 
-	return video->bicubic_effect;
+	return obs->video.bicubic_effect;
 }
 
-static inline bool resolution_close(struct obs_core_video *video,
+static inline bool resolution_close(struct obs_canvas *canvas,
 		uint32_t width, uint32_t height)
 {
-	long width_cmp  = (long)video->base_width  - (long)width;
-	long height_cmp = (long)video->base_height - (long)height;
+	long width_cmp  = (long)canvas->base_width  - (long)width;
+	long height_cmp = (long)canvas->base_height - (long)height;
 
 	return labs(width_cmp) <= 16 && labs(height_cmp) <= 16;
 }
 
-static inline gs_effect_t *get_scale_effect(struct obs_core_video *video,
+static inline gs_effect_t *get_scale_effect(struct obs_canvas *canvas,
 		uint32_t width, uint32_t height)
 {
-	if (resolution_close(video, width, height)) {
-		return video->default_effect;
+	if (resolution_close(canvas, width, height)) {
+		return obs->video.default_effect;
 	} else {
 		/* if the scale method couldn't be loaded, use either bicubic
 		 * or bilinear by default */
-		gs_effect_t *effect = get_scale_effect_internal(video);
+		gs_effect_t *effect = get_scale_effect_internal(canvas);
 		if (!effect)
-			effect = !!video->bicubic_effect ?
-				video->bicubic_effect :
-				video->default_effect;
+			effect = !!obs->video.bicubic_effect ?
+				obs->video.bicubic_effect :
+				obs->video.default_effect;
 		return effect;
 	}
 }
 
 static const char *render_output_texture_name = "render_output_texture";
-static inline void render_output_texture(struct obs_core_video *video,
+static inline void render_output_texture(struct obs_canvas *canvas,
 		int cur_texture, int prev_texture)
 {
 	profile_start(render_output_texture_name);
 
-	gs_texture_t *texture = video->render_textures[prev_texture];
-	gs_texture_t *target  = video->output_textures[cur_texture];
+	gs_texture_t *texture = canvas->render_textures[prev_texture];
+	gs_texture_t *target  = canvas->output_textures[cur_texture];
 	uint32_t     width   = gs_texture_get_width(target);
 	uint32_t     height  = gs_texture_get_height(target);
 	struct vec2  base_i;
 
 	vec2_set(&base_i,
-		1.0f / (float)video->base_width,
-		1.0f / (float)video->base_height);
+		1.0f / (float)canvas->base_width,
+		1.0f / (float)canvas->base_height);
 
-	gs_effect_t    *effect  = get_scale_effect(video, width, height);
+	gs_effect_t    *effect  = get_scale_effect(canvas, width, height);
 	gs_technique_t *tech    = gs_effect_get_technique(effect, "DrawMatrix");
 	gs_eparam_t    *image   = gs_effect_get_param_by_name(effect, "image");
 	gs_eparam_t    *matrix  = gs_effect_get_param_by_name(effect,
@@ -197,7 +203,7 @@ static inline void render_output_texture(struct obs_core_video *video,
 			"base_dimension_i");
 	size_t      passes, i;
 
-	if (!video->textures_rendered[prev_texture])
+	if (!canvas->textures_rendered[prev_texture])
 		goto end;
 
 	gs_set_render_target(target, NULL);
@@ -206,7 +212,7 @@ static inline void render_output_texture(struct obs_core_video *video,
 	if (bres_i)
 		gs_effect_set_vec2(bres_i, &base_i);
 
-	gs_effect_set_val(matrix, video->color_matrix, sizeof(float) * 16);
+	gs_effect_set_val(matrix, canvas->color_matrix, sizeof(float) * 16);
 	gs_effect_set_texture(image, texture);
 
 	gs_enable_blending(false);
@@ -219,7 +225,7 @@ static inline void render_output_texture(struct obs_core_video *video,
 	gs_technique_end(tech);
 	gs_enable_blending(true);
 
-	video->textures_output[cur_texture] = true;
+	canvas->textures_output[cur_texture] = true;
 
 end:
 	profile_end(render_output_texture_name);
@@ -232,27 +238,27 @@ static inline void set_eparam(gs_effect_t *effect, const char *name, float val)
 }
 
 static const char *render_convert_texture_name = "render_convert_texture";
-static void render_convert_texture(struct obs_core_video *video,
+static void render_convert_texture(struct obs_canvas *canvas,
 		int cur_texture, int prev_texture)
 {
 	profile_start(render_convert_texture_name);
 
-	gs_texture_t *texture = video->output_textures[prev_texture];
-	gs_texture_t *target  = video->convert_textures[cur_texture];
-	float        fwidth  = (float)video->output_width;
-	float        fheight = (float)video->output_height;
+	gs_texture_t *texture = canvas->output_textures[prev_texture];
+	gs_texture_t *target  = canvas->convert_textures[cur_texture];
+	float        fwidth  = (float)canvas->output_width;
+	float        fheight = (float)canvas->output_height;
 	size_t       passes, i;
 
-	gs_effect_t    *effect  = video->conversion_effect;
+	gs_effect_t    *effect  = obs->video.conversion_effect;
 	gs_eparam_t    *image   = gs_effect_get_param_by_name(effect, "image");
 	gs_technique_t *tech    = gs_effect_get_technique(effect,
-			video->conversion_tech);
+			canvas->conversion_tech);
 
-	if (!video->textures_output[prev_texture])
+	if (!canvas->textures_output[prev_texture])
 		goto end;
 
-	set_eparam(effect, "u_plane_offset", (float)video->plane_offsets[1]);
-	set_eparam(effect, "v_plane_offset", (float)video->plane_offsets[2]);
+	set_eparam(effect, "u_plane_offset", (float)canvas->plane_offsets[1]);
+	set_eparam(effect, "v_plane_offset", (float)canvas->plane_offsets[2]);
 	set_eparam(effect, "width",  fwidth);
 	set_eparam(effect, "height", fheight);
 	set_eparam(effect, "width_i",  1.0f / fwidth);
@@ -261,62 +267,62 @@ static void render_convert_texture(struct obs_core_video *video,
 	set_eparam(effect, "height_d2", fheight * 0.5f);
 	set_eparam(effect, "width_d2_i",  1.0f / (fwidth  * 0.5f));
 	set_eparam(effect, "height_d2_i", 1.0f / (fheight * 0.5f));
-	set_eparam(effect, "input_height", (float)video->conversion_height);
+	set_eparam(effect, "input_height", (float)canvas->conversion_height);
 
 	gs_effect_set_texture(image, texture);
 
 	gs_set_render_target(target, NULL);
-	set_render_size(video->output_width, video->conversion_height);
+	set_render_size(canvas->output_width, canvas->conversion_height);
 
 	gs_enable_blending(false);
 	passes = gs_technique_begin(tech);
 	for (i = 0; i < passes; i++) {
 		gs_technique_begin_pass(tech, i);
-		gs_draw_sprite(texture, 0, video->output_width,
-				video->conversion_height);
+		gs_draw_sprite(texture, 0, canvas->output_width,
+				canvas->conversion_height);
 		gs_technique_end_pass(tech);
 	}
 	gs_technique_end(tech);
 	gs_enable_blending(true);
 
-	video->textures_converted[cur_texture] = true;
+	canvas->textures_converted[cur_texture] = true;
 
 end:
 	profile_end(render_convert_texture_name);
 }
 
 static const char *stage_output_texture_name = "stage_output_texture";
-static inline void stage_output_texture(struct obs_core_video *video,
+static inline void stage_output_texture(struct obs_canvas *canvas,
 		int cur_texture, int prev_texture)
 {
 	profile_start(stage_output_texture_name);
 
 	gs_texture_t   *texture;
 	bool        texture_ready;
-	gs_stagesurf_t *copy = video->copy_surfaces[cur_texture];
+	gs_stagesurf_t *copy = canvas->copy_surfaces[cur_texture];
 
-	if (video->gpu_conversion) {
-		texture = video->convert_textures[prev_texture];
-		texture_ready = video->textures_converted[prev_texture];
+	if (canvas->gpu_conversion) {
+		texture = canvas->convert_textures[prev_texture];
+		texture_ready = canvas->textures_converted[prev_texture];
 	} else {
-		texture = video->output_textures[prev_texture];
-		texture_ready = video->output_textures[prev_texture];
+		texture = canvas->output_textures[prev_texture];
+		texture_ready = canvas->output_textures[prev_texture];
 	}
 
-	unmap_last_surface(video);
+	unmap_last_surface(canvas);
 
 	if (!texture_ready)
 		goto end;
 
 	gs_stage_texture(copy, texture);
 
-	video->textures_copied[cur_texture] = true;
+	canvas->textures_copied[cur_texture] = true;
 
 end:
 	profile_end(stage_output_texture_name);
 }
 
-static inline void render_video(struct obs_core_video *video, int cur_texture,
+static inline void render_video(struct obs_canvas *canvas, int cur_texture,
 		int prev_texture)
 {
 	gs_begin_scene();
@@ -324,12 +330,12 @@ static inline void render_video(struct obs_core_video *video, int cur_texture,
 	gs_enable_depth_test(false);
 	gs_set_cull_mode(GS_NEITHER);
 
-	render_main_texture(video, cur_texture);
-	render_output_texture(video, cur_texture, prev_texture);
-	if (video->gpu_conversion)
-		render_convert_texture(video, cur_texture, prev_texture);
+	render_main_texture(canvas, cur_texture);
+	render_output_texture(canvas, cur_texture, prev_texture);
+	if (canvas->gpu_conversion)
+		render_convert_texture(canvas, cur_texture, prev_texture);
 
-	stage_output_texture(video, cur_texture, prev_texture);
+	stage_output_texture(canvas, cur_texture, prev_texture);
 
 	gs_set_render_target(NULL, NULL);
 	gs_enable_blending(true);
@@ -337,18 +343,18 @@ static inline void render_video(struct obs_core_video *video, int cur_texture,
 	gs_end_scene();
 }
 
-static inline bool download_frame(struct obs_core_video *video,
+static inline bool download_frame(struct obs_canvas *canvas,
 		int prev_texture, struct video_data *frame)
 {
-	gs_stagesurf_t *surface = video->copy_surfaces[prev_texture];
+	gs_stagesurf_t *surface = canvas->copy_surfaces[prev_texture];
 
-	if (!video->textures_copied[prev_texture])
+	if (!canvas->textures_copied[prev_texture])
 		return false;
 
 	if (!gs_stagesurface_map(surface, &frame->data[0], &frame->linesize[0]))
 		return false;
 
-	video->mapped_surface = surface;
+	canvas->mapped_surface = surface;
 	return true;
 }
 
@@ -389,7 +395,7 @@ static inline uint32_t make_aligned_linesize_offset(uint32_t offset,
 	return (offset / dst_linesize) * src_linesize + remainder;
 }
 
-static void fix_gpu_converted_alignment(struct obs_core_video *video,
+static void fix_gpu_converted_alignment(struct obs_canvas *canvas,
 		struct video_frame *output, const struct video_data *input)
 {
 	uint32_t src_linesize = input->linesize[0];
@@ -397,38 +403,38 @@ static void fix_gpu_converted_alignment(struct obs_core_video *video,
 	uint32_t src_pos      = 0;
 
 	for (size_t i = 0; i < 3; i++) {
-		if (video->plane_linewidth[i] == 0)
+		if (canvas->plane_linewidth[i] == 0)
 			break;
 
-		src_pos = make_aligned_linesize_offset(video->plane_offsets[i],
+		src_pos = make_aligned_linesize_offset(canvas->plane_offsets[i],
 				dst_linesize, src_linesize);
 
 		copy_dealign(output->data[i], 0, dst_linesize,
 				input->data[0], src_pos, src_linesize,
-				video->plane_sizes[i]);
+				canvas->plane_sizes[i]);
 	}
 }
 
-static void set_gpu_converted_data(struct obs_core_video *video,
+static void set_gpu_converted_data(struct obs_canvas *canvas,
 		struct video_frame *output, const struct video_data *input,
 		const struct video_output_info *info)
 {
-	if (input->linesize[0] == video->output_width*4) {
+	if (input->linesize[0] == canvas->output_width*4) {
 		struct video_frame frame;
 
 		for (size_t i = 0; i < 3; i++) {
-			if (video->plane_linewidth[i] == 0)
+			if (canvas->plane_linewidth[i] == 0)
 				break;
 
-			frame.linesize[i] = video->plane_linewidth[i];
+			frame.linesize[i] = canvas->plane_linewidth[i];
 			frame.data[i] =
-				input->data[0] + video->plane_offsets[i];
+				input->data[0] + canvas->plane_offsets[i];
 		}
 
 		video_frame_copy(output, &frame, info->format, info->height);
 
 	} else {
-		fix_gpu_converted_alignment(video, output, input);
+		fix_gpu_converted_alignment(canvas, output, input);
 	}
 }
 
@@ -478,20 +484,20 @@ static inline void copy_rgbx_frame(
 	}
 }
 
-static inline void output_video_data(struct obs_core_video *video,
+static inline void output_video_data(struct obs_canvas *canvas,
 		struct video_data *input_frame, int count)
 {
 	const struct video_output_info *info;
 	struct video_frame output_frame;
 	bool locked;
 
-	info = video_output_get_info(video->video);
+	info = video_output_get_info(canvas->video);
 
-	locked = video_output_lock_frame(video->video, &output_frame, count,
+	locked = video_output_lock_frame(canvas->video, &output_frame, count,
 			input_frame->timestamp);
 	if (locked) {
-		if (video->gpu_conversion) {
-			set_gpu_converted_data(video, &output_frame,
+		if (canvas->gpu_conversion) {
+			set_gpu_converted_data(canvas, &output_frame,
 					input_frame, info);
 
 		} else if (format_is_yuv(info->format)) {
@@ -500,14 +506,36 @@ static inline void output_video_data(struct obs_core_video *video,
 			copy_rgbx_frame(&output_frame, input_frame, info);
 		}
 
-		video_output_unlock_frame(video->video);
+		video_output_unlock_frame(canvas->video);
 	}
 }
 
+static inline void push_frame_info(struct obs_canvas *canvas,
+		uint64_t timestamp, uint64_t total_ticks)
+{
+	struct obs_vframe_info vframe_info;
+	uint64_t divisor = canvas->frame_divisor;
+	uint64_t frames;
+
+	if (!canvas->rendered)
+		return;
+
+	/* the rendered frame stands in for every frame of the canvas that is
+	 * due until the next main frame */
+	frames = (total_ticks - canvas->next_tick + divisor - 1) / divisor;
+	canvas->next_tick += frames * divisor;
+	canvas->rendered = false;
+
+	vframe_info.timestamp = timestamp;
+	vframe_info.count = (int)frames;
+	circlebuf_push_back(&canvas->vframe_info_buffer, &vframe_info,
+			sizeof(vframe_info));
+}
+
 static inline void video_sleep(struct obs_core_video *video,
 		uint64_t *p_time, uint64_t interval_ns)
 {
-	struct obs_vframe_info vframe_info;
+	struct obs_canvas *canvas;
 	uint64_t cur_time = *p_time;
 	uint64_t t = cur_time + interval_ns;
 	int count;
@@ -523,37 +551,82 @@ static inline void video_sleep(struct obs_core_video *video,
 	video->total_frames += count;
 	video->lagged_frames += count - 1;
 
-	vframe_info.timestamp = cur_time;
-	vframe_info.count = count;
-	circlebuf_push_back(&video->vframe_info_buffer, &vframe_info,
-			sizeof(vframe_info));
+	pthread_mutex_lock(&obs->data.canvases_mutex);
+
+	video->total_ticks += count;
+	push_frame_info(&video->main_canvas, cur_time, video->total_ticks);
+
+	canvas = obs->data.first_canvas;
+	while (canvas) {
+		push_frame_info(canvas, cur_time, video->total_ticks);
+		canvas = canvas->next;
+	}
+
+	pthread_mutex_unlock(&obs->data.canvases_mutex);
+}
+
+static inline void render_canvas(struct obs_canvas *canvas)
+{
+	int cur_texture  = canvas->cur_texture;
+	int prev_texture = cur_texture == 0 ? NUM_TEXTURES-1 : cur_texture-1;
+
+	canvas->rendered = obs->video.total_ticks >= canvas->next_tick;
+	canvas->frame_ready = false;
+
+	if (!canvas->rendered)
+		return;
+
+	render_video(canvas, cur_texture, prev_texture);
+
+	memset(&canvas->frame, 0, sizeof(struct video_data));
+	canvas->frame_ready = download_frame(canvas, prev_texture,
+			&canvas->frame);
+}
+
+static inline void output_canvas(struct obs_canvas *canvas)
+{
+	if (!canvas->rendered)
+		return;
+
+	if (canvas->frame_ready) {
+		struct obs_vframe_info vframe_info;
+		circlebuf_pop_front(&canvas->vframe_info_buffer, &vframe_info,
+				sizeof(vframe_info));
+
+		canvas->frame.timestamp = vframe_info.timestamp;
+		output_video_data(canvas, &canvas->frame, vframe_info.count);
+	}
+
+	if (++canvas->cur_texture == NUM_TEXTURES)
+		canvas->cur_texture = 0;
 }
 
 static const char *output_frame_gs_context_name = "gs_context(video->graphics)";
 static const char *output_frame_render_video_name = "render_video";
-static const char *output_frame_download_frame_name = "download_frame";
 static const char *output_frame_gs_flush_name = "gs_flush";
 static const char *output_frame_output_video_data_name = "output_video_data";
 static inline void output_frame(void)
 {
 	struct obs_core_video *video = &obs->video;
-	int cur_texture  = video->cur_texture;
-	int prev_texture = cur_texture == 0 ? NUM_TEXTURES-1 : cur_texture-1;
-	struct video_data frame;
-	bool frame_ready;
+	struct obs_canvas *canvas;
 
-	memset(&frame, 0, sizeof(struct video_data));
+	/* canvases can't be destroyed while their frame is in flight */
+	pthread_mutex_lock(&obs->data.canvases_mutex);
 
 	profile_start(output_frame_gs_context_name);
 	gs_enter_context(video->graphics);
 
+	/* sources are rendered once for every canvas that shows them, the
+	 * render cache lets later canvases reuse what the first one drew */
 	profile_start(output_frame_render_video_name);
-	render_video(video, cur_texture, prev_texture);
-	profile_end(output_frame_render_video_name);
+	render_canvas(&video->main_canvas);
 
-	profile_start(output_frame_download_frame_name);
-	frame_ready = download_frame(video, prev_texture, &frame);
-	profile_end(output_frame_download_frame_name);
+	canvas = obs->data.first_canvas;
+	while (canvas) {
+		render_canvas(canvas);
+		canvas = canvas->next;
+	}
+	profile_end(output_frame_render_video_name);
 
 	profile_start(output_frame_gs_flush_name);
 	gs_flush();
@@ -562,19 +635,17 @@ static inline void output_frame(void)
 	gs_leave_context();
 	profile_end(output_frame_gs_context_name);
 
-	if (frame_ready) {
-		struct obs_vframe_info vframe_info;
-		circlebuf_pop_front(&video->vframe_info_buffer, &vframe_info,
-				sizeof(vframe_info));
+	profile_start(output_frame_output_video_data_name);
+	output_canvas(&video->main_canvas);
 
-		frame.timestamp = vframe_info.timestamp;
-		profile_start(output_frame_output_video_data_name);
-		output_video_data(video, &frame, vframe_info.count);
-		profile_end(output_frame_output_video_data_name);
+	canvas = obs->data.first_canvas;
+	while (canvas) {
+		output_canvas(canvas);
+		canvas = canvas->next;
 	}
+	profile_end(output_frame_output_video_data_name);
 
-	if (++video->cur_texture == NUM_TEXTURES)
-		video->cur_texture = 0;
+	pthread_mutex_unlock(&obs->data.canvases_mutex);
 }
 
 #define NBSP "\xC2\xA0"
@@ -585,12 +656,14 @@ static const char *output_frame_name = "output_frame";
 void *obs_video_thread(void *param)
 {
 	uint64_t last_time = 0;
-	uint64_t interval = video_output_get_frame_time(obs->video.video);
+	uint64_t interval =
+		video_output_get_frame_time(obs->video.main_canvas.video);
 	uint64_t frame_time_total_ns = 0;
 	uint64_t fps_total_ns = 0;
 	uint32_t fps_total_frames = 0;
 
 	obs->video.video_time = os_gettime_ns();
+	obs->video.total_ticks = 0;
 
 	os_set_thread_name("libobs: graphics thread");
 
@@ -599,7 +672,7 @@ void *obs_video_thread(void *param)
 			"obs_video_thread(%g"NBSP"ms)", interval / 1000000.);
 	profile_register_root(video_thread_name, interval);
 
-	while (!video_output_stopped(obs->video.video)) {
+	while (!video_output_stopped(obs->video.main_canvas.video)) {
 		uint64_t frame_start = os_gettime_ns();
 		uint64_t frame_time_ns;
 
@@ -385,6 +385,26 @@ bool obs_hotkeys_platform_is_pressed(obs_hotkeys_platform_t *context,
 	return vk_down(obs_key_to_virtual_key(key));
 }
 
+bool obs_hotkeys_platform_has_key_events(obs_hotkeys_platform_t *context)
+{
+	UNUSED_PARAMETER(context);
+	return false;
+}
+
+bool obs_hotkeys_platform_wait_key_event(obs_hotkeys_platform_t *context,
+		obs_key_t *key, bool *pressed)
+{
+	UNUSED_PARAMETER(context);
+	*key = OBS_KEY_NONE;
+	*pressed = false;
+	return false;
+}
+
+void obs_hotkeys_platform_wake_key_events(obs_hotkeys_platform_t *context)
+{
+	UNUSED_PARAMETER(context);
+}
+
 void obs_key_to_str(obs_key_t key, struct dstr *str)
 {
 	wchar_t name[128] = L"";
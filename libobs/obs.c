@@ -47,168 +47,167 @@ static inline void make_video_info(struct video_output_info *vi,
 #define GET_ALIGN(val, align) \
 	(((val) + (align-1)) & ~(align-1))
 
-static inline void set_420p_sizes(const struct obs_video_info *ovi)
+static inline void set_420p_sizes(struct obs_canvas *canvas,
+		const struct obs_video_info *ovi)
 {
-	struct obs_core_video *video = &obs->video;
 	uint32_t chroma_pixels;
 	uint32_t total_bytes;
 
 	chroma_pixels = (ovi->output_width * ovi->output_height / 4);
 	chroma_pixels = GET_ALIGN(chroma_pixels, PIXEL_SIZE);
 
-	video->plane_offsets[0] = 0;
-	video->plane_offsets[1] = ovi->output_width * ovi->output_height;
-	video->plane_offsets[2] = video->plane_offsets[1] + chroma_pixels;
+	canvas->plane_offsets[0] = 0;
+	canvas->plane_offsets[1] = ovi->output_width * ovi->output_height;
+	canvas->plane_offsets[2] = canvas->plane_offsets[1] + chroma_pixels;
 
-	video->plane_linewidth[0] = ovi->output_width;
-	video->plane_linewidth[1] = ovi->output_width/2;
-	video->plane_linewidth[2] = ovi->output_width/2;
+	canvas->plane_linewidth[0] = ovi->output_width;
+	canvas->plane_linewidth[1] = ovi->output_width/2;
+	canvas->plane_linewidth[2] = ovi->output_width/2;
 
-	video->plane_sizes[0] = video->plane_offsets[1];
-	video->plane_sizes[1] = video->plane_sizes[0]/4;
-	video->plane_sizes[2] = video->plane_sizes[1];
+	canvas->plane_sizes[0] = canvas->plane_offsets[1];
+	canvas->plane_sizes[1] = canvas->plane_sizes[0]/4;
+	canvas->plane_sizes[2] = canvas->plane_sizes[1];
 
-	total_bytes = video->plane_offsets[2] + chroma_pixels;
+	total_bytes = canvas->plane_offsets[2] + chroma_pixels;
 
-	video->conversion_height =
+	canvas->conversion_height =
 		(total_bytes/PIXEL_SIZE + ovi->output_width-1) /
 		ovi->output_width;
 
-	video->conversion_height = GET_ALIGN(video->conversion_height, 2);
-	video->conversion_tech = "Planar420";
+	canvas->conversion_height = GET_ALIGN(canvas->conversion_height, 2);
+	canvas->conversion_tech = "Planar420";
 }
 
-static inline void set_nv12_sizes(const struct obs_video_info *ovi)
+static inline void set_nv12_sizes(struct obs_canvas *canvas,
+		const struct obs_video_info *ovi)
 {
-	struct obs_core_video *video = &obs->video;
 	uint32_t chroma_pixels;
 	uint32_t total_bytes;
 
 	chroma_pixels = (ovi->output_width * ovi->output_height / 2);
 	chroma_pixels = GET_ALIGN(chroma_pixels, PIXEL_SIZE);
 
-	video->plane_offsets[0] = 0;
-	video->plane_offsets[1] = ovi->output_width * ovi->output_height;
+	canvas->plane_offsets[0] = 0;
+	canvas->plane_offsets[1] = ovi->output_width * ovi->output_height;
 
-	video->plane_linewidth[0] = ovi->output_width;
-	video->plane_linewidth[1] = ovi->output_width;
+	canvas->plane_linewidth[0] = ovi->output_width;
+	canvas->plane_linewidth[1] = ovi->output_width;
 
-	video->plane_sizes[0] = video->plane_offsets[1];
-	video->plane_sizes[1] = video->plane_sizes[0]/2;
+	canvas->plane_sizes[0] = canvas->plane_offsets[1];
+	canvas->plane_sizes[1] = canvas->plane_sizes[0]/2;
 
-	total_bytes = video->plane_offsets[1] + chroma_pixels;
+	total_bytes = canvas->plane_offsets[1] + chroma_pixels;
 
-	video->conversion_height =
+	canvas->conversion_height =
 		(total_bytes/PIXEL_SIZE + ovi->output_width-1) /
 		ovi->output_width;
 
-	video->conversion_height = GET_ALIGN(video->conversion_height, 2);
-	video->conversion_tech = "NV12";
+	canvas->conversion_height = GET_ALIGN(canvas->conversion_height, 2);
+	canvas->conversion_tech = "NV12";
 }
 
-static inline void set_444p_sizes(const struct obs_video_info *ovi)
+static inline void set_444p_sizes(struct obs_canvas *canvas,
+		const struct obs_video_info *ovi)
 {
-	struct obs_core_video *video = &obs->video;
 	uint32_t chroma_pixels;
 	uint32_t total_bytes;
 
 	chroma_pixels = (ovi->output_width * ovi->output_height);
 	chroma_pixels = GET_ALIGN(chroma_pixels, PIXEL_SIZE);
 
-	video->plane_offsets[0] = 0;
-	video->plane_offsets[1] = chroma_pixels;
-	video->plane_offsets[2] = chroma_pixels + chroma_pixels;
+	canvas->plane_offsets[0] = 0;
+	canvas->plane_offsets[1] = chroma_pixels;
+	canvas->plane_offsets[2] = chroma_pixels + chroma_pixels;
 
-	video->plane_linewidth[0] = ovi->output_width;
-	video->plane_linewidth[1] = ovi->output_width;
-	video->plane_linewidth[2] = ovi->output_width;
+	canvas->plane_linewidth[0] = ovi->output_width;
+	canvas->plane_linewidth[1] = ovi->output_width;
+	canvas->plane_linewidth[2] = ovi->output_width;
 
-	video->plane_sizes[0] = chroma_pixels;
-	video->plane_sizes[1] = chroma_pixels;
-	video->plane_sizes[2] = chroma_pixels;
+	canvas->plane_sizes[0] = chroma_pixels;
+	canvas->plane_sizes[1] = chroma_pixels;
+	canvas->plane_sizes[2] = chroma_pixels;
 
-	total_bytes = video->plane_offsets[2] + chroma_pixels;
+	total_bytes = canvas->plane_offsets[2] + chroma_pixels;
 
-	video->conversion_height =
+	canvas->conversion_height =
 		(total_bytes/PIXEL_SIZE + ovi->output_width-1) /
 		ovi->output_width;
 
-	video->conversion_height = GET_ALIGN(video->conversion_height, 2);
-	video->conversion_tech = "Planar444";
+	canvas->conversion_height = GET_ALIGN(canvas->conversion_height, 2);
+	canvas->conversion_tech = "Planar444";
 }
 
-static inline void calc_gpu_conversion_sizes(const struct obs_video_info *ovi)
+static inline void calc_gpu_conversion_sizes(struct obs_canvas *canvas,
+		const struct obs_video_info *ovi)
 {
-	obs->video.conversion_height = 0;
-	memset(obs->video.plane_offsets, 0, sizeof(obs->video.plane_offsets));
-	memset(obs->video.plane_sizes, 0, sizeof(obs->video.plane_sizes));
-	memset(obs->video.plane_linewidth, 0,
-		sizeof(obs->video.plane_linewidth));
+	canvas->conversion_height = 0;
+	memset(canvas->plane_offsets, 0, sizeof(canvas->plane_offsets));
+	memset(canvas->plane_sizes, 0, sizeof(canvas->plane_sizes));
+	memset(canvas->plane_linewidth, 0, sizeof(canvas->plane_linewidth));
 
 	switch ((uint32_t)ovi->output_format) {
 	case VIDEO_FORMAT_I420:
-		set_420p_sizes(ovi);
+		set_420p_sizes(canvas, ovi);
 		break;
 	case VIDEO_FORMAT_NV12:
-		set_nv12_sizes(ovi);
+		set_nv12_sizes(canvas, ovi);
 		break;
 	case VIDEO_FORMAT_I444:
-		set_444p_sizes(ovi);
+		set_444p_sizes(canvas, ovi);
 		break;
 	}
 }
 
-static bool obs_init_gpu_conversion(struct obs_video_info *ovi)
+static bool obs_init_gpu_conversion(struct obs_canvas *canvas,
+		struct obs_video_info *ovi)
 {
-	struct obs_core_video *video = &obs->video;
-
-	calc_gpu_conversion_sizes(ovi);
+	calc_gpu_conversion_sizes(canvas, ovi);
 
-	if (!video->conversion_height) {
+	if (!canvas->conversion_height) {
 		blog(LOG_INFO, "GPU conversion not available for format: %u",
 				(unsigned int)ovi->output_format);
-		video->gpu_conversion = false;
+		canvas->gpu_conversion = false;
 		return true;
 	}
 
 	for (size_t i = 0; i < NUM_TEXTURES; i++) {
-		video->convert_textures[i] = gs_texture_create(
-				ovi->output_width, video->conversion_height,
+		canvas->convert_textures[i] = gs_texture_create(
+				ovi->output_width, canvas->conversion_height,
 				GS_RGBA, 1, NULL, GS_RENDER_TARGET);
 
-		if (!video->convert_textures[i])
+		if (!canvas->convert_textures[i])
 			return false;
 	}
 
 	return true;
 }
 
-static bool obs_init_textures(struct obs_video_info *ovi)
+static bool obs_init_textures(struct obs_canvas *canvas,
+		struct obs_video_info *ovi)
 {
-	struct obs_core_video *video = &obs->video;
-	uint32_t output_height = video->gpu_conversion ?
-		video->conversion_height : ovi->output_height;
+	uint32_t output_height = canvas->gpu_conversion ?
+		canvas->conversion_height : ovi->output_height;
 	size_t i;
 
 	for (i = 0; i < NUM_TEXTURES; i++) {
-		video->copy_surfaces[i] = gs_stagesurface_create(
+		canvas->copy_surfaces[i] = gs_stagesurface_create(
 				ovi->output_width, output_height, GS_RGBA);
 
-		if (!video->copy_surfaces[i])
+		if (!canvas->copy_surfaces[i])
 			return false;
 
-		video->render_textures[i] = gs_texture_create(
+		canvas->render_textures[i] = gs_texture_create(
 				ovi->base_width, ovi->base_height,
 				GS_RGBA, 1, NULL, GS_RENDER_TARGET);
 
-		if (!video->render_textures[i])
+		if (!canvas->render_textures[i])
 			return false;
 
-		video->output_textures[i] = gs_texture_create(
+		canvas->output_textures[i] = gs_texture_create(
 				ovi->output_width, ovi->output_height,
 				GS_RGBA, 1, NULL, GS_RENDER_TARGET);
 
-		if (!video->output_textures[i])
+		if (!canvas->output_textures[i])
 			return false;
 	}
 
@@ -325,7 +324,7 @@ static int obs_init_graphics(struct obs_video_info *ovi)
 	return success ? OBS_VIDEO_SUCCESS : OBS_VIDEO_FAIL;
 }
 
-static inline void set_video_matrix(struct obs_core_video *video,
+static inline void set_video_matrix(struct obs_canvas *canvas,
 		struct obs_video_info *ovi)
 {
 	struct matrix4 mat;
@@ -344,26 +343,27 @@ static inline void set_video_matrix(struct obs_core_video *video,
 		matrix4_identity(&mat);
 	}
 
-	memcpy(video->color_matrix, &mat, sizeof(float) * 16);
+	memcpy(canvas->color_matrix, &mat, sizeof(float) * 16);
 }
 
-static int obs_init_video(struct obs_video_info *ovi)
+int obs_canvas_init_video(struct obs_canvas *canvas,
+		struct obs_video_info *ovi)
 {
-	struct obs_core_video *video = &obs->video;
 	struct video_output_info vi;
+	bool success = true;
 	int errorcode;
 
 	make_video_info(&vi, ovi);
-	video->base_width     = ovi->base_width;
-	video->base_height    = ovi->base_height;
-	video->output_width   = ovi->output_width;
-	video->output_height  = ovi->output_height;
-	video->gpu_conversion = ovi->gpu_conversion;
-	video->scale_type     = ovi->scale_type;
+	canvas->base_width     = ovi->base_width;
+	canvas->base_height    = ovi->base_height;
+	canvas->output_width   = ovi->output_width;
+	canvas->output_height  = ovi->output_height;
+	canvas->gpu_conversion = ovi->gpu_conversion;
+	canvas->scale_type     = ovi->scale_type;
 
-	set_video_matrix(video, ovi);
+	set_video_matrix(canvas, ovi);
 
-	errorcode = video_output_open(&video->video, &vi);
+	errorcode = video_output_open(&canvas->video, &vi);
 
 	if (errorcode != VIDEO_OUTPUT_SUCCESS) {
 		if (errorcode == VIDEO_OUTPUT_INVALIDPARAM) {
@@ -375,22 +375,41 @@ static int obs_init_video(struct obs_video_info *ovi)
 		return OBS_VIDEO_FAIL;
 	}
 
-	gs_enter_context(video->graphics);
+	gs_enter_context(obs->video.graphics);
 
-	if (ovi->gpu_conversion && !obs_init_gpu_conversion(ovi))
-		return OBS_VIDEO_FAIL;
-	if (!obs_init_textures(ovi))
-		return OBS_VIDEO_FAIL;
+	if (ovi->gpu_conversion && !obs_init_gpu_conversion(canvas, ovi))
+		success = false;
+	else if (!obs_init_textures(canvas, ovi))
+		success = false;
 
 	gs_leave_context();
 
+	if (!success)
+		return OBS_VIDEO_FAIL;
+
+	canvas->ovi = *ovi;
+	return OBS_VIDEO_SUCCESS;
+}
+
+static int obs_init_video(struct obs_video_info *ovi)
+{
+	struct obs_core_video *video = &obs->video;
+	struct obs_canvas *canvas = &video->main_canvas;
+	int errorcode;
+
+	canvas->view          = &obs->data.main_view;
+	canvas->frame_divisor = 1;
+
+	errorcode = obs_canvas_init_video(canvas, ovi);
+	if (errorcode != OBS_VIDEO_SUCCESS)
+		return errorcode;
+
 	errorcode = pthread_create(&video->video_thread, NULL,
 			obs_video_thread, obs);
 	if (errorcode != 0)
 		return OBS_VIDEO_FAIL;
 
 	video->thread_initialized = true;
-	video->ovi = *ovi;
 	return OBS_VIDEO_SUCCESS;
 }
 
@@ -399,8 +418,8 @@ static void stop_video(void)
 	struct obs_core_video *video = &obs->video;
 	void *thread_retval;
 
-	if (video->video) {
-		video_output_stop(video->video);
+	if (video->main_canvas.video) {
+		video_output_stop(video->main_canvas.video);
 		if (video->thread_initialized) {
 			pthread_join(video->video_thread, &thread_retval);
 			video->thread_initialized = false;
@@ -409,51 +428,56 @@ static void stop_video(void)
 
 }
 
-static void obs_free_video(void)
+void obs_canvas_free_video(struct obs_canvas *canvas)
 {
-	struct obs_core_video *video = &obs->video;
+	if (!canvas->video)
+		return;
 
-	if (video->video) {
-		video_output_close(video->video);
-		video->video = NULL;
+	video_output_close(canvas->video);
+	canvas->video = NULL;
 
-		if (!video->graphics)
-			return;
+	if (!obs->video.graphics)
+		return;
 
-		gs_enter_context(video->graphics);
+	gs_enter_context(obs->video.graphics);
 
-		if (video->mapped_surface) {
-			gs_stagesurface_unmap(video->mapped_surface);
-			video->mapped_surface = NULL;
-		}
+	if (canvas->mapped_surface) {
+		gs_stagesurface_unmap(canvas->mapped_surface);
+		canvas->mapped_surface = NULL;
+	}
 
-		for (size_t i = 0; i < NUM_TEXTURES; i++) {
-			gs_stagesurface_destroy(video->copy_surfaces[i]);
-			gs_texture_destroy(video->render_textures[i]);
-			gs_texture_destroy(video->convert_textures[i]);
-			gs_texture_destroy(video->output_textures[i]);
+	for (size_t i = 0; i < NUM_TEXTURES; i++) {
+		gs_stagesurface_destroy(canvas->copy_surfaces[i]);
+		gs_texture_destroy(canvas->render_textures[i]);
+		gs_texture_destroy(canvas->convert_textures[i]);
+		gs_texture_destroy(canvas->output_textures[i]);
+
+		canvas->copy_surfaces[i]    = NULL;
+		canvas->render_textures[i]  = NULL;
+		canvas->convert_textures[i] = NULL;
+		canvas->output_textures[i]  = NULL;
+	}
 
-			video->copy_surfaces[i]    = NULL;
-			video->render_textures[i]  = NULL;
-			video->convert_textures[i] = NULL;
-			video->output_textures[i]  = NULL;
-		}
+	gs_leave_context();
 
-		gs_leave_context();
+	circlebuf_free(&canvas->vframe_info_buffer);
 
-		circlebuf_free(&video->vframe_info_buffer);
+	memset(&canvas->textures_rendered, 0,
+			sizeof(canvas->textures_rendered));
+	memset(&canvas->textures_output, 0,
+			sizeof(canvas->textures_output));
+	memset(&canvas->textures_copied, 0,
+			sizeof(canvas->textures_copied));
+	memset(&canvas->textures_converted, 0,
+			sizeof(canvas->textures_converted));
 
-		memset(&video->textures_rendered, 0,
-				sizeof(video->textures_rendered));
-		memset(&video->textures_output, 0,
-				sizeof(video->textures_output));
-		memset(&video->textures_copied, 0,
-				sizeof(video->textures_copied));
-		memset(&video->textures_converted, 0,
-				sizeof(video->textures_converted));
+	canvas->cur_texture = 0;
+	canvas->next_tick   = 0;
+}
 
-		video->cur_texture = 0;
-	}
+static void obs_free_video(void)
+{
+	obs_canvas_free_video(&obs->video.main_canvas);
 }
 
 static void obs_free_graphics(void)
@@ -542,6 +566,7 @@ static bool obs_init_data(void)
 	assert(data != NULL);
 
 	pthread_mutex_init_value(&obs->data.displays_mutex);
+	pthread_mutex_init_value(&obs->data.canvases_mutex);
 	pthread_mutex_init_value(&obs->data.draw_callbacks_mutex);
 
 	if (pthread_mutexattr_init(&attr) != 0)
@@ -554,6 +579,8 @@ static bool obs_init_data(void)
 		goto fail;
 	if (pthread_mutex_init(&data->displays_mutex, &attr) != 0)
 		goto fail;
+	if (pthread_mutex_init(&data->canvases_mutex, NULL) != 0)
+		goto fail;
 	if (pthread_mutex_init(&data->outputs_mutex, &attr) != 0)
 		goto fail;
 	if (pthread_mutex_init(&data->encoders_mutex, &attr) != 0)
@@ -605,6 +632,7 @@ static void obs_free_data(void)
 
 	blog(LOG_INFO, "Freeing OBS context data");
 
+	FREE_OBS_LINKED_LIST(canvas);
 	FREE_OBS_LINKED_LIST(source);
 	FREE_OBS_LINKED_LIST(output);
 	FREE_OBS_LINKED_LIST(encoder);
@@ -614,6 +642,7 @@ static void obs_free_data(void)
 	pthread_mutex_destroy(&data->sources_mutex);
 	pthread_mutex_destroy(&data->audio_sources_mutex);
 	pthread_mutex_destroy(&data->displays_mutex);
+	pthread_mutex_destroy(&data->canvases_mutex);
 	pthread_mutex_destroy(&data->outputs_mutex);
 	pthread_mutex_destroy(&data->encoders_mutex);
 	pthread_mutex_destroy(&data->services_mutex);
@@ -714,6 +743,8 @@ static inline void stop_hotkeys(void)
 
 	if (hotkeys->hotkey_thread_initialized) {
 		os_event_signal(hotkeys->stop_event);
+		obs_hotkeys_platform_wake_key_events(
+				hotkeys->platform_context);
 		pthread_join(hotkeys->hotkey_thread, &thread_ret);
 		hotkeys->hotkey_thread_initialized = false;
 	}
@@ -743,12 +774,36 @@ extern const struct obs_source_info scene_info;
 
 extern void log_system_info(void);
 
+static bool init_types_mutex(void)
+{
+	pthread_mutexattr_t attr;
+	bool success;
+
+	if (pthread_mutexattr_init(&attr) != 0)
+		return false;
+	if (pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE) != 0) {
+		pthread_mutexattr_destroy(&attr);
+		return false;
+	}
+
+	success = pthread_mutex_init(&obs->types_mutex, &attr) == 0;
+	pthread_mutexattr_destroy(&attr);
+	return success;
+}
+
 static bool obs_init(const char *locale, const char *module_config_path,
 		profiler_name_store_t *store)
 {
 	obs = bzalloc(sizeof(struct obs_core));
 
 	pthread_mutex_init_value(&obs->audio.monitoring_mutex);
+	pthread_mutex_init_value(&obs->type_defaults_mutex);
+	pthread_mutex_init_value(&obs->types_mutex);
+
+	if (pthread_mutex_init(&obs->type_defaults_mutex, NULL) != 0)
+		return false;
+	if (!init_types_mutex())
+		return false;
 
 	obs->name_store_owned = !store;
 	obs->name_store = store ? store : profiler_name_store_create();
@@ -832,6 +887,11 @@ void obs_shutdown(void)
 
 #undef FREE_REGISTERED_TYPES
 
+	type_index_free(&obs->source_index);
+	type_index_free(&obs->output_index);
+	type_index_free(&obs->encoder_index);
+	type_index_free(&obs->service_index);
+
 	da_free(obs->input_types);
 	da_free(obs->filter_types);
 	da_free(obs->transition_types);
@@ -856,6 +916,7 @@ void obs_shutdown(void)
 		module = next;
 	}
 	obs->first_module = NULL;
+	free_deferred_types();
 
 	for (size_t i = 0; i < obs->module_paths.num; i++)
 		free_module_path(obs->module_paths.array+i);
@@ -866,6 +927,8 @@ void obs_shutdown(void)
 
 	bfree(obs->module_config_path);
 	bfree(obs->locale);
+	pthread_mutex_destroy(&obs->type_defaults_mutex);
+	pthread_mutex_destroy(&obs->types_mutex);
 	bfree(obs);
 	obs = NULL;
 
@@ -884,6 +947,15 @@ uint32_t obs_get_version(void)
 	return LIBOBS_API_VER;
 }
 
+/* type defaults may depend on the locale or the video settings */
+static void clear_type_defaults(void)
+{
+	type_index_clear_defaults(&obs->source_index);
+	type_index_clear_defaults(&obs->output_index);
+	type_index_clear_defaults(&obs->encoder_index);
+	type_index_clear_defaults(&obs->service_index);
+}
+
 void obs_set_locale(const char *locale)
 {
 	struct obs_module *module;
@@ -894,6 +966,10 @@ void obs_set_locale(const char *locale)
 		bfree(obs->locale);
 	obs->locale = bstrdup(locale);
 
+	/* display names of deferred types are cached for the previous locale */
+	load_deferred_modules();
+	clear_type_defaults();
+
 	module = obs->first_module;
 	while (module) {
 		if (module->set_locale)
@@ -922,7 +998,12 @@ int obs_reset_video(struct obs_video_info *ovi)
 	if (!obs) return OBS_VIDEO_FAIL;
 
 	/* don't allow changing of video settings if active. */
-	if (obs->video.video && video_output_active(obs->video.video))
+	if (obs->video.main_canvas.video &&
+	    video_output_active(obs->video.main_canvas.video))
+		return OBS_VIDEO_CURRENTLY_ACTIVE;
+
+	/* additional canvases run on the main frame clock */
+	if (obs->data.first_canvas)
 		return OBS_VIDEO_CURRENTLY_ACTIVE;
 
 	if (!size_valid(ovi->output_width, ovi->output_height) ||
@@ -933,6 +1014,7 @@ int obs_reset_video(struct obs_video_info *ovi)
 
 	stop_video();
 	obs_free_video();
+	clear_type_defaults();
 
 	/* align to multiple-of-two and SSE alignment sizes */
 	ovi->output_width  &= 0xFFFFFFFC;
@@ -1018,7 +1100,7 @@ bool obs_get_video_info(struct obs_video_info *ovi)
 	if (!obs || !video->graphics)
 		return false;
 
-	*ovi = video->ovi;
+	*ovi = video->main_canvas.ovi;
 	return true;
 }
 
@@ -1039,72 +1121,100 @@ bool obs_get_audio_info(struct obs_audio_info *oai)
 
 bool obs_enum_source_types(size_t idx, const char **id)
 {
+	bool found;
+
 	if (!obs) return false;
 
-	if (idx >= obs->source_types.num)
-		return false;
-	*id = obs->source_types.array[idx].id;
-	return true;
+	pthread_mutex_lock(&obs->types_mutex);
+	found = idx < obs->source_types.num;
+	if (found)
+		*id = obs->source_types.array[idx].id;
+	pthread_mutex_unlock(&obs->types_mutex);
+	return found;
 }
 
 bool obs_enum_input_types(size_t idx, const char **id)
 {
+	bool found;
+
 	if (!obs) return false;
 
-	if (idx >= obs->input_types.num)
-		return false;
-	*id = obs->input_types.array[idx].id;
-	return true;
+	pthread_mutex_lock(&obs->types_mutex);
+	found = idx < obs->input_types.num;
+	if (found)
+		*id = obs->input_types.array[idx].id;
+	pthread_mutex_unlock(&obs->types_mutex);
+	return found;
 }
 
 bool obs_enum_filter_types(size_t idx, const char **id)
 {
+	bool found;
+
 	if (!obs) return false;
 
-	if (idx >= obs->filter_types.num)
-		return false;
-	*id = obs->filter_types.array[idx].id;
-	return true;
+	pthread_mutex_lock(&obs->types_mutex);
+	found = idx < obs->filter_types.num;
+	if (found)
+		*id = obs->filter_types.array[idx].id;
+	pthread_mutex_unlock(&obs->types_mutex);
+	return found;
 }
 
 bool obs_enum_transition_types(size_t idx, const char **id)
 {
+	bool found;
+
 	if (!obs) return false;
 
-	if (idx >= obs->transition_types.num)
-		return false;
-	*id = obs->transition_types.array[idx].id;
-	return true;
+	pthread_mutex_lock(&obs->types_mutex);
+	found = idx < obs->transition_types.num;
+	if (found)
+		*id = obs->transition_types.array[idx].id;
+	pthread_mutex_unlock(&obs->types_mutex);
+	return found;
 }
 
 bool obs_enum_output_types(size_t idx, const char **id)
 {
+	bool found;
+
 	if (!obs) return false;
 
-	if (idx >= obs->output_types.num)
-		return false;
-	*id = obs->output_types.array[idx].id;
-	return true;
+	pthread_mutex_lock(&obs->types_mutex);
+	found = idx < obs->output_types.num;
+	if (found)
+		*id = obs->output_types.array[idx].id;
+	pthread_mutex_unlock(&obs->types_mutex);
+	return found;
 }
 
 bool obs_enum_encoder_types(size_t idx, const char **id)
 {
+	bool found;
+
 	if (!obs) return false;
 
-	if (idx >= obs->encoder_types.num)
-		return false;
-	*id = obs->encoder_types.array[idx].id;
-	return true;
+	pthread_mutex_lock(&obs->types_mutex);
+	found = idx < obs->encoder_types.num;
+	if (found)
+		*id = obs->encoder_types.array[idx].id;
+	pthread_mutex_unlock(&obs->types_mutex);
+	return found;
 }
 
 bool obs_enum_service_types(size_t idx, const char **id)
 {
+	bool found;
+
 	if (!obs) return false;
 
-	if (idx >= obs->service_types.num)
-		return false;
-	*id = obs->service_types.array[idx].id;
-	return true;
+	pthread_mutex_lock(&obs->types_mutex);
+	found = idx < obs->service_types.num;
+	if (found)
+		*id = obs->service_types.array[idx].id;
+	pthread_mutex_unlock(&obs->types_mutex);
+	return found;
 }
 
 void obs_enter_graphics(void)
@@ -1126,7 +1236,7 @@ audio_t *obs_get_audio(void)
 
 video_t *obs_get_video(void)
 {
-	return (obs != NULL) ? obs->video.video : NULL;
+	return (obs != NULL) ? obs->video.main_canvas.video : NULL;
 }
 
 /* TODO: optimize this later so it's not just O(N) string lookups */
@@ -1444,7 +1554,8 @@ float obs_get_master_volume(void)
 	return obs ? obs->audio.user_volume : 0.0f;
 }
 
-static obs_source_t *obs_load_source_type(obs_data_t *source_data)
+static obs_source_t *obs_load_source_type(obs_data_t *source_data,
+		bool defer_create)
 {
 	obs_data_array_t *filters = obs_data_get_array(source_data, "filters");
 	obs_source_t *source;
@@ -1460,7 +1571,9 @@ static obs_source_t *obs_load_source_type(obs_data_t *source_data)
 	int          di_mode;
 	int          monitoring_type;
 
-	source = obs_source_create(id, name, settings, hotkeys);
+	source = defer_create
+		? obs_source_create_deferred(id, name, settings, hotkeys)
+		: obs_source_create(id, name, settings, hotkeys);
 
 	obs_data_release(hotkeys);
 
@@ -1522,7 +1635,7 @@ static obs_source_t *obs_load_source_type(obs_data_t *source_data)
 				obs_data_array_item(filters, i);
 
 			obs_source_t *filter = obs_load_source_type(
-					filter_data);
+					filter_data, false);
 			if (filter) {
 				obs_source_filter_add(source, filter);
 				obs_source_release(filter);
@@ -1541,7 +1654,75 @@ static obs_source_t *obs_load_source_type(obs_data_t *source_data)
 
 obs_source_t *obs_load_source(obs_data_t *source_data)
 {
-	return obs_load_source_type(source_data);
+	return obs_load_source_type(source_data, false);
+}
+
+#define MAX_CREATE_THREADS 16
+
+struct create_queue {
+	obs_source_t **sources;
+	size_t num;
+	volatile long next;
+};
+
+static void *create_thread(void *param)
+{
+	struct create_queue *queue = param;
+	long idx;
+
+	os_set_thread_name("libobs: source create thread");
+
+	while ((idx = os_atomic_inc_long(&queue->next) - 1) <
+			(long)queue->num)
+		obs_source_deferred_create(queue->sources[idx]);
+
+	return NULL;
+}
+
+/*
+ * Calls the create callbacks that were deferred while loading.  They run
+ * concurrently, so loading takes as long as the slowest source instead of
+ * the sum of all of them.
+ */
+static void create_deferred_sources(obs_source_t **sources, size_t count)
+{
+	DARRAY(obs_source_t*) pending;
+	pthread_t threads[MAX_CREATE_THREADS];
+	struct create_queue queue;
+	size_t num_threads = 0;
+
+	da_init(pending);
+
+	for (size_t i = 0; i < count; i++) {
+		if (sources[i] &&
+		    os_atomic_load_bool(&sources[i]->create_pending))
+			da_push_back(pending, &sources[i]);
+	}
+
+	if (!pending.num)
+		return;
+
+	queue.sources = pending.array;
+	queue.num     = pending.num;
+	queue.next    = 0;
+
+	for (size_t i = 1; i < pending.num && i < MAX_CREATE_THREADS; i++) {
+		if (pthread_create(&threads[num_threads], NULL, create_thread,
+					&queue) != 0)
+			break;
+		num_threads++;
+	}
+
+	/* the loading thread takes part as well, and does all the work if
+	 * no thread could be created */
+	create_thread(&queue);
+
+	for (size_t i = 0; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+
+	blog(LOG_DEBUG, "Created %d sources on %d threads",
+			(int)pending.num, (int)num_threads + 1);
+	da_free(pending);
 }
 
 void obs_load_sources(obs_data_array_t *array, obs_load_source_cb cb,
@@ -1561,15 +1742,29 @@ void obs_load_sources(obs_data_array_t *array, obs_load_source_cb cb,
 
 	pthread_mutex_lock(&data->sources_mutex);
 
+	/* build every source first, the expensive create callbacks of
+	 * sources that allow it run afterwards on worker threads */
 	for (i = 0; i < count; i++) {
 		obs_data_t   *source_data = obs_data_array_item(array, i);
-		obs_source_t *source      = obs_load_source(source_data);
+		obs_source_t *source      = obs_load_source_type(source_data,
+				true);
 
 		da_push_back(sources, &source);
 
 		obs_data_release(source_data);
 	}
 
+	/* create callbacks may look up other sources, which would deadlock
+	 * while this thread waits for them */
+	pthread_mutex_unlock(&data->sources_mutex);
+	create_deferred_sources(sources.array, sources.num);
+	pthread_mutex_lock(&data->sources_mutex);
+
+	/* source_create of every loaded source, in load order, now that all
+	 * of them have been created */
+	for (i = 0; i < sources.num; i++)
+		obs_source_deferred_finish(sources.array[i]);
+
 	/* tell sources that we want to load */
 	for (i = 0; i < sources.num; i++) {
 		obs_source_t *source = sources.array[i];
@@ -1578,7 +1773,8 @@ void obs_load_sources(obs_data_array_t *array, obs_load_source_cb cb,
 			if (source->info.type == OBS_SOURCE_TYPE_TRANSITION)
 				obs_transition_load(source, source_data);
 			obs_source_load(source);
-			cb(private_data, source);
+			if (cb)
+				cb(private_data, source);
 		}
 		obs_data_release(source_data);
 	}
@@ -1666,8 +1862,107 @@ obs_data_t *obs_save_source(obs_source_t *source)
 	return source_data;
 }
 
-obs_data_array_t *obs_save_sources_filtered(obs_save_source_filter_cb cb,
-		void *data_)
+/* replaces the live settings objects with copies */
+static void detach_source_data(obs_data_t *source_data)
+{
+	obs_data_t *settings = obs_data_get_obj(source_data, "settings");
+	obs_data_array_t *filters = obs_data_get_array(source_data, "filters");
+
+	if (settings) {
+		obs_data_t *copy = obs_data_create_from_json(
+				obs_data_get_json(settings));
+		obs_data_set_obj(source_data, "settings", copy);
+		obs_data_release(copy);
+		obs_data_release(settings);
+	}
+
+	if (filters) {
+		size_t count = obs_data_array_count(filters);
+
+		for (size_t i = 0; i < count; i++) {
+			obs_data_t *filter_data = obs_data_array_item(filters,
+					i);
+			detach_source_data(filter_data);
+			obs_data_release(filter_data);
+		}
+
+		obs_data_array_release(filters);
+	}
+}
+
+/*
+ * Changes to sources with a save callback can't be tracked, the callback may
+ * save anything.  Scenes are the exception, their items mark them as dirty.
+ */
+static bool can_reuse_snapshot(obs_source_t *source)
+{
+	bool reuse = true;
+
+	if (source->info.type == OBS_SOURCE_TYPE_TRANSITION)
+		return false;
+	if (source->info.save && source->info.type != OBS_SOURCE_TYPE_SCENE)
+		return false;
+
+	pthread_mutex_lock(&source->filter_mutex);
+
+	for (size_t i = 0; i < source->filters.num; i++) {
+		if (source->filters.array[i]->info.save) {
+			reuse = false;
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&source->filter_mutex);
+	return reuse;
+}
+
+obs_data_t *obs_save_source_snapshot(obs_source_t *source)
+{
+	struct obs_core_data *data;
+	obs_data_t *snapshot;
+	long gen, global_gen;
+	bool reuse;
+
+	if (!obs_source_valid(source, "obs_save_source_snapshot"))
+		return NULL;
+
+	data = &obs->data;
+	reuse = can_reuse_snapshot(source);
+
+	pthread_mutex_lock(&data->sources_mutex);
+
+	/* read before saving, so changes made while saving invalidate the
+	 * snapshot */
+	gen = os_atomic_load_long(&source->save_gen);
+	global_gen = os_atomic_load_long(&data->save_gen);
+
+	if (reuse && source->save_snapshot &&
+	    source->save_snapshot_gen == gen &&
+	    source->save_snapshot_global_gen == global_gen) {
+		snapshot = source->save_snapshot;
+		obs_data_addref(snapshot);
+
+	} else {
+		snapshot = obs_save_source(source);
+		detach_source_data(snapshot);
+
+		obs_data_release(source->save_snapshot);
+		source->save_snapshot = NULL;
+
+		if (reuse) {
+			obs_data_addref(snapshot);
+			source->save_snapshot = snapshot;
+			source->save_snapshot_gen = gen;
+			source->save_snapshot_global_gen = global_gen;
+		}
+	}
+
+	pthread_mutex_unlock(&data->sources_mutex);
+	return snapshot;
+}
+
+static obs_data_array_t *save_sources_filtered(obs_save_source_filter_cb cb,
+		void *data_, bool snapshot)
 {
 	if (!obs) return NULL;
 
@@ -1684,7 +1979,9 @@ obs_data_array_t *obs_save_sources_filtered(obs_save_source_filter_cb cb,
 	while (source) {
 		if ((source->info.type != OBS_SOURCE_TYPE_FILTER) != 0 &&
 				!source->context.private && cb(data_, source)) {
-			obs_data_t *source_data = obs_save_source(source);
+			obs_data_t *source_data = snapshot
+				? obs_save_source_snapshot(source)
+				: obs_save_source(source);
 
 			obs_data_array_push_back(array, source_data);
 			obs_data_release(source_data);
@@ -1698,6 +1995,18 @@ obs_data_array_t *obs_save_sources_filtered(obs_save_source_filter_cb cb,
 	return array;
 }
 
+obs_data_array_t *obs_save_sources_filtered(obs_save_source_filter_cb cb,
+		void *data_)
+{
+	return save_sources_filtered(cb, data_, false);
+}
+
+obs_data_array_t *obs_save_sources_snapshot_filtered(
+		obs_save_source_filter_cb cb, void *data_)
+{
+	return save_sources_filtered(cb, data_, true);
+}
+
 static bool save_source_filter(void *data, obs_source_t *source)
 {
 	UNUSED_PARAMETER(data);
@@ -1974,3 +2283,22 @@ uint32_t obs_get_lagged_frames(void)
 {
 	return obs ? obs->video.lagged_frames : 0;
 }
+
+uint32_t obs_get_audio_buffering_events(void)
+{
+	return obs ? (uint32_t)obs->audio.buffering_events : 0;
+}
+
+uint32_t obs_get_audio_buffering_ms(void)
+{
+	struct obs_core_audio *audio;
+	uint64_t frames;
+
+	if (!obs || !obs->audio.audio)
+		return 0;
+
+	audio = &obs->audio;
+	frames = (uint64_t)audio->total_buffering_ticks * AUDIO_OUTPUT_FRAMES;
+	return (uint32_t)(frames * 1000 /
+			audio_output_get_sample_rate(audio->audio));
+}
@@ -41,6 +41,7 @@ struct matrix4;
 /* opaque types */
 struct obs_display;
 struct obs_view;
+struct obs_canvas;
 struct obs_source;
 struct obs_scene;
 struct obs_scene_item;
@@ -53,6 +54,7 @@ struct obs_volmeter;
 
 typedef struct obs_display    obs_display_t;
 typedef struct obs_view       obs_view_t;
+typedef struct obs_canvas     obs_canvas_t;
 typedef struct obs_source     obs_source_t;
 typedef struct obs_scene      obs_scene_t;
 typedef struct obs_scene_item obs_sceneitem_t;
@@ -290,7 +292,8 @@ EXPORT profiler_name_store_t *obs_get_profiler_name_store(void);
  * @return       OBS_VIDEO_SUCCESS if successful
  *               OBS_VIDEO_NOT_SUPPORTED if the adapter lacks capabilities
  *               OBS_VIDEO_INVALID_PARAM if a parameter is invalid
- *               OBS_VIDEO_CURRENTLY_ACTIVE if video is currently active
+ *               OBS_VIDEO_CURRENTLY_ACTIVE if video is currently active or
+ *                                          canvases exist
  *               OBS_VIDEO_MODULE_NOT_FOUND if the graphics module is not found
  *               OBS_VIDEO_FAIL for generic failure
  */
@@ -371,7 +374,15 @@ EXPORT const char *obs_get_module_data_path(obs_module_t *module);
  */
 EXPORT void obs_add_module_path(const char *bin, const char *data);
 
-/** Automatically loads all modules from module paths (convenience function) */
+/**
+ * Automatically loads all modules from module paths (convenience function)
+ *
+ *   The types each module registers are cached in a manifest in the module
+ * config path.  Modules that are unchanged since the manifest was written
+ * are not opened; their types are available right away and the module is
+ * loaded the first time one of its types is created, or when defaults or
+ * properties of one of its types are requested.
+ */
 EXPORT void obs_load_all_modules(void);
 
 struct obs_module_info {
@@ -559,7 +570,10 @@ EXPORT obs_source_t *obs_load_source(obs_data_t *data);
 
 typedef void (*obs_load_source_cb)(void *private_data, obs_source_t *source);
 
-/** Loads sources from a data array */
+/**
+ * Loads sources from a data array.  The callback is called for each loaded
+ * source in the order of the array, and may be NULL.
+ */
 EXPORT void obs_load_sources(obs_data_array_t *array, obs_load_source_cb cb,
 		void *private_data);
 
@@ -570,6 +584,20 @@ typedef bool (*obs_save_source_filter_cb)(void *data, obs_source_t *source);
 EXPORT obs_data_array_t *obs_save_sources_filtered(obs_save_source_filter_cb cb,
 		void *data);
 
+/**
+ * Saves a source to settings data that can be passed to another thread
+ *
+ * Unlike obs_save_source, the data does not reference the live settings of
+ * the source.  Sources that have not changed since the last snapshot return
+ * the previous snapshot without saving it again, so the returned data must
+ * not be modified.
+ */
+EXPORT obs_data_t *obs_save_source_snapshot(obs_source_t *source);
+
+/** Saves sources to a data array of snapshots, see obs_save_source_snapshot */
+EXPORT obs_data_array_t *obs_save_sources_snapshot_filtered(
+		obs_save_source_filter_cb cb, void *data);
+
 enum obs_obj_type {
 	OBS_OBJ_TYPE_INVALID,
 	OBS_OBJ_TYPE_SOURCE,
@@ -632,6 +660,56 @@ EXPORT uint64_t obs_get_average_frame_time_ns(void);
 EXPORT uint32_t obs_get_total_frames(void);
 EXPORT uint32_t obs_get_lagged_frames(void);
 
+/** Gets the number of times audio buffering had to be increased */
+EXPORT uint32_t obs_get_audio_buffering_events(void);
+
+/** Gets the amount of audio buffering currently in use */
+EXPORT uint32_t obs_get_audio_buffering_ms(void);
+
+
+/* ------------------------------------------------------------------------- */
+/* Canvases */
+
+/**
+ * Creates an additional canvas, which composites its own sources at its own
+ * resolution and outputs the result through its own video output.
+ *
+ *   Canvases share the sources, graphics context and frame clock of the main
+ * canvas set up by obs_reset_video.  Sources are ticked once per frame no
+ * matter how many canvases show them, and a source shown in several canvases
+ * is rendered once and reused.  The video settings can't be reset while any
+ * canvas exists.
+ *
+ * @param  ovi            Base/output resolution, output format, color space
+ *                        and scale type of the canvas.  The frame rate and
+ *                        graphics settings are taken from the main canvas.
+ * @param  frame_divisor  The canvas outputs every frame_divisor-th frame of
+ *                        the main canvas.
+ * @return                The new canvas, or NULL if failed.
+ */
+EXPORT obs_canvas_t *obs_canvas_create(const struct obs_video_info *ovi,
+		uint32_t frame_divisor);
+
+/** Destroys a canvas, outputs must stop using its video output first */
+EXPORT void obs_canvas_destroy(obs_canvas_t *canvas);
+
+/** Gets the video output of a canvas, to be used with encoders */
+EXPORT video_t *obs_canvas_get_video(const obs_canvas_t *canvas);
+
+/** Gets the video settings of a canvas */
+EXPORT bool obs_canvas_get_video_info(const obs_canvas_t *canvas,
+		struct obs_video_info *ovi);
+
+EXPORT uint32_t obs_canvas_get_frame_divisor(const obs_canvas_t *canvas);
+
+/** Sets the source of a channel of the canvas, which activates it */
+EXPORT void obs_canvas_set_source(obs_canvas_t *canvas, uint32_t channel,
+		obs_source_t *source);
+
+/** Gets the source of a channel of the canvas */
+EXPORT obs_source_t *obs_canvas_get_source(obs_canvas_t *canvas,
+		uint32_t channel);
+
 
 /* ------------------------------------------------------------------------- */
 /* Display context */
@@ -950,6 +1028,13 @@ EXPORT void obs_source_set_monitoring_type(obs_source_t *source,
 EXPORT enum obs_monitoring_type obs_source_get_monitoring_type(
 		const obs_source_t *source);
 
+/**
+ * Returns the current latency of the source's audio monitoring in
+ * nanoseconds, or 0 if it isn't monitored or the monitoring backend doesn't
+ * measure it.
+ */
+EXPORT uint64_t obs_source_get_monitoring_latency(const obs_source_t *source);
+
 /* ------------------------------------------------------------------------- */
 /* Functions used by sources */
 
@@ -990,6 +1075,26 @@ EXPORT void obs_source_draw(gs_texture_t *image, int x, int y,
 EXPORT void obs_source_output_video(obs_source_t *source,
 		const struct obs_source_frame *frame);
 
+/**
+ * Outputs asynchronous video data that stays owned by the caller.
+ *
+ *   libobs calls release(param) exactly once, from any thread, when it no
+ * longer needs the frame data.  Packed formats and tightly packed I420/NV12
+ * frames are used without copying until the frame has been rendered or
+ * dropped, other frames are copied and released right away.  Async video
+ * filters always get a copy.  If release is NULL this is the same as
+ * obs_source_output_video.
+ */
+EXPORT void obs_source_output_video_external(obs_source_t *source,
+		const struct obs_source_frame *frame,
+		void (*release)(void *param), void *param);
+
+/**
+ * Drops the asynchronous video frames that are still queued, so the buffers
+ * of frames output with obs_source_output_video_external are released
+ */
+EXPORT void obs_source_flush_async_video(obs_source_t *source);
+
 /** Preloads asynchronous video data to allow instantaneous playback */
 EXPORT void obs_source_preload_video(obs_source_t *source,
 		const struct obs_source_frame *frame);
@@ -1217,6 +1322,20 @@ EXPORT obs_source_t *obs_scene_get_source(const obs_scene_t *scene);
 /** Gets the scene from its source, or NULL if not a scene */
 EXPORT obs_scene_t *obs_scene_from_source(const obs_source_t *source);
 
+/**
+ * Marks the video output of a source as changed, for sources and filters with
+ * the OBS_SOURCE_STATIC_CONTENT flag.  Invalidating a filter invalidates the
+ * source it is attached to.
+ */
+EXPORT void obs_source_invalidate_content(obs_source_t *source);
+
+/**
+ * Gets the number of items that were skipped when the scene was last
+ * rendered, because they were outside of the canvas or covered by opaque
+ * items above them
+ */
+EXPORT size_t obs_scene_get_culled_item_count(const obs_scene_t *scene);
+
 /** Determines whether a source is within a scene */
 EXPORT obs_sceneitem_t *obs_scene_find_source(obs_scene_t *scene,
 		const char *name);
@@ -53,3 +53,14 @@ static inline bool os_atomic_load_bool(const volatile bool *ptr)
 {
 	return !!_InterlockedOr8((volatile char*)ptr, 0);
 }
+
+static inline void *os_atomic_set_ptr(void *volatile *ptr, void *val)
+{
+	return _InterlockedExchangePointer(ptr, val);
+}
+
+static inline void *os_atomic_load_ptr(void *const volatile *ptr)
+{
+	return _InterlockedCompareExchangePointer((void *volatile*)ptr,
+			NULL, NULL);
+}
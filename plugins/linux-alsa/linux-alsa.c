@@ -17,6 +17,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <obs-module.h>
 
 OBS_DECLARE_MODULE()
+OBS_MODULE_DEFERRABLE()
 OBS_MODULE_USE_DEFAULT_LOCALE("linux-alsa", "en-US")
 
 extern struct obs_source_info alsa_input_capture;
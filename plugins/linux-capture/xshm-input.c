@@ -453,6 +453,18 @@ static void xshm_video_render(void *vptr, gs_effect_t *effect)
 	}
 }
 
+/**
+ * Whether the capture draws opaque pixels over its whole area
+ *
+ * @note called from the graphics thread, which also creates and destroys
+ *       the texture
+ */
+static bool xshm_video_opaque(void *vptr)
+{
+	XSHM_DATA(vptr);
+	return data->texture != NULL;
+}
+
 /**
  * Width of the captured data
  */
@@ -476,7 +488,8 @@ struct obs_source_info xshm_input = {
 	.type           = OBS_SOURCE_TYPE_INPUT,
 	.output_flags   = OBS_SOURCE_VIDEO |
 	                  OBS_SOURCE_CUSTOM_DRAW |
-	                  OBS_SOURCE_DO_NOT_DUPLICATE,
+	                  OBS_SOURCE_DO_NOT_DUPLICATE |
+	                  OBS_SOURCE_OPAQUE,
 	.get_name       = xshm_getname,
 	.create         = xshm_create,
 	.destroy        = xshm_destroy,
@@ -486,5 +499,6 @@ struct obs_source_info xshm_input = {
 	.video_tick     = xshm_video_tick,
 	.video_render   = xshm_video_render,
 	.get_width      = xshm_getwidth,
-	.get_height     = xshm_getheight
+	.get_height     = xshm_getheight,
+	.video_opaque   = xshm_video_opaque
 };
@@ -524,7 +524,8 @@ struct obs_source_info pulse_input_capture = {
 	.id             = "pulse_input_capture",
 	.type           = OBS_SOURCE_TYPE_INPUT,
 	.output_flags   = OBS_SOURCE_AUDIO |
-	                  OBS_SOURCE_DO_NOT_DUPLICATE,
+	                  OBS_SOURCE_DO_NOT_DUPLICATE |
+	                  OBS_SOURCE_DYNAMIC_DEFAULTS,
 	.get_name       = pulse_input_getname,
 	.create         = pulse_create,
 	.destroy        = pulse_destroy,
@@ -538,7 +539,8 @@ struct obs_source_info pulse_output_capture = {
 	.type           = OBS_SOURCE_TYPE_INPUT,
 	.output_flags   = OBS_SOURCE_AUDIO |
 	                  OBS_SOURCE_DO_NOT_DUPLICATE |
-	                  OBS_SOURCE_DO_NOT_SELF_MONITOR,
+	                  OBS_SOURCE_DO_NOT_SELF_MONITOR |
+	                  OBS_SOURCE_DYNAMIC_DEFAULTS,
 	.get_name       = pulse_output_getname,
 	.create         = pulse_create,
 	.destroy        = pulse_destroy,
@@ -194,7 +194,9 @@ int_fast32_t v4l2_stop_capture(int_fast32_t dev);
 /**
  * Create memory mapping for buffers
  *
- * This tries to map at least 2, preferably 4, buffers to application memory.
+ * This tries to map at least 2, preferably 8, buffers to application memory.
+ * Buffers beyond the first two can be held by libobs until a frame has been
+ * rendered, so the extra buffers avoid copying frames.
  *
  * @param dev handle for the v4l2 device
  * @param buf buffer data
@@ -31,6 +31,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <util/threading.h>
 #include <util/bmem.h>
+#include <util/darray.h>
 #include <util/dstr.h>
 #include <util/platform.h>
 #include <obs-module.h>
@@ -41,6 +42,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "v4l2-udev.h"
 #endif
 
+#if HAVE_MJPEG
+#include "v4l2-mjpeg.h"
+#endif
+
 /* The new dv timing api was introduced in Linux 3.4
  * Currently we simply disable dv timings when this is not defined */
 #if !defined(VIDIOC_ENUM_DV_TIMINGS) || !defined(V4L2_IN_CAP_DV_TIMINGS)
@@ -63,6 +68,43 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #define blog(level, msg, ...) blog(level, "v4l2-input: " msg, ##__VA_ARGS__)
 
+/* buffers that always stay queued in the driver, frames beyond this are
+ * copied by libobs instead of being handed over */
+#define V4L2_MIN_QUEUED_BUFFERS 2
+
+struct v4l2_buffer_pool;
+
+/**
+ * Reference to a mapped buffer that is owned by libobs
+ */
+struct v4l2_buffer_slot {
+	struct v4l2_buffer_pool *pool;
+	uint32_t index;
+};
+
+/**
+ * Mapped buffers shared between the capture thread and libobs
+ *
+ * Every frame that is handed to libobs without a copy holds a reference to
+ * the pool.  Once libobs is done with the frame the buffer index is put on the
+ * requeue list, which is drained by the capture thread.  When the source is
+ * deactivated it waits on the released condition until libobs has given back
+ * every buffer, and the device handle and the mappings are released together
+ * with the last reference.
+ */
+struct v4l2_buffer_pool {
+	volatile long refs;
+	volatile long outstanding;
+
+	int_fast32_t dev;
+	struct v4l2_buffer_data buffers;
+	struct v4l2_buffer_slot *slots;
+
+	pthread_mutex_t mutex;
+	pthread_cond_t released;
+	DARRAY(uint32_t) requeue;
+};
+
 /**
  * Data structure for the v4l2 source
  */
@@ -85,13 +127,122 @@ struct v4l2_data {
 	int width;
 	int height;
 	int linesize;
-	struct v4l2_buffer_data buffers;
+	struct v4l2_buffer_pool *pool;
+#if HAVE_MJPEG
+	struct v4l2_mjpeg_decoder *mjpeg;
+#endif
 };
 
 /* forward declarations */
 static void v4l2_init(struct v4l2_data *data);
 static void v4l2_terminate(struct v4l2_data *data);
 
+static struct v4l2_buffer_pool *v4l2_buffer_pool_create(int_fast32_t dev)
+{
+	struct v4l2_buffer_pool *pool = bzalloc(sizeof(*pool));
+
+	pool->refs = 1;
+	pool->dev  = dev;
+
+	if (pthread_mutex_init(&pool->mutex, NULL) != 0) {
+		bfree(pool);
+		return NULL;
+	}
+	if (pthread_cond_init(&pool->released, NULL) != 0) {
+		pthread_mutex_destroy(&pool->mutex);
+		bfree(pool);
+		return NULL;
+	}
+
+	if (v4l2_create_mmap(dev, &pool->buffers) < 0) {
+		v4l2_destroy_mmap(&pool->buffers);
+		pthread_cond_destroy(&pool->released);
+		pthread_mutex_destroy(&pool->mutex);
+		bfree(pool);
+		return NULL;
+	}
+
+	pool->slots = bzalloc(pool->buffers.count * sizeof(*pool->slots));
+	for (uint_fast32_t i = 0; i < pool->buffers.count; ++i) {
+		pool->slots[i].pool  = pool;
+		pool->slots[i].index = (uint32_t)i;
+	}
+
+	return pool;
+}
+
+/*
+ * Check if frames of a pixel format can be passed on to obs
+ */
+static inline bool v4l2_format_supported(uint_fast32_t pixfmt)
+{
+#if HAVE_MJPEG
+	if (pixfmt == V4L2_PIX_FMT_MJPEG)
+		return true;
+#endif
+	return v4l2_to_obs_video_format(pixfmt) != VIDEO_FORMAT_NONE;
+}
+
+static void v4l2_buffer_pool_release(struct v4l2_buffer_pool *pool)
+{
+	if (!pool || os_atomic_dec_long(&pool->refs) != 0)
+		return;
+
+	v4l2_destroy_mmap(&pool->buffers);
+	if (pool->dev != -1)
+		v4l2_close(pool->dev);
+
+	da_free(pool->requeue);
+	pthread_cond_destroy(&pool->released);
+	pthread_mutex_destroy(&pool->mutex);
+	bfree(pool->slots);
+	bfree(pool);
+}
+
+/*
+ * Called by libobs once it no longer needs the data of a frame
+ */
+static void v4l2_release_buffer(void *param)
+{
+	struct v4l2_buffer_slot *slot = param;
+	struct v4l2_buffer_pool *pool = slot->pool;
+
+	pthread_mutex_lock(&pool->mutex);
+	da_push_back(pool->requeue, &slot->index);
+
+	/* the source keeps its own reference until every buffer is back, so
+	 * this is never the last one */
+	os_atomic_dec_long(&pool->refs);
+	if (os_atomic_dec_long(&pool->outstanding) == 0)
+		pthread_cond_broadcast(&pool->released);
+	pthread_mutex_unlock(&pool->mutex);
+}
+
+/*
+ * Give buffers released by libobs back to the driver
+ */
+static int_fast32_t v4l2_requeue_buffers(struct v4l2_buffer_pool *pool)
+{
+	struct v4l2_buffer buf;
+	int_fast32_t ret = 0;
+
+	memset(&buf, 0, sizeof(buf));
+	buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	buf.memory = V4L2_MEMORY_MMAP;
+
+	pthread_mutex_lock(&pool->mutex);
+
+	for (size_t i = 0; i < pool->requeue.num; i++) {
+		buf.index = pool->requeue.array[i];
+		if (v4l2_ioctl(pool->dev, VIDIOC_QBUF, &buf) < 0)
+			ret = -1;
+	}
+	da_resize(pool->requeue, 0);
+
+	pthread_mutex_unlock(&pool->mutex);
+	return ret;
+}
+
 /**
  * Prepare the output frame structure for obs and compute plane offsets
  *
@@ -152,20 +303,31 @@ static void *v4l2_thread(void *vptr)
 	fd_set fds;
 	uint8_t *start;
 	uint64_t frames;
+	uint64_t copied;
 	uint64_t first_ts;
 	struct timeval tv;
 	struct v4l2_buffer buf;
 	struct obs_source_frame out;
 	size_t plane_offsets[MAX_AV_PLANES];
+	struct v4l2_buffer_pool *pool = data->pool;
+	long max_outstanding;
 
-	if (v4l2_start_capture(data->dev, &data->buffers) < 0)
+	if (v4l2_start_capture(data->dev, &pool->buffers) < 0)
 		goto exit;
 
+	max_outstanding = (long)pool->buffers.count - V4L2_MIN_QUEUED_BUFFERS;
+
 	frames   = 0;
+	copied   = 0;
 	first_ts = 0;
 	v4l2_prep_obs_frame(data, &out, plane_offsets);
 
 	while (os_event_try(data->event) == EAGAIN) {
+		if (v4l2_requeue_buffers(pool) < 0) {
+			blog(LOG_DEBUG, "failed to enqueue buffer");
+			break;
+		}
+
 		FD_ZERO(&fds);
 		FD_SET(data->dev, &fds);
 		tv.tv_sec = 1;
@@ -197,20 +359,51 @@ static void *v4l2_thread(void *vptr)
 			first_ts = out.timestamp;
 		out.timestamp -= first_ts;
 
-		start = (uint8_t *) data->buffers.info[buf.index].start;
+		start = (uint8_t *) pool->buffers.info[buf.index].start;
+
+#if HAVE_MJPEG
+		if (data->mjpeg) {
+			/* the decoder copies the compressed data */
+			v4l2_mjpeg_decode(data->mjpeg, start, buf.bytesused,
+					out.timestamp);
+
+			if (v4l2_ioctl(data->dev, VIDIOC_QBUF, &buf) < 0) {
+				blog(LOG_DEBUG, "failed to enqueue buffer");
+				break;
+			}
+
+			frames++;
+			continue;
+		}
+#endif
+
 		for (uint_fast32_t i = 0; i < MAX_AV_PLANES; ++i)
 			out.data[i] = start + plane_offsets[i];
-		obs_source_output_video(data->source, &out);
 
-		if (v4l2_ioctl(data->dev, VIDIOC_QBUF, &buf) < 0) {
-			blog(LOG_DEBUG, "failed to enqueue buffer");
-			break;
+		/* hand the buffer to libobs unless that would starve the
+		 * driver, in which case libobs copies the frame */
+		if (os_atomic_load_long(&pool->outstanding) < max_outstanding) {
+			os_atomic_inc_long(&pool->outstanding);
+			os_atomic_inc_long(&pool->refs);
+
+			obs_source_output_video_external(data->source, &out,
+					v4l2_release_buffer,
+					&pool->slots[buf.index]);
+		} else {
+			obs_source_output_video(data->source, &out);
+
+			if (v4l2_ioctl(data->dev, VIDIOC_QBUF, &buf) < 0) {
+				blog(LOG_DEBUG, "failed to enqueue buffer");
+				break;
+			}
+			copied++;
 		}
 
 		frames++;
 	}
 
-	blog(LOG_INFO, "Stopped capture after %"PRIu64" frames", frames);
+	blog(LOG_INFO, "Stopped capture after %"PRIu64" frames "
+			"(%"PRIu64" copied)", frames, copied);
 
 exit:
 	v4l2_stop_capture(data->dev);
@@ -388,8 +581,7 @@ static void v4l2_format_list(int dev, obs_property_t *prop)
 		if (fmt.flags & V4L2_FMT_FLAG_EMULATED)
 			dstr_cat(&buffer, " (Emulated)");
 
-		if (v4l2_to_obs_video_format(fmt.pixelformat)
-				!= VIDEO_FORMAT_NONE) {
+		if (v4l2_format_supported(fmt.pixelformat)) {
 			obs_property_list_add_int(prop, buffer.array,
 					fmt.pixelformat);
 			blog(LOG_INFO, "Pixelformat: %s (available)",
@@ -784,7 +976,30 @@ static void v4l2_terminate(struct v4l2_data *data)
 		data->thread = 0;
 	}
 
-	v4l2_destroy_mmap(&data->buffers);
+#if HAVE_MJPEG
+	v4l2_mjpeg_destroy(data->mjpeg);
+	data->mjpeg = NULL;
+#endif
+
+	if (data->pool) {
+		struct v4l2_buffer_pool *pool = data->pool;
+
+		/* drop queued frames so the buffers come back, then wait for
+		 * the renderer to let go of the frame it may be uploading,
+		 * the device can only be opened again once it is unmapped */
+		obs_source_output_video(data->source, NULL);
+		obs_source_flush_async_video(data->source);
+
+		pthread_mutex_lock(&pool->mutex);
+		while (os_atomic_load_long(&pool->outstanding) > 0)
+			pthread_cond_wait(&pool->released, &pool->mutex);
+		pthread_mutex_unlock(&pool->mutex);
+
+		/* the pool closes the device with the last reference */
+		v4l2_buffer_pool_release(data->pool);
+		data->pool = NULL;
+		data->dev  = -1;
+	}
 
 	if (data->dev != -1) {
 		v4l2_close(data->dev);
@@ -874,7 +1089,7 @@ static void v4l2_init(struct v4l2_data *data)
 		blog(LOG_ERROR, "Unable to set format");
 		goto fail;
 	}
-	if (v4l2_to_obs_video_format(data->pixfmt) == VIDEO_FORMAT_NONE) {
+	if (!v4l2_format_supported(data->pixfmt)) {
 		blog(LOG_ERROR, "Selected video format not supported");
 		goto fail;
 	}
@@ -891,8 +1106,20 @@ static void v4l2_init(struct v4l2_data *data)
 	v4l2_unpack_tuple(&fps_num, &fps_denom, data->framerate);
 	blog(LOG_INFO, "Framerate: %.2f fps", (float) fps_denom / fps_num);
 
+#if HAVE_MJPEG
+	/* start the decoder for compressed formats */
+	if (data->pixfmt == V4L2_PIX_FMT_MJPEG) {
+		data->mjpeg = v4l2_mjpeg_create(data->source);
+		if (!data->mjpeg) {
+			blog(LOG_ERROR, "Failed to create mjpeg decoder");
+			goto fail;
+		}
+	}
+#endif
+
 	/* map buffers */
-	if (v4l2_create_mmap(data->dev, &data->buffers) < 0) {
+	data->pool = v4l2_buffer_pool_create(data->dev);
+	if (!data->pool) {
 		blog(LOG_ERROR, "Failed to map buffers");
 		goto fail;
 	}
@@ -977,7 +1204,8 @@ struct obs_source_info v4l2_input = {
 	.id             = "v4l2_input",
 	.type           = OBS_SOURCE_TYPE_INPUT,
 	.output_flags   = OBS_SOURCE_ASYNC_VIDEO |
-	                  OBS_SOURCE_DO_NOT_DUPLICATE,
+	                  OBS_SOURCE_DO_NOT_DUPLICATE |
+	                  OBS_SOURCE_CREATE_THREADSAFE,
 	.get_name       = v4l2_getname,
 	.create         = v4l2_create,
 	.destroy        = v4l2_destroy,
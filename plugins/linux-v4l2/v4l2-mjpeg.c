@@ -0,0 +1,503 @@
+/*
+Copyright (C) 2026 by agent <agent@local>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <string.h>
+
+#include <libavcodec/avcodec.h>
+#include <libavutil/buffer.h>
+#include <libavutil/pixdesc.h>
+
+#include <util/threading.h>
+#include <util/platform.h>
+#include <util/bmem.h>
+
+#include "v4l2-mjpeg.h"
+
+#define blog(level, msg, ...) blog(level, "v4l2-mjpeg: " msg, ##__VA_ARGS__)
+
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 48, 101)
+#define USE_NEW_FFMPEG_DECODE_API
+#endif
+
+#ifndef AV_INPUT_BUFFER_PADDING_SIZE
+#define AV_INPUT_BUFFER_PADDING_SIZE FF_INPUT_BUFFER_PADDING_SIZE
+#endif
+
+#define MAX_WORKERS 4
+
+/* alignment of the planes of packed pictures */
+#define PLANE_ALIGN 64
+
+enum job_state {
+	JOB_FREE,
+	JOB_QUEUED,
+	JOB_DECODING,
+	JOB_DONE
+};
+
+/**
+ * A compressed frame and the picture decoded from it
+ */
+struct mjpeg_job {
+	enum job_state state;
+	bool failed;
+
+	uint8_t *data;
+	size_t size;
+	size_t capacity;
+	uint64_t timestamp;
+
+	AVFrame *frame;
+};
+
+struct mjpeg_worker {
+	struct v4l2_mjpeg_decoder *dec;
+	AVCodecContext *context;
+
+	/* buffers of packed pictures, outlive the worker while libobs still
+	 * holds pictures */
+	AVBufferPool *pool;
+	size_t pool_size;
+
+	pthread_t thread;
+	bool thread_created;
+};
+
+/**
+ * Decoder pool
+ *
+ * Jobs form a ring that is indexed by a running sequence number.  Frames are
+ * submitted, decoded and output in sequence order, so the output stays sorted
+ * by timestamp even though the workers finish out of order.
+ */
+struct v4l2_mjpeg_decoder {
+	obs_source_t *source;
+
+	pthread_mutex_t mutex;
+	pthread_mutex_t output_mutex;
+	os_sem_t *queued;
+	volatile bool stop;
+
+	struct mjpeg_job *jobs;
+	size_t num_jobs;
+	uint64_t next_submit;
+	uint64_t next_decode;
+	uint64_t next_output;
+
+	struct mjpeg_worker workers[MAX_WORKERS];
+	size_t num_workers;
+
+	uint64_t dropped;
+	uint64_t failed;
+
+	struct obs_source_frame out;
+	enum AVPixelFormat out_format;
+};
+
+static inline struct mjpeg_job *get_job(struct v4l2_mjpeg_decoder *dec,
+		uint64_t seq)
+{
+	return &dec->jobs[seq % dec->num_jobs];
+}
+
+static bool decode_job(struct mjpeg_worker *w, struct mjpeg_job *job)
+{
+	AVPacket packet;
+	int got_frame;
+	int ret;
+
+	av_init_packet(&packet);
+	packet.data = job->data;
+	packet.size = (int)job->size;
+
+#ifdef USE_NEW_FFMPEG_DECODE_API
+	ret = avcodec_send_packet(w->context, &packet);
+	if (ret == 0)
+		ret = avcodec_receive_frame(w->context, job->frame);
+	got_frame = (ret == 0);
+#else
+	ret = avcodec_decode_video2(w->context, job->frame, &got_frame,
+			&packet);
+#endif
+	return ret >= 0 && got_frame;
+}
+
+/*
+ * Update the output frame description if the decoded picture changed.
+ *
+ * 4:2:2 pictures are passed on as I420 by skipping every other chroma line,
+ * which lets libobs use the decoded planes as they are.
+ */
+static bool prep_output_frame(struct v4l2_mjpeg_decoder *dec, AVFrame *frame)
+{
+	struct obs_source_frame *out = &dec->out;
+	enum AVPixelFormat format = frame->format;
+	enum video_range_type range;
+	int chroma_step = 1;
+
+	switch (format) {
+	case AV_PIX_FMT_YUVJ420P:
+	case AV_PIX_FMT_YUV420P:
+		out->format = VIDEO_FORMAT_I420;
+		break;
+	case AV_PIX_FMT_YUVJ422P:
+	case AV_PIX_FMT_YUV422P:
+		out->format = VIDEO_FORMAT_I420;
+		chroma_step = 2;
+		break;
+	case AV_PIX_FMT_GRAY8:
+		out->format = VIDEO_FORMAT_Y800;
+		break;
+	default:
+		if (format != dec->out_format)
+			blog(LOG_ERROR, "Unsupported pixel format %s",
+					av_get_pix_fmt_name(format));
+		dec->out_format = format;
+		return false;
+	}
+
+	out->width  = frame->width;
+	out->height = frame->height;
+	for (size_t i = 0; i < MAX_AV_PLANES && i < AV_NUM_DATA_POINTERS; i++) {
+		out->data[i]     = frame->data[i];
+		out->linesize[i] = frame->linesize[i] * (i ? chroma_step : 1);
+	}
+
+	if (format == dec->out_format)
+		return true;
+
+	range = (format == AV_PIX_FMT_YUV420P || format == AV_PIX_FMT_YUV422P)
+		? VIDEO_RANGE_PARTIAL : VIDEO_RANGE_FULL;
+
+	out->full_range = range == VIDEO_RANGE_FULL;
+	video_format_get_parameters(VIDEO_CS_601, range, out->color_matrix,
+			out->color_range_min, out->color_range_max);
+
+	blog(LOG_INFO, "Decoding %dx%d %s", frame->width, frame->height,
+			av_get_pix_fmt_name(format));
+	dec->out_format = format;
+	return true;
+}
+
+static void release_frame(void *param)
+{
+	AVFrame *frame = param;
+	av_frame_free(&frame);
+}
+
+/*
+ * Hand the decoded picture to libobs, which keeps a reference to it until
+ * the frame has been rendered or dropped
+ */
+static void output_frame(struct v4l2_mjpeg_decoder *dec, AVFrame *frame)
+{
+	AVFrame *ref = av_frame_clone(frame);
+
+	if (ref)
+		obs_source_output_video_external(dec->source, &dec->out,
+				release_frame, ref);
+	else
+		obs_source_output_video(dec->source, &dec->out);
+}
+
+/*
+ * Output all jobs that are done, in submission order
+ */
+static void output_jobs(struct v4l2_mjpeg_decoder *dec)
+{
+	pthread_mutex_lock(&dec->output_mutex);
+
+	for (;;) {
+		struct mjpeg_job *job;
+
+		pthread_mutex_lock(&dec->mutex);
+		job = get_job(dec, dec->next_output);
+		if (job->state != JOB_DONE) {
+			pthread_mutex_unlock(&dec->mutex);
+			break;
+		}
+		pthread_mutex_unlock(&dec->mutex);
+
+		if (!job->failed && prep_output_frame(dec, job->frame)) {
+			dec->out.timestamp = job->timestamp;
+			output_frame(dec, job->frame);
+		}
+		av_frame_unref(job->frame);
+
+		pthread_mutex_lock(&dec->mutex);
+		job->state = JOB_FREE;
+		dec->next_output++;
+		pthread_mutex_unlock(&dec->mutex);
+	}
+
+	pthread_mutex_unlock(&dec->output_mutex);
+}
+
+static void *mjpeg_worker_thread(void *param)
+{
+	struct mjpeg_worker *w = param;
+	struct v4l2_mjpeg_decoder *dec = w->dec;
+
+	os_set_thread_name("v4l2: mjpeg decoder");
+
+	while (os_sem_wait(dec->queued) == 0) {
+		struct mjpeg_job *job;
+
+		if (dec->stop)
+			break;
+
+		pthread_mutex_lock(&dec->mutex);
+		job = get_job(dec, dec->next_decode++);
+		job->state = JOB_DECODING;
+		pthread_mutex_unlock(&dec->mutex);
+
+		job->failed = !decode_job(w, job);
+
+		pthread_mutex_lock(&dec->mutex);
+		job->state = JOB_DONE;
+		if (job->failed)
+			dec->failed++;
+		pthread_mutex_unlock(&dec->mutex);
+
+		output_jobs(dec);
+	}
+
+	return NULL;
+}
+
+/*
+ * Decode 4:2:0 pictures into one buffer with tightly packed planes when the
+ * decoder doesn't need any padding for them, which is the layout libobs can
+ * use without copying.  Other pictures use the default buffers and are
+ * copied by libobs.
+ */
+static int get_packed_buffer(AVCodecContext *context, AVFrame *frame,
+		int flags)
+{
+	struct mjpeg_worker *w = context->opaque;
+	int width  = frame->width;
+	int height = frame->height;
+	int linesize_align[AV_NUM_DATA_POINTERS];
+	size_t luma_size;
+	size_t chroma_size;
+	size_t size;
+	AVBufferRef *buf;
+
+	if (frame->format != AV_PIX_FMT_YUVJ420P &&
+	    frame->format != AV_PIX_FMT_YUV420P)
+		goto fallback;
+	if (frame->width != context->width || frame->height != context->height)
+		goto fallback;
+
+	avcodec_align_dimensions2(context, &width, &height, linesize_align);
+	if (width != frame->width || height != frame->height)
+		goto fallback;
+	if (width % linesize_align[0] != 0 ||
+	    (width / 2) % linesize_align[1] != 0 ||
+	    (width / 2) % linesize_align[2] != 0)
+		goto fallback;
+
+	luma_size   = (size_t)width * height;
+	chroma_size = luma_size / 4;
+	if (luma_size % PLANE_ALIGN != 0 || chroma_size % PLANE_ALIGN != 0)
+		goto fallback;
+
+	size = luma_size + chroma_size * 2 + PLANE_ALIGN;
+	if (!w->pool || w->pool_size != size) {
+		av_buffer_pool_uninit(&w->pool);
+		w->pool      = av_buffer_pool_init((int)size, av_buffer_alloc);
+		w->pool_size = size;
+		if (!w->pool)
+			return AVERROR(ENOMEM);
+	}
+
+	buf = av_buffer_pool_get(w->pool);
+	if (!buf)
+		return AVERROR(ENOMEM);
+
+	frame->buf[0]      = buf;
+	frame->data[0]     = buf->data;
+	frame->data[1]     = frame->data[0] + luma_size;
+	frame->data[2]     = frame->data[1] + chroma_size;
+	frame->linesize[0] = width;
+	frame->linesize[1] = width / 2;
+	frame->linesize[2] = width / 2;
+	frame->extended_data = frame->data;
+	return 0;
+
+fallback:
+	return avcodec_default_get_buffer2(context, frame, flags);
+}
+
+static bool init_worker(struct v4l2_mjpeg_decoder *dec, struct mjpeg_worker *w)
+{
+	AVCodec *codec = avcodec_find_decoder(AV_CODEC_ID_MJPEG);
+
+	w->dec = dec;
+
+	if (!codec) {
+		blog(LOG_ERROR, "Failed to find the mjpeg decoder");
+		return false;
+	}
+
+	w->context = avcodec_alloc_context3(codec);
+	if (!w->context)
+		return false;
+
+	/* parallelism comes from the pool, one frame per worker */
+	w->context->thread_count = 1;
+	w->context->get_buffer2  = get_packed_buffer;
+	w->context->opaque       = w;
+
+	if (avcodec_open2(w->context, codec, NULL) < 0) {
+		blog(LOG_ERROR, "Failed to open the mjpeg decoder");
+		return false;
+	}
+
+	if (pthread_create(&w->thread, NULL, mjpeg_worker_thread, w) != 0)
+		return false;
+
+	w->thread_created = true;
+	return true;
+}
+
+static void free_worker(struct mjpeg_worker *w)
+{
+	if (w->thread_created)
+		pthread_join(w->thread, NULL);
+
+	if (w->context) {
+		avcodec_close(w->context);
+		av_free(w->context);
+	}
+
+	av_buffer_pool_uninit(&w->pool);
+}
+
+struct v4l2_mjpeg_decoder *v4l2_mjpeg_create(obs_source_t *source)
+{
+	struct v4l2_mjpeg_decoder *dec = bzalloc(sizeof(*dec));
+	int cores = os_get_logical_cores();
+
+	dec->source     = source;
+	dec->out_format = AV_PIX_FMT_NONE;
+
+	if (pthread_mutex_init(&dec->mutex, NULL) != 0)
+		goto fail_mutex;
+	if (pthread_mutex_init(&dec->output_mutex, NULL) != 0)
+		goto fail_output_mutex;
+	if (os_sem_init(&dec->queued, 0) != 0)
+		goto fail_sem;
+
+	/* leave a core for the capture and render threads */
+	dec->num_workers = cores > 2 ? (size_t)cores - 1 : 1;
+	if (dec->num_workers > MAX_WORKERS)
+		dec->num_workers = MAX_WORKERS;
+
+	dec->num_jobs = dec->num_workers * 2;
+	dec->jobs     = bzalloc(dec->num_jobs * sizeof(struct mjpeg_job));
+
+	for (size_t i = 0; i < dec->num_jobs; i++) {
+		dec->jobs[i].frame = av_frame_alloc();
+		if (!dec->jobs[i].frame)
+			goto fail;
+	}
+
+	for (size_t i = 0; i < dec->num_workers; i++) {
+		if (!init_worker(dec, &dec->workers[i]))
+			goto fail;
+	}
+
+	blog(LOG_INFO, "Using %d decoder threads", (int)dec->num_workers);
+	return dec;
+
+fail:
+	v4l2_mjpeg_destroy(dec);
+	return NULL;
+
+fail_sem:
+	pthread_mutex_destroy(&dec->output_mutex);
+fail_output_mutex:
+	pthread_mutex_destroy(&dec->mutex);
+fail_mutex:
+	bfree(dec);
+	return NULL;
+}
+
+void v4l2_mjpeg_destroy(struct v4l2_mjpeg_decoder *dec)
+{
+	if (!dec)
+		return;
+
+	dec->stop = true;
+	for (size_t i = 0; i < dec->num_workers; i++)
+		os_sem_post(dec->queued);
+	for (size_t i = 0; i < dec->num_workers; i++)
+		free_worker(&dec->workers[i]);
+
+	for (size_t i = 0; i < dec->num_jobs; i++) {
+		bfree(dec->jobs[i].data);
+		av_frame_free(&dec->jobs[i].frame);
+	}
+
+	if (dec->dropped || dec->failed)
+		blog(LOG_INFO, "Dropped %"PRIu64" frames, %"PRIu64" frames "
+				"failed to decode", dec->dropped, dec->failed);
+
+	os_sem_destroy(dec->queued);
+	pthread_mutex_destroy(&dec->output_mutex);
+	pthread_mutex_destroy(&dec->mutex);
+	bfree(dec->jobs);
+	bfree(dec);
+}
+
+bool v4l2_mjpeg_decode(struct v4l2_mjpeg_decoder *dec, const uint8_t *data,
+		size_t size, uint64_t timestamp)
+{
+	struct mjpeg_job *job;
+
+	pthread_mutex_lock(&dec->mutex);
+
+	job = get_job(dec, dec->next_submit);
+	if (job->state != JOB_FREE) {
+		dec->dropped++;
+		pthread_mutex_unlock(&dec->mutex);
+		return false;
+	}
+
+	pthread_mutex_unlock(&dec->mutex);
+
+	/* the job is free, so nothing else touches it until it is queued */
+	if (job->capacity < size + AV_INPUT_BUFFER_PADDING_SIZE) {
+		job->capacity = size + AV_INPUT_BUFFER_PADDING_SIZE;
+		job->data     = brealloc(job->data, job->capacity);
+	}
+
+	memcpy(job->data, data, size);
+	memset(job->data + size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+	job->size      = size;
+	job->timestamp = timestamp;
+	job->failed    = false;
+
+	pthread_mutex_lock(&dec->mutex);
+	job->state = JOB_QUEUED;
+	dec->next_submit++;
+	pthread_mutex_unlock(&dec->mutex);
+
+	os_sem_post(dec->queued);
+	return true;
+}
@@ -0,0 +1,70 @@
+/*
+Copyright (C) 2026 by agent <agent@local>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <inttypes.h>
+
+#include <obs-module.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct v4l2_mjpeg_decoder;
+
+/**
+ * Create a pool of mjpeg decoder threads for a source
+ *
+ * Compressed frames are decoded in parallel and handed to
+ * obs_source_output_video_external in the order they were submitted, the
+ * decoded pictures are released once libobs is done with them.
+ *
+ * @param source the source that receives the decoded frames
+ *
+ * @return the decoder or NULL on failure
+ */
+struct v4l2_mjpeg_decoder *v4l2_mjpeg_create(obs_source_t *source);
+
+/**
+ * Destroy the decoder
+ *
+ * This stops all worker threads, frames that have not been output yet are
+ * dropped.
+ *
+ * @param dec the decoder
+ */
+void v4l2_mjpeg_destroy(struct v4l2_mjpeg_decoder *dec);
+
+/**
+ * Queue a compressed frame for decoding
+ *
+ * The data is copied, so the capture buffer can be reused right away.
+ *
+ * @param dec the decoder
+ * @param data the compressed frame
+ * @param size size of the compressed frame
+ * @param timestamp timestamp of the frame in nanoseconds
+ *
+ * @return false if the frame was dropped because all workers are busy
+ */
+bool v4l2_mjpeg_decode(struct v4l2_mjpeg_decoder *dec, const uint8_t *data,
+		size_t size, uint64_t timestamp);
+
+#ifdef __cplusplus
+}
+#endif
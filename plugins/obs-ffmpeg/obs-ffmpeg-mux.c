@@ -60,6 +60,24 @@ struct ffmpeg_muxer {
 	pthread_t                     mux_thread;
 	bool                          mux_thread_joinable;
 	volatile bool                 muxing;
+
+	/* split file */
+	struct dstr                   base_path;
+	int64_t                       split_max_size;
+	int64_t                       split_max_time;
+	int64_t                       split_size;
+	int64_t                       split_start_usec;
+	int64_t                       split_video_dts;
+	int                           segment;
+	bool                          next_requested;
+	int                           spawn_segment;
+	os_process_pipe_t             *next_pipe;
+	DARRAY(os_process_pipe_t*)    finalize_pipes;
+	pthread_mutex_t               split_mutex;
+	os_sem_t                      *split_sem;
+	pthread_t                     split_thread;
+	bool                          split_thread_active;
+	volatile bool                 split_stop;
 };
 
 static const char *ffmpeg_mux_getname(void *type)
@@ -85,6 +103,8 @@ static inline void replay_buffer_clear(struct ffmpeg_muxer *stream)
 	stream->keyframes = 0;
 }
 
+static void stop_split_thread(struct ffmpeg_muxer *stream);
+
 static void ffmpeg_mux_destroy(void *data)
 {
 	struct ffmpeg_muxer *stream = data;
@@ -94,8 +114,12 @@ static void ffmpeg_mux_destroy(void *data)
 		pthread_join(stream->mux_thread, NULL);
 	da_free(stream->mux_packets);
 
+	stop_split_thread(stream);
+	da_free(stream->finalize_pipes);
+
 	os_process_pipe_destroy(stream->pipe);
 	dstr_free(&stream->path);
+	dstr_free(&stream->base_path);
 	bfree(stream);
 }
 
@@ -225,6 +249,7 @@ static void build_command_line(struct ffmpeg_muxer *stream, struct dstr *cmd,
 {
 	obs_encoder_t *vencoder = obs_output_get_video_encoder(stream->output);
 	obs_encoder_t *aencoders[MAX_AUDIO_MIXES];
+	struct dstr escaped_path = {0};
 	int num_tracks = 0;
 
 	for (;;) {
@@ -241,9 +266,10 @@ static void build_command_line(struct ffmpeg_muxer *stream, struct dstr *cmd,
 	dstr_insert_ch(cmd, 0, '\"');
 	dstr_cat(cmd, "\" \"");
 
-	dstr_copy(&stream->path, path);
-	dstr_replace(&stream->path, "\"", "\"\"");
-	dstr_cat_dstr(cmd, &stream->path);
+	dstr_copy(&escaped_path, path);
+	dstr_replace(&escaped_path, "\"", "\"\"");
+	dstr_cat_dstr(cmd, &escaped_path);
+	dstr_free(&escaped_path);
 
 	dstr_catf(cmd, "\" %d %d ", vencoder ? 1 : 0, num_tracks);
 
@@ -261,14 +287,302 @@ static void build_command_line(struct ffmpeg_muxer *stream, struct dstr *cmd,
 	add_muxer_params(cmd, stream);
 }
 
-static inline void start_pipe(struct ffmpeg_muxer *stream, const char *path)
+static os_process_pipe_t *create_pipe(struct ffmpeg_muxer *stream,
+		const char *path)
 {
+	os_process_pipe_t *pipe;
 	struct dstr cmd;
+
 	build_command_line(stream, &cmd, path);
-	stream->pipe = os_process_pipe_create(cmd.array, "w");
+	pipe = os_process_pipe_create(cmd.array, "w");
 	dstr_free(&cmd);
+	return pipe;
+}
+
+static inline void start_pipe(struct ffmpeg_muxer *stream, const char *path)
+{
+	stream->pipe = create_pipe(stream, path);
+}
+
+/* ------------------------------------------------------------------------ */
+/* split file
+ *
+ * When a maximum duration or size is set, the recording is split into
+ * multiple files at the first video keyframe after the limit is reached.
+ * The muxer process of the next file is spawned once the current file gets
+ * close to the limit, and muxer processes of finished files write their
+ * trailer while recording continues, both on the split thread, so switching
+ * files never blocks the output.
+ *
+ * The limits are the "max_time_sec" and "max_size_mb" output settings.  The
+ * frontend doesn't set them, they're only available to API users that create
+ * their own ffmpeg_muxer output; without them no split thread is created and
+ * no extra muxer process is spawned. */
+
+/* the next muxer process is spawned once 90% of a limit is reached */
+#define SPLIT_SPAWN_PERCENT 90
+
+static inline bool split_enabled(struct ffmpeg_muxer *stream)
+{
+	return stream->split_max_time > 0 || stream->split_max_size > 0;
 }
 
+/* the first file uses the configured path, the following files get a
+ * number appended: "name.mkv", "name_002.mkv", "name_003.mkv", ... */
+static void get_split_path(struct ffmpeg_muxer *stream, int segment,
+		struct dstr *path)
+{
+	const char *base = stream->base_path.array;
+	const char *slash;
+	const char *ext;
+
+	dstr_copy(path, base);
+	if (!segment)
+		return;
+
+	slash = strrchr(base, '/');
+	ext   = strrchr(base, '.');
+	if (!ext || (slash && ext < slash))
+		ext = base + stream->base_path.len;
+
+	dstr_resize(path, ext - base);
+	dstr_catf(path, "_%03d%s", segment + 1, ext);
+}
+
+/* spawns the muxer process of the file after the current one */
+static void spawn_next_pipe(struct ffmpeg_muxer *stream)
+{
+	struct dstr path = {0};
+	os_process_pipe_t *pipe;
+	int segment;
+
+	pthread_mutex_lock(&stream->split_mutex);
+	segment = stream->spawn_segment;
+	stream->spawn_segment = 0;
+	if (stream->next_pipe || stream->segment + 1 != segment)
+		segment = 0;
+	pthread_mutex_unlock(&stream->split_mutex);
+
+	if (!segment)
+		return;
+
+	get_split_path(stream, segment, &path);
+	pipe = create_pipe(stream, path.array);
+	dstr_free(&path);
+
+	if (!pipe)
+		return;
+
+	pthread_mutex_lock(&stream->split_mutex);
+	if (!stream->next_pipe && stream->segment + 1 == segment) {
+		stream->next_pipe = pipe;
+		pipe = NULL;
+	}
+	pthread_mutex_unlock(&stream->split_mutex);
+
+	/* the output already moved on without it */
+	os_process_pipe_destroy(pipe);
+}
+
+/* closing a muxer pipe waits for the process to write the file trailer */
+static void finalize_pipes(struct ffmpeg_muxer *stream)
+{
+	for (;;) {
+		os_process_pipe_t *pipe = NULL;
+
+		pthread_mutex_lock(&stream->split_mutex);
+		if (stream->finalize_pipes.num) {
+			pipe = stream->finalize_pipes.array[0];
+			da_erase(stream->finalize_pipes, 0);
+		}
+		pthread_mutex_unlock(&stream->split_mutex);
+
+		if (!pipe)
+			break;
+
+		os_process_pipe_destroy(pipe);
+	}
+}
+
+static void *split_thread(void *data)
+{
+	struct ffmpeg_muxer *stream = data;
+
+	os_set_thread_name("ffmpeg-mux: split file");
+
+	while (os_sem_wait(stream->split_sem) == 0) {
+		bool stop = os_atomic_load_bool(&stream->split_stop);
+
+		if (!stop)
+			spawn_next_pipe(stream);
+		finalize_pipes(stream);
+
+		if (stop)
+			break;
+	}
+
+	return NULL;
+}
+
+static bool start_split_thread(struct ffmpeg_muxer *stream)
+{
+	os_atomic_set_bool(&stream->split_stop, false);
+	stream->next_requested = false;
+	stream->spawn_segment  = 0;
+
+	if (pthread_mutex_init(&stream->split_mutex, NULL) != 0)
+		return false;
+	if (os_sem_init(&stream->split_sem, 0) != 0)
+		goto fail_sem;
+	if (pthread_create(&stream->split_thread, NULL, split_thread,
+				stream) != 0)
+		goto fail_thread;
+
+	stream->split_thread_active = true;
+	return true;
+
+fail_thread:
+	os_sem_destroy(stream->split_sem);
+	stream->split_sem = NULL;
+fail_sem:
+	pthread_mutex_destroy(&stream->split_mutex);
+	return false;
+}
+
+static void stop_split_thread(struct ffmpeg_muxer *stream)
+{
+	if (!stream->split_thread_active)
+		return;
+
+	os_atomic_set_bool(&stream->split_stop, true);
+	os_sem_post(stream->split_sem);
+	pthread_join(stream->split_thread, NULL);
+	stream->split_thread_active = false;
+
+	/* never received headers, so it exits without creating a file */
+	os_process_pipe_destroy(stream->next_pipe);
+	stream->next_pipe = NULL;
+
+	finalize_pipes(stream);
+
+	os_sem_destroy(stream->split_sem);
+	stream->split_sem = NULL;
+	pthread_mutex_destroy(&stream->split_mutex);
+}
+
+static inline bool should_split(struct ffmpeg_muxer *stream,
+		struct encoder_packet *packet)
+{
+	if (!split_enabled(stream) || !stream->split_size)
+		return false;
+	if (packet->type != OBS_ENCODER_VIDEO || !packet->keyframe)
+		return false;
+
+	if (stream->split_max_time && packet->dts_usec -
+			stream->split_start_usec >= stream->split_max_time)
+		return true;
+
+	return stream->split_max_size &&
+		stream->split_size >= stream->split_max_size;
+}
+
+static inline bool near_split(struct ffmpeg_muxer *stream,
+		struct encoder_packet *packet)
+{
+	if (stream->split_max_time && (packet->dts_usec -
+			stream->split_start_usec) * 100 >=
+			stream->split_max_time * SPLIT_SPAWN_PERCENT)
+		return true;
+
+	return stream->split_max_size && stream->split_size * 100 >=
+		stream->split_max_size * SPLIT_SPAWN_PERCENT;
+}
+
+/* has the split thread spawn the muxer process of the next file */
+static void request_next_pipe(struct ffmpeg_muxer *stream,
+		struct encoder_packet *packet)
+{
+	if (!split_enabled(stream) || stream->next_requested)
+		return;
+	if (!near_split(stream, packet))
+		return;
+
+	pthread_mutex_lock(&stream->split_mutex);
+	stream->spawn_segment = stream->segment + 1;
+	pthread_mutex_unlock(&stream->split_mutex);
+
+	stream->next_requested = true;
+	os_sem_post(stream->split_sem);
+}
+
+static bool split_file(struct ffmpeg_muxer *stream,
+		struct encoder_packet *keyframe)
+{
+	os_process_pipe_t *next;
+
+	pthread_mutex_lock(&stream->split_mutex);
+	next = stream->next_pipe;
+	stream->next_pipe = NULL;
+	stream->spawn_segment = 0;
+	da_push_back(stream->finalize_pipes, &stream->pipe);
+	stream->segment++;
+	pthread_mutex_unlock(&stream->split_mutex);
+
+	stream->pipe = NULL;
+	get_split_path(stream, stream->segment, &stream->path);
+
+	if (!next) {
+		warn("Muxer process for the next file was not ready yet");
+		next = create_pipe(stream, stream->path.array);
+	}
+
+	/* finalizes the previous file */
+	os_sem_post(stream->split_sem);
+
+	if (!next) {
+		warn("Failed to create process pipe");
+		return false;
+	}
+
+	stream->pipe             = next;
+	stream->sent_headers     = false;
+	stream->split_size       = 0;
+	stream->split_start_usec = keyframe->dts_usec;
+	stream->split_video_dts  = keyframe->dts;
+	stream->next_requested   = false;
+
+	info("Writing file '%s'...", stream->path.array);
+	return true;
+}
+
+/* makes the timestamps of each file after the first start at the video
+ * keyframe it was split on */
+static void offset_packet(struct ffmpeg_muxer *stream,
+		struct encoder_packet *packet)
+{
+	int64_t offset;
+
+	if (!stream->segment)
+		return;
+
+	if (packet->type == OBS_ENCODER_VIDEO) {
+		offset = stream->split_video_dts;
+	} else {
+		offset = stream->split_start_usec * packet->timebase_den /
+			((int64_t)packet->timebase_num * 1000000LL);
+	}
+
+	packet->pts -= offset;
+	packet->dts -= offset;
+
+	if (packet->type == OBS_ENCODER_AUDIO && packet->dts < 0) {
+		packet->pts = 0;
+		packet->dts = 0;
+	}
+}
+
+/* ------------------------------------------------------------------------ */
+
 static bool ffmpeg_mux_start(void *data)
 {
 	struct ffmpeg_muxer *stream = data;
@@ -282,6 +596,12 @@ static bool ffmpeg_mux_start(void *data)
 
 	settings = obs_output_get_settings(stream->output);
 	path = obs_data_get_string(settings, "path");
+	stream->split_max_time = obs_data_get_int(settings, "max_time_sec") *
+		1000000LL;
+	stream->split_max_size = obs_data_get_int(settings, "max_size_mb") *
+		(1024 * 1024);
+	dstr_copy(&stream->base_path, path);
+	dstr_copy(&stream->path, path);
 	start_pipe(stream, path);
 	obs_data_release(settings);
 
@@ -290,6 +610,18 @@ static bool ffmpeg_mux_start(void *data)
 		return false;
 	}
 
+	stream->segment          = 0;
+	stream->split_size       = 0;
+	stream->split_start_usec = 0;
+	stream->split_video_dts  = 0;
+
+	if (split_enabled(stream) && !start_split_thread(stream)) {
+		warn("Failed to create split thread");
+		os_process_pipe_destroy(stream->pipe);
+		stream->pipe = NULL;
+		return false;
+	}
+
 	/* write headers and start capture */
 	os_atomic_set_bool(&stream->active, true);
 	os_atomic_set_bool(&stream->capturing, true);
@@ -308,6 +640,8 @@ static int deactivate(struct ffmpeg_muxer *stream)
 		ret = os_process_pipe_destroy(stream->pipe);
 		stream->pipe = NULL;
 
+		stop_split_thread(stream);
+
 		os_atomic_set_bool(&stream->active, false);
 		os_atomic_set_bool(&stream->sent_headers, false);
 
@@ -377,6 +711,7 @@ static bool write_packet(struct ffmpeg_muxer *stream,
 	}
 
 	stream->total_bytes += packet->size;
+	stream->split_size += (int64_t)packet->size;
 	return true;
 }
 
@@ -430,17 +765,11 @@ static bool send_headers(struct ffmpeg_muxer *stream)
 static void ffmpeg_mux_data(void *data, struct encoder_packet *packet)
 {
 	struct ffmpeg_muxer *stream = data;
+	struct encoder_packet pkt;
 
 	if (!active(stream))
 		return;
 
-	if (!stream->sent_headers) {
-		if (!send_headers(stream))
-			return;
-
-		stream->sent_headers = true;
-	}
-
 	if (stopping(stream)) {
 		if (packet->sys_dts_usec >= stream->stop_ts) {
 			deactivate(stream);
@@ -448,7 +777,22 @@ static void ffmpeg_mux_data(void *data, struct encoder_packet *packet)
 		}
 	}
 
-	write_packet(stream, packet);
+	if (should_split(stream, packet) && !split_file(stream, packet)) {
+		signal_failure(stream);
+		return;
+	}
+
+	if (!stream->sent_headers) {
+		if (!send_headers(stream))
+			return;
+
+		stream->sent_headers = true;
+	}
+
+	pkt = *packet;
+	offset_packet(stream, &pkt);
+	if (write_packet(stream, &pkt))
+		request_next_pipe(stream, packet);
 }
 
 static obs_properties_t *ffmpeg_mux_properties(void *unused)
@@ -460,6 +804,12 @@ static obs_properties_t *ffmpeg_mux_properties(void *unused)
 	obs_properties_add_text(props, "path",
 			obs_module_text("FilePath"),
 			OBS_TEXT_DEFAULT);
+
+	/* not set by the frontend, see the split file section above */
+	obs_properties_add_int(props, "max_time_sec",
+			obs_module_text("SplitFile.MaxTime"), 0, 86400, 1);
+	obs_properties_add_int(props, "max_size_mb",
+			obs_module_text("SplitFile.MaxSize"), 0, 1024 * 1024, 1);
 	return props;
 }
 
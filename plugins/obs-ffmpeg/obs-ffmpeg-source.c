@@ -21,7 +21,7 @@
 #include "obs-ffmpeg-compat.h"
 #include "obs-ffmpeg-formats.h"
 
-#include <media-playback/media.h>
+#include <media-playback/session.h>
 
 #define FF_LOG(level, format, ...) \
 	blog(level, "[Media Source]: " format, ##__VA_ARGS__)
@@ -35,8 +35,7 @@ static bool video_frame(struct ff_frame *frame, void *opaque);
 static bool video_format(AVCodecContext *codec_context, void *opaque);
 
 struct ffmpeg_source {
-	mp_media_t media;
-	bool media_valid;
+	mp_subscriber_t *media;
 	bool destroy_media;
 
 	struct SwsContext *sws_ctx;
@@ -58,6 +57,9 @@ struct ffmpeg_source {
 	bool is_clear_on_media_end;
 	bool restart_on_activate;
 	bool close_when_inactive;
+	bool loop_cache;
+	int loop_cache_max_sec;
+	int loop_cache_max_mb;
 };
 
 static bool is_local_file_modified(obs_properties_t *props,
@@ -73,12 +75,20 @@ static bool is_local_file_modified(obs_properties_t *props,
 	obs_property_t *looping = obs_properties_get(props, "looping");
 	obs_property_t *buffering = obs_properties_get(props, "buffering_mb");
 	obs_property_t *close = obs_properties_get(props, "close_when_inactive");
+	obs_property_t *cache = obs_properties_get(props, "loop_cache");
+	obs_property_t *cache_sec = obs_properties_get(props,
+			"loop_cache_max_sec");
+	obs_property_t *cache_mb = obs_properties_get(props,
+			"loop_cache_max_mb");
 	obs_property_set_visible(input, !enabled);
 	obs_property_set_visible(input_format, !enabled);
 	obs_property_set_visible(buffering, !enabled);
 	obs_property_set_visible(close, enabled);
 	obs_property_set_visible(local_file, enabled);
 	obs_property_set_visible(looping, enabled);
+	obs_property_set_visible(cache, enabled);
+	obs_property_set_visible(cache_sec, enabled);
+	obs_property_set_visible(cache_mb, enabled);
 
 	return true;
 }
@@ -93,6 +103,10 @@ static void ffmpeg_source_defaults(obs_data_t *settings)
 	obs_data_set_default_bool(settings, "hw_decode", true);
 #endif
 	obs_data_set_default_int(settings, "buffering_mb", 2);
+	obs_data_set_default_bool(settings, "loop_cache", false);
+	obs_data_set_default_int(settings, "loop_cache_max_sec", 30);
+	/* frames are cached uncompressed, enough for a 30 second 1080p30 loop */
+	obs_data_set_default_int(settings, "loop_cache_max_mb", 3072);
 }
 
 static const char *media_filter =
@@ -148,6 +162,16 @@ static obs_properties_t *ffmpeg_source_getproperties(void *data)
 	prop = obs_properties_add_bool(props, "looping",
 			obs_module_text("Looping"));
 
+	prop = obs_properties_add_bool(props, "loop_cache",
+			obs_module_text("LoopCache"));
+	obs_property_set_long_description(prop,
+			obs_module_text("LoopCache.ToolTip"));
+
+	obs_properties_add_int(props, "loop_cache_max_sec",
+			obs_module_text("LoopCacheMaxDuration"), 1, 600, 1);
+	obs_properties_add_int(props, "loop_cache_max_mb",
+			obs_module_text("LoopCacheMaxMB"), 16, 16384, 16);
+
 	obs_properties_add_bool(props, "restart_on_activate",
 			obs_module_text("RestartWhenActivated"));
 
@@ -195,20 +219,23 @@ static void dump_source_info(struct ffmpeg_source *s, const char *input,
 			"\tis_hw_decoding:          %s\n"
 			"\tis_clear_on_media_end:   %s\n"
 			"\trestart_on_activate:     %s\n"
-			"\tclose_when_inactive:     %s",
+			"\tclose_when_inactive:     %s\n"
+			"\tloop_cache:              %s",
 			input ? input : "(null)",
 			input_format ? input_format : "(null)",
 			s->is_looping ? "yes" : "no",
 			s->is_hw_decoding ? "yes" : "no",
 			s->is_clear_on_media_end ? "yes" : "no",
 			s->restart_on_activate ? "yes" : "no",
-			s->close_when_inactive ? "yes" : "no");
+			s->close_when_inactive ? "yes" : "no",
+			s->loop_cache ? "yes" : "no");
 }
 
-static void get_frame(void *opaque, struct obs_source_frame *f)
+static void get_frame(void *opaque, struct obs_source_frame *f,
+		void (*release)(void *param), void *param)
 {
 	struct ffmpeg_source *s = opaque;
-	obs_source_output_video(s->source, f);
+	obs_source_output_video_external(s->source, f, release, param);
 }
 
 static void preload_frame(void *opaque, struct obs_source_frame *f)
@@ -239,12 +266,27 @@ static void media_stopped(void *opaque)
 
 static void ffmpeg_source_open(struct ffmpeg_source *s)
 {
+	/* only looping files are played more than once */
+	bool cache = s->loop_cache && s->is_looping;
+
+	struct mp_session_info info = {
+		.path                = s->input,
+		.format              = s->input_format,
+		.buffering           = s->buffering_mb * 1024 * 1024,
+		.hardware_decoding   = s->is_hw_decoding,
+		.force_range         = s->range,
+		.looping             = s->is_looping,
+		.restart_on_activate = s->restart_on_activate,
+		.close_when_inactive = s->close_when_inactive,
+		.cache_max_sec       = cache ? s->loop_cache_max_sec : 0,
+		.cache_max_mb        = cache ? s->loop_cache_max_mb : 0
+	};
+
+	/* sources that play the same input with the same options share a
+	 * single decoder */
 	if (s->input && *s->input)
-		s->media_valid = mp_media_init(&s->media,
-				s->input, s->input_format,
-				s->buffering_mb * 1024 * 1024,
-				s, get_frame, get_audio, media_stopped,
-				preload_frame, s->is_hw_decoding, s->range);
+		s->media = mp_session_subscribe(&info, s, get_frame, get_audio,
+				media_stopped, preload_frame);
 }
 
 static void ffmpeg_source_tick(void *data, float seconds)
@@ -253,21 +295,19 @@ static void ffmpeg_source_tick(void *data, float seconds)
 
 	struct ffmpeg_source *s = data;
 	if (s->destroy_media) {
-		if (s->media_valid) {
-			mp_media_free(&s->media);
-			s->media_valid = false;
-		}
+		mp_session_unsubscribe(s->media);
+		s->media = NULL;
 		s->destroy_media = false;
 	}
 }
 
-static void ffmpeg_source_start(struct ffmpeg_source *s)
+static void ffmpeg_source_start(struct ffmpeg_source *s, bool restart)
 {
-	if (!s->media_valid)
+	if (!s->media)
 		ffmpeg_source_open(s);
 
-	if (s->media_valid) {
-		mp_media_play(&s->media, s->is_looping);
+	if (s->media) {
+		mp_subscriber_play(s->media, restart);
 		if (s->is_local_file)
 			obs_source_show_preloaded_video(s->source);
 	}
@@ -291,6 +331,7 @@ static void ffmpeg_source_update(void *data, obs_data_t *settings)
 		s->is_looping = obs_data_get_bool(settings, "looping");
 		s->close_when_inactive = obs_data_get_bool(settings,
 				"close_when_inactive");
+		s->loop_cache = obs_data_get_bool(settings, "loop_cache");
 
 		obs_source_set_async_unbuffered(s->source, true);
 	} else {
@@ -299,6 +340,7 @@ static void ffmpeg_source_update(void *data, obs_data_t *settings)
 				"input_format");
 		s->is_looping = false;
 		s->close_when_inactive = true;
+		s->loop_cache = false;
 
 		obs_source_set_async_unbuffered(s->source, false);
 	}
@@ -315,12 +357,14 @@ static void ffmpeg_source_update(void *data, obs_data_t *settings)
 	s->range = (enum video_range_type)obs_data_get_int(settings,
 			"color_range");
 	s->buffering_mb = (int)obs_data_get_int(settings, "buffering_mb");
+	s->loop_cache_max_sec = (int)obs_data_get_int(settings,
+			"loop_cache_max_sec");
+	s->loop_cache_max_mb = (int)obs_data_get_int(settings,
+			"loop_cache_max_mb");
 	s->is_local_file = is_local_file;
 
-	if (s->media_valid) {
-		mp_media_free(&s->media);
-		s->media_valid = false;
-	}
+	mp_session_unsubscribe(s->media);
+	s->media = NULL;
 
 	bool active = obs_source_active(s->source);
 	if (!s->close_when_inactive || active)
@@ -328,7 +372,7 @@ static void ffmpeg_source_update(void *data, obs_data_t *settings)
 
 	dump_source_info(s, input, input_format);
 	if (!s->restart_on_activate || active)
-		ffmpeg_source_start(s);
+		ffmpeg_source_start(s, s->restart_on_activate);
 }
 
 static const char *ffmpeg_source_getname(void *unused)
@@ -346,7 +390,7 @@ static void restart_hotkey(void *data, obs_hotkey_id id,
 
 	struct ffmpeg_source *s = data;
 	if (obs_source_active(s->source))
-		ffmpeg_source_start(s);
+		ffmpeg_source_start(s, true);
 }
 
 static void restart_proc(void *data, calldata_t *cd)
@@ -355,6 +399,15 @@ static void restart_proc(void *data, calldata_t *cd)
 	UNUSED_PARAMETER(cd);
 }
 
+static void seek_proc(void *data, calldata_t *cd)
+{
+	struct ffmpeg_source *s = data;
+	long long ms = calldata_int(cd, "ms");
+
+	if (s->media && s->is_local_file)
+		mp_subscriber_seek(s->media, ms * 1000000LL);
+}
+
 static void *ffmpeg_source_create(obs_data_t *settings, obs_source_t *source)
 {
 	UNUSED_PARAMETER(settings);
@@ -369,6 +422,7 @@ static void *ffmpeg_source_create(obs_data_t *settings, obs_source_t *source)
 
 	proc_handler_t *ph = obs_source_get_proc_handler(source);
 	proc_handler_add(ph, "void restart()", restart_proc, s);
+	proc_handler_add(ph, "void seek(int ms)", seek_proc, s);
 
 	ffmpeg_source_update(s, settings);
 	return s;
@@ -380,8 +434,7 @@ static void ffmpeg_source_destroy(void *data)
 
 	if (s->hotkey)
 		obs_hotkey_unregister(s->hotkey);
-	if (s->media_valid)
-		mp_media_free(&s->media);
+	mp_session_unsubscribe(s->media);
 
 	if (s->sws_ctx != NULL)
 		sws_freeContext(s->sws_ctx);
@@ -395,8 +448,10 @@ static void ffmpeg_source_activate(void *data)
 {
 	struct ffmpeg_source *s = data;
 
+	/* plays from the beginning even if other sources already play the
+	 * same file */
 	if (s->restart_on_activate)
-		ffmpeg_source_start(s);
+		ffmpeg_source_start(s, true);
 }
 
 static void ffmpeg_source_deactivate(void *data)
@@ -404,8 +459,8 @@ static void ffmpeg_source_deactivate(void *data)
 	struct ffmpeg_source *s = data;
 
 	if (s->restart_on_activate) {
-		if (s->media_valid) {
-			mp_media_stop(&s->media);
+		if (s->media) {
+			mp_subscriber_stop(s->media);
 
 			if (s->is_clear_on_media_end)
 				obs_source_output_video(s->source, NULL);
@@ -417,7 +472,8 @@ struct obs_source_info ffmpeg_source = {
 	.id             = "ffmpeg_source",
 	.type           = OBS_SOURCE_TYPE_INPUT,
 	.output_flags   = OBS_SOURCE_ASYNC_VIDEO | OBS_SOURCE_AUDIO |
-	                  OBS_SOURCE_DO_NOT_DUPLICATE,
+	                  OBS_SOURCE_DO_NOT_DUPLICATE |
+	                  OBS_SOURCE_CREATE_THREADSAFE,
 	.get_name       = ffmpeg_source_getname,
 	.create         = ffmpeg_source_create,
 	.destroy        = ffmpeg_source_destroy,
@@ -1,5 +1,7 @@
 #include <obs-module.h>
 #include <util/circlebuf.h>
+#include <util/threading.h>
+#include <media-io/video-scaler.h>
 
 #ifndef SEC_TO_NSEC
 #define SEC_TO_NSEC 1000000000ULL
@@ -10,8 +12,16 @@
 #endif
 
 #define SETTING_DELAY_MS               "delay_ms"
+#define SETTING_COMPACT                "compact"
 
 #define TEXT_DELAY_MS                  obs_module_text("DelayMs")
+#define TEXT_COMPACT                   obs_module_text("CompactStorage")
+
+/* a delayed frame converted to tightly packed I420 */
+struct compact_frame {
+	uint8_t                        *data;
+	uint64_t                       timestamp;
+};
 
 struct async_delay_data {
 	obs_source_t                   *context;
@@ -19,6 +29,20 @@ struct async_delay_data {
 	/* contains struct obs_source_frame* */
 	struct circlebuf               video_frames;
 
+	/* contains struct compact_frame, used instead of video_frames in
+	 * compact mode.  frames are converted to I420 as they come in, so
+	 * the source gets its frame back right away, and the oldest frame
+	 * is converted back into output_frame, which belongs to the filter
+	 * and is reused once libobs has released it. */
+	struct circlebuf               compact_frames;
+	uint8_t                        *spare_data;
+	struct obs_source_frame        *output_frame;
+	video_scaler_t                 *pack_scaler;
+	video_scaler_t                 *unpack_scaler;
+	struct video_scale_info        compact_info;
+	bool                           compact_failed;
+	bool                           compact;
+
 	/* stores the audio data */
 	struct circlebuf               audio_frames;
 	struct obs_audio_data          audio_output;
@@ -51,6 +75,36 @@ static void free_video_data(struct async_delay_data *filter,
 	}
 }
 
+static void free_compact_data(struct async_delay_data *filter)
+{
+	while (filter->compact_frames.size) {
+		struct compact_frame frame;
+
+		circlebuf_pop_front(&filter->compact_frames, &frame,
+				sizeof(frame));
+		bfree(frame.data);
+	}
+
+	bfree(filter->spare_data);
+	filter->spare_data = NULL;
+
+	/* libobs destroys the frame itself if it still uses it */
+	if (filter->output_frame &&
+	    os_atomic_dec_long(&filter->output_frame->refs) == 0)
+		obs_source_frame_destroy(filter->output_frame);
+	filter->output_frame = NULL;
+}
+
+static void free_compact_scalers(struct async_delay_data *filter)
+{
+	video_scaler_destroy(filter->pack_scaler);
+	video_scaler_destroy(filter->unpack_scaler);
+	filter->pack_scaler   = NULL;
+	filter->unpack_scaler = NULL;
+	filter->compact_failed = false;
+	memset(&filter->compact_info, 0, sizeof(filter->compact_info));
+}
+
 static inline void free_audio_packet(struct obs_audio_data *audio)
 {
 	for (size_t i = 0; i < MAX_AV_PLANES; i++)
@@ -78,6 +132,7 @@ static void async_delay_filter_update(void *data, obs_data_t *settings)
 	if (new_interval < filter->interval)
 		free_video_data(filter, obs_filter_get_parent(filter->context));
 
+	filter->compact = obs_data_get_bool(settings, SETTING_COMPACT);
 	filter->reset_audio = true;
 	filter->reset_video = true;
 	filter->interval = new_interval;
@@ -105,7 +160,10 @@ static void async_delay_filter_destroy(void *data)
 	struct async_delay_data *filter = data;
 
 	free_audio_packet(&filter->audio_output);
+	free_compact_data(filter);
+	free_compact_scalers(filter);
 	circlebuf_free(&filter->video_frames);
+	circlebuf_free(&filter->compact_frames);
 	circlebuf_free(&filter->audio_frames);
 	bfree(data);
 }
@@ -116,6 +174,7 @@ static obs_properties_t *async_delay_filter_properties(void *data)
 
 	obs_properties_add_int(props, SETTING_DELAY_MS, TEXT_DELAY_MS,
 			0, 20000, 1);
+	obs_properties_add_bool(props, SETTING_COMPACT, TEXT_COMPACT);
 
 	UNUSED_PARAMETER(data);
 	return props;
@@ -126,6 +185,7 @@ static void async_delay_filter_remove(void *data, obs_source_t *parent)
 	struct async_delay_data *filter = data;
 
 	free_video_data(filter, parent);
+	free_compact_data(filter);
 	free_audio_data(filter);
 }
 
@@ -138,6 +198,151 @@ static inline bool is_timestamp_jump(uint64_t ts, uint64_t prev_ts)
 	return ts < prev_ts || (ts - prev_ts) > SEC_TO_NSEC;
 }
 
+static inline size_t compact_size(const struct video_scale_info *info)
+{
+	size_t cx = info->width;
+	size_t cy = info->height;
+	return cx * cy + ((cx + 1) / 2) * ((cy + 1) / 2) * 2;
+}
+
+static inline void get_compact_planes(const struct video_scale_info *info,
+		uint8_t *data, uint8_t *planes[], uint32_t linesize[])
+{
+	uint32_t chroma_cx = (info->width  + 1) / 2;
+	uint32_t chroma_cy = (info->height + 1) / 2;
+
+	planes[0]   = data;
+	planes[1]   = planes[0] + info->width * info->height;
+	planes[2]   = planes[1] + chroma_cx * chroma_cy;
+	linesize[0] = info->width;
+	linesize[1] = chroma_cx;
+	linesize[2] = chroma_cx;
+}
+
+/* returns true if the stored frames are still valid for this frame.  if the
+ * scalers can't be created, the format is remembered and its frames are
+ * stored as they are until the format changes again */
+static bool update_compact_scalers(struct async_delay_data *filter,
+		const struct obs_source_frame *frame)
+{
+	struct video_scale_info src = {
+		.format     = frame->format,
+		.width      = frame->width,
+		.height     = frame->height,
+		.range      = frame->full_range ?
+			VIDEO_RANGE_FULL : VIDEO_RANGE_PARTIAL,
+		.colorspace = VIDEO_CS_DEFAULT
+	};
+	struct video_scale_info dst = src;
+
+	if ((filter->pack_scaler || filter->compact_failed) &&
+	    memcmp(&src, &filter->compact_info, sizeof(src)) == 0)
+		return true;
+
+	free_compact_scalers(filter);
+	free_compact_data(filter);
+
+	dst.format = VIDEO_FORMAT_I420;
+
+	if (video_scaler_create(&filter->pack_scaler, &dst, &src,
+				VIDEO_SCALE_FAST_BILINEAR) !=
+				VIDEO_SCALER_SUCCESS ||
+	    video_scaler_create(&filter->unpack_scaler, &src, &dst,
+				VIDEO_SCALE_FAST_BILINEAR) !=
+				VIDEO_SCALER_SUCCESS) {
+		blog(LOG_WARNING, "async delay: Failed to create compact "
+				"storage for %s frames, storing them as "
+				"they are",
+				get_video_format_name(frame->format));
+		free_compact_scalers(filter);
+		filter->compact_failed = true;
+	}
+
+	filter->compact_info = src;
+	return false;
+}
+
+static struct obs_source_frame *get_output_frame(
+		struct async_delay_data *filter,
+		const struct obs_source_frame *frame)
+{
+	struct obs_source_frame *output = filter->output_frame;
+
+	/* one reference is held by the filter, the other one by libobs until
+	 * it releases the frame */
+	if (output && os_atomic_load_long(&output->refs) != 1) {
+		if (os_atomic_dec_long(&output->refs) == 0)
+			obs_source_frame_destroy(output);
+		output = NULL;
+	}
+
+	if (!output) {
+		output = obs_source_frame_create(frame->format,
+				frame->width, frame->height);
+		output->refs = 1;
+		filter->output_frame = output;
+	}
+
+	output->flip       = frame->flip;
+	output->full_range = frame->full_range;
+	memcpy(output->color_matrix, frame->color_matrix,
+			sizeof(frame->color_matrix));
+	memcpy(output->color_range_min, frame->color_range_min,
+			sizeof(frame->color_range_min));
+	memcpy(output->color_range_max, frame->color_range_max,
+			sizeof(frame->color_range_max));
+
+	os_atomic_inc_long(&output->refs);
+	return output;
+}
+
+static struct obs_source_frame *compact_delay_video(
+		struct async_delay_data *filter, obs_source_t *parent,
+		struct obs_source_frame *frame)
+{
+	const struct video_scale_info *info = &filter->compact_info;
+	struct compact_frame stored;
+	struct obs_source_frame *output;
+	uint8_t *planes[MAX_AV_PLANES] = {0};
+	uint32_t linesize[MAX_AV_PLANES] = {0};
+	uint64_t cur_interval;
+
+	stored.data = filter->spare_data ?
+		filter->spare_data : bmalloc(compact_size(info));
+	stored.timestamp = frame->timestamp;
+	filter->spare_data = NULL;
+
+	get_compact_planes(info, stored.data, planes, linesize);
+	video_scaler_scale(filter->pack_scaler, planes, linesize,
+			(const uint8_t *const *)frame->data, frame->linesize);
+
+	circlebuf_push_back(&filter->compact_frames, &stored, sizeof(stored));
+	circlebuf_peek_front(&filter->compact_frames, &stored, sizeof(stored));
+
+	cur_interval = frame->timestamp - stored.timestamp;
+	if (!filter->video_delay_reached && cur_interval < filter->interval) {
+		obs_source_release_frame(parent, frame);
+		return NULL;
+	}
+
+	circlebuf_pop_front(&filter->compact_frames, NULL, sizeof(stored));
+
+	/* the input frame may use memory of the source, so the delayed
+	 * picture goes into a frame of the filter */
+	output = get_output_frame(filter, frame);
+	obs_source_release_frame(parent, frame);
+
+	get_compact_planes(info, stored.data, planes, linesize);
+	video_scaler_scale(filter->unpack_scaler, output->data,
+			output->linesize, (const uint8_t *const *)planes,
+			linesize);
+	output->timestamp = stored.timestamp;
+
+	filter->spare_data = stored.data;
+	filter->video_delay_reached = true;
+	return output;
+}
+
 static struct obs_source_frame *async_delay_filter_video(void *data,
 		struct obs_source_frame *frame)
 {
@@ -145,16 +350,24 @@ static struct obs_source_frame *async_delay_filter_video(void *data,
 	obs_source_t *parent = obs_filter_get_parent(filter->context);
 	struct obs_source_frame *output;
 	uint64_t cur_interval;
+	bool reset = filter->reset_video ||
+		is_timestamp_jump(frame->timestamp, filter->last_video_ts);
+
+	if (filter->compact && !update_compact_scalers(filter, frame))
+		reset = true;
 
-	if (filter->reset_video ||
-	    is_timestamp_jump(frame->timestamp, filter->last_video_ts)) {
+	if (reset) {
 		free_video_data(filter, parent);
+		free_compact_data(filter);
 		filter->video_delay_reached = false;
 		filter->reset_video = false;
 	}
 
 	filter->last_video_ts = frame->timestamp;
 
+	if (filter->compact && filter->pack_scaler)
+		return compact_delay_video(filter, parent, frame);
+
 	circlebuf_push_back(&filter->video_frames, &frame,
 			sizeof(struct obs_source_frame*));
 	circlebuf_peek_front(&filter->video_frames, &output,
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <obs-module.h>
+#include <xmmintrin.h>
+
+/* Block helpers shared by the audio filters.  Each works on the planar
+ * float data of an obs_audio_data, skipping channels without data, and
+ * handles all channels of a block before moving to the next one. */
+
+#define DSP_BLOCK 4
+
+static inline void dsp_max_abs(float *out, float **data, size_t channels,
+		size_t frames)
+{
+	const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+	size_t i = 0;
+
+	for (; i + DSP_BLOCK <= frames; i += DSP_BLOCK) {
+		__m128 max_val = _mm_setzero_ps();
+
+		for (size_t c = 0; c < channels; c++) {
+			if (!data[c])
+				continue;
+
+			__m128 v = _mm_loadu_ps(data[c] + i);
+			max_val = _mm_max_ps(max_val, _mm_and_ps(v, abs_mask));
+		}
+
+		_mm_storeu_ps(out + i, max_val);
+	}
+
+	for (; i < frames; i++) {
+		float max_val = 0.0f;
+
+		for (size_t c = 0; c < channels; c++) {
+			if (data[c] && fabsf(data[c][i]) > max_val)
+				max_val = fabsf(data[c][i]);
+		}
+
+		out[i] = max_val;
+	}
+}
+
+static inline void dsp_apply_gain(float **data, size_t channels,
+		const float *gain, size_t frames)
+{
+	size_t i = 0;
+
+	for (; i + DSP_BLOCK <= frames; i += DSP_BLOCK) {
+		__m128 g = _mm_loadu_ps(gain + i);
+
+		for (size_t c = 0; c < channels; c++) {
+			if (!data[c])
+				continue;
+
+			__m128 v = _mm_loadu_ps(data[c] + i);
+			_mm_storeu_ps(data[c] + i, _mm_mul_ps(v, g));
+		}
+	}
+
+	for (; i < frames; i++) {
+		for (size_t c = 0; c < channels; c++) {
+			if (data[c])
+				data[c][i] *= gain[i];
+		}
+	}
+}
+
+static inline void dsp_scale(float **data, size_t channels, float mul,
+		size_t frames)
+{
+	const __m128 m = _mm_set1_ps(mul);
+
+	for (size_t c = 0; c < channels; c++) {
+		float *ch = data[c];
+		size_t i = 0;
+
+		if (!ch)
+			continue;
+
+		for (; i + DSP_BLOCK <= frames; i += DSP_BLOCK)
+			_mm_storeu_ps(ch + i, _mm_mul_ps(_mm_loadu_ps(ch + i), m));
+		for (; i < frames; i++)
+			ch[i] *= mul;
+	}
+}
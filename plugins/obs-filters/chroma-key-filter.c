@@ -279,7 +279,8 @@ static void chroma_key_defaults(obs_data_t *settings)
 struct obs_source_info chroma_key_filter = {
 	.id                            = "chroma_key_filter",
 	.type                          = OBS_SOURCE_TYPE_FILTER,
-	.output_flags                  = OBS_SOURCE_VIDEO,
+	.output_flags                  = OBS_SOURCE_VIDEO |
+	                                 OBS_SOURCE_STATIC_CONTENT,
 	.get_name                      = chroma_key_name,
 	.create                        = chroma_key_create,
 	.destroy                       = chroma_key_destroy,
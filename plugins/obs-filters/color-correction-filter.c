@@ -402,7 +402,7 @@ static void color_correction_filter_defaults(obs_data_t *settings)
 struct obs_source_info color_filter = {
 	.id = "color_filter",
 	.type = OBS_SOURCE_TYPE_FILTER,
-	.output_flags = OBS_SOURCE_VIDEO,
+	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_STATIC_CONTENT,
 	.get_name = color_correction_filter_name,
 	.create = color_correction_filter_create,
 	.destroy = color_correction_filter_destroy,
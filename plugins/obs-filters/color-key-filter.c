@@ -245,7 +245,8 @@ static void color_key_defaults(obs_data_t *settings)
 struct obs_source_info color_key_filter = {
 	.id                            = "color_key_filter",
 	.type                          = OBS_SOURCE_TYPE_FILTER,
-	.output_flags                  = OBS_SOURCE_VIDEO,
+	.output_flags                  = OBS_SOURCE_VIDEO |
+	                                 OBS_SOURCE_STATIC_CONTENT,
 	.get_name                      = color_key_name,
 	.create                        = color_key_create,
 	.destroy                       = color_key_destroy,
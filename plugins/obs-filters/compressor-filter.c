@@ -4,6 +4,7 @@
 
 #include <obs-module.h>
 #include <media-io/audio-math.h>
+#include "audio-dsp.h"
 
 /* -------------------------------------------------------- */
 
@@ -132,6 +133,8 @@ static void compressor_destroy(void *data)
 	bfree(cd);
 }
 
+/* The detector is linked across channels: the envelope follows the loudest
+ * channel, so only one recursive filter has to run per sample. */
 static inline void analyze_envelope(struct compressor_data *cd,
 	float **samples, const uint32_t num_samples)
 {
@@ -139,41 +142,44 @@ static inline void analyze_envelope(struct compressor_data *cd,
 		resize_env_buffer(cd, num_samples);
 	}
 
-	memset(cd->envelope_buf, 0, num_samples * sizeof(cd->envelope_buf[0]));
-	for (size_t chan = 0; chan < cd->num_channels; ++chan) {
-		if (samples[chan]) {
-			float env = cd->envelope;
-			for (uint32_t i = 0; i < num_samples; ++i) {
-				const float env_in = fabsf(samples[chan][i]);
-				if (env < env_in) {
-					env = env_in + cd->attack_gain *
-						(env - env_in);
-				} else {
-					env = env_in + cd->release_gain *
-						(env - env_in);
-				}
-				cd->envelope_buf[i] = fmaxf(
-						cd->envelope_buf[i], env);
-			}
-		}
+	dsp_max_abs(cd->envelope_buf, samples, cd->num_channels, num_samples);
+
+	float env = cd->envelope;
+	for (uint32_t i = 0; i < num_samples; ++i) {
+		const float env_in = cd->envelope_buf[i];
+		const float gain = env < env_in ?
+			cd->attack_gain : cd->release_gain;
+
+		env = env_in + gain * (env - env_in);
+		cd->envelope_buf[i] = env;
 	}
-	cd->envelope = cd->envelope_buf[num_samples - 1];
+	cd->envelope = env;
 }
 
 static inline void process_compression(const struct compressor_data *cd,
 	float **samples, uint32_t num_samples)
 {
-	for (size_t i = 0; i < num_samples; ++i) {
-		const float env_db = mul_to_db(cd->envelope_buf[i]);
+	const __m128 slope = _mm_set1_ps(cd->slope);
+	const __m128 threshold = _mm_set1_ps(cd->threshold);
+	const __m128 output_gain = _mm_set1_ps(cd->output_gain);
+	const __m128 zero = _mm_setzero_ps();
+	float *buf = cd->envelope_buf;
+	uint32_t i = 0;
+
+	/* turn the envelope buffer into a per-sample gain buffer */
+	for (; i + DSP_BLOCK <= num_samples; i += DSP_BLOCK) {
+		__m128 env_db = mul_to_db_fast_ps(_mm_loadu_ps(buf + i));
+		__m128 gain = _mm_mul_ps(slope, _mm_sub_ps(threshold, env_db));
+		gain = db_to_mul_fast_ps(_mm_min_ps(zero, gain));
+		_mm_storeu_ps(buf + i, _mm_mul_ps(gain, output_gain));
+	}
+	for (; i < num_samples; ++i) {
+		const float env_db = mul_to_db_fast(buf[i]);
 		float gain = cd->slope * (cd->threshold - env_db);
-		gain = db_to_mul(fminf(0, gain));
-
-		for (size_t c = 0; c < cd->num_channels; ++c) {
-			if (samples[c]) {
-				samples[c][i] *= gain * cd->output_gain;
-			}
-		}
+		buf[i] = db_to_mul_fast(fminf(0, gain)) * cd->output_gain;
 	}
+
+	dsp_apply_gain(samples, cd->num_channels, buf, num_samples);
 }
 
 static struct obs_audio_data *compressor_filter_audio(void *data,
@@ -183,6 +189,9 @@ static struct obs_audio_data *compressor_filter_audio(void *data,
 	const uint32_t num_samples = audio->frames;
 	float **samples = (float**)audio->data;
 
+	if (!num_samples)
+		return audio;
+
 	analyze_envelope(cd, samples, num_samples);
 	process_compression(cd, samples, num_samples);
 
@@ -1,6 +1,7 @@
 #include <obs-module.h>
 #include <media-io/audio-math.h>
 #include <math.h>
+#include "audio-dsp.h"
 
 #define do_log(level, format, ...) \
 	blog(level, "[gain filter: '%s'] " format, \
@@ -52,16 +53,8 @@ static struct obs_audio_data *gain_filter_audio(void *data,
 {
 	struct gain_data *gf = data;
 
-	float *adata[2] = {(float*)audio->data[0], (float*)audio->data[1]};
-	const float multiple = gf->multiple;
-
-	for (size_t c = 0; c < 2; c++) {
-		if (audio->data[c]) {
-			for (size_t i = 0; i < audio->frames; i++) {
-				adata[c][i] *= multiple;
-			}
-		}
-	}
+	dsp_scale((float**)audio->data, MAX_AV_PLANES, gf->multiple,
+			audio->frames);
 
 	return audio;
 }
@@ -2,10 +2,15 @@
 #include <util/circlebuf.h>
 
 #define S_DELAY_MS                     "delay_ms"
+#define S_COMPACT                      "compact"
 #define T_DELAY_MS                     obs_module_text("DelayMs")
+#define T_COMPACT                      obs_module_text("CompactStorage")
 
+/* in compact mode, render holds the Y plane and chroma the half size U and V
+ * planes, each one byte per pixel instead of four */
 struct frame {
 	gs_texrender_t *render;
+	gs_texrender_t *chroma[2];
 	uint64_t ts;
 };
 
@@ -18,6 +23,20 @@ struct gpu_delay_filter_data {
 	uint32_t                       cy;
 	bool                           target_valid;
 	bool                           processed_frame;
+
+	bool                           compact;
+	gs_texrender_t                 *scratch;
+	gs_effect_t                    *effect;
+	gs_eparam_t                    *color_vec_param;
+	gs_eparam_t                    *plane_u_param;
+	gs_eparam_t                    *plane_v_param;
+};
+
+/* full range BT.709 */
+static const struct vec4 pack_vecs[3] = {
+	{{{ 0.212600f,  0.715200f,  0.072200f, 0.0f}}},
+	{{{-0.114572f, -0.385428f,  0.500000f, 0.5f}}},
+	{{{ 0.500000f, -0.454153f, -0.045847f, 0.5f}}},
 };
 
 static const char *gpu_delay_filter_get_name(void *unused)
@@ -26,15 +45,24 @@ static const char *gpu_delay_filter_get_name(void *unused)
 	return obs_module_text("GPUDelayFilter");
 }
 
+static inline void destroy_frame(struct frame *frame)
+{
+	gs_texrender_destroy(frame->render);
+	gs_texrender_destroy(frame->chroma[0]);
+	gs_texrender_destroy(frame->chroma[1]);
+}
+
 static void free_textures(struct gpu_delay_filter_data *f)
 {
 	obs_enter_graphics();
 	while (f->frames.size) {
 		struct frame frame;
 		circlebuf_pop_front(&f->frames, &frame, sizeof(frame));
-		gs_texrender_destroy(frame.render);
+		destroy_frame(&frame);
 	}
 	circlebuf_free(&f->frames);
+	gs_texrender_destroy(f->scratch);
+	f->scratch = NULL;
 	obs_leave_graphics();
 }
 
@@ -64,9 +92,25 @@ static void update_interval(struct gpu_delay_filter_data *f,
 		for (size_t i = prev_num; i < num; i++) {
 			struct frame *frame = circlebuf_data(&f->frames,
 					i * sizeof(*frame));
-			frame->render = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+
+			if (f->compact) {
+				frame->render = gs_texrender_create(GS_R8,
+						GS_ZS_NONE);
+				frame->chroma[0] = gs_texrender_create(GS_R8,
+						GS_ZS_NONE);
+				frame->chroma[1] = gs_texrender_create(GS_R8,
+						GS_ZS_NONE);
+			} else {
+				frame->render = gs_texrender_create(GS_RGBA,
+						GS_ZS_NONE);
+				frame->chroma[0] = NULL;
+				frame->chroma[1] = NULL;
+			}
 		}
 
+		if (f->compact && !f->scratch)
+			f->scratch = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+
 		obs_leave_graphics();
 
 	} else if (num < num_frames(&f->frames)) {
@@ -75,7 +119,7 @@ static void update_interval(struct gpu_delay_filter_data *f,
 		while (num_frames(&f->frames) > num) {
 			struct frame frame;
 			circlebuf_pop_front(&f->frames, &frame, sizeof(frame));
-			gs_texrender_destroy(frame.render);
+			destroy_frame(&frame);
 		}
 
 		obs_leave_graphics();
@@ -135,6 +179,7 @@ static void gpu_delay_filter_update(void *data, obs_data_t *s)
 	struct gpu_delay_filter_data *f = data;
 
 	f->delay_ns = (uint64_t)obs_data_get_int(s, S_DELAY_MS) * 1000000ULL;
+	f->compact  = obs_data_get_bool(s, S_COMPACT) && !!f->effect;
 
 	/* full reset */
 	f->cx = 0;
@@ -148,6 +193,7 @@ static obs_properties_t *gpu_delay_filter_properties(void *data)
 	obs_properties_t *props = obs_properties_create();
 
 	obs_properties_add_int(props, S_DELAY_MS, T_DELAY_MS, 0, 500, 1);
+	obs_properties_add_bool(props, S_COMPACT, T_COMPACT);
 
 	UNUSED_PARAMETER(data);
 	return props;
@@ -156,8 +202,26 @@ static obs_properties_t *gpu_delay_filter_properties(void *data)
 static void *gpu_delay_filter_create(obs_data_t *settings, obs_source_t *context)
 {
 	struct gpu_delay_filter_data *f = bzalloc(sizeof(*f));
+	char *effect_path = obs_module_file("compact_frame.effect");
+
 	f->context = context;
 
+	obs_enter_graphics();
+
+	f->effect = gs_effect_create_from_file(effect_path, NULL);
+	if (f->effect) {
+		f->color_vec_param = gs_effect_get_param_by_name(f->effect,
+				"color_vec");
+		f->plane_u_param = gs_effect_get_param_by_name(f->effect,
+				"plane_u");
+		f->plane_v_param = gs_effect_get_param_by_name(f->effect,
+				"plane_v");
+	}
+
+	obs_leave_graphics();
+
+	bfree(effect_path);
+
 	obs_source_update(context, settings);
 	return f;
 }
@@ -167,6 +231,11 @@ static void gpu_delay_filter_destroy(void *data)
 	struct gpu_delay_filter_data *f = data;
 
 	free_textures(f);
+
+	obs_enter_graphics();
+	gs_effect_destroy(f->effect);
+	obs_leave_graphics();
+
 	bfree(f);
 }
 
@@ -183,11 +252,35 @@ static void gpu_delay_filter_tick(void *data, float t)
 	check_interval(f);
 }
 
+static void draw_compact_frame(struct gpu_delay_filter_data *f,
+		struct frame *frame)
+{
+	gs_texture_t *y = gs_texrender_get_texture(frame->render);
+	gs_texture_t *u = gs_texrender_get_texture(frame->chroma[0]);
+	gs_texture_t *v = gs_texrender_get_texture(frame->chroma[1]);
+
+	if (!y || !u || !v)
+		return;
+
+	gs_effect_set_texture(gs_effect_get_param_by_name(f->effect, "image"),
+			y);
+	gs_effect_set_texture(f->plane_u_param, u);
+	gs_effect_set_texture(f->plane_v_param, v);
+
+	while (gs_effect_loop(f->effect, "Unpack"))
+		gs_draw_sprite(y, 0, f->cx, f->cy);
+}
+
 static void draw_frame(struct gpu_delay_filter_data *f)
 {
 	struct frame frame;
 	circlebuf_peek_front(&f->frames, &frame, sizeof(frame));
 
+	if (frame.chroma[0]) {
+		draw_compact_frame(f, &frame);
+		return;
+	}
+
 	gs_effect_t *effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
 	gs_texture_t *tex = gs_texrender_get_texture(frame.render);
 	if (tex) {
@@ -200,6 +293,42 @@ static void draw_frame(struct gpu_delay_filter_data *f)
 	}
 }
 
+static void pack_plane(struct gpu_delay_filter_data *f,
+		gs_texrender_t *plane, gs_texture_t *tex,
+		const struct vec4 *color_vec, uint32_t cx, uint32_t cy)
+{
+	gs_texrender_reset(plane);
+
+	if (gs_texrender_begin(plane, cx, cy)) {
+		gs_ortho(0.0f, (float)cx, 0.0f, (float)cy, -100.0f, 100.0f);
+
+		gs_effect_set_texture(gs_effect_get_param_by_name(f->effect,
+					"image"), tex);
+		gs_effect_set_vec4(f->color_vec_param, color_vec);
+
+		while (gs_effect_loop(f->effect, "Pack"))
+			gs_draw_sprite(tex, 0, cx, cy);
+
+		gs_texrender_end(plane);
+	}
+}
+
+static void pack_frame(struct gpu_delay_filter_data *f, struct frame *frame)
+{
+	gs_texture_t *tex = gs_texrender_get_texture(f->scratch);
+	uint32_t chroma_cx = (f->cx + 1) / 2;
+	uint32_t chroma_cy = (f->cy + 1) / 2;
+
+	if (!tex)
+		return;
+
+	pack_plane(f, frame->render, tex, &pack_vecs[0], f->cx, f->cy);
+	pack_plane(f, frame->chroma[0], tex, &pack_vecs[1],
+			chroma_cx, chroma_cy);
+	pack_plane(f, frame->chroma[1], tex, &pack_vecs[2],
+			chroma_cx, chroma_cy);
+}
+
 static void gpu_delay_filter_render(void *data, gs_effect_t *effect)
 {
 	struct gpu_delay_filter_data *f = data;
@@ -219,12 +348,14 @@ static void gpu_delay_filter_render(void *data, gs_effect_t *effect)
 	struct frame frame;
 	circlebuf_pop_front(&f->frames, &frame, sizeof(frame));
 
-	gs_texrender_reset(frame.render);
+	gs_texrender_t *render = frame.chroma[0] ? f->scratch : frame.render;
+
+	gs_texrender_reset(render);
 
 	gs_blend_state_push();
 	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
 
-	if (gs_texrender_begin(frame.render, f->cx, f->cy)) {
+	if (gs_texrender_begin(render, f->cx, f->cy)) {
 		uint32_t parent_flags = obs_source_get_output_flags(target);
 		bool custom_draw = (parent_flags & OBS_SOURCE_CUSTOM_DRAW) != 0;
 		bool async = (parent_flags & OBS_SOURCE_ASYNC) != 0;
@@ -240,9 +371,12 @@ static void gpu_delay_filter_render(void *data, gs_effect_t *effect)
 		else
 			obs_source_video_render(target);
 
-		gs_texrender_end(frame.render);
+		gs_texrender_end(render);
 	}
 
+	if (frame.chroma[0])
+		pack_frame(f, &frame);
+
 	gs_blend_state_pop();
 
 	circlebuf_push_back(&f->frames, &frame, sizeof(frame));
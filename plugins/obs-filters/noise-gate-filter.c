@@ -1,6 +1,7 @@
 #include <media-io/audio-math.h>
 #include <obs-module.h>
 #include <math.h>
+#include "audio-dsp.h"
 
 #define do_log(level, format, ...) \
 	blog(level, "[noise gate: '%s'] " format, \
@@ -39,6 +40,9 @@ struct noise_gate_data {
 	float attenuation;
 	float level;
 	float held_time;
+
+	float *gain_buf;
+	size_t gain_buf_len;
 };
 
 #define VOL_MIN -96.0f
@@ -53,6 +57,7 @@ static const char *noise_gate_name(void *unused)
 static void noise_gate_destroy(void *data)
 {
 	struct noise_gate_data *ng = data;
+	bfree(ng->gain_buf);
 	bfree(ng);
 }
 
@@ -109,7 +114,7 @@ static struct obs_audio_data *noise_gate_filter_audio(void *data,
 {
 	struct noise_gate_data *ng = data;
 
-	float *adata[2] = {(float*)audio->data[0], (float*)audio->data[1]};
+	float **adata = (float**)audio->data;
 	const float close_threshold = ng->close_threshold;
 	const float open_threshold = ng->open_threshold;
 	const float sample_rate_i = ng->sample_rate_i;
@@ -119,10 +124,19 @@ static struct obs_audio_data *noise_gate_filter_audio(void *data,
 	const float hold_time = ng->hold_time;
 	const size_t channels = ng->channels;
 
+	if (ng->gain_buf_len < audio->frames) {
+		ng->gain_buf_len = audio->frames;
+		ng->gain_buf = brealloc(ng->gain_buf,
+				ng->gain_buf_len * sizeof(float));
+	}
+
+	/* levels are detected for the whole block first, then the gate state
+	 * machine turns them into per-sample attenuation in place */
+	float *gain = ng->gain_buf;
+	dsp_max_abs(gain, adata, channels, audio->frames);
+
 	for (size_t i = 0; i < audio->frames; i++) {
-		float cur_level = (channels == 2)
-			? fmaxf(fabsf(adata[0][i]), fabsf(adata[1][i]))
-			: fabsf(adata[0][i]);
+		float cur_level = gain[i];
 
 		if (cur_level > open_threshold && !ng->is_open) {
 			ng->is_open = true;
@@ -145,10 +159,11 @@ static struct obs_audio_data *noise_gate_filter_audio(void *data,
 			}
 		}
 
-		for (size_t c = 0; c < channels; c++)
-			adata[c][i] *= ng->attenuation;
+		gain[i] = ng->attenuation;
 	}
 
+	dsp_apply_gain(adata, channels, gain, audio->frames);
+
 	return audio;
 }
 
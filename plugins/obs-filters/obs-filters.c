@@ -2,6 +2,7 @@
 #include "obs-filters-config.h"
 
 OBS_DECLARE_MODULE()
+OBS_MODULE_DEFERRABLE()
 
 OBS_MODULE_USE_DEFAULT_LOCALE("obs-filters", "en-US")
 
@@ -115,7 +115,7 @@ static void sharpness_defaults(obs_data_t *settings)
 struct obs_source_info sharpness_filter = {
 	.id = "sharpness_filter",
 	.type = OBS_SOURCE_TYPE_FILTER,
-	.output_flags = OBS_SOURCE_VIDEO,
+	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_STATIC_CONTENT,
 	.get_name = sharpness_getname,
 	.create = sharpness_create,
 	.destroy = sharpness_destroy,
@@ -182,10 +182,12 @@ static void flv_video(struct serializer *s, struct encoder_packet *packet,
 {
 	int64_t offset  = packet->pts - packet->dts;
 	int32_t time_ms = get_ms_time(packet, packet->dts);
+	int64_t start_pos;
 
 	if (!packet->data || !packet->size)
 		return;
 
+	start_pos = serializer_get_pos(s);
 	s_w8(s, RTMP_PACKET_TYPE_VIDEO);
 
 #ifdef DEBUG_TIMESTAMPS
@@ -209,17 +211,19 @@ static void flv_video(struct serializer *s, struct encoder_packet *packet,
 	s_write(s, packet->data, packet->size);
 
 	/* write tag size (starting byte doesn't count) */
-	s_wb32(s, (uint32_t)serializer_get_pos(s) + 4 - 1);
+	s_wb32(s, (uint32_t)(serializer_get_pos(s) - start_pos) + 4 - 1);
 }
 
 static void flv_audio(struct serializer *s, struct encoder_packet *packet,
 		bool is_header)
 {
 	int32_t time_ms = get_ms_time(packet, packet->dts);
+	int64_t start_pos;
 
 	if (!packet->data || !packet->size)
 		return;
 
+	start_pos = serializer_get_pos(s);
 	s_w8(s, RTMP_PACKET_TYPE_AUDIO);
 
 #ifdef DEBUG_TIMESTAMPS
@@ -242,7 +246,16 @@ static void flv_audio(struct serializer *s, struct encoder_packet *packet,
 	s_write(s, packet->data, packet->size);
 
 	/* write tag size (starting byte doesn't count) */
-	s_wb32(s, (uint32_t)serializer_get_pos(s) + 4 - 1);
+	s_wb32(s, (uint32_t)(serializer_get_pos(s) - start_pos) + 4 - 1);
+}
+
+void flv_packet_serialize(struct serializer *s, struct encoder_packet *packet,
+		bool is_header)
+{
+	if (packet->type == OBS_ENCODER_VIDEO)
+		flv_video(s, packet, is_header);
+	else
+		flv_audio(s, packet, is_header);
 }
 
 void flv_packet_mux(struct encoder_packet *packet,
@@ -252,11 +265,7 @@ void flv_packet_mux(struct encoder_packet *packet,
 	struct serializer s;
 
 	array_output_serializer_init(&s, &data);
-
-	if (packet->type == OBS_ENCODER_VIDEO)
-		flv_video(&s, packet, is_header);
-	else
-		flv_audio(&s, packet, is_header);
+	flv_packet_serialize(&s, packet, is_header);
 
 	*output = data.bytes.array;
 	*size   = data.bytes.num;
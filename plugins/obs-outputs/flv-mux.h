@@ -18,6 +18,7 @@
 #pragma once
 
 #include <obs.h>
+#include <util/serializer.h>
 
 #define MILLISECOND_DEN   1000
 
@@ -32,3 +33,7 @@ extern bool flv_meta_data(obs_output_t *context, uint8_t **output, size_t *size,
 		bool write_header, size_t audio_idx);
 extern void flv_packet_mux(struct encoder_packet *packet,
 		uint8_t **output, size_t *size, bool is_header);
+
+/* serializes a packet as an FLV tag without allocating an output buffer */
+extern void flv_packet_serialize(struct serializer *s,
+		struct encoder_packet *packet, bool is_header);
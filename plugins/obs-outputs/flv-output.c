@@ -15,15 +15,27 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 ******************************************************************************/
 
+#ifdef __linux__
+#define _GNU_SOURCE
+#include <fcntl.h>
+#endif
+
 #include <stdio.h>
+#include <stdlib.h>
 #include <obs-module.h>
 #include <obs-avc.h>
 #include <util/platform.h>
+#include <util/circlebuf.h>
+#include <util/darray.h>
 #include <util/dstr.h>
 #include <util/threading.h>
 #include <inttypes.h>
 #include "flv-mux.h"
 
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
 #define do_log(level, format, ...) \
 	blog(level, "[flv output: '%s'] " format, \
 			obs_output_get_name(stream->output), ##__VA_ARGS__)
@@ -31,6 +43,20 @@
 #define warn(format, ...)  do_log(LOG_WARNING, format, ##__VA_ARGS__)
 #define info(format, ...)  do_log(LOG_INFO,    format, ##__VA_ARGS__)
 
+/* packets are serialized into write buffers, which are written to disk on a
+ * separate thread once they are full.  buffers are allocated on demand up to
+ * MAX_WRITE_BUFFERS, after which the output waits for the disk.  if a buffer
+ * can't be allocated, the output waits for one of the existing buffers, and
+ * fails if it doesn't have any. */
+#define WRITE_BUFFER_SIZE  (1024 * 1024)
+#define WRITE_ALIGNMENT    4096
+#define MAX_WRITE_BUFFERS  64
+
+struct write_buffer {
+	uint8_t      *data;
+	size_t       size;
+};
+
 struct flv_output {
 	obs_output_t *output;
 	struct dstr  path;
@@ -38,6 +64,27 @@ struct flv_output {
 	bool         active;
 	bool         sent_headers;
 	int64_t      last_packet_ts;
+
+	struct serializer             serializer;
+	struct write_buffer           *cur_buffer;
+	uint64_t                      file_size;
+
+	DARRAY(struct write_buffer*)  free_buffers;
+	struct circlebuf              queued_buffers;
+	size_t                        num_buffers;
+	pthread_mutex_t               write_mutex;
+	os_sem_t                      *write_sem;
+	os_event_t                    *buffer_freed;
+	pthread_t                     write_thread;
+	bool                          write_thread_active;
+	bool                          direct_io;
+	volatile bool                 write_error;
+
+	/* write statistics */
+	size_t                        max_queue_depth;
+	uint64_t                      num_writes;
+	uint64_t                      total_write_ns;
+	uint64_t                      max_write_ns;
 };
 
 static const char *flv_output_getname(void *unused)
@@ -46,6 +93,334 @@ static const char *flv_output_getname(void *unused)
 	return obs_module_text("FLVOutput");
 }
 
+/* ------------------------------------------------------------------------ */
+/* write buffers */
+
+static struct write_buffer *write_buffer_create(void)
+{
+	struct write_buffer *buf = bzalloc(sizeof(struct write_buffer));
+
+	/* aligned so that full buffers can bypass the page cache */
+#ifdef _WIN32
+	buf->data = _aligned_malloc(WRITE_BUFFER_SIZE, WRITE_ALIGNMENT);
+#else
+	if (posix_memalign((void**)&buf->data, WRITE_ALIGNMENT,
+				WRITE_BUFFER_SIZE) != 0)
+		buf->data = NULL;
+#endif
+	if (!buf->data) {
+		bfree(buf);
+		return NULL;
+	}
+
+	return buf;
+}
+
+static void write_buffer_destroy(struct write_buffer *buf)
+{
+	if (!buf)
+		return;
+
+#ifdef _WIN32
+	_aligned_free(buf->data);
+#else
+	free(buf->data);
+#endif
+	bfree(buf);
+}
+
+#ifdef __linux__
+static bool set_direct_io(FILE *file, bool enable)
+{
+	int fd = fileno(file);
+	int flags = fcntl(fd, F_GETFL);
+
+	if (flags == -1)
+		return false;
+
+	flags = enable ? (flags | O_DIRECT) : (flags & ~O_DIRECT);
+	return fcntl(fd, F_SETFL, flags) == 0;
+}
+#endif
+
+static void write_buffer_to_file(struct flv_output *stream,
+		struct write_buffer *buf)
+{
+	uint64_t start = os_gettime_ns();
+	uint64_t elapsed;
+	size_t   written;
+
+#ifdef __linux__
+	/* only full, aligned buffers can be written directly, which is
+	 * everything but the final buffer of the file */
+	if (stream->direct_io && buf->size % WRITE_ALIGNMENT != 0) {
+		set_direct_io(stream->file, false);
+		stream->direct_io = false;
+	}
+#endif
+
+	written = fwrite(buf->data, 1, buf->size, stream->file);
+
+#ifdef __linux__
+	/* the file system may not support direct I/O after all */
+	if (written != buf->size && stream->direct_io) {
+		set_direct_io(stream->file, false);
+		stream->direct_io = false;
+		clearerr(stream->file);
+
+		written += fwrite(buf->data + written, 1, buf->size - written,
+				stream->file);
+	}
+#endif
+
+	if (written != buf->size &&
+	    !os_atomic_load_bool(&stream->write_error)) {
+		warn("Failed to write to '%s'", stream->path.array);
+		os_atomic_set_bool(&stream->write_error, true);
+	}
+
+	elapsed = os_gettime_ns() - start;
+
+	pthread_mutex_lock(&stream->write_mutex);
+	stream->num_writes++;
+	stream->total_write_ns += elapsed;
+	if (elapsed > stream->max_write_ns)
+		stream->max_write_ns = elapsed;
+	pthread_mutex_unlock(&stream->write_mutex);
+}
+
+static void *write_thread(void *data)
+{
+	struct flv_output *stream = data;
+
+	os_set_thread_name("flv-output: write");
+
+	while (os_sem_wait(stream->write_sem) == 0) {
+		struct write_buffer *buf = NULL;
+
+		pthread_mutex_lock(&stream->write_mutex);
+		if (stream->queued_buffers.size)
+			circlebuf_pop_front(&stream->queued_buffers, &buf,
+					sizeof(buf));
+		pthread_mutex_unlock(&stream->write_mutex);
+
+		/* queued buffers are posted before the stop signal, so an
+		 * empty queue means the output is stopping */
+		if (!buf)
+			break;
+
+		write_buffer_to_file(stream, buf);
+		buf->size = 0;
+
+		pthread_mutex_lock(&stream->write_mutex);
+		da_push_back(stream->free_buffers, &buf);
+		pthread_mutex_unlock(&stream->write_mutex);
+
+		os_event_signal(stream->buffer_freed);
+	}
+
+	return NULL;
+}
+
+static inline size_t queue_depth(struct flv_output *stream)
+{
+	return stream->queued_buffers.size / sizeof(struct write_buffer*);
+}
+
+static void queue_cur_buffer(struct flv_output *stream)
+{
+	struct write_buffer *buf = stream->cur_buffer;
+
+	if (!buf)
+		return;
+
+	stream->cur_buffer = NULL;
+
+	pthread_mutex_lock(&stream->write_mutex);
+	circlebuf_push_back(&stream->queued_buffers, &buf, sizeof(buf));
+	if (queue_depth(stream) > stream->max_queue_depth)
+		stream->max_queue_depth = queue_depth(stream);
+	pthread_mutex_unlock(&stream->write_mutex);
+
+	os_sem_post(stream->write_sem);
+}
+
+/* returns NULL only if no buffer exists and none can be allocated.  every
+ * buffer that isn't free is queued or being written at this point, so the
+ * write thread always hands one back eventually. */
+static struct write_buffer *get_free_buffer(struct flv_output *stream)
+{
+	struct write_buffer *buf = NULL;
+	bool alloc_failed = false;
+	bool waited = false;
+	size_t num_buffers;
+
+	for (;;) {
+		pthread_mutex_lock(&stream->write_mutex);
+		if (stream->free_buffers.num) {
+			buf = da_end(stream->free_buffers);
+			da_pop_back(stream->free_buffers);
+		} else if (stream->num_buffers < MAX_WRITE_BUFFERS) {
+			buf = write_buffer_create();
+			if (buf)
+				stream->num_buffers++;
+			else
+				alloc_failed = true;
+		}
+		num_buffers = stream->num_buffers;
+		pthread_mutex_unlock(&stream->write_mutex);
+
+		if (buf)
+			break;
+
+		if (!num_buffers) {
+			warn("Failed to allocate a write buffer");
+			break;
+		}
+
+		if (!waited) {
+			if (alloc_failed)
+				warn("Failed to allocate a write buffer, "
+						"waiting for the disk");
+			else
+				warn("Write queue is full, waiting for the "
+						"disk");
+			waited = true;
+		}
+
+		os_event_wait(stream->buffer_freed);
+	}
+
+	return buf;
+}
+
+static size_t buffer_write(void *param, const void *data, size_t size)
+{
+	struct flv_output *stream = param;
+	const uint8_t *src = data;
+	size_t remaining = size;
+
+	while (remaining) {
+		struct write_buffer *buf = stream->cur_buffer;
+		size_t copy;
+
+		if (!buf) {
+			buf = stream->cur_buffer = get_free_buffer(stream);
+			if (!buf) {
+				/* the output is failed on the next packet */
+				os_atomic_set_bool(&stream->write_error, true);
+				return size - remaining;
+			}
+		}
+
+		copy = WRITE_BUFFER_SIZE - buf->size;
+		if (copy > remaining)
+			copy = remaining;
+
+		memcpy(buf->data + buf->size, src, copy);
+		buf->size += copy;
+		src       += copy;
+		remaining -= copy;
+
+		if (buf->size == WRITE_BUFFER_SIZE)
+			queue_cur_buffer(stream);
+	}
+
+	stream->file_size += size;
+	return size;
+}
+
+static int64_t buffer_get_pos(void *param)
+{
+	struct flv_output *stream = param;
+	return (int64_t)stream->file_size;
+}
+
+static bool start_write_thread(struct flv_output *stream)
+{
+	memset(&stream->serializer, 0, sizeof(stream->serializer));
+	stream->serializer.data    = stream;
+	stream->serializer.write   = buffer_write;
+	stream->serializer.get_pos = buffer_get_pos;
+
+	stream->file_size       = 0;
+	os_atomic_set_bool(&stream->write_error, false);
+	stream->max_queue_depth = 0;
+	stream->num_writes      = 0;
+	stream->total_write_ns  = 0;
+	stream->max_write_ns    = 0;
+
+	/* everything goes through the write buffers */
+	setvbuf(stream->file, NULL, _IONBF, 0);
+
+#ifdef __linux__
+	stream->direct_io = set_direct_io(stream->file, true);
+#endif
+
+	if (pthread_create(&stream->write_thread, NULL, write_thread,
+				stream) != 0)
+		return false;
+
+	stream->write_thread_active = true;
+	return true;
+}
+
+static void stop_write_thread(struct flv_output *stream)
+{
+	if (!stream->write_thread_active)
+		return;
+
+	queue_cur_buffer(stream);
+	os_sem_post(stream->write_sem);
+	pthread_join(stream->write_thread, NULL);
+	stream->write_thread_active = false;
+
+#ifdef __linux__
+	if (stream->direct_io) {
+		set_direct_io(stream->file, false);
+		stream->direct_io = false;
+	}
+#endif
+
+	if (stream->num_writes)
+		info("Write queue peak depth: %d, average write time: %.2f ms, "
+				"max write time: %.2f ms",
+				(int)stream->max_queue_depth,
+				(double)stream->total_write_ns /
+				(double)stream->num_writes / 1000000.0,
+				(double)stream->max_write_ns / 1000000.0);
+}
+
+static void free_write_buffers(struct flv_output *stream)
+{
+	for (size_t i = 0; i < stream->free_buffers.num; i++)
+		write_buffer_destroy(stream->free_buffers.array[i]);
+	da_free(stream->free_buffers);
+	circlebuf_free(&stream->queued_buffers);
+	stream->num_buffers = 0;
+}
+
+static void get_write_stats_proc(void *data, calldata_t *cd)
+{
+	struct flv_output *stream = data;
+	double avg_ms = 0.0;
+
+	pthread_mutex_lock(&stream->write_mutex);
+	if (stream->num_writes)
+		avg_ms = (double)stream->total_write_ns /
+			(double)stream->num_writes / 1000000.0;
+
+	calldata_set_int(cd, "queue_depth", (long long)queue_depth(stream));
+	calldata_set_int(cd, "max_queue_depth",
+			(long long)stream->max_queue_depth);
+	calldata_set_float(cd, "avg_write_ms", avg_ms);
+	calldata_set_float(cd, "max_write_ms",
+			(double)stream->max_write_ns / 1000000.0);
+	pthread_mutex_unlock(&stream->write_mutex);
+}
+
+/* ------------------------------------------------------------------------ */
+
 static void flv_output_stop(void *data, uint64_t ts);
 
 static void flv_output_destroy(void *data)
@@ -55,6 +430,10 @@ static void flv_output_destroy(void *data)
 	if (stream->active)
 		flv_output_stop(data, 0);
 
+	free_write_buffers(stream);
+	os_event_destroy(stream->buffer_freed);
+	os_sem_destroy(stream->write_sem);
+	pthread_mutex_destroy(&stream->write_mutex);
 	dstr_free(&stream->path);
 	bfree(stream);
 }
@@ -62,10 +441,43 @@ static void flv_output_destroy(void *data)
 static void *flv_output_create(obs_data_t *settings, obs_output_t *output)
 {
 	struct flv_output *stream = bzalloc(sizeof(struct flv_output));
+	proc_handler_t *ph = obs_output_get_proc_handler(output);
+
 	stream->output = output;
 
+	pthread_mutex_init_value(&stream->write_mutex);
+	if (pthread_mutex_init(&stream->write_mutex, NULL) != 0)
+		goto fail;
+	if (os_sem_init(&stream->write_sem, 0) != 0)
+		goto fail;
+	if (os_event_init(&stream->buffer_freed, OS_EVENT_TYPE_AUTO) != 0)
+		goto fail;
+
+	proc_handler_add(ph, "void get_write_stats(out int queue_depth, "
+			"out int max_queue_depth, out float avg_write_ms, "
+			"out float max_write_ms)",
+			get_write_stats_proc, stream);
+
 	UNUSED_PARAMETER(settings);
 	return stream;
+
+fail:
+	flv_output_destroy(stream);
+	return NULL;
+}
+
+static void close_file(struct flv_output *stream)
+{
+	if (!stream->file)
+		return;
+
+	stop_write_thread(stream);
+
+	write_file_info(stream->file, stream->last_packet_ts,
+			(int64_t)stream->file_size);
+
+	fclose(stream->file);
+	stream->file = NULL;
 }
 
 static void flv_output_stop(void *data, uint64_t ts)
@@ -73,12 +485,7 @@ static void flv_output_stop(void *data, uint64_t ts)
 	struct flv_output *stream = data;
 
 	if (stream->active) {
-		if (stream->file) {
-			write_file_info(stream->file, stream->last_packet_ts,
-					os_ftelli64(stream->file));
-
-			fclose(stream->file);
-		}
+		close_file(stream);
 		obs_output_end_data_capture(stream->output);
 		stream->active = false;
 		stream->sent_headers = false;
@@ -89,18 +496,26 @@ static void flv_output_stop(void *data, uint64_t ts)
 	UNUSED_PARAMETER(ts);
 }
 
+/* stops the output when data was lost, rather than leaving a file with
+ * gaps in it */
+static void signal_failure(struct flv_output *stream)
+{
+	close_file(stream);
+	stream->active = false;
+	stream->sent_headers = false;
+
+	warn("FLV file output failed");
+	obs_output_signal_stop(stream->output, OBS_OUTPUT_ERROR);
+}
+
 static int write_packet(struct flv_output *stream,
 		struct encoder_packet *packet, bool is_header)
 {
-	uint8_t *data;
-	size_t  size;
-	int     ret = 0;
+	int ret = 0;
 
 	stream->last_packet_ts = get_ms_time(packet, packet->dts);
 
-	flv_packet_mux(packet, &data, &size, is_header);
-	fwrite(data, 1, size, stream->file);
-	bfree(data);
+	flv_packet_serialize(&stream->serializer, packet, is_header);
 	obs_encoder_packet_release(packet);
 
 	return ret;
@@ -112,7 +527,7 @@ static void write_meta_data(struct flv_output *stream)
 	size_t  meta_data_size;
 
 	flv_meta_data(stream->output, &meta_data, &meta_data_size, true, 0);
-	fwrite(meta_data, 1, meta_data_size, stream->file);
+	s_write(&stream->serializer, meta_data, meta_data_size);
 	bfree(meta_data);
 }
 
@@ -180,6 +595,13 @@ static bool flv_output_start(void *data)
 		return false;
 	}
 
+	if (!start_write_thread(stream)) {
+		warn("Failed to create write thread");
+		fclose(stream->file);
+		stream->file = NULL;
+		return false;
+	}
+
 	/* write headers and start capture */
 	stream->active = true;
 	obs_output_begin_data_capture(stream->output, 0);
@@ -193,6 +615,9 @@ static void flv_output_data(void *data, struct encoder_packet *packet)
 	struct flv_output     *stream = data;
 	struct encoder_packet parsed_packet;
 
+	if (!stream->active)
+		return;
+
 	if (!stream->sent_headers) {
 		write_headers(stream);
 		stream->sent_headers = true;
@@ -205,6 +630,9 @@ static void flv_output_data(void *data, struct encoder_packet *packet)
 	} else {
 		write_packet(stream, packet, false);
 	}
+
+	if (os_atomic_load_bool(&stream->write_error))
+		signal_failure(stream);
 }
 
 static obs_properties_t *flv_output_properties(void *unused)
@@ -38,7 +38,8 @@ static struct obs_source_info freetype2_source_info = {
 #ifdef _WIN32
 	                OBS_SOURCE_DEPRECATED |
 #endif
-	                OBS_SOURCE_CUSTOM_DRAW,
+	                OBS_SOURCE_CUSTOM_DRAW |
+	                OBS_SOURCE_STATIC_CONTENT,
 	.get_name = ft2_source_get_name,
 	.create = ft2_source_create,
 	.destroy = ft2_source_destroy,
@@ -247,6 +248,8 @@ static void ft2_video_tick(void *data, float seconds)
 			cache_glyphs(srcdata, srcdata->text);
 			set_up_vertex_buffer(srcdata);
 			srcdata->update_file = false;
+
+			obs_source_invalidate_content(srcdata->src);
 		}
 
 		if (srcdata->m_timestamp != t) {
@@ -0,0 +1,288 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+/* direct audio conversion, compared against a plain per-sample conversion */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <media-io/audio-conversion.h>
+#include "test-check.h"
+
+#define MAX_FRAMES   1027
+#define MIX_LEVEL    0.70710678118654752f
+#define TOLERANCE    1e-6f
+
+/* ------------------------------------------------------------------------- */
+/* reference conversion */
+
+static float get_sample(enum audio_format format, const uint8_t *data,
+		size_t idx)
+{
+	switch (format) {
+	case AUDIO_FORMAT_U8BIT:
+	case AUDIO_FORMAT_U8BIT_PLANAR:
+		return (float)((int)data[idx] - 128) / 128.0f;
+
+	case AUDIO_FORMAT_16BIT:
+	case AUDIO_FORMAT_16BIT_PLANAR:
+		return (float)((const int16_t*)data)[idx] / 32768.0f;
+
+	case AUDIO_FORMAT_32BIT:
+	case AUDIO_FORMAT_32BIT_PLANAR:
+		return (float)((const int32_t*)data)[idx] / 2147483648.0f;
+
+	case AUDIO_FORMAT_FLOAT:
+	case AUDIO_FORMAT_FLOAT_PLANAR:
+		return ((const float*)data)[idx];
+
+	case AUDIO_FORMAT_UNKNOWN:
+		break;
+	}
+
+	return 0.0f;
+}
+
+static float get_input(const struct resample_info *src,
+		const uint8_t *const input[], size_t channel, uint32_t frame)
+{
+	size_t channels = get_audio_channels(src->speakers);
+
+	if (is_audio_planar(src->format))
+		return get_sample(src->format, input[channel], frame);
+
+	return get_sample(src->format, input[0], frame * channels + channel);
+}
+
+static float reference_sample(const struct resample_info *dst,
+		const struct resample_info *src,
+		const uint8_t *const input[], size_t channel, uint32_t frame)
+{
+	if (src->speakers == SPEAKERS_STEREO &&
+	    dst->speakers == SPEAKERS_MONO)
+		return (get_input(src, input, 0, frame) +
+		        get_input(src, input, 1, frame)) * MIX_LEVEL;
+
+	if (src->speakers == SPEAKERS_MONO &&
+	    dst->speakers == SPEAKERS_STEREO)
+		return get_input(src, input, 0, frame) * MIX_LEVEL;
+
+	return get_input(src, input, channel, frame);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* covers the whole range of each format, including both extremes */
+static void fill_input(enum audio_format format, uint8_t *data, size_t count,
+		uint32_t seed)
+{
+	for (size_t i = 0; i < count; i++) {
+		seed = seed * 1103515245 + 12345;
+
+		switch (format) {
+		case AUDIO_FORMAT_U8BIT:
+		case AUDIO_FORMAT_U8BIT_PLANAR:
+			data[i] = i < 2 ? (uint8_t)(i * 255) :
+				(uint8_t)(seed >> 16);
+			break;
+
+		case AUDIO_FORMAT_16BIT:
+		case AUDIO_FORMAT_16BIT_PLANAR:
+			((int16_t*)data)[i] = i < 2 ?
+				(i ? INT16_MAX : INT16_MIN) :
+				(int16_t)(seed >> 16);
+			break;
+
+		case AUDIO_FORMAT_32BIT:
+		case AUDIO_FORMAT_32BIT_PLANAR:
+			((int32_t*)data)[i] = i < 2 ?
+				(i ? INT32_MAX : INT32_MIN) :
+				(int32_t)seed;
+			break;
+
+		case AUDIO_FORMAT_FLOAT:
+		case AUDIO_FORMAT_FLOAT_PLANAR:
+			((float*)data)[i] = i < 2 ? (i ? 1.0f : -1.0f) :
+				(float)(int16_t)(seed >> 16) / 32768.0f;
+			break;
+
+		case AUDIO_FORMAT_UNKNOWN:
+			break;
+		}
+	}
+}
+
+static void test_convert(enum audio_format format,
+		enum speaker_layout src_speakers,
+		enum speaker_layout dst_speakers, uint32_t frames)
+{
+	struct resample_info src = {48000, format, src_speakers};
+	struct resample_info dst = {48000, AUDIO_FORMAT_FLOAT_PLANAR,
+		dst_speakers};
+	size_t src_channels = get_audio_channels(src_speakers);
+	size_t dst_channels = get_audio_channels(dst_speakers);
+	bool planar = is_audio_planar(format);
+
+	static uint8_t input_data[MAX_AV_PLANES][MAX_FRAMES * 8 * 4];
+	static float output_data[MAX_AV_PLANES][MAX_FRAMES + 1];
+	const uint8_t *input[MAX_AV_PLANES] = {0};
+	float *output[MAX_AV_PLANES] = {0};
+	bool ok = true;
+
+	if (planar) {
+		for (size_t c = 0; c < src_channels; c++) {
+			fill_input(format, input_data[c], frames,
+					(uint32_t)c + 1);
+			input[c] = input_data[c];
+		}
+	} else {
+		fill_input(format, input_data[0], frames * src_channels, 1);
+		input[0] = input_data[0];
+	}
+
+	/* the sample after the last frame must not be written */
+	for (size_t c = 0; c < dst_channels; c++) {
+		output_data[c][frames] = 123.0f;
+		output[c] = output_data[c];
+	}
+
+	check(audio_convert_supported(&dst, &src));
+	audio_convert(&dst, &src, output, input, frames);
+
+	for (size_t c = 0; c < dst_channels; c++) {
+		for (uint32_t i = 0; i < frames; i++) {
+			float expected = reference_sample(&dst, &src, input,
+					c, i);
+			if (fabsf(output[c][i] - expected) > TOLERANCE)
+				ok = false;
+		}
+
+		if (output_data[c][frames] != 123.0f)
+			ok = false;
+	}
+
+	if (!ok)
+		fprintf(stderr, "format %d, %d -> %d channels, %u frames\n",
+				(int)format, (int)src_channels,
+				(int)dst_channels, frames);
+	check(ok);
+}
+
+static void test_formats(void)
+{
+	static const enum audio_format formats[] = {
+		AUDIO_FORMAT_U8BIT,
+		AUDIO_FORMAT_16BIT,
+		AUDIO_FORMAT_32BIT,
+		AUDIO_FORMAT_FLOAT,
+		AUDIO_FORMAT_U8BIT_PLANAR,
+		AUDIO_FORMAT_16BIT_PLANAR,
+		AUDIO_FORMAT_32BIT_PLANAR,
+		AUDIO_FORMAT_FLOAT_PLANAR
+	};
+
+	static const enum speaker_layout layouts[][2] = {
+		{SPEAKERS_MONO,    SPEAKERS_MONO},
+		{SPEAKERS_STEREO,  SPEAKERS_STEREO},
+		{SPEAKERS_5POINT1, SPEAKERS_5POINT1},
+		{SPEAKERS_MONO,    SPEAKERS_STEREO},
+		{SPEAKERS_STEREO,  SPEAKERS_MONO}
+	};
+
+	/* block sizes with and without a tail after the vector loops */
+	static const uint32_t frame_counts[] = {0, 1, 3, 4, 7, 480, MAX_FRAMES};
+
+	for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++)
+	for (size_t l = 0; l < sizeof(layouts) / sizeof(layouts[0]); l++)
+	for (size_t n = 0; n < sizeof(frame_counts) / sizeof(frame_counts[0]);
+			n++)
+		test_convert(formats[f], layouts[l][0], layouts[l][1],
+				frame_counts[n]);
+}
+
+static void test_supported(void)
+{
+	struct resample_info src = {48000, AUDIO_FORMAT_16BIT,
+		SPEAKERS_STEREO};
+	struct resample_info dst = {48000, AUDIO_FORMAT_FLOAT_PLANAR,
+		SPEAKERS_STEREO};
+
+	check(audio_convert_supported(&dst, &src));
+
+	src.samples_per_sec = 44100;
+	check(!audio_convert_supported(&dst, &src));
+	src.samples_per_sec = 48000;
+
+	dst.format = AUDIO_FORMAT_FLOAT;
+	check(!audio_convert_supported(&dst, &src));
+	dst.format = AUDIO_FORMAT_FLOAT_PLANAR;
+
+	src.format = AUDIO_FORMAT_UNKNOWN;
+	check(!audio_convert_supported(&dst, &src));
+	src.format = AUDIO_FORMAT_16BIT;
+
+	src.speakers = SPEAKERS_5POINT1;
+	check(!audio_convert_supported(&dst, &src));
+
+	src.speakers = SPEAKERS_UNKNOWN;
+	dst.speakers = SPEAKERS_UNKNOWN;
+	check(!audio_convert_supported(&dst, &src));
+}
+
+static void test_downmix_to_mono(void)
+{
+	static const uint32_t frame_counts[] = {1, 4, 7, MAX_FRAMES};
+	static float data[3][MAX_FRAMES];
+	static float expected[MAX_FRAMES];
+	float *planes[3] = {data[0], data[1], data[2]};
+
+	for (size_t n = 0; n < sizeof(frame_counts) / sizeof(frame_counts[0]);
+			n++) {
+		uint32_t frames = frame_counts[n];
+		bool ok = true;
+
+		for (size_t c = 0; c < 3; c++)
+			fill_input(AUDIO_FORMAT_FLOAT_PLANAR,
+					(uint8_t*)data[c], frames,
+					(uint32_t)c + 7);
+
+		for (uint32_t i = 0; i < frames; i++)
+			expected[i] = (data[0][i] + data[1][i] + data[2][i]) /
+				3.0f;
+
+		audio_downmix_to_mono_planar(planes, 3, frames);
+
+		for (size_t c = 0; c < 3; c++) {
+			for (uint32_t i = 0; i < frames; i++) {
+				if (fabsf(data[c][i] - expected[i]) >
+						TOLERANCE)
+					ok = false;
+			}
+		}
+
+		check(ok);
+	}
+}
+
+int main(void)
+{
+	test_formats();
+	test_supported();
+	test_downmix_to_mono();
+
+	return check_result();
+}
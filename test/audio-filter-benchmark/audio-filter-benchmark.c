@@ -0,0 +1,350 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+/*
+ * Offline audio filter benchmark
+ *
+ * Feeds synthetic audio through each audio filter's filter_audio callback
+ * and prints the time spent per block and per sample.  Every filter is
+ * attached on its own to a source that outputs audio as fast as it can, the
+ * time of the same source without filters is subtracted.
+ *
+ * The signal is a tone that switches between a loud and a quiet level a few
+ * times per second, so gates open and close and compressors attack and
+ * release during the run.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <util/base.h>
+#include <util/bmem.h>
+#include <util/platform.h>
+#include <obs.h>
+
+#define SAMPLE_RATE     48000
+#define BLOCK_FRAMES    480
+#define TONE_HZ         440.0
+#define SWITCH_FRAMES   (SAMPLE_RATE / 4)
+#define LOUD_LEVEL      0.5f   /* about -6 dB */
+#define QUIET_LEVEL     0.003f /* about -50 dB */
+
+#ifndef M_PI
+#define M_PI 3.1415926535897932384626433832795
+#endif
+
+struct benchmark_config {
+	const char *filter;
+	enum speaker_layout speakers;
+	uint32_t seconds;
+	bool verbose;
+};
+
+static bool verbose = false;
+
+static void do_log(int log_level, const char *msg, va_list args, void *param)
+{
+	if (log_level <= LOG_WARNING || verbose) {
+		vfprintf(stderr, msg, args);
+		fputc('\n', stderr);
+	}
+
+	UNUSED_PARAMETER(param);
+}
+
+/* ------------------------------------------------------------------------- */
+/* synthetic source, only exists so filters can be attached to it */
+
+static const char *bench_source_name(void *unused)
+{
+	UNUSED_PARAMETER(unused);
+	return "Audio filter benchmark source";
+}
+
+static void *bench_source_create(obs_data_t *settings, obs_source_t *source)
+{
+	UNUSED_PARAMETER(settings);
+	return source;
+}
+
+static void bench_source_destroy(void *data)
+{
+	UNUSED_PARAMETER(data);
+}
+
+static struct obs_source_info bench_source_info = {
+	.id           = "audio_filter_benchmark_source",
+	.type         = OBS_SOURCE_TYPE_INPUT,
+	.output_flags = OBS_SOURCE_AUDIO,
+	.get_name     = bench_source_name,
+	.create       = bench_source_create,
+	.destroy      = bench_source_destroy,
+};
+
+/* ------------------------------------------------------------------------- */
+
+struct signal {
+	float *planes[MAX_AV_PLANES];
+	uint32_t channels;
+	uint32_t frames;
+};
+
+/* the whole run is generated up front so the signal generation is not part
+ * of the measured time */
+static void signal_init(struct signal *sig, uint32_t channels,
+		uint32_t seconds)
+{
+	sig->channels = channels;
+	sig->frames   = seconds * SAMPLE_RATE;
+	sig->frames  -= sig->frames % BLOCK_FRAMES;
+
+	for (uint32_t c = 0; c < channels; c++) {
+		float *plane = bmalloc(sig->frames * sizeof(float));
+		double phase = (double)c * 0.25;
+
+		for (uint32_t i = 0; i < sig->frames; i++) {
+			bool loud = (i / SWITCH_FRAMES) % 2 == 0;
+			float level = loud ? LOUD_LEVEL : QUIET_LEVEL;
+			double t = (double)i / SAMPLE_RATE;
+
+			plane[i] = level *
+				(float)sin(2.0 * M_PI * TONE_HZ * t + phase);
+		}
+
+		sig->planes[c] = plane;
+	}
+}
+
+static void signal_free(struct signal *sig)
+{
+	for (uint32_t c = 0; c < sig->channels; c++)
+		bfree(sig->planes[c]);
+	memset(sig, 0, sizeof(*sig));
+}
+
+/* returns the time in nanoseconds it took to output the whole signal */
+static uint64_t run_signal(obs_source_t *source, const struct signal *sig,
+		enum speaker_layout speakers)
+{
+	struct obs_source_audio audio = {0};
+	uint64_t start;
+
+	audio.speakers        = speakers;
+	audio.format          = AUDIO_FORMAT_FLOAT_PLANAR;
+	audio.samples_per_sec = SAMPLE_RATE;
+	audio.frames          = BLOCK_FRAMES;
+
+	start = os_gettime_ns();
+
+	for (uint32_t pos = 0; pos < sig->frames; pos += BLOCK_FRAMES) {
+		for (uint32_t c = 0; c < sig->channels; c++)
+			audio.data[c] = (uint8_t*)(sig->planes[c] + pos);
+
+		audio.timestamp = os_gettime_ns();
+		obs_source_output_audio(source, &audio);
+	}
+
+	return os_gettime_ns() - start;
+}
+
+static uint64_t run_filter(const char *id, const struct signal *sig,
+		enum speaker_layout speakers)
+{
+	obs_source_t *source;
+	obs_source_t *filter = NULL;
+	uint64_t time;
+
+	source = obs_source_create_private(bench_source_info.id,
+			"benchmark source", NULL);
+
+	if (id) {
+		filter = obs_source_create_private(id, "benchmark filter",
+				NULL);
+		obs_source_filter_add(source, filter);
+	}
+
+	time = run_signal(source, sig, speakers);
+
+	if (filter) {
+		obs_source_filter_remove(source, filter);
+		obs_source_release(filter);
+	}
+	obs_source_release(source);
+	return time;
+}
+
+static void print_result(const char *id, uint64_t time, uint64_t baseline,
+		const struct signal *sig)
+{
+	uint64_t blocks = sig->frames / BLOCK_FRAMES;
+	uint64_t samples = (uint64_t)sig->frames * sig->channels;
+	double filter_ns = time > baseline ? (double)(time - baseline) : 0.0;
+
+	printf("%-24s %10.2f us/block %8.2f ns/sample %8.2f%% realtime\n",
+			id, filter_ns / 1000.0 / blocks,
+			filter_ns / samples,
+			filter_ns * 100.0 /
+				((double)sig->frames * 1000000000.0 /
+				 SAMPLE_RATE));
+}
+
+static bool is_audio_filter(const char *id)
+{
+	uint32_t flags = obs_get_source_output_flags(id);
+	return (flags & OBS_SOURCE_AUDIO) != 0 &&
+	       (flags & OBS_SOURCE_VIDEO) == 0;
+}
+
+static int run_benchmark(const struct benchmark_config *config)
+{
+	struct obs_audio_info oai = {0};
+	struct signal sig = {0};
+	uint64_t baseline;
+	const char *id;
+	bool found = false;
+
+	oai.samples_per_sec = SAMPLE_RATE;
+	oai.speakers        = config->speakers;
+
+	if (!obs_reset_audio(&oai)) {
+		blog(LOG_ERROR, "Couldn't initialize audio");
+		return 1;
+	}
+
+	obs_register_source(&bench_source_info);
+	obs_load_all_modules();
+
+	signal_init(&sig, get_audio_channels(config->speakers),
+			config->seconds);
+
+	/* first run warms up caches and allocations */
+	run_filter(NULL, &sig, config->speakers);
+	baseline = run_filter(NULL, &sig, config->speakers);
+
+	printf("%u channels, %u seconds of audio, %d frames per block\n",
+			sig.channels, config->seconds, BLOCK_FRAMES);
+
+	for (size_t i = 0; obs_enum_filter_types(i, &id); i++) {
+		if (config->filter && strcmp(config->filter, id) != 0)
+			continue;
+		if (!is_audio_filter(id))
+			continue;
+
+		print_result(id, run_filter(id, &sig, config->speakers),
+				baseline, &sig);
+		found = true;
+	}
+
+	signal_free(&sig);
+
+	if (!found) {
+		blog(LOG_ERROR, "No audio filter found");
+		return 1;
+	}
+
+	return 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void print_usage(const char *name)
+{
+	fprintf(stderr,
+		"Usage: %s [options]\n"
+		"  --filter <id>            only run the filter with this id\n"
+		"  --channels <n>           1, 2, 3, 4, 5, 6 or 8 (default 2)\n"
+		"  --seconds <n>            seconds of audio per filter "
+			"(default 60)\n"
+		"  --verbose                log everything to stderr\n",
+		name);
+}
+
+static bool parse_speakers(const char *arg, enum speaker_layout *speakers)
+{
+	switch (atoi(arg)) {
+	case 1: *speakers = SPEAKERS_MONO;    return true;
+	case 2: *speakers = SPEAKERS_STEREO;  return true;
+	case 3: *speakers = SPEAKERS_2POINT1; return true;
+	case 4: *speakers = SPEAKERS_QUAD; return true;
+	case 5: *speakers = SPEAKERS_4POINT1; return true;
+	case 6: *speakers = SPEAKERS_5POINT1; return true;
+	case 8: *speakers = SPEAKERS_7POINT1; return true;
+	}
+
+	return false;
+}
+
+static bool parse_args(struct benchmark_config *config, int argc, char *argv[])
+{
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+
+		if (strcmp(arg, "--verbose") == 0) {
+			config->verbose = true;
+			continue;
+		}
+
+		if (!val)
+			return false;
+		i++;
+
+		if (strcmp(arg, "--filter") == 0) {
+			config->filter = val;
+		} else if (strcmp(arg, "--channels") == 0) {
+			if (!parse_speakers(val, &config->speakers))
+				return false;
+		} else if (strcmp(arg, "--seconds") == 0) {
+			int seconds = atoi(val);
+			config->seconds = seconds < 1 ? 1 : (uint32_t)seconds;
+		} else {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	struct benchmark_config config = {0};
+	int ret = 1;
+
+	config.speakers = SPEAKERS_STEREO;
+	config.seconds  = 60;
+
+	if (!parse_args(&config, argc, argv)) {
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	verbose = config.verbose;
+	base_set_log_handler(do_log, NULL);
+
+	if (obs_startup("en-US", NULL, NULL)) {
+		ret = run_benchmark(&config);
+	} else {
+		blog(LOG_ERROR, "Couldn't start libobs");
+	}
+
+	obs_shutdown();
+
+	blog(LOG_INFO, "Number of memory leaks: %ld", bnum_allocs());
+	return ret;
+}
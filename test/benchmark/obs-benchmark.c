@@ -0,0 +1,680 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+/*
+ * Headless pipeline benchmark
+ *
+ * Loads a scene collection or generates a synthetic one, runs the graphics,
+ * audio and encoder threads into a null output for a fixed number of frames
+ * and writes a JSON report with frame time percentiles, lagged and skipped
+ * frames, audio buffering and the profiler tree.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <util/base.h>
+#include <util/dstr.h>
+#include <util/darray.h>
+#include <util/platform.h>
+#include <util/profiler.h>
+#include <obs.h>
+
+#ifdef _WIN32
+#define GRAPHICS_MODULE DL_D3D11
+#else
+#define GRAPHICS_MODULE DL_OPENGL
+#endif
+
+struct benchmark_config {
+	const char *collection;
+	const char *report;
+	const char *video_encoder;
+	const char *audio_encoder;
+
+	int num_sources;
+	int num_filters;
+	int num_scenes;
+
+	uint32_t frames;
+	uint32_t width;
+	uint32_t height;
+	uint32_t fps;
+	bool verbose;
+};
+
+static bool verbose = false;
+
+static void do_log(int log_level, const char *msg, va_list args, void *param)
+{
+	if (log_level <= LOG_WARNING || verbose) {
+		vfprintf(stderr, msg, args);
+		fputc('\n', stderr);
+	}
+
+	UNUSED_PARAMETER(param);
+}
+
+/* ------------------------------------------------------------------------- */
+/* scene setup */
+
+static const char *video_filters[] = {
+	"color_filter",
+	"sharpness_filter",
+	"crop_filter",
+};
+
+static const char *audio_filters[] = {
+	"gain_filter",
+	"compressor_filter",
+	"noise_gate_filter",
+};
+
+#define NUM_FILTER_TYPES 3
+
+static inline bool type_exists(const char *id)
+{
+	return obs_source_get_display_name(id) != NULL;
+}
+
+static void add_filters(obs_source_t *source, const char **ids, int count)
+{
+	for (int i = 0; i < count; i++) {
+		const char *id = ids[i % NUM_FILTER_TYPES];
+		obs_source_t *filter;
+		struct dstr name = {0};
+
+		if (!type_exists(id))
+			continue;
+
+		dstr_printf(&name, "%s %d", id, i);
+		filter = obs_source_create(id, name.array, NULL, NULL);
+		obs_source_filter_add(source, filter);
+		obs_source_release(filter);
+		dstr_free(&name);
+	}
+}
+
+/* cycles through an async video source, a sync video source and an audio
+ * source, so every part of the pipeline gets some load */
+static obs_source_t *create_synthetic_source(int idx, int num_filters)
+{
+	static const char *ids[] = {"random", "color_source", "test_sinewave"};
+	const char *id = ids[idx % 3];
+	obs_source_t *source;
+	struct dstr name = {0};
+
+	if (!type_exists(id)) {
+		blog(LOG_WARNING, "Source type '%s' is not available", id);
+		return NULL;
+	}
+
+	dstr_printf(&name, "%s %d", id, idx);
+	source = obs_source_create(id, name.array, NULL, NULL);
+	dstr_free(&name);
+
+	if (obs_source_get_output_flags(source) & OBS_SOURCE_VIDEO)
+		add_filters(source, video_filters, num_filters);
+	else
+		add_filters(source, audio_filters, num_filters);
+
+	return source;
+}
+
+static void add_grid_item(obs_scene_t *scene, obs_source_t *source, int idx,
+		int count, const struct benchmark_config *config)
+{
+	obs_sceneitem_t *item = obs_scene_add(scene, source);
+	int columns = 1;
+	struct vec2 pos;
+
+	while (columns * columns < count)
+		columns++;
+
+	vec2_set(&pos,
+		(float)(idx % columns) * (float)config->width  / columns,
+		(float)(idx / columns) * (float)config->height / columns);
+	obs_sceneitem_set_pos(item, &pos);
+}
+
+/* the first scene is output, every other scene is nested into it and the
+ * sources are spread over all scenes */
+static obs_source_t *create_synthetic_collection(
+		const struct benchmark_config *config)
+{
+	obs_scene_t **scenes = bzalloc(sizeof(obs_scene_t*) *
+			config->num_scenes);
+	obs_source_t *output;
+
+	for (int i = 0; i < config->num_scenes; i++) {
+		struct dstr name = {0};
+		dstr_printf(&name, "Scene %d", i);
+		scenes[i] = obs_scene_create(name.array);
+		dstr_free(&name);
+	}
+
+	for (int i = 1; i < config->num_scenes; i++)
+		add_grid_item(scenes[0], obs_scene_get_source(scenes[i]),
+				i - 1, config->num_scenes - 1, config);
+
+	for (int i = 0; i < config->num_sources; i++) {
+		obs_source_t *source = create_synthetic_source(i,
+				config->num_filters);
+		obs_scene_t *scene = scenes[i % config->num_scenes];
+
+		if (!source)
+			continue;
+
+		add_grid_item(scene, source, i / config->num_scenes,
+				config->num_sources / config->num_scenes + 1,
+				config);
+		obs_source_release(source);
+	}
+
+	output = obs_scene_get_source(scenes[0]);
+	obs_source_addref(output);
+
+	for (int i = 0; i < config->num_scenes; i++)
+		obs_scene_release(scenes[i]);
+	bfree(scenes);
+
+	return output;
+}
+
+/* like the frontend, keep a reference to every loaded scene, otherwise the
+ * scenes are destroyed again as soon as loading finishes */
+struct loaded_scenes {
+	DARRAY(obs_source_t*) scenes;
+};
+
+static void scene_loaded(void *param, obs_source_t *source)
+{
+	struct loaded_scenes *loaded = param;
+
+	if (obs_scene_from_source(source) != NULL) {
+		obs_source_addref(source);
+		da_push_back(loaded->scenes, &source);
+	}
+}
+
+static obs_source_t *load_collection(const char *path)
+{
+	obs_data_t *data = obs_data_create_from_json_file(path);
+	struct loaded_scenes loaded = {0};
+	obs_data_array_t *sources;
+	obs_source_t *output = NULL;
+	const char *name;
+
+	if (!data) {
+		blog(LOG_ERROR, "Failed to load scene collection '%s'", path);
+		return NULL;
+	}
+
+	sources = obs_data_get_array(data, "sources");
+	obs_load_sources(sources, scene_loaded, &loaded);
+	obs_data_array_release(sources);
+
+	name = obs_data_get_string(data, "current_scene");
+
+	for (size_t i = 0; i < loaded.scenes.num; i++) {
+		obs_source_t *scene = loaded.scenes.array[i];
+
+		if (!output && strcmp(obs_source_get_name(scene), name) == 0) {
+			output = scene;
+			continue;
+		}
+
+		obs_source_release(scene);
+	}
+
+	da_free(loaded.scenes);
+
+	if (!output)
+		blog(LOG_ERROR, "Scene collection '%s' has no current scene",
+				path);
+
+	obs_data_release(data);
+	return output;
+}
+
+/* ------------------------------------------------------------------------- */
+/* report */
+
+static int cmp_time_entry(const void *a, const void *b)
+{
+	const profiler_time_entry_t *first  = a;
+	const profiler_time_entry_t *second = b;
+
+	if (first->time_delta == second->time_delta)
+		return 0;
+	return first->time_delta < second->time_delta ? -1 : 1;
+}
+
+/* times are in microseconds, and stored as a histogram of call durations */
+static void add_percentiles(obs_data_t *obj, profiler_time_entries_t *times)
+{
+	static const double percentiles[] = {0.5, 0.9, 0.95, 0.99, 1.0};
+	static const char *names[] = {"p50_ms", "p90_ms", "p95_ms", "p99_ms",
+		"max_ms"};
+	profiler_time_entry_t *entries;
+	uint64_t total = 0;
+	uint64_t sum = 0;
+	uint64_t seen = 0;
+	size_t p = 0;
+
+	if (!times || !times->num)
+		return;
+
+	entries = bmemdup(times->array, times->num * sizeof(*entries));
+	qsort(entries, times->num, sizeof(*entries), cmp_time_entry);
+
+	for (size_t i = 0; i < times->num; i++) {
+		total += entries[i].count;
+		sum   += entries[i].time_delta * entries[i].count;
+	}
+
+	for (size_t i = 0; i < times->num && p < 5; i++) {
+		seen += entries[i].count;
+
+		while (p < 5 && (double)seen >= percentiles[p] * total) {
+			obs_data_set_double(obj, names[p],
+					entries[i].time_delta / 1000.0);
+			p++;
+		}
+	}
+
+	obs_data_set_double(obj, "avg_ms", (double)sum / total / 1000.0);
+	bfree(entries);
+}
+
+static bool add_profiler_entry(void *context, profiler_snapshot_entry_t *entry)
+{
+	obs_data_array_t *array = context;
+	obs_data_array_t *children = obs_data_array_create();
+	obs_data_t *obj = obs_data_create();
+
+	obs_data_set_string(obj, "name", profiler_snapshot_entry_name(entry));
+	obs_data_set_int(obj, "calls",
+			profiler_snapshot_entry_overall_count(entry));
+	obs_data_set_double(obj, "min_ms",
+			profiler_snapshot_entry_min_time(entry) / 1000.0);
+	add_percentiles(obj, profiler_snapshot_entry_times(entry));
+
+	profiler_snapshot_enumerate_children(entry, add_profiler_entry,
+			children);
+	obs_data_set_array(obj, "children", children);
+
+	obs_data_array_push_back(array, obj);
+	obs_data_array_release(children);
+	obs_data_release(obj);
+	return true;
+}
+
+static bool find_video_thread_root(void *context,
+		profiler_snapshot_entry_t *entry)
+{
+	profiler_snapshot_entry_t **root = context;
+	const char *name = profiler_snapshot_entry_name(entry);
+
+	if (strncmp(name, "obs_video_thread(", 17) == 0) {
+		*root = entry;
+		return false;
+	}
+
+	return true;
+}
+
+static obs_data_t *create_report(const struct benchmark_config *config,
+		uint32_t total_frames, uint32_t lagged_frames,
+		uint32_t skipped_frames, double elapsed_sec)
+{
+	profiler_snapshot_t *snap = profile_snapshot_create();
+	profiler_snapshot_entry_t *video_root = NULL;
+	obs_data_t *report = obs_data_create();
+	obs_data_t *settings = obs_data_create();
+	obs_data_t *frames = obs_data_create();
+	obs_data_t *frame_time = obs_data_create();
+	obs_data_t *audio = obs_data_create();
+	obs_data_array_t *tree = obs_data_array_create();
+
+	obs_data_set_int(settings, "width", config->width);
+	obs_data_set_int(settings, "height", config->height);
+	obs_data_set_int(settings, "fps", config->fps);
+	obs_data_set_int(settings, "frames", config->frames);
+	obs_data_set_string(settings, "video_encoder", config->video_encoder);
+	obs_data_set_string(settings, "audio_encoder", config->audio_encoder);
+	if (config->collection) {
+		obs_data_set_string(settings, "collection", config->collection);
+	} else {
+		obs_data_set_int(settings, "sources", config->num_sources);
+		obs_data_set_int(settings, "filters", config->num_filters);
+		obs_data_set_int(settings, "scenes", config->num_scenes);
+	}
+
+	obs_data_set_int(frames, "total", total_frames);
+	obs_data_set_int(frames, "lagged", lagged_frames);
+	obs_data_set_int(frames, "skipped", skipped_frames);
+	obs_data_set_double(frames, "elapsed_sec", elapsed_sec);
+
+	profiler_snapshot_enumerate_roots(snap, find_video_thread_root,
+			&video_root);
+	if (video_root)
+		add_percentiles(frame_time,
+				profiler_snapshot_entry_times(video_root));
+
+	obs_data_set_int(audio, "buffering_events",
+			obs_get_audio_buffering_events());
+	obs_data_set_int(audio, "buffering_ms", obs_get_audio_buffering_ms());
+
+	profiler_snapshot_enumerate_roots(snap, add_profiler_entry, tree);
+
+	obs_data_set_obj(report, "settings", settings);
+	obs_data_set_obj(report, "frames", frames);
+	obs_data_set_obj(report, "frame_time", frame_time);
+	obs_data_set_obj(report, "audio", audio);
+	obs_data_set_array(report, "profiler", tree);
+
+	obs_data_array_release(tree);
+	obs_data_release(audio);
+	obs_data_release(frame_time);
+	obs_data_release(frames);
+	obs_data_release(settings);
+	profile_snapshot_free(snap);
+	return report;
+}
+
+/* ------------------------------------------------------------------------- */
+/* run */
+
+static bool reset_video_audio(const struct benchmark_config *config)
+{
+	struct obs_video_info ovi = {0};
+	struct obs_audio_info oai = {0};
+
+	ovi.adapter         = 0;
+	ovi.graphics_module = GRAPHICS_MODULE;
+	ovi.base_width      = config->width;
+	ovi.base_height     = config->height;
+	ovi.output_width    = config->width;
+	ovi.output_height   = config->height;
+	ovi.fps_num         = config->fps;
+	ovi.fps_den         = 1;
+	ovi.output_format   = VIDEO_FORMAT_NV12;
+	ovi.colorspace      = VIDEO_CS_709;
+	ovi.range           = VIDEO_RANGE_PARTIAL;
+	ovi.scale_type      = OBS_SCALE_BICUBIC;
+	ovi.gpu_conversion  = true;
+
+	oai.samples_per_sec = 48000;
+	oai.speakers        = SPEAKERS_STEREO;
+
+	if (obs_reset_video(&ovi) != OBS_VIDEO_SUCCESS) {
+		blog(LOG_ERROR, "Couldn't initialize video");
+		return false;
+	}
+	if (!obs_reset_audio(&oai)) {
+		blog(LOG_ERROR, "Couldn't initialize audio");
+		return false;
+	}
+
+	return true;
+}
+
+static obs_output_t *start_output(const struct benchmark_config *config,
+		obs_encoder_t **venc, obs_encoder_t **aenc)
+{
+	obs_output_t *output;
+
+	*venc = obs_video_encoder_create(config->video_encoder,
+			"benchmark video", NULL, NULL);
+	*aenc = obs_audio_encoder_create(config->audio_encoder,
+			"benchmark audio", NULL, 0, NULL);
+	output = obs_output_create("null_output", "benchmark output", NULL,
+			NULL);
+
+	if (!*venc || !*aenc || !output) {
+		blog(LOG_ERROR, "Couldn't create the encoders or null output");
+		return output;
+	}
+
+	obs_encoder_set_video(*venc, obs_get_video());
+	obs_encoder_set_audio(*aenc, obs_get_audio());
+	obs_output_set_video_encoder(output, *venc);
+	obs_output_set_audio_encoder(output, *aenc, 0);
+
+	if (!obs_output_start(output))
+		blog(LOG_ERROR, "Couldn't start the null output");
+
+	return output;
+}
+
+static bool wait_for_frames(uint32_t start, uint32_t frames, uint32_t fps)
+{
+	/* give up if the pipeline runs at less than a quarter of real time */
+	uint64_t timeout = os_gettime_ns() +
+		(uint64_t)frames * 4000000000ULL / fps + 5000000000ULL;
+
+	while (obs_get_total_frames() - start < frames) {
+		if (os_gettime_ns() > timeout) {
+			blog(LOG_ERROR, "Timed out waiting for frames");
+			return false;
+		}
+		os_sleep_ms(10);
+	}
+
+	return true;
+}
+
+static void wait_for_stop(obs_output_t *output)
+{
+	for (int i = 0; i < 500 && obs_output_active(output); i++)
+		os_sleep_ms(10);
+
+	if (obs_output_active(output))
+		obs_output_force_stop(output);
+}
+
+static int run_benchmark(const struct benchmark_config *config)
+{
+	obs_source_t *scene;
+	obs_output_t *output;
+	obs_encoder_t *venc = NULL;
+	obs_encoder_t *aenc = NULL;
+	obs_data_t *report;
+	uint32_t start_frames, start_lagged, start_skipped;
+	uint64_t start_time;
+	double elapsed;
+	bool success;
+
+	if (!reset_video_audio(config))
+		return 1;
+
+	obs_load_all_modules();
+
+	scene = config->collection ?
+		load_collection(config->collection) :
+		create_synthetic_collection(config);
+	if (!scene)
+		return 1;
+
+	obs_set_output_source(0, scene);
+
+	output = start_output(config, &venc, &aenc);
+	success = output && obs_output_active(output);
+
+	start_frames  = obs_get_total_frames();
+	start_lagged  = obs_get_lagged_frames();
+	start_skipped = video_output_get_skipped_frames(obs_get_video());
+	start_time    = os_gettime_ns();
+
+	if (success)
+		success = wait_for_frames(start_frames, config->frames,
+				config->fps);
+
+	elapsed = (double)(os_gettime_ns() - start_time) / 1000000000.0;
+
+	if (output) {
+		obs_output_stop(output);
+		wait_for_stop(output);
+	}
+
+	report = create_report(config,
+			obs_get_total_frames() - start_frames,
+			obs_get_lagged_frames() - start_lagged,
+			video_output_get_skipped_frames(obs_get_video()) -
+				start_skipped,
+			elapsed);
+
+	if (config->report) {
+		if (!os_quick_write_utf8_file(config->report,
+					obs_data_get_json(report),
+					strlen(obs_data_get_json(report)),
+					false)) {
+			blog(LOG_ERROR, "Couldn't write report to '%s'",
+					config->report);
+			success = false;
+		}
+	} else {
+		puts(obs_data_get_json(report));
+	}
+
+	obs_data_release(report);
+	obs_set_output_source(0, NULL);
+	obs_output_release(output);
+	obs_encoder_release(venc);
+	obs_encoder_release(aenc);
+	obs_source_release(scene);
+	return success ? 0 : 1;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void print_usage(const char *name)
+{
+	fprintf(stderr,
+		"Usage: %s [options]\n"
+		"  --collection <file>      scene collection to load\n"
+		"  --sources <n>            synthetic sources (default 12)\n"
+		"  --filters <n>            filters per synthetic source "
+			"(default 2)\n"
+		"  --scenes <n>             synthetic scenes (default 3)\n"
+		"  --frames <n>             frames to run (default 600)\n"
+		"  --size <width>x<height>  canvas size (default 1920x1080)\n"
+		"  --fps <n>                frame rate (default 30)\n"
+		"  --video-encoder <id>     (default obs_x264)\n"
+		"  --audio-encoder <id>     (default ffmpeg_aac)\n"
+		"  --report <file>          write the report to a file instead "
+			"of stdout\n"
+		"  --verbose                log everything to stderr\n",
+		name);
+}
+
+static inline int clamp_arg(const char *arg, int min)
+{
+	int val = atoi(arg);
+	return val < min ? min : val;
+}
+
+static bool parse_args(struct benchmark_config *config, int argc, char *argv[])
+{
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+
+		if (strcmp(arg, "--verbose") == 0) {
+			config->verbose = true;
+			continue;
+		}
+
+		if (!val)
+			return false;
+		i++;
+
+		if (strcmp(arg, "--collection") == 0) {
+			config->collection = val;
+		} else if (strcmp(arg, "--sources") == 0) {
+			config->num_sources = clamp_arg(val, 0);
+		} else if (strcmp(arg, "--filters") == 0) {
+			config->num_filters = clamp_arg(val, 0);
+		} else if (strcmp(arg, "--scenes") == 0) {
+			config->num_scenes = clamp_arg(val, 1);
+		} else if (strcmp(arg, "--frames") == 0) {
+			config->frames = (uint32_t)clamp_arg(val, 1);
+		} else if (strcmp(arg, "--fps") == 0) {
+			config->fps = (uint32_t)clamp_arg(val, 1);
+		} else if (strcmp(arg, "--size") == 0) {
+			if (sscanf(val, "%ux%u", &config->width,
+						&config->height) != 2)
+				return false;
+		} else if (strcmp(arg, "--video-encoder") == 0) {
+			config->video_encoder = val;
+		} else if (strcmp(arg, "--audio-encoder") == 0) {
+			config->audio_encoder = val;
+		} else if (strcmp(arg, "--report") == 0) {
+			config->report = val;
+		} else {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	struct benchmark_config config = {0};
+	profiler_name_store_t *store;
+	int ret = 1;
+
+	config.num_sources   = 12;
+	config.num_filters   = 2;
+	config.num_scenes    = 3;
+	config.frames        = 600;
+	config.width         = 1920;
+	config.height        = 1080;
+	config.fps           = 30;
+	config.video_encoder = "obs_x264";
+	config.audio_encoder = "ffmpeg_aac";
+
+	if (!parse_args(&config, argc, argv)) {
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	verbose = config.verbose;
+	base_set_log_handler(do_log, NULL);
+
+	profiler_start();
+	store = profiler_name_store_create();
+
+	if (obs_startup("en-US", NULL, store)) {
+		ret = run_benchmark(&config);
+	} else {
+		blog(LOG_ERROR, "Couldn't start libobs");
+	}
+
+	obs_shutdown();
+
+	blog(LOG_INFO, "Number of memory leaks: %ld", bnum_allocs());
+
+	profiler_stop();
+	profiler_free();
+	profiler_name_store_free(store);
+	return ret;
+}
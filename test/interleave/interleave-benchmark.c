@@ -0,0 +1,385 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+/*
+ * Interleaver trace replay benchmark
+ *
+ * Replays a packet trace through the output interleave buffer the way an
+ * output does: every packet is inserted, and the oldest packet is sent once
+ * the buffer holds a newer packet of the other type.  With a delay, packets
+ * are held until they're older than the newest packet by the delay.
+ *
+ * A trace is a text file with one packet per line in the order the output
+ * received them:
+ *
+ *     <v|a> <track> <dts_usec>
+ *
+ * Lines starting with '#' are ignored.  Without a trace file, a trace of
+ * video with encoder latency plus audio tracks with jittered delivery is
+ * generated, --write-trace saves it for comparisons.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <util/base.h>
+#include <util/bmem.h>
+#include <util/darray.h>
+#include <util/platform.h>
+#include <obs-interleave.h>
+
+struct trace_packet {
+	enum obs_encoder_type type;
+	size_t track;
+	int64_t dts_usec;
+	int64_t arrival_usec;
+};
+
+struct benchmark_config {
+	const char *trace;
+	const char *write_trace;
+	uint32_t seconds;
+	uint32_t tracks;
+	uint32_t delay_ms;
+	uint32_t runs;
+};
+
+/* ------------------------------------------------------------------------- */
+/* traces */
+
+static bool load_trace(const char *path, struct darray *trace)
+{
+	FILE *file = os_fopen(path, "r");
+	char line[256];
+	size_t line_num = 0;
+
+	if (!file) {
+		blog(LOG_ERROR, "Couldn't open trace '%s'", path);
+		return false;
+	}
+
+	while (fgets(line, sizeof(line), file)) {
+		struct trace_packet packet = {0};
+		long long dts;
+		char type;
+		unsigned track;
+
+		line_num++;
+		if (line[0] == '#' || line[0] == '\n' || line[0] == '\r')
+			continue;
+
+		if (sscanf(line, " %c %u %lld", &type, &track, &dts) != 3 ||
+		    (type != 'v' && type != 'a') ||
+		    track >= MAX_AUDIO_MIXES) {
+			blog(LOG_ERROR, "%s:%zu: invalid packet", path,
+					line_num);
+			fclose(file);
+			return false;
+		}
+
+		packet.type     = type == 'v' ? OBS_ENCODER_VIDEO :
+		                                OBS_ENCODER_AUDIO;
+		packet.track    = track;
+		packet.dts_usec = dts;
+		darray_push_back(sizeof(packet), trace, &packet);
+	}
+
+	fclose(file);
+	return true;
+}
+
+static bool save_trace(const char *path, const struct darray *trace)
+{
+	const struct trace_packet *packets = trace->array;
+	FILE *file = os_fopen(path, "w");
+
+	if (!file) {
+		blog(LOG_ERROR, "Couldn't write trace '%s'", path);
+		return false;
+	}
+
+	fprintf(file, "# <v|a> <track> <dts_usec>\n");
+	for (size_t i = 0; i < trace->num; i++)
+		fprintf(file, "%c %u %" PRId64 "\n",
+				packets[i].type == OBS_ENCODER_VIDEO ?
+					'v' : 'a',
+				(unsigned)packets[i].track,
+				packets[i].dts_usec);
+
+	fclose(file);
+	return true;
+}
+
+static int cmp_arrival(const void *a, const void *b)
+{
+	const struct trace_packet *first  = a;
+	const struct trace_packet *second = b;
+
+	if (first->arrival_usec == second->arrival_usec)
+		return 0;
+	return first->arrival_usec < second->arrival_usec ? -1 : 1;
+}
+
+#define VIDEO_FRAME_USEC   16667
+#define VIDEO_LATENCY_USEC 100000
+#define AUDIO_PACKET_USEC  21333
+#define AUDIO_JITTER_USEC  15000
+
+/* 60 fps video that the encoder delivers with a fixed latency, and aac
+ * audio tracks that are encoded one after another with some jitter.  each
+ * track arrives in dts order, like encoder output does. */
+static void generate_trace(struct darray *trace,
+		const struct benchmark_config *config)
+{
+	int64_t duration = (int64_t)config->seconds * 1000000;
+	uint32_t seed = 1;
+
+	for (int64_t ts = 0; ts < duration; ts += VIDEO_FRAME_USEC) {
+		struct trace_packet packet = {0};
+
+		packet.type         = OBS_ENCODER_VIDEO;
+		packet.dts_usec     = ts;
+		packet.arrival_usec = ts + VIDEO_LATENCY_USEC;
+		darray_push_back(sizeof(packet), trace, &packet);
+	}
+
+	for (size_t track = 0; track < config->tracks; track++) {
+		for (int64_t ts = 0; ts < duration; ts += AUDIO_PACKET_USEC) {
+			struct trace_packet packet = {0};
+
+			seed = seed * 1103515245 + 12345;
+
+			packet.type         = OBS_ENCODER_AUDIO;
+			packet.track        = track;
+			packet.dts_usec     = ts;
+			packet.arrival_usec = ts + (int64_t)track * 500 +
+				(int64_t)((seed >> 16) % AUDIO_JITTER_USEC);
+			darray_push_back(sizeof(packet), trace, &packet);
+		}
+	}
+
+	qsort(trace->array, trace->num, sizeof(struct trace_packet),
+			cmp_arrival);
+}
+
+/* ------------------------------------------------------------------------- */
+/* replay */
+
+struct replay_stats {
+	uint64_t insert_ns;
+	uint64_t merge_ns;
+	size_t sent;
+	/* packets older than one that was already sent, because a track
+	 * lagged behind the others */
+	size_t out_of_order;
+	size_t max_buffered;
+};
+
+static inline bool can_send(const struct darray *packets,
+		const int64_t highest[2], int64_t delay_usec)
+{
+	const struct encoder_packet *first = packets->array;
+	int64_t newest = highest[0] > highest[1] ? highest[0] : highest[1];
+	int other = first->type == OBS_ENCODER_VIDEO ? 1 : 0;
+
+	return first->dts_usec < highest[other] &&
+	       first->dts_usec <= newest - delay_usec;
+}
+
+static void replay(const struct darray *trace, int64_t delay_usec,
+		struct replay_stats *stats)
+{
+	const struct trace_packet *packets = trace->array;
+	struct darray buffer;
+	int64_t highest[2] = {INT64_MIN, INT64_MIN};
+	int64_t last_sent = INT64_MIN;
+	uint64_t start;
+
+	darray_init(&buffer);
+
+	start = os_gettime_ns();
+
+	for (size_t i = 0; i < trace->num; i++) {
+		struct encoder_packet packet = {0};
+		int type_idx = packets[i].type == OBS_ENCODER_VIDEO ? 0 : 1;
+
+		packet.type      = packets[i].type;
+		packet.track_idx = packets[i].track;
+		packet.dts_usec  = packets[i].dts_usec;
+
+		interleave_insert_packet(&buffer, &packet);
+		if (packet.dts_usec > highest[type_idx])
+			highest[type_idx] = packet.dts_usec;
+
+		if (buffer.num > stats->max_buffered)
+			stats->max_buffered = buffer.num;
+
+		while (buffer.num && can_send(&buffer, highest, delay_usec)) {
+			struct encoder_packet *first = buffer.array;
+
+			if (first->dts_usec < last_sent)
+				stats->out_of_order++;
+			last_sent = first->dts_usec;
+
+			darray_erase(sizeof(packet), &buffer, 0);
+			stats->sent++;
+		}
+	}
+
+	stats->insert_ns += os_gettime_ns() - start;
+
+	/* what a restart with new track offsets costs for a full buffer */
+	darray_free(&buffer);
+	for (size_t i = 0; i < trace->num; i++) {
+		struct encoder_packet packet = {0};
+
+		packet.type      = packets[i].type;
+		packet.track_idx = packets[i].track;
+		packet.dts_usec  = packets[i].dts_usec +
+			(packets[i].type == OBS_ENCODER_VIDEO ? 0 :
+			 (int64_t)packets[i].track * -1000);
+		interleave_insert_packet(&buffer, &packet);
+	}
+
+	start = os_gettime_ns();
+	interleave_merge_tracks(&buffer);
+	stats->merge_ns += os_gettime_ns() - start;
+
+	darray_free(&buffer);
+}
+
+static int run_benchmark(const struct benchmark_config *config)
+{
+	struct replay_stats stats = {0};
+	struct darray trace;
+	int ret = 0;
+
+	darray_init(&trace);
+
+	if (config->trace) {
+		if (!load_trace(config->trace, &trace)) {
+			darray_free(&trace);
+			return 1;
+		}
+	} else {
+		generate_trace(&trace, config);
+	}
+
+	if (config->write_trace && !save_trace(config->write_trace, &trace))
+		ret = 1;
+
+	for (uint32_t i = 0; i < config->runs; i++) {
+		struct replay_stats run = {0};
+
+		replay(&trace, (int64_t)config->delay_ms * 1000, &run);
+
+		stats.insert_ns   += run.insert_ns;
+		stats.merge_ns    += run.merge_ns;
+		stats.sent         = run.sent;
+		stats.out_of_order = run.out_of_order;
+		stats.max_buffered = run.max_buffered;
+	}
+
+	printf("packets:        %zu\n", trace.num);
+	printf("sent:           %zu\n", stats.sent);
+	printf("sent late:      %zu\n", stats.out_of_order);
+	printf("max buffered:   %zu\n", stats.max_buffered);
+	printf("insert + send:  %.1f ns/packet\n",
+			(double)stats.insert_ns / config->runs / trace.num);
+	printf("track merge:    %.1f ns/packet\n",
+			(double)stats.merge_ns / config->runs / trace.num);
+
+	darray_free(&trace);
+	return ret;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void print_usage(const char *name)
+{
+	fprintf(stderr,
+		"Usage: %s [options]\n"
+		"  --trace <file>           packet trace to replay\n"
+		"  --write-trace <file>     write the replayed trace to a file\n"
+		"  --seconds <n>            generated trace length "
+			"(default 600)\n"
+		"  --tracks <n>             generated audio tracks, 1 to 6 "
+			"(default 6)\n"
+		"  --delay <ms>             hold packets for a delay "
+			"(default 0)\n"
+		"  --runs <n>               replays to average (default 5)\n",
+		name);
+}
+
+static inline int clamp_arg(const char *arg, int min, int max)
+{
+	int val = atoi(arg);
+	return val < min ? min : (val > max ? max : val);
+}
+
+static bool parse_args(struct benchmark_config *config, int argc, char *argv[])
+{
+	for (int i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+
+		if (!val)
+			return false;
+		i++;
+
+		if (strcmp(arg, "--trace") == 0) {
+			config->trace = val;
+		} else if (strcmp(arg, "--write-trace") == 0) {
+			config->write_trace = val;
+		} else if (strcmp(arg, "--seconds") == 0) {
+			config->seconds = (uint32_t)clamp_arg(val, 1, 86400);
+		} else if (strcmp(arg, "--tracks") == 0) {
+			config->tracks = (uint32_t)clamp_arg(val, 1,
+					MAX_AUDIO_MIXES);
+		} else if (strcmp(arg, "--delay") == 0) {
+			config->delay_ms = (uint32_t)clamp_arg(val, 0, 600000);
+		} else if (strcmp(arg, "--runs") == 0) {
+			config->runs = (uint32_t)clamp_arg(val, 1, 1000);
+		} else {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	struct benchmark_config config = {0};
+	int ret;
+
+	config.seconds = 600;
+	config.tracks  = MAX_AUDIO_MIXES;
+	config.runs    = 5;
+
+	if (!parse_args(&config, argc, argv)) {
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	ret = run_benchmark(&config);
+
+	blog(LOG_INFO, "Number of memory leaks: %ld", bnum_allocs());
+	return ret;
+}
@@ -0,0 +1,190 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+/* ordering of the output interleave buffer */
+
+#include <stdio.h>
+#include <obs-interleave.h>
+#include "test-check.h"
+
+/* the packet size doubles as an id to check the order of equal timestamps */
+static struct encoder_packet make_packet(enum obs_encoder_type type,
+		size_t track, int64_t dts_usec, size_t id)
+{
+	struct encoder_packet packet = {0};
+
+	packet.type      = type;
+	packet.track_idx = track;
+	packet.dts_usec  = dts_usec;
+	packet.size      = id;
+	return packet;
+}
+
+static void insert(struct darray *packets, enum obs_encoder_type type,
+		size_t track, int64_t dts_usec, size_t id)
+{
+	struct encoder_packet packet = make_packet(type, track, dts_usec, id);
+	interleave_insert_packet(packets, &packet);
+}
+
+static bool is_sorted(const struct darray *packets)
+{
+	const struct encoder_packet *array = packets->array;
+
+	for (size_t i = 1; i < packets->num; i++) {
+		if (array[i].dts_usec < array[i - 1].dts_usec)
+			return false;
+	}
+
+	return true;
+}
+
+static void test_insert_in_order(void)
+{
+	struct darray packets;
+	darray_init(&packets);
+
+	for (size_t i = 0; i < 100; i++)
+		insert(&packets, OBS_ENCODER_AUDIO, 0, (int64_t)i * 10, i);
+
+	check(packets.num == 100);
+	check(is_sorted(&packets));
+
+	darray_free(&packets);
+}
+
+static void test_insert_late(void)
+{
+	struct darray packets;
+	struct encoder_packet *array;
+
+	darray_init(&packets);
+
+	insert(&packets, OBS_ENCODER_AUDIO, 0, 0, 0);
+	insert(&packets, OBS_ENCODER_AUDIO, 0, 20, 1);
+	insert(&packets, OBS_ENCODER_AUDIO, 0, 40, 2);
+	insert(&packets, OBS_ENCODER_VIDEO, 0, 30, 3);
+	insert(&packets, OBS_ENCODER_VIDEO, 0, -10, 4);
+
+	array = packets.array;
+	check(packets.num == 5);
+	check(is_sorted(&packets));
+	check(array[0].size == 4);
+	check(array[3].size == 3);
+
+	darray_free(&packets);
+}
+
+static void test_insert_equal_timestamps(void)
+{
+	struct darray packets;
+	struct encoder_packet *array;
+
+	darray_init(&packets);
+
+	insert(&packets, OBS_ENCODER_AUDIO, 0, 0, 0);
+	insert(&packets, OBS_ENCODER_AUDIO, 0, 50, 1);
+	insert(&packets, OBS_ENCODER_VIDEO, 0, 20, 2);
+	insert(&packets, OBS_ENCODER_AUDIO, 1, 20, 3);
+	insert(&packets, OBS_ENCODER_AUDIO, 2, 20, 4);
+
+	/* equal timestamps keep the order they were received in */
+	array = packets.array;
+	check(packets.num == 5);
+	check(array[1].size == 2);
+	check(array[2].size == 3);
+	check(array[3].size == 4);
+	check(array[4].size == 1);
+
+	darray_free(&packets);
+}
+
+static void test_merge_tracks(void)
+{
+	struct darray packets;
+	struct encoder_packet *array;
+	size_t id = 0;
+
+	darray_init(&packets);
+
+	/* ordered by track first, as if the audio tracks were shifted back in
+	 * time after they were inserted */
+	for (int64_t ts = 0; ts < 1000; ts += 100) {
+		struct encoder_packet video = make_packet(OBS_ENCODER_VIDEO,
+				0, ts, id++);
+		struct encoder_packet audio1 = make_packet(OBS_ENCODER_AUDIO,
+				0, ts - 250, id++);
+		struct encoder_packet audio2 = make_packet(OBS_ENCODER_AUDIO,
+				1, ts - 300, id++);
+
+		darray_push_back(sizeof(video), &packets, &video);
+		darray_push_back(sizeof(audio1), &packets, &audio1);
+		darray_push_back(sizeof(audio2), &packets, &audio2);
+	}
+
+	interleave_merge_tracks(&packets);
+
+	check(packets.num == 30);
+	check(is_sorted(&packets));
+
+	/* video and the second audio track share timestamps, the packet that
+	 * came first in the old array stays first */
+	array = packets.array;
+	for (size_t i = 1; i < packets.num; i++) {
+		if (array[i].dts_usec == array[i - 1].dts_usec)
+			check(array[i].size > array[i - 1].size);
+	}
+
+	/* every track keeps its own order */
+	for (size_t track = 0; track < 3; track++) {
+		int64_t last = INT64_MIN;
+
+		for (size_t i = 0; i < packets.num; i++) {
+			size_t t = array[i].type == OBS_ENCODER_VIDEO ? 0 :
+				array[i].track_idx + 1;
+			if (t != track)
+				continue;
+
+			check(array[i].dts_usec > last);
+			last = array[i].dts_usec;
+		}
+	}
+
+	darray_free(&packets);
+}
+
+static void test_merge_empty(void)
+{
+	struct darray packets;
+	darray_init(&packets);
+
+	interleave_merge_tracks(&packets);
+	check(packets.num == 0);
+
+	darray_free(&packets);
+}
+
+int main(void)
+{
+	test_insert_in_order();
+	test_insert_late();
+	test_insert_equal_timestamps();
+	test_merge_tracks();
+	test_merge_empty();
+
+	return check_result();
+}
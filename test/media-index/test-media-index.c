@@ -0,0 +1,171 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+/* keyframe lookups of the media playback index, loaded from an index file */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <util/platform.h>
+#include <media-playback/index.h>
+#include "test-check.h"
+
+#define MEDIA_PATH "test-media-index.tmp"
+#define MEDIA_DATA "not a media file"
+#define INDEX_PATH MEDIA_PATH ".obs-index"
+
+#define SEC_NS 1000000000LL
+
+/* the contents don't matter, the index only checks size and time */
+static bool write_media_file(const char *data)
+{
+	FILE *file = os_fopen(MEDIA_PATH, "wb");
+	size_t size = strlen(data);
+	bool success;
+
+	if (!file)
+		return false;
+
+	success = fwrite(data, 1, size, file) == size;
+	fclose(file);
+	return success;
+}
+
+/* overwrites the start of the index file, where its magic is stored */
+static bool corrupt_index_file(void)
+{
+	FILE *file = os_fopen(INDEX_PATH, "r+b");
+	bool success;
+
+	if (!file)
+		return false;
+
+	success = fputc('X', file) != EOF;
+	fclose(file);
+	return success;
+}
+
+static int64_t find_pts(struct mp_index *index, int64_t pts)
+{
+	struct mp_index_entry entry = {-1, -1};
+
+	if (!mp_index_find(index, pts, &entry))
+		return -1;
+
+	check(entry.ts == entry.pts / SEC_NS);
+	return entry.pts;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static const struct mp_index_entry keyframes[] = {
+	{0 * SEC_NS, 0},
+	{2 * SEC_NS, 2},
+	{4 * SEC_NS, 4},
+	{6 * SEC_NS, 6}
+};
+
+#define NUM_KEYFRAMES (sizeof(keyframes) / sizeof(keyframes[0]))
+
+static void test_find(void)
+{
+	struct mp_index *index;
+
+	check(mp_index_write(MEDIA_PATH, 0, keyframes, NUM_KEYFRAMES));
+
+	index = mp_index_create(MEDIA_PATH, 0);
+	check(index != NULL);
+
+	/* before the first keyframe */
+	check(find_pts(index, -1) == 0);
+
+	/* exactly on a keyframe */
+	check(find_pts(index, 0) == 0);
+	check(find_pts(index, 2 * SEC_NS) == 2 * SEC_NS);
+	check(find_pts(index, 6 * SEC_NS) == 6 * SEC_NS);
+
+	/* between keyframes */
+	check(find_pts(index, 2 * SEC_NS - 1) == 0);
+	check(find_pts(index, 5 * SEC_NS) == 4 * SEC_NS);
+
+	/* after the last keyframe */
+	check(find_pts(index, 100 * SEC_NS) == 6 * SEC_NS);
+
+	mp_index_destroy(index);
+}
+
+static void test_find_single(void)
+{
+	struct mp_index *index;
+
+	check(mp_index_write(MEDIA_PATH, 0, &keyframes[1], 1));
+
+	index = mp_index_create(MEDIA_PATH, 0);
+	check(index != NULL);
+
+	check(find_pts(index, 0) == 2 * SEC_NS);
+	check(find_pts(index, 2 * SEC_NS) == 2 * SEC_NS);
+	check(find_pts(index, 3 * SEC_NS) == 2 * SEC_NS);
+
+	mp_index_destroy(index);
+}
+
+/* an index that doesn't match the file is built again, which fails for
+ * this file, so lookups never succeed */
+static void test_ignore_invalid(void)
+{
+	struct mp_index *index;
+
+	/* the file changed after the index was written */
+	check(mp_index_write(MEDIA_PATH, 0, keyframes, NUM_KEYFRAMES));
+	check(write_media_file(MEDIA_DATA " changed"));
+	index = mp_index_create(MEDIA_PATH, 0);
+	check(find_pts(index, 0) == -1);
+	mp_index_destroy(index);
+
+	/* the index was written for another stream */
+	check(mp_index_write(MEDIA_PATH, 1, keyframes, NUM_KEYFRAMES));
+	index = mp_index_create(MEDIA_PATH, 0);
+	check(find_pts(index, 0) == -1);
+	mp_index_destroy(index);
+
+	/* the index file is damaged */
+	check(mp_index_write(MEDIA_PATH, 0, keyframes, NUM_KEYFRAMES));
+	check(corrupt_index_file());
+	index = mp_index_create(MEDIA_PATH, 0);
+	check(find_pts(index, 0) == -1);
+	mp_index_destroy(index);
+
+	check(find_pts(NULL, 0) == -1);
+}
+
+int main(void)
+{
+	if (!write_media_file(MEDIA_DATA)) {
+		fprintf(stderr, "Couldn't write '%s'\n", MEDIA_PATH);
+		return 1;
+	}
+
+	test_find();
+	test_find_single();
+	test_ignore_invalid();
+
+	os_unlink(INDEX_PATH);
+	os_unlink(MEDIA_PATH);
+
+	return check_result();
+}
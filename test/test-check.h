@@ -0,0 +1,45 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+/*
+ * Minimal check harness shared by the unit tests.  A failed check prints its
+ * location and expression and the test keeps going, main returns
+ * check_result() so ctest sees every failure at once.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+
+static int failures = 0;
+
+#define check(expr) \
+	do { \
+		if (!(expr)) { \
+			fprintf(stderr, "%s:%d: check failed: %s\n", \
+					__FILE__, __LINE__, #expr); \
+			failures++; \
+		} \
+	} while (false)
+
+static inline int check_result(void)
+{
+	if (failures)
+		fprintf(stderr, "%d checks failed\n", failures);
+	return failures ? 1 : 0;
+}